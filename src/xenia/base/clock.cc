@@ -31,6 +31,24 @@ DEFINE_bool(clock_source_raw, false,
             "Use the RDTSC instruction as the time source. "
             "Host CPU must support invariant TSC.",
             "CPU");
+DEFINE_bool(clock_deterministic, false,
+            "Run guest time from a virtual clock instead of the host clock. "
+            "Guest time advances by a fixed amount on every guest clock read "
+            "and jumps to the next frame on every vblank, so it follows the "
+            "guest's progress rather than the host's. It still depends on how "
+            "many reads the guest gets to make before each vblank, so it "
+            "isn't fully independent of the host speed.",
+            "CPU");
+DEFINE_uint64(clock_deterministic_ticks_per_read, 500,
+              "Guest ticks (50MHz) that pass on every guest clock read with "
+              "clock_deterministic, so code waiting for time to pass makes "
+              "progress between vblanks.",
+              "CPU");
+// 2025-01-01 00:00:00 UTC.
+DEFINE_uint64(clock_deterministic_system_time, 133801632000000000,
+              "Guest system time at startup with clock_deterministic, in "
+              "FILETIME format.",
+              "CPU");
 
 namespace xe {
 
@@ -49,6 +67,9 @@ std::pair<uint64_t, uint64_t> guest_tick_ratio_ = std::make_pair(1, 1);
 uint64_t last_guest_tick_count_ = 0;
 // Last sampled host tick count.
 uint64_t last_host_tick_count_ = Clock::QueryHostTickCount();
+// With clock_deterministic, the guest tick count at which the current frame
+// ends, 0 before the first frame.
+uint64_t guest_frame_end_tick_count_ = 0;
 
 using tick_mutex_type = std::mutex;
 
@@ -79,6 +100,11 @@ void RecomputeGuestTickScalar() {
 // Update the guest timer for all threads.
 // Return a copy of the value so locking is reduced.
 uint64_t UpdateGuestClock() {
+  if (cvars::clock_deterministic) {
+    std::lock_guard<tick_mutex_type> lock(tick_mutex_);
+    return last_guest_tick_count_;
+  }
+
   uint64_t host_tick_count = Clock::QueryHostTickCount();
 
   if (cvars::clock_no_scaling) {
@@ -106,7 +132,7 @@ uint64_t UpdateGuestClock() {
 
 // Offset of the current guest system file time relative to the guest base time.
 inline uint64_t QueryGuestSystemTimeOffset() {
-  if (cvars::clock_no_scaling) {
+  if (cvars::clock_no_scaling && !cvars::clock_deterministic) {
     return Clock::QueryHostSystemTime() - guest_system_time_base_;
   }
 
@@ -165,13 +191,27 @@ void Clock::set_guest_system_time_base(uint64_t time_base) {
 }
 
 uint64_t Clock::QueryGuestTickCount() {
+  if (cvars::clock_deterministic) {
+    std::lock_guard<tick_mutex_type> lock(tick_mutex_);
+    uint64_t guest_tick_count =
+        last_guest_tick_count_ + cvars::clock_deterministic_ticks_per_read;
+    if (guest_frame_end_tick_count_) {
+      // Time passing within the frame must not reach the next one.
+      guest_tick_count = std::max(
+          last_guest_tick_count_,
+          std::min(guest_tick_count, guest_frame_end_tick_count_ - 1));
+    }
+    last_guest_tick_count_ = guest_tick_count;
+    return guest_tick_count;
+  }
+
   auto guest_tick_count = UpdateGuestClock();
   return guest_tick_count;
 }
 
 uint64_t* Clock::GetGuestTickCountPointer() { return &last_guest_tick_count_; }
 uint64_t Clock::QueryGuestSystemTime() {
-  if (cvars::clock_no_scaling) {
+  if (cvars::clock_no_scaling && !cvars::clock_deterministic) {
     return Clock::QueryHostSystemTime();
   }
 
@@ -180,6 +220,9 @@ uint64_t Clock::QueryGuestSystemTime() {
 }
 
 uint64_t Clock::QueryGuestInterruptTime() {
+  if (cvars::clock_deterministic) {
+    return QueryGuestSystemTimeOffset();
+  }
   return Clock::QueryHostInterruptTime();
 }
 
@@ -190,7 +233,7 @@ uint32_t Clock::QueryGuestUptimeMillis() {
 }
 
 void Clock::SetGuestSystemTime(uint64_t system_time) {
-  if (cvars::clock_no_scaling) {
+  if (cvars::clock_no_scaling && !cvars::clock_deterministic) {
     // Time is fixed to host time.
     return;
   }
@@ -200,6 +243,28 @@ void Clock::SetGuestSystemTime(uint64_t system_time) {
   guest_system_time_base_ = system_time - guest_system_time_offset;
 }
 
+void Clock::AdvanceGuestFrame(uint64_t frame_ticks) {
+  if (!cvars::clock_deterministic) {
+    return;
+  }
+  std::lock_guard<tick_mutex_type> lock(tick_mutex_);
+  // The first frame starts wherever the reads before it left the clock.
+  last_guest_tick_count_ =
+      std::max(last_guest_tick_count_, guest_frame_end_tick_count_);
+  guest_frame_end_tick_count_ = last_guest_tick_count_ + frame_ticks;
+}
+
+void Clock::ResetForTesting() {
+  guest_time_scalar_ = 1.0;
+  guest_tick_frequency_ = Clock::host_tick_frequency_platform();
+  guest_system_time_base_ = Clock::QueryHostSystemTime();
+  RecomputeGuestTickScalar();
+  std::lock_guard<tick_mutex_type> lock(tick_mutex_);
+  last_guest_tick_count_ = 0;
+  last_host_tick_count_ = Clock::QueryHostTickCount();
+  guest_frame_end_tick_count_ = 0;
+}
+
 uint32_t Clock::ScaleGuestDurationMillis(uint32_t guest_ms) {
   if (cvars::clock_no_scaling) {
     return guest_ms;
@@ -22,9 +22,16 @@
 
 DECLARE_bool(clock_no_scaling);
 DECLARE_bool(clock_source_raw);
+DECLARE_bool(clock_deterministic);
+DECLARE_uint64(clock_deterministic_ticks_per_read);
+DECLARE_uint64(clock_deterministic_system_time);
 
 namespace xe {
 
+namespace base::test {
+class DeterministicClockScope;
+}  // namespace base::test
+
 // chrono APIs in xenia/base/chrono.h are preferred
 
 class Clock {
@@ -88,12 +95,25 @@ class Clock {
   // Sets the system time of the guest.
   static void SetGuestSystemTime(uint64_t system_time);
 
+  // With clock_deterministic, starts a new guest frame lasting frame_ticks
+  // guest ticks: guest time jumps to the end of the previous frame, and each
+  // QueryGuestTickCount then moves it forward by a fixed step, but never past
+  // the end of the new frame. Does nothing otherwise.
+  static void AdvanceGuestFrame(uint64_t frame_ticks);
+
   // Scales a time duration in milliseconds, from guest time.
   static uint32_t ScaleGuestDurationMillis(uint32_t guest_ms);
   // Scales a time duration in 100ns ticks like FILETIME, from guest time.
   static int64_t ScaleGuestDurationFileTime(int64_t guest_file_time);
   // Scales a time duration represented as a timeval, from guest time.
   static void ScaleGuestDurationTimeval(int32_t* tv_sec, int32_t* tv_usec);
+
+ private:
+  friend class base::test::DeterministicClockScope;
+
+  // Puts the guest clock back in its startup state, with the host frequency and
+  // system time, no scaling and no frames.
+  static void ResetForTesting();
 };
 
 }  // namespace xe
@@ -108,6 +108,14 @@ class FileHandle {
   // Flushes any pending write buffers to the underlying filesystem.
   virtual void Flush() = 0;
 
+  // Hints that the range will be read soon, so the OS may start loading it in
+  // the background.
+  virtual void Prefetch(size_t file_offset, size_t length) {}
+
+  // Hints that the file is accessed randomly, so the OS should not read ahead
+  // beyond the requested ranges.
+  virtual void DisableReadAhead() {}
+
  protected:
   explicit FileHandle(const std::filesystem::path& path) : path_(path) {}
 
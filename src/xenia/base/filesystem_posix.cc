@@ -155,6 +155,13 @@ class PosixFileHandle : public FileHandle {
     return ftruncate(handle_, length) >= 0 ? true : false;
   }
   void Flush() override { fsync(handle_); }
+  void Prefetch(size_t file_offset, size_t length) override {
+    posix_fadvise(handle_, off_t(file_offset), off_t(length),
+                  POSIX_FADV_WILLNEED);
+  }
+  void DisableReadAhead() override {
+    posix_fadvise(handle_, 0, 0, POSIX_FADV_RANDOM);
+  }
 
  private:
   int handle_ = -1;
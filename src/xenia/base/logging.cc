@@ -56,6 +56,11 @@ DEFINE_bool(log_to_debugprint, false, "Dump the log to DebugPrint.", "Logging");
 DEFINE_bool(flush_log, true, "Flush log file after each log line batch.",
             "Logging");
 
+DEFINE_bool(log_deferred_formatting, true,
+            "Format log lines with simple arguments (numbers, enums) on the "
+            "logging thread instead of the thread doing the logging.",
+            "Logging");
+
 DEFINE_uint32(log_mask, 0,
               "Disables specific categorizes for more granular debug logging. "
               "Kernel = 1, Apu = 2, Cpu = 4.",
@@ -81,6 +86,11 @@ struct LogLine {
   uint16_t _pad_0;  // (2b) padding
   bool terminate;
   char prefix_char;
+  // If not null, the buffer contains arguments packed by DeferredLogArgs
+  // followed by the format string (format_length characters at the end of the
+  // buffer) rather than text, and they need to be formatted.
+  logging::internal::DeferredFormatFunction format_function;
+  size_t format_length;
 };
 
 thread_local char thread_log_buffer_[64_KiB];
@@ -262,6 +272,10 @@ class Logger {
     return (byte_size + (kBlockSize - 1)) / kBlockSize;
   }
 
+  // Deferred lines are formatted here, only accessed by the write thread.
+  char format_buffer_[64_KiB];
+  char format_string_buffer_[logging::internal::kMaxDeferredFormatSize];
+
   dp::spin_wait_strategy wait_strategy_;
   dp::multi_threaded_claim_strategy<dp::spin_wait_strategy> claim_strategy_;
   dp::sequence_barrier<dp::spin_wait_strategy> consumed_;
@@ -336,7 +350,9 @@ class Logger {
             Write(prefix, sizeof(prefix) - 1);
           }
 
-          if (line.buffer_length) {
+          if (line.format_function) {
+            WriteDeferredLine(rb, line);
+          } else if (line.buffer_length) {
             // Get access to the line data - which may be split in the ring
             // buffer - and write it out in parts.
             auto line_range = rb.BeginRead(line.buffer_length);
@@ -402,6 +418,38 @@ class Logger {
     }
   }
 
+  void WriteDeferredLine(RingBuffer& rb, const LogLine& line) {
+    // The packed arguments may be split in the ring buffer, and need to be
+    // aligned for reading anyway.
+    alignas(16) uint8_t packed_args[logging::internal::kMaxDeferredArgsSize];
+    size_t packed_size = line.buffer_length - line.format_length;
+    assert_true(packed_size <= sizeof(packed_args));
+    assert_true(line.format_length <= sizeof(format_string_buffer_));
+    rb.Read(packed_args, packed_size);
+    rb.Read(format_string_buffer_, line.format_length);
+    std::string_view format(format_string_buffer_, line.format_length);
+
+    size_t length = 0;
+    try {
+      length = line.format_function(format, packed_args, format_buffer_,
+                                    sizeof(format_buffer_));
+    } catch (const std::exception& e) {
+      auto result = fmt::format_to_n(format_buffer_, sizeof(format_buffer_),
+                                     "Failed to format log line \"{}\": {}",
+                                     format, e.what());
+      length = std::min(result.size, sizeof(format_buffer_));
+    }
+    if (length) {
+      Write(format_buffer_, length);
+    }
+
+    // Always ensure there is a newline.
+    if (!length || format_buffer_[length - 1] != '\n') {
+      constexpr char suffix[1] = {'\n'};
+      Write(suffix, 1);
+    }
+  }
+
  public:
   void AppendLine(uint32_t thread_id, const char prefix_char,
                   const char* buffer_data, size_t buffer_length,
@@ -428,6 +476,36 @@ class Logger {
 
     claim_strategy_.publish(range);
   }
+
+  void AppendDeferredLine(uint32_t thread_id, const char prefix_char,
+                          std::string_view format,
+                          logging::internal::DeferredFormatFunction function,
+                          const uint8_t* packed_args, size_t packed_size) {
+    size_t count =
+        BlockCount(sizeof(LogLine) + packed_size + format.size());
+
+    auto range = claim_strategy_.claim(count);
+    assert_true(range.size() == count);
+
+    RingBuffer rb(buffer_, kBufferSize);
+    rb.set_write_offset(BlockOffset(range.first()));
+    rb.set_read_offset(BlockOffset(range.end()));
+
+    LogLine line = {};
+    line.buffer_length = packed_size + format.size();
+    line.thread_id = thread_id;
+    line.prefix_char = prefix_char;
+    line.format_function = function;
+    line.format_length = format.size();
+
+    rb.Write(&line, sizeof(LogLine));
+    if (packed_size) {
+      rb.Write(packed_args, packed_size);
+    }
+    rb.Write(format.data(), format.size());
+
+    claim_strategy_.publish(range);
+  }
 };
 
 void InitializeLogging(const std::string_view app_name) {
@@ -497,6 +575,23 @@ void logging::internal::AppendLogLine(LogLevel log_level,
                       thread_log_buffer_, written);
 }
 
+bool logging::internal::ShouldDeferFormatting() {
+  return logger_ && cvars::log_deferred_formatting;
+}
+
+XE_NOALIAS
+void logging::internal::AppendDeferredLogLine(
+    LogLevel log_level, const char prefix_char, std::string_view format,
+    DeferredFormatFunction format_function, const uint8_t* packed_args,
+    size_t packed_size) {
+  if (!logger_ || !ShouldLog(log_level)) {
+    return;
+  }
+  logger_->AppendDeferredLine(xe::threading::current_thread_id(), prefix_char,
+                              format, format_function, packed_args,
+                              packed_size);
+}
+
 void logging::AppendLogLine(LogLevel log_level, const char prefix_char,
                             const std::string_view str, uint32_t log_mask) {
   if (!internal::ShouldLog(log_level, log_mask) || !str.size()) {
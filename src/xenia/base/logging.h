@@ -10,9 +10,15 @@
 #ifndef XENIA_BASE_LOGGING_H_
 #define XENIA_BASE_LOGGING_H_
 
+#include <algorithm>
+#include <array>
 #include <cstdarg>
 #include <cstdint>
+#include <cstring>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "third_party/fmt/include/fmt/format.h"
 #include "third_party/fmt/include/fmt/std.h"
@@ -81,6 +87,7 @@ void InitializeLogging(const std::string_view app_name);
 void ShutdownLogging();
 
 namespace logging {
+
 namespace internal {
 
 void ToggleLogLevel();
@@ -92,6 +99,85 @@ std::pair<char*, size_t> GetThreadBuffer();
 XE_NOALIAS
 void AppendLogLine(LogLevel log_level, const char prefix_char, size_t written);
 
+// Formats packed arguments into out, returning the number of characters
+// written (capped to out_size). Called on the logging thread.
+using DeferredFormatFunction = size_t (*)(std::string_view format,
+                                          const uint8_t* packed_args,
+                                          char* out, size_t out_size);
+
+// Largest argument pack that may be copied into the log ring buffer. Larger
+// packs are formatted on the calling thread.
+constexpr size_t kMaxDeferredArgsSize = 128;
+// The format string may not outlive the call either, so it's copied into the
+// log ring buffer after the arguments. Longer ones are formatted on the calling
+// thread. The format is only checked against the arguments when formatting, at
+// runtime, either way.
+constexpr size_t kMaxDeferredFormatSize = 1024;
+
+// Only values that are meaningful on their own can be formatted later - a
+// pointer to a string or a string_view may be dangling by the time the logging
+// thread gets to it, even though they are trivially copyable.
+template <typename T>
+struct IsDeferrableLogArg
+    : std::bool_constant<std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+                         std::is_null_pointer_v<T> ||
+                         (std::is_pointer_v<T> &&
+                          std::is_void_v<std::remove_pointer_t<T>>)> {};
+
+template <typename... Args>
+struct DeferredLogArgs {
+  static constexpr size_t kSize = (size_t(0) + ... + sizeof(Args));
+  static constexpr bool kDeferrable =
+      (true && ... && IsDeferrableLogArg<Args>::value) &&
+      kSize <= kMaxDeferredArgsSize;
+
+  static void Pack(uint8_t* out, const Args&... args) {
+    size_t offset = 0;
+    ((std::memcpy(out + offset, &args, sizeof(Args)), offset += sizeof(Args)),
+     ...);
+  }
+
+  static size_t Format(std::string_view format, const uint8_t* packed_args,
+                       char* out, size_t out_size) {
+    return FormatUnpacked(format, packed_args, out, out_size,
+                          std::index_sequence_for<Args...>());
+  }
+
+ private:
+  static constexpr std::array<size_t, sizeof...(Args)> kOffsets = [] {
+    std::array<size_t, sizeof...(Args)> offsets{};
+    size_t offset = 0, i = 0;
+    ((offsets[i++] = offset, offset += sizeof(Args)), ...);
+    return offsets;
+  }();
+
+  template <typename T>
+  static T Unpack(const uint8_t* packed) {
+    T value;
+    std::memcpy(&value, packed, sizeof(T));
+    return value;
+  }
+
+  template <size_t... I>
+  static size_t FormatUnpacked(std::string_view format,
+                               const uint8_t* packed_args, char* out,
+                               size_t out_size, std::index_sequence<I...>) {
+    auto result = fmt::format_to_n(
+        out, out_size, fmt::runtime(format),
+        Unpack<std::tuple_element_t<I, std::tuple<Args...>>>(packed_args +
+                                                             kOffsets[I])...);
+    return std::min(result.size, out_size);
+  }
+};
+
+// Whether log_deferred_formatting is enabled and the logger is running.
+bool ShouldDeferFormatting();
+XE_NOALIAS
+void AppendDeferredLogLine(LogLevel log_level, const char prefix_char,
+                           std::string_view format,
+                           DeferredFormatFunction format_function,
+                           const uint8_t* packed_args, size_t packed_size);
+
 }  // namespace internal
 // technically, noalias is incorrect here, these functions do in fact alias
 // global memory, but msvc will not optimize the calls away, and the global
@@ -101,6 +187,20 @@ template <typename... Args>
 XE_NOALIAS XE_NOINLINE XE_COLD static void AppendLogLineFormat_Impl(
     LogLevel log_level, const char prefix_char, std::string_view format,
     const Args&... args) noexcept {
+  using Deferred = internal::DeferredLogArgs<Args...>;
+  if constexpr (Deferred::kDeferrable) {
+    // Only copies of the format string and the arguments enter the ring
+    // buffer, the logging thread does the actual formatting.
+    if (format.size() <= internal::kMaxDeferredFormatSize &&
+        internal::ShouldDeferFormatting()) {
+      uint8_t packed_args[Deferred::kSize ? Deferred::kSize : 1];
+      Deferred::Pack(packed_args, args...);
+      internal::AppendDeferredLogLine(log_level, prefix_char, format,
+                                      &Deferred::Format, packed_args,
+                                      Deferred::kSize);
+      return;
+    }
+  }
   auto target = internal::GetThreadBuffer();
   auto result = fmt::format_to_n(target.first, target.second,
                                  fmt::runtime(format), args...);
@@ -59,6 +59,10 @@ class MappedMemory {
   // Changes the offset inside the file. This will update data() and size()!
   virtual bool Remap(size_t offset, size_t length) { return false; }
 
+  // Hints that the range will be accessed soon, so the OS may start paging it
+  // in the background instead of faulting on access.
+  virtual void Prefetch(size_t offset, size_t length) {}
+
  protected:
   void* data_;
   size_t size_;
@@ -13,6 +13,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <algorithm>
 #include <memory>
 
 #include "xenia/base/filesystem.h"
@@ -84,6 +85,19 @@ class PosixMappedMemory : public MappedMemory {
 
   void Flush() override { msync(data(), size(), MS_ASYNC); }
 
+  void Prefetch(size_t offset, size_t length) override {
+    if (!data_ || offset >= size()) {
+      return;
+    }
+    length = std::min(length, size() - offset);
+    // madvise requires a page-aligned start.
+    uintptr_t page_size = uintptr_t(sysconf(_SC_PAGESIZE));
+    uintptr_t start = uintptr_t(data() + offset);
+    uintptr_t aligned_start = start & ~(page_size - 1);
+    madvise(reinterpret_cast<void*>(aligned_start),
+            length + (start - aligned_start), MADV_WILLNEED);
+  }
+
  private:
   int file_descriptor_;
 };
@@ -7,6 +7,7 @@
  ******************************************************************************
  */
 
+#include <algorithm>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -68,6 +69,16 @@ class Win32MappedMemory : public MappedMemory {
   }
 
   void Flush() override { FlushViewOfFile(data(), size()); }
+
+  void Prefetch(size_t offset, size_t length) override {
+    if (!data_ || offset >= size()) {
+      return;
+    }
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = data() + offset;
+    range.NumberOfBytes = std::min(length, size() - offset);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+  }
   bool Remap(size_t offset, size_t length) override {
     size_t aligned_offset = offset & ~(memory::allocation_granularity() - 1);
     size_t aligned_length = length + (offset - aligned_offset);
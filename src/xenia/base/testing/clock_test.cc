@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/clock.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe::base::test {
+
+// Leaves the clock as other tests expect it even if a check fails.
+class DeterministicClockScope {
+ public:
+  DeterministicClockScope() : deterministic_(cvars::clock_deterministic) {
+    cvars::clock_deterministic = true;
+  }
+  ~DeterministicClockScope() {
+    cvars::clock_deterministic = deterministic_;
+    Clock::ResetForTesting();
+  }
+
+ private:
+  bool deterministic_;
+};
+
+TEST_CASE("Deterministic guest clock", "[clock]") {
+  DeterministicClockScope clock_scope;
+  Clock::set_guest_tick_frequency(50000000);
+  Clock::set_guest_system_time_base(cvars::clock_deterministic_system_time);
+  const uint64_t step = cvars::clock_deterministic_ticks_per_read;
+
+  SECTION("Tick count reads advance the clock by a fixed step") {
+    uint64_t first = Clock::QueryGuestTickCount();
+    REQUIRE(Clock::QueryGuestTickCount() == first + step);
+    // Other queries read the clock without moving it.
+    uint64_t system_time = Clock::QueryGuestSystemTime();
+    REQUIRE(Clock::QueryGuestSystemTime() == system_time);
+    REQUIRE(Clock::QueryGuestTickCount() == first + step * 2);
+    REQUIRE(Clock::QueryGuestSystemTime() == system_time + step / 5);
+  }
+
+  SECTION("Time passing within a frame stops at the frame end") {
+    const uint64_t frame_ticks = step * 3;
+    Clock::AdvanceGuestFrame(frame_ticks);
+    uint64_t frame_start = Clock::QueryGuestTickCount() - step;
+    REQUIRE(Clock::QueryGuestTickCount() == frame_start + step * 2);
+    REQUIRE(Clock::QueryGuestTickCount() == frame_start + frame_ticks - 1);
+    REQUIRE(Clock::QueryGuestTickCount() == frame_start + frame_ticks - 1);
+    Clock::AdvanceGuestFrame(frame_ticks);
+    REQUIRE(Clock::QueryGuestTickCount() == frame_start + frame_ticks + step);
+  }
+}
+
+}  // namespace xe::base::test
@@ -20,51 +20,120 @@ namespace backend {
 namespace x64 {
 
 volatile int anchor_control = 0;
+
+// Returns the compare opcode giving the same result with the operands swapped.
+static Opcode SwapCompareOperands(Opcode opcode) {
+  switch (opcode) {
+    case OPCODE_COMPARE_SLT:
+      return OPCODE_COMPARE_SGT;
+    case OPCODE_COMPARE_SLE:
+      return OPCODE_COMPARE_SGE;
+    case OPCODE_COMPARE_SGT:
+      return OPCODE_COMPARE_SLT;
+    case OPCODE_COMPARE_SGE:
+      return OPCODE_COMPARE_SLE;
+    case OPCODE_COMPARE_ULT:
+      return OPCODE_COMPARE_UGT;
+    case OPCODE_COMPARE_ULE:
+      return OPCODE_COMPARE_UGE;
+    case OPCODE_COMPARE_UGT:
+      return OPCODE_COMPARE_ULT;
+    case OPCODE_COMPARE_UGE:
+      return OPCODE_COMPARE_ULE;
+    default:
+      return opcode;
+  }
+}
+
+// Returns the compare opcode giving the opposite result.
+static Opcode InvertCompare(Opcode opcode) {
+  switch (opcode) {
+    case OPCODE_COMPARE_EQ:
+      return OPCODE_COMPARE_NE;
+    case OPCODE_COMPARE_NE:
+      return OPCODE_COMPARE_EQ;
+    case OPCODE_COMPARE_SLT:
+      return OPCODE_COMPARE_SGE;
+    case OPCODE_COMPARE_SLE:
+      return OPCODE_COMPARE_SGT;
+    case OPCODE_COMPARE_SGT:
+      return OPCODE_COMPARE_SLE;
+    case OPCODE_COMPARE_SGE:
+      return OPCODE_COMPARE_SLT;
+    case OPCODE_COMPARE_ULT:
+      return OPCODE_COMPARE_UGE;
+    case OPCODE_COMPARE_ULE:
+      return OPCODE_COMPARE_UGT;
+    case OPCODE_COMPARE_UGT:
+      return OPCODE_COMPARE_ULE;
+    case OPCODE_COMPARE_UGE:
+      return OPCODE_COMPARE_ULT;
+    default:
+      return opcode;
+  }
+}
+
+// If the condition is computed by an integer compare right before the branch,
+// jumps on the flags it left instead of testing the result.
 template <typename T>
-static void EmitFusedBranch(X64Emitter& e, const T& i) {
-  bool valid = i.instr->prev && i.instr->prev->dest == i.src1.value;
-  auto opcode = valid ? i.instr->prev->opcode->num : -1;
-  if (valid) {
-    std::string name = i.src2.value->GetIdString();
-    switch (opcode) {
-      case OPCODE_COMPARE_EQ:
-        e.je(std::move(name), e.T_NEAR);
-        break;
-      case OPCODE_COMPARE_NE:
-        e.jne(std::move(name), e.T_NEAR);
-        break;
-      case OPCODE_COMPARE_SLT:
-        e.jl(std::move(name), e.T_NEAR);
-        break;
-      case OPCODE_COMPARE_SLE:
-        e.jle(std::move(name), e.T_NEAR);
-        break;
-      case OPCODE_COMPARE_SGT:
-        e.jg(std::move(name), e.T_NEAR);
-        break;
-      case OPCODE_COMPARE_SGE:
-        e.jge(std::move(name), e.T_NEAR);
-        break;
-      case OPCODE_COMPARE_ULT:
-        e.jb(std::move(name), e.T_NEAR);
-        break;
-      case OPCODE_COMPARE_ULE:
-        e.jbe(std::move(name), e.T_NEAR);
-        break;
-      case OPCODE_COMPARE_UGT:
-        e.ja(std::move(name), e.T_NEAR);
-        break;
-      case OPCODE_COMPARE_UGE:
-        e.jae(std::move(name), e.T_NEAR);
-        break;
-      default:
-        e.test(i.src1, i.src1);
-        e.jnz(std::move(name), e.T_NEAR);
-        break;
-    }
-  } else {
+static void EmitFusedBranch(X64Emitter& e, const T& i, bool branch_if_true) {
+  const hir::Instr* prev = i.instr->prev;
+  bool valid = prev && prev->dest == i.src1.value &&
+               prev->opcode->num >= OPCODE_COMPARE_EQ &&
+               prev->opcode->num <= OPCODE_COMPARE_UGE &&
+               IsScalarIntegralType(prev->src1.value->type);
+  std::string name = i.src2.value->GetIdString();
+  if (!valid) {
     e.test(i.src1, i.src1);
-    e.jnz(i.src2.value->GetIdString(), e.T_NEAR);
+    if (branch_if_true) {
+      e.jnz(std::move(name), e.T_NEAR);
+    } else {
+      e.jz(std::move(name), e.T_NEAR);
+    }
+    return;
+  }
+  Opcode opcode = prev->opcode->num;
+  // A constant first operand is compared with the operands swapped.
+  if (prev->src1.value->IsConstant()) {
+    opcode = SwapCompareOperands(opcode);
+  }
+  if (!branch_if_true) {
+    opcode = InvertCompare(opcode);
+  }
+  switch (opcode) {
+    case OPCODE_COMPARE_EQ:
+      e.je(std::move(name), e.T_NEAR);
+      break;
+    case OPCODE_COMPARE_NE:
+      e.jne(std::move(name), e.T_NEAR);
+      break;
+    case OPCODE_COMPARE_SLT:
+      e.jl(std::move(name), e.T_NEAR);
+      break;
+    case OPCODE_COMPARE_SLE:
+      e.jle(std::move(name), e.T_NEAR);
+      break;
+    case OPCODE_COMPARE_SGT:
+      e.jg(std::move(name), e.T_NEAR);
+      break;
+    case OPCODE_COMPARE_SGE:
+      e.jge(std::move(name), e.T_NEAR);
+      break;
+    case OPCODE_COMPARE_ULT:
+      e.jb(std::move(name), e.T_NEAR);
+      break;
+    case OPCODE_COMPARE_ULE:
+      e.jbe(std::move(name), e.T_NEAR);
+      break;
+    case OPCODE_COMPARE_UGT:
+      e.ja(std::move(name), e.T_NEAR);
+      break;
+    case OPCODE_COMPARE_UGE:
+      e.jae(std::move(name), e.T_NEAR);
+      break;
+    default:
+      assert_unhandled_case(opcode);
+      break;
   }
 }
 // ============================================================================
@@ -501,25 +570,25 @@ EMITTER_OPCODE_TABLE(OPCODE_BRANCH, BRANCH);
 struct BRANCH_TRUE_I8
     : Sequence<BRANCH_TRUE_I8, I<OPCODE_BRANCH_TRUE, VoidOp, I8Op, LabelOp>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
-    EmitFusedBranch(e, i);
+    EmitFusedBranch(e, i, true);
   }
 };
 struct BRANCH_TRUE_I16
     : Sequence<BRANCH_TRUE_I16, I<OPCODE_BRANCH_TRUE, VoidOp, I16Op, LabelOp>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
-    EmitFusedBranch(e, i);
+    EmitFusedBranch(e, i, true);
   }
 };
 struct BRANCH_TRUE_I32
     : Sequence<BRANCH_TRUE_I32, I<OPCODE_BRANCH_TRUE, VoidOp, I32Op, LabelOp>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
-    EmitFusedBranch(e, i);
+    EmitFusedBranch(e, i, true);
   }
 };
 struct BRANCH_TRUE_I64
     : Sequence<BRANCH_TRUE_I64, I<OPCODE_BRANCH_TRUE, VoidOp, I64Op, LabelOp>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
-    EmitFusedBranch(e, i);
+    EmitFusedBranch(e, i, true);
   }
 };
 struct BRANCH_TRUE_F32
@@ -556,32 +625,28 @@ EMITTER_OPCODE_TABLE(OPCODE_BRANCH_TRUE, BRANCH_TRUE_I8, BRANCH_TRUE_I16,
 struct BRANCH_FALSE_I8
     : Sequence<BRANCH_FALSE_I8, I<OPCODE_BRANCH_FALSE, VoidOp, I8Op, LabelOp>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
-    e.test(i.src1, i.src1);
-    e.jz(i.src2.value->GetIdString(), e.T_NEAR);
+    EmitFusedBranch(e, i, false);
   }
 };
 struct BRANCH_FALSE_I16
     : Sequence<BRANCH_FALSE_I16,
                I<OPCODE_BRANCH_FALSE, VoidOp, I16Op, LabelOp>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
-    e.test(i.src1, i.src1);
-    e.jz(i.src2.value->GetIdString(), e.T_NEAR);
+    EmitFusedBranch(e, i, false);
   }
 };
 struct BRANCH_FALSE_I32
     : Sequence<BRANCH_FALSE_I32,
                I<OPCODE_BRANCH_FALSE, VoidOp, I32Op, LabelOp>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
-    e.test(i.src1, i.src1);
-    e.jz(i.src2.value->GetIdString(), e.T_NEAR);
+    EmitFusedBranch(e, i, false);
   }
 };
 struct BRANCH_FALSE_I64
     : Sequence<BRANCH_FALSE_I64,
                I<OPCODE_BRANCH_FALSE, VoidOp, I64Op, LabelOp>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
-    e.test(i.src1, i.src1);
-    e.jz(i.src2.value->GetIdString(), e.T_NEAR);
+    EmitFusedBranch(e, i, false);
   }
 };
 struct BRANCH_FALSE_F32
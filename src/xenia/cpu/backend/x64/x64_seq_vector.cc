@@ -576,6 +576,33 @@ struct VECTOR_COMPARE_UGE_V128
     : Sequence<VECTOR_COMPARE_UGE_V128,
                I<OPCODE_VECTOR_COMPARE_UGE, V128Op, V128Op, V128Op>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
+    if (e.IsFeatureEnabled(kX64EmitAVX512Ortho | kX64EmitAVX512BW |
+                           kX64EmitAVX512DQ) &&
+        (i.instr->flags != FLOAT32_TYPE)) {
+      Xmm src1 = GetInputRegOrConstant(e, i.src1, e.xmm0);
+      Xmm src2 = GetInputRegOrConstant(e, i.src2, e.xmm1);
+
+      // Predicate 5 is "not less than".
+      switch (i.instr->flags) {
+        case INT8_TYPE:
+          e.vpcmpub(e.k1, src1, src2, 0x5);
+          e.vpmovm2b(i.dest, e.k1);
+          break;
+        case INT16_TYPE:
+          e.vpcmpuw(e.k1, src1, src2, 0x5);
+          e.vpmovm2w(i.dest, e.k1);
+          break;
+        case INT32_TYPE:
+          e.vpcmpud(e.k1, src1, src2, 0x5);
+          e.vpmovm2d(i.dest, e.k1);
+          break;
+        default:
+          assert_always();
+          break;
+      }
+      return;
+    }
+
     Xbyak::Address sign_addr = e.ptr[e.rax];  // dummy
     switch (i.instr->flags) {
       case INT8_TYPE:
@@ -880,6 +907,56 @@ static XmmConst GetShiftmaskForType(unsigned typ) {
     return XMMXOPDwordShiftMask;
   }
 }
+
+// AVX-512BW has shifts by a separate amount in every word, bytes are shifted
+// as words and truncated back. Returns false if not available for the type.
+template <typename T>
+static bool EmitVariableShiftAVX512(X64Emitter& e, const T& i, Opcode opcode) {
+  const uint32_t type = i.instr->flags;
+  if ((type != INT8_TYPE && type != INT16_TYPE) ||
+      !e.IsFeatureEnabled(kX64EmitAVX512Ortho | kX64EmitAVX512BW)) {
+    return false;
+  }
+  Xmm src1 = GetInputRegOrConstant(e, i.src1, e.xmm0);
+  Xmm src2 = GetInputRegOrConstant(e, i.src2, e.xmm1);
+  e.vpand(e.xmm2, src2, e.GetXmmConstPtr(GetShiftmaskForType(type)));
+
+  if (type == INT16_TYPE) {
+    switch (opcode) {
+      case OPCODE_VECTOR_SHL:
+        e.vpsllvw(i.dest, src1, e.xmm2);
+        break;
+      case OPCODE_VECTOR_SHR:
+        e.vpsrlvw(i.dest, src1, e.xmm2);
+        break;
+      default:
+        e.vpsravw(i.dest, src1, e.xmm2);
+        break;
+    }
+    return true;
+  }
+
+  if (opcode == OPCODE_VECTOR_SHA) {
+    e.vpmovsxbw(e.ymm0, src1);
+  } else {
+    e.vpmovzxbw(e.ymm0, src1);
+  }
+  e.vpmovzxbw(e.ymm2, e.xmm2);
+  switch (opcode) {
+    case OPCODE_VECTOR_SHL:
+      e.vpsllvw(e.ymm0, e.ymm0, e.ymm2);
+      break;
+    case OPCODE_VECTOR_SHR:
+      e.vpsrlvw(e.ymm0, e.ymm0, e.ymm2);
+      break;
+    default:
+      e.vpsravw(e.ymm0, e.ymm0, e.ymm2);
+      break;
+  }
+  e.vpmovwb(i.dest, e.ymm0);
+  return true;
+}
+
 struct VECTOR_SHL_V128
     : Sequence<VECTOR_SHL_V128, I<OPCODE_VECTOR_SHL, V128Op, V128Op, V128Op>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
@@ -921,6 +998,9 @@ struct VECTOR_SHL_V128
   }
 
   static void EmitInt8(X64Emitter& e, const EmitArgType& i) {
+    if (EmitVariableShiftAVX512(e, i, OPCODE_VECTOR_SHL)) {
+      return;
+    }
     // TODO(benvanik): native version (with shift magic).
 
     if (e.IsFeatureEnabled(kX64EmitAVX2)) {
@@ -1063,6 +1143,10 @@ struct VECTOR_SHL_V128
       }
     }
 
+    if (EmitVariableShiftAVX512(e, i, OPCODE_VECTOR_SHL)) {
+      return;
+    }
+
     // Shift 8 words in src1 by amount specified in src2.
     Xbyak::Label emu, end;
 
@@ -1281,6 +1365,9 @@ struct VECTOR_SHR_V128
         return;
       }
     }
+    if (EmitVariableShiftAVX512(e, i, OPCODE_VECTOR_SHR)) {
+      return;
+    }
     unsigned stack_offset_src1 = StackLayout::GUEST_SCRATCH;
     unsigned stack_offset_src2 = StackLayout::GUEST_SCRATCH + 16;
 
@@ -1338,6 +1425,10 @@ struct VECTOR_SHR_V128
       }
     }
 
+    if (EmitVariableShiftAVX512(e, i, OPCODE_VECTOR_SHR)) {
+      return;
+    }
+
     // Shift 8 words in src1 by amount specified in src2.
     Xbyak::Label emu, end;
 
@@ -1583,9 +1674,15 @@ struct VECTOR_SHA_V128
         return;
       }
 
+      if (EmitVariableShiftAVX512(e, i, OPCODE_VECTOR_SHA)) {
+        return;
+      }
       e.StashConstantXmm(1, i.src2.constant());
       stack_offset_src2 = X64Emitter::kStashOffset + 16;
     } else {
+      if (EmitVariableShiftAVX512(e, i, OPCODE_VECTOR_SHA)) {
+        return;
+      }
       e.vmovdqa(e.ptr[e.rsp + stack_offset_src2], i.src2);
     }
 
@@ -1637,6 +1734,10 @@ struct VECTOR_SHA_V128
       }
     }
 
+    if (EmitVariableShiftAVX512(e, i, OPCODE_VECTOR_SHA)) {
+      return;
+    }
+
     // Shift 8 words in src1 by amount specified in src2.
     Xbyak::Label emu, end;
 
@@ -1809,6 +1910,21 @@ struct VECTOR_ROTATE_LEFT_V128
       unsigned stack_offset_src2 = StackLayout::GUEST_SCRATCH + 16;
       switch (i.instr->flags) {
         case INT8_TYPE: {
+          if (e.IsFeatureEnabled(kX64EmitAVX512Ortho | kX64EmitAVX512BW)) {
+            Xmm src1 = GetInputRegOrConstant(e, i.src1, e.xmm0);
+            Xmm src2 = GetInputRegOrConstant(e, i.src2, e.xmm1);
+            e.vpand(e.xmm2, src2, e.GetXmmConstPtr(XMMXOPByteShiftMask));
+            e.vpmovzxbw(e.ymm2, e.xmm2);
+            // Each byte doubled into a word, the high byte of the shifted
+            // word is the rotated byte.
+            e.vpmovzxbw(e.ymm0, src1);
+            e.vpsllw(e.ymm1, e.ymm0, 8);
+            e.vpor(e.ymm0, e.ymm0, e.ymm1);
+            e.vpsllvw(e.ymm0, e.ymm0, e.ymm2);
+            e.vpsrlw(e.ymm0, e.ymm0, 8);
+            e.vpmovwb(i.dest, e.ymm0);
+            break;
+          }
           if (i.src1.is_constant) {
             e.StashConstantXmm(0, i.src1.constant());
             stack_offset_src1 = X64Emitter::kStashOffset;
@@ -1841,6 +1957,19 @@ struct VECTOR_ROTATE_LEFT_V128
 
         } break;
         case INT16_TYPE: {
+          if (e.IsFeatureEnabled(kX64EmitAVX512Ortho | kX64EmitAVX512BW)) {
+            Xmm src1 = GetInputRegOrConstant(e, i.src1, e.xmm0);
+            Xmm src2 = GetInputRegOrConstant(e, i.src2, e.xmm1);
+            e.vpand(e.xmm1, src2, e.GetXmmConstPtr(XMMXOPWordShiftMask));
+            // (x << n) | (x >> ((16 - n) & 15)).
+            e.vpxor(e.xmm2, e.xmm2, e.xmm2);
+            e.vpsubw(e.xmm2, e.xmm2, e.xmm1);
+            e.vpand(e.xmm2, e.xmm2, e.GetXmmConstPtr(XMMXOPWordShiftMask));
+            e.vpsllvw(e.xmm3, src1, e.xmm1);
+            e.vpsrlvw(i.dest, src1, e.xmm2);
+            e.vpor(i.dest, i.dest, e.xmm3);
+            break;
+          }
           if (i.src1.is_constant) {
             e.StashConstantXmm(0, i.src1.constant());
             stack_offset_src1 = X64Emitter::kStashOffset;
@@ -1873,7 +2002,9 @@ struct VECTOR_ROTATE_LEFT_V128
         } break;
         case INT32_TYPE: {
           if (e.IsFeatureEnabled(kX64EmitAVX512Ortho)) {
-            e.vprolvd(i.dest, i.src1, i.src2);
+            Xmm src1 = GetInputRegOrConstant(e, i.src1, e.xmm0);
+            Xmm src2 = GetInputRegOrConstant(e, i.src2, e.xmm1);
+            e.vprolvd(i.dest, src1, src2);
           } else if (e.IsFeatureEnabled(kX64EmitAVX2)) {
             Xmm temp = i.dest;
             if (i.dest == i.src1 || i.dest == i.src2) {
@@ -2932,6 +3063,16 @@ struct PACK : Sequence<PACK, I<OPCODE_PACK, V128Op, V128Op, V128Op>> {
       if (IsPackOutUnsigned(flags)) {
         if (IsPackOutSaturate(flags)) {
           // unsigned -> unsigned + saturate
+          if (e.IsFeatureEnabled(kX64EmitAVX512Ortho)) {
+            // Narrow both sources at once, then swap the words in each dword
+            // like the shuffles below.
+            Xmm src1 = GetInputRegOrConstant(e, i.src1, e.xmm0);
+            Xmm src2 = GetInputRegOrConstant(e, i.src2, e.xmm1);
+            e.vinserti128(e.ymm0, Xbyak::Ymm(src1.getIdx()), src2, 1);
+            e.vpmovusdw(i.dest, e.ymm0);
+            e.vprold(i.dest, i.dest, 16);
+            return;
+          }
           // Construct a saturation max value
           e.mov(e.eax, 0xFFFFu);
           e.vmovd(e.xmm0, e.eax);
@@ -2993,8 +3134,12 @@ struct PACK : Sequence<PACK, I<OPCODE_PACK, V128Op, V128Op, V128Op>> {
           // TMP[15:0] <- (DEST[31:0] < 0) ? 0 : DEST[15:0];
           // DEST[15:0] <- (DEST[31:0] > FFFFH) ? FFFFH : TMP[15:0];
           e.vpackusdw(i.dest, i.src1, i.src2);
-          e.vpshuflw(i.dest, i.dest, 0b10110001);
-          e.vpshufhw(i.dest, i.dest, 0b10110001);
+          if (e.IsFeatureEnabled(kX64EmitAVX512Ortho)) {
+            e.vprold(i.dest, i.dest, 16);
+          } else {
+            e.vpshuflw(i.dest, i.dest, 0b10110001);
+            e.vpshufhw(i.dest, i.dest, 0b10110001);
+          }
         } else {
           // signed -> unsigned
           assert_always();
@@ -3012,8 +3157,12 @@ struct PACK : Sequence<PACK, I<OPCODE_PACK, V128Op, V128Op, V128Op>> {
             e.LoadConstantXmm(src2, i.src2.constant());
           }
           e.vpackssdw(i.dest, i.src1, src2);
-          e.vpshuflw(i.dest, i.dest, 0b10110001);
-          e.vpshufhw(i.dest, i.dest, 0b10110001);
+          if (e.IsFeatureEnabled(kX64EmitAVX512Ortho)) {
+            e.vprold(i.dest, i.dest, 16);
+          } else {
+            e.vpshuflw(i.dest, i.dest, 0b10110001);
+            e.vpshufhw(i.dest, i.dest, 0b10110001);
+          }
         } else {
           // signed -> signed
           assert_always();
@@ -495,7 +495,8 @@ EMITTER_OPCODE_TABLE(OPCODE_ROUND, ROUND_F32, ROUND_F64, ROUND_V128);
 // ============================================================================
 struct LOAD_CLOCK : Sequence<LOAD_CLOCK, I<OPCODE_LOAD_CLOCK, I64Op>> {
   static void Emit(X64Emitter& e, const EmitArgType& i) {
-    if (cvars::inline_loadclock) {
+    // Reads through Clock move the deterministic clock forward.
+    if (cvars::inline_loadclock && !cvars::clock_deterministic) {
       e.mov(e.rcx,
             e.GetBackendCtxPtr(offsetof(X64BackendContext, guest_tick_count)));
       e.mov(i.dest, e.qword[e.rcx]);
@@ -505,7 +506,8 @@ struct LOAD_CLOCK : Sequence<LOAD_CLOCK, I<OPCODE_LOAD_CLOCK, I64Op>> {
       // simple multiply and division. In that case we rather bake the scaling
       // in here to cut extra function calls with CPU cache misses and stack
       // frame overhead.
-      if (cvars::clock_no_scaling && cvars::clock_source_raw) {
+      if (cvars::clock_no_scaling && cvars::clock_source_raw &&
+          !cvars::clock_deterministic) {
         auto ratio = Clock::guest_tick_ratio();
         // The 360 CPU is an in-order CPU, AMD64 usually isn't. Without
         // mfence/lfence magic the rdtsc instruction can be executed sooner or
@@ -9,6 +9,9 @@
 
 #include "xenia/cpu/compiler/passes/context_promotion_pass.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "xenia/apu/apu_flags.h"
 #include "xenia/base/cvar.h"
 #include "xenia/base/profiling.h"
@@ -51,6 +54,7 @@ bool ContextPromotionPass::Initialize(Compiler* compiler) {
   // This is a terrible implementation.
   context_values_.resize(sizeof(ppc::PPCContext));
   context_validity_.resize(static_cast<uint32_t>(sizeof(ppc::PPCContext)));
+  context_slots_.resize(sizeof(ppc::PPCContext), kUntrackedSlot);
 
   return true;
 }
@@ -68,11 +72,12 @@ bool ContextPromotionPass::Run(HIRBuilder* builder) {
   // Example of dead store elimination:
   //   store_context +100, v0  <-- removed due to following store
   //   store_context +100, v1
-  // This is more generally done by DSE, however if it could be done here
-  // instead as it may be faster (at least on the block-level).
+  // Stores are removed at the function level, so values overwritten on all
+  // paths after a branch are dropped too.
 
   // Promote loads to values.
-  // Process each block independently, for now.
+  // Values can't cross blocks at this stage, so each block is processed
+  // independently.
   auto block = builder->first_block();
   while (block) {
     PromoteBlock(block);
@@ -84,11 +89,7 @@ bool ContextPromotionPass::Run(HIRBuilder* builder) {
   // trying to extract stack traces/register values, so we don't do that.
   if (cvars::full_optimization_even_with_debug ||
       (!cvars::debug && !cvars::store_all_context_values)) {
-    block = builder->first_block();
-    while (block) {
-      RemoveDeadStoresBlock(block);
-      block = block->next;
-    }
+    RemoveDeadStores(builder);
   }
 
   return true;
@@ -101,12 +102,14 @@ void ContextPromotionPass::PromoteBlock(Block* block) {
   Instr* i = block->instr_head;
   while (i) {
     auto next = i->next;
-    if (i->opcode->flags & OPCODE_FLAG_VOLATILE) {
+    if (i->opcode->flags & OPCODE_FLAG_VOLATILE ||
+        i->opcode == &OPCODE_CONTEXT_BARRIER_info) {
       // Volatile instruction - requires all context values be flushed.
       validity.reset();
     } else if (i->opcode == &OPCODE_LOAD_CONTEXT_info) {
       size_t offset = i->src1.offset;
-      if (validity.test(static_cast<uint32_t>(offset))) {
+      if (validity.test(static_cast<uint32_t>(offset)) &&
+          context_values_[offset]->type == i->dest->type) {
         // Legit previous value, reuse.
         Value* previous_value = context_values_[offset];
         i->opcode = &hir::OPCODE_ASSIGN_info;
@@ -119,6 +122,8 @@ void ContextPromotionPass::PromoteBlock(Block* block) {
     } else if (i->opcode == &OPCODE_STORE_CONTEXT_info) {
       size_t offset = i->src1.offset;
       Value* value = i->src2.value;
+      // Values of other widths sharing the stored bytes are stale now.
+      InvalidateOverlappingValues(offset, GetTypeSize(value->type));
       // Store value into the table for later.
       context_values_[offset] = value;
       validity.set(static_cast<uint32_t>(offset));
@@ -127,25 +132,135 @@ void ContextPromotionPass::PromoteBlock(Block* block) {
   }
 }
 
-void ContextPromotionPass::RemoveDeadStoresBlock(Block* block) {
+void ContextPromotionPass::InvalidateOverlappingValues(size_t offset,
+                                                       size_t size) {
   auto& validity = context_validity_;
-  validity.reset();
+  // Values are at most 16 bytes wide, so the ones starting further before
+  // can't overlap.
+  size_t first_offset = offset >= 15 ? offset - 15 : 0;
+  for (size_t value_offset = first_offset; value_offset < offset + size;
+       ++value_offset) {
+    if (validity.test(static_cast<uint32_t>(value_offset)) &&
+        value_offset + GetTypeSize(context_values_[value_offset]->type) >
+            offset) {
+      validity.reset(static_cast<uint32_t>(value_offset));
+    }
+  }
+}
 
-  // Walk backwards and mark offsets that are written to.
-  // If the offset was written to earlier, ignore the store.
-  Instr* i = block->instr_tail;
+void ContextPromotionPass::RemoveDeadStores(HIRBuilder* builder) {
+  // Give a liveness bit to every context byte stored to in the function.
+  // Bytes that are only loaded can't make any store dead, so they aren't
+  // tracked.
+  uint32_t slot_count = 0;
+  size_t block_count = 0;
+  auto block = builder->first_block();
+  while (block) {
+    block->ordinal = uint16_t(block_count++);
+    for (Instr* i = block->instr_head; i; i = i->next) {
+      if (i->opcode != &OPCODE_STORE_CONTEXT_info) {
+        continue;
+      }
+      size_t offset = i->src1.offset;
+      size_t end_offset = offset + GetTypeSize(i->src2.value->type);
+      for (size_t byte_offset = offset; byte_offset < end_offset;
+           ++byte_offset) {
+        if (context_slots_[byte_offset] == kUntrackedSlot) {
+          context_slots_[byte_offset] = slot_count++;
+        }
+      }
+    }
+    block = block->next;
+  }
+
+  // The per-block state is indexed by the 16-bit block ordinals, which wrap in
+  // huge functions. Keep all their stores then, as those are very rare.
+  if (slot_count && block_count <= UINT16_MAX) {
+    // Backwards liveness of the stored bytes. The sets only grow, so this
+    // converges, usually after one more iteration than the loop nesting depth.
+    if (block_live_in_.size() < block_count) {
+      block_live_in_.resize(block_count);
+    }
+    for (size_t n = 0; n < block_count; ++n) {
+      block_live_in_[n].clear();
+      block_live_in_[n].resize(slot_count);
+    }
+    llvm::BitVector live(slot_count);
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      block = builder->last_block();
+      while (block) {
+        ComputeLiveness(block, live, false);
+        if (live != block_live_in_[block->ordinal]) {
+          block_live_in_[block->ordinal] = live;
+          changed = true;
+        }
+        block = block->prev;
+      }
+    }
+
+    // Drop the stores overwritten on every path before anything can read
+    // them.
+    block = builder->first_block();
+    while (block) {
+      ComputeLiveness(block, live, true);
+      block = block->next;
+    }
+  }
+
+  std::fill(context_slots_.begin(), context_slots_.end(), kUntrackedSlot);
+}
+
+void ContextPromotionPass::ComputeLiveness(Block* block, llvm::BitVector& live,
+                                           bool remove_dead_stores) {
+  // Start from what's live when leaving the block. Branches to labels are
+  // merged in as they are reached, the rest of the successors is the next
+  // block unless the block ends with an unconditional branch.
+  Instr* tail = block->instr_tail;
+  if (tail && tail->opcode == &OPCODE_BRANCH_info) {
+    live.reset();
+  } else if (block->next) {
+    live = block_live_in_[block->next->ordinal];
+  } else {
+    // Falling off the end of the function.
+    live.set();
+  }
+
+  Instr* i = tail;
   while (i) {
     Instr* prev = i->prev;
-    if (i->opcode->flags & (OPCODE_FLAG_VOLATILE | OPCODE_FLAG_BRANCH)) {
-      // Volatile instruction - requires all context values be flushed.
-      validity.reset();
+    if (i->opcode == &OPCODE_BRANCH_info) {
+      live |= block_live_in_[i->src1.label->block->ordinal];
+    } else if (i->opcode == &OPCODE_BRANCH_TRUE_info ||
+               i->opcode == &OPCODE_BRANCH_FALSE_info) {
+      live |= block_live_in_[i->src2.label->block->ordinal];
+    } else if (i->opcode->flags & OPCODE_FLAG_VOLATILE ||
+               i->opcode == &OPCODE_CONTEXT_BARRIER_info) {
+      // Calls, returns, traps and such may observe the whole context.
+      live.set();
+    } else if (i->opcode == &OPCODE_LOAD_CONTEXT_info) {
+      size_t offset = i->src1.offset;
+      size_t end_offset = offset + GetTypeSize(i->dest->type);
+      for (size_t byte_offset = offset; byte_offset < end_offset;
+           ++byte_offset) {
+        uint32_t slot = context_slots_[byte_offset];
+        if (slot != kUntrackedSlot) {
+          live.set(slot);
+        }
+      }
     } else if (i->opcode == &OPCODE_STORE_CONTEXT_info) {
       size_t offset = i->src1.offset;
-      if (!validity.test(static_cast<uint32_t>(offset))) {
-        // Offset not yet written, mark and continue.
-        validity.set(static_cast<uint32_t>(offset));
-      } else {
-        // Already written to. Remove this store.
+      size_t end_offset = offset + GetTypeSize(i->src2.value->type);
+      bool is_live = false;
+      for (size_t byte_offset = offset; byte_offset < end_offset;
+           ++byte_offset) {
+        uint32_t slot = context_slots_[byte_offset];
+        is_live |= live.test(slot);
+        live.reset(slot);
+      }
+      if (!is_live && remove_dead_stores) {
+        // Overwritten everywhere before being read. Remove this store.
         i->UnlinkAndNOP();
       }
     }
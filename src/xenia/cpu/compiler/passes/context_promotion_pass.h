@@ -11,6 +11,7 @@
 #define XENIA_CPU_COMPILER_PASSES_CONTEXT_PROMOTION_PASS_H_
 
 #include <cmath>
+#include <cstdint>
 #include <vector>
 
 #include "xenia/base/platform.h"
@@ -42,11 +43,23 @@ class ContextPromotionPass : public CompilerPass {
 
  private:
   void PromoteBlock(hir::Block* block);
-  void RemoveDeadStoresBlock(hir::Block* block);
+  void InvalidateOverlappingValues(size_t offset, size_t size);
+  void RemoveDeadStores(hir::HIRBuilder* builder);
+  void ComputeLiveness(hir::Block* block, llvm::BitVector& live,
+                       bool remove_dead_stores);
 
  private:
+  static constexpr uint32_t kUntrackedSlot = UINT32_MAX;
+
   std::vector<hir::Value*> context_values_;
   llvm::BitVector context_validity_;
+
+  // Liveness bit index of each context byte stored to in the function, or
+  // kUntrackedSlot.
+  std::vector<uint32_t> context_slots_;
+  // Context bytes that may be read before being overwritten when entering each
+  // block, by block ordinal.
+  std::vector<llvm::BitVector> block_live_in_;
 };
 
 }  // namespace passes
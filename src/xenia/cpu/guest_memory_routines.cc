@@ -0,0 +1,294 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/guest_memory_routines.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "xenia/base/assert.h"
+#include "xenia/base/mutex.h"
+#include "xenia/cpu/ppc/ppc_context.h"
+#include "xenia/cpu/processor.h"
+#include "xenia/memory.h"
+
+namespace xe {
+namespace cpu {
+
+namespace {
+
+// Guest addresses from 0xE0000000 may have an additional offset in the host
+// mapping, so ranges crossing it can't be accessed as one host range.
+constexpr uint32_t kHostAddressOffsetBoundary = 0xE0000000;
+
+bool CrossesHostAddressOffsetBoundary(uint32_t address, uint32_t length) {
+  return address < kHostAddressOffsetBoundary &&
+         length > kHostAddressOffsetBoundary - address;
+}
+
+// Notifies the owners of watched physical pages (such as the GPU caches) about
+// the range being written, like writing to them from guest code would.
+void TriggerWriteCallbacks(Memory* memory, uint32_t address, uint32_t length) {
+  while (length) {
+    BaseHeap* heap = memory->LookupHeap(address);
+    if (!heap) {
+      return;
+    }
+    uint64_t heap_end = uint64_t(heap->heap_base()) + heap->heap_size();
+    if (heap_end <= address) {
+      return;
+    }
+    uint32_t heap_length =
+        uint32_t(std::min(uint64_t(length), heap_end - address));
+    if (heap->heap_type() == HeapType::kGuestPhysical) {
+      memory->TriggerPhysicalMemoryCallbacks(
+          xe::global_critical_region::AcquireDirect(), address, heap_length,
+          true, true);
+    }
+    address += heap_length;
+    length -= heap_length;
+  }
+}
+
+// Whether the guest can access the whole range without faulting. The host
+// mapping of pages the guest can't access may be missing, so such ranges are
+// left to the guest code.
+bool IsRangeAccessible(Memory* memory, uint32_t address, uint32_t length,
+                       bool write) {
+  if (uint64_t(address) + length > UINT64_C(0x100000000)) {
+    return false;
+  }
+  while (length) {
+    BaseHeap* heap = memory->LookupHeap(address);
+    if (!heap) {
+      return false;
+    }
+    uint64_t heap_end = uint64_t(heap->heap_base()) + heap->heap_size();
+    if (heap_end <= address) {
+      return false;
+    }
+    uint32_t heap_length =
+        uint32_t(std::min(uint64_t(length), heap_end - address));
+    xe::memory::PageAccess access =
+        heap->QueryRangeAccess(address, address + heap_length - 1);
+    if (write ? access != xe::memory::PageAccess::kReadWrite
+              : access == xe::memory::PageAccess::kNoAccess) {
+      return false;
+    }
+    address += heap_length;
+    length -= heap_length;
+  }
+  return true;
+}
+
+void GuestMemmove(ppc::PPCContext* ppc_context,
+                  kernel::KernelState* kernel_state) {
+  uint32_t dest = uint32_t(ppc_context->r[3]);
+  uint32_t src = uint32_t(ppc_context->r[4]);
+  uint32_t length = uint32_t(ppc_context->r[5]);
+  Memory* memory = ppc_context->processor->memory();
+  if (!IsRangeAccessible(memory, src, length, false) ||
+      !IsRangeAccessible(memory, dest, length, true)) {
+    ppc_context->scratch = 0;
+    return;
+  }
+  ppc_context->scratch = 1;
+  // r3 is returned unchanged.
+  if (!length) {
+    return;
+  }
+  TriggerWriteCallbacks(memory, dest, length);
+  if (!CrossesHostAddressOffsetBoundary(dest, length) &&
+      !CrossesHostAddressOffsetBoundary(src, length)) {
+    std::memmove(memory->TranslateVirtual(dest),
+                 memory->TranslateVirtual(src), length);
+    return;
+  }
+  // Rare, per byte in the direction safe for overlapping ranges.
+  if (dest <= src) {
+    for (uint32_t i = 0; i < length; ++i) {
+      *memory->TranslateVirtual(dest + i) = *memory->TranslateVirtual(src + i);
+    }
+  } else {
+    for (uint32_t i = length; i--;) {
+      *memory->TranslateVirtual(dest + i) = *memory->TranslateVirtual(src + i);
+    }
+  }
+}
+
+void GuestMemset(ppc::PPCContext* ppc_context,
+                 kernel::KernelState* kernel_state) {
+  uint32_t dest = uint32_t(ppc_context->r[3]);
+  uint8_t value = uint8_t(ppc_context->r[4]);
+  uint32_t length = uint32_t(ppc_context->r[5]);
+  Memory* memory = ppc_context->processor->memory();
+  if (!IsRangeAccessible(memory, dest, length, true)) {
+    ppc_context->scratch = 0;
+    return;
+  }
+  ppc_context->scratch = 1;
+  if (!length) {
+    return;
+  }
+  TriggerWriteCallbacks(memory, dest, length);
+  if (CrossesHostAddressOffsetBoundary(dest, length)) {
+    uint32_t low_length = kHostAddressOffsetBoundary - dest;
+    std::memset(memory->TranslateVirtual(dest), value, low_length);
+    dest = kHostAddressOffsetBoundary;
+    length -= low_length;
+  }
+  std::memset(memory->TranslateVirtual(dest), value, length);
+}
+
+// An instruction with the bits outside the mask (usually registers chosen by
+// the compiler) ignored.
+struct InstructionPattern {
+  uint32_t value;
+  uint32_t mask;
+};
+
+constexpr uint32_t kFieldRS = 0x1F << 21;  // Also RT.
+constexpr uint32_t kFieldRA = 0x1F << 16;
+constexpr uint32_t kFieldRB = 0x1F << 11;
+constexpr uint32_t kFieldBF = 0x7 << 23;
+
+constexpr InstructionPattern MakePattern(uint32_t value,
+                                         uint32_t ignored_fields = 0) {
+  return {value & ~ignored_fields, ~ignored_fields};
+}
+
+constexpr uint32_t EncodeM(uint32_t opcode, uint32_t rs, uint32_t ra,
+                           uint32_t sh, uint32_t mb, uint32_t me) {
+  return opcode << 26 | rs << 21 | ra << 16 | sh << 11 | mb << 6 | me << 1;
+}
+constexpr uint32_t EncodeX(uint32_t xo, uint32_t rt, uint32_t ra,
+                           uint32_t rb) {
+  return 31 << 26 | rt << 21 | ra << 16 | rb << 11 | xo << 1;
+}
+
+// rlwimi rA, rS, 8, 16, 23 (insrwi rA, rS, 8, 16).
+constexpr uint32_t kSplatByteToHalfword = EncodeM(20, 0, 0, 8, 16, 23);
+// rlwimi rA, rS, 16, 0, 15 (insrwi rA, rS, 16, 0).
+constexpr uint32_t kSplatHalfwordToWord = EncodeM(20, 0, 0, 16, 0, 15);
+// subf rT, r4, r3 - dest - src.
+constexpr uint32_t kSubtractSourceFromDest = EncodeX(40, 0, 4, 3);
+
+struct RoutineSignature {
+  GuestMemoryRoutine routine;
+  // Must appear in this order among the first kSignatureWindow instructions.
+  uint32_t pattern_count;
+  InstructionPattern patterns[3];
+};
+
+constexpr uint32_t kSignatureWindow = 32;
+// Larger functions are something more than a plain memory routine.
+constexpr uint32_t kSignatureMaxInstructionCount = 4096;
+
+const RoutineSignature kRoutineSignatures[] = {
+    // The value byte replicated to a word in place for word-sized stores.
+    {GuestMemoryRoutine::kMemset,
+     2,
+     {MakePattern(kSplatByteToHalfword | 4 << 21 | 4 << 16),
+      MakePattern(kSplatHalfwordToWord | 4 << 21 | 4 << 16)}},
+    // The same after zero-extending the value byte to another register.
+    {GuestMemoryRoutine::kMemset,
+     3,
+     {MakePattern(EncodeM(21, 4, 0, 0, 24, 31), kFieldRA),
+      MakePattern(kSplatByteToHalfword, kFieldRS | kFieldRA),
+      MakePattern(kSplatHalfwordToWord, kFieldRS | kFieldRA)}},
+    // dest - src compared with the count as unsigned to copy backwards if the
+    // destination starts inside the source.
+    {GuestMemoryRoutine::kMemmove,
+     2,
+     {MakePattern(kSubtractSourceFromDest, kFieldRS),
+      MakePattern(EncodeX(32, 0, 0, 5), kFieldBF | kFieldRA)}},
+    {GuestMemoryRoutine::kMemmove,
+     2,
+     {MakePattern(kSubtractSourceFromDest, kFieldRS),
+      MakePattern(EncodeX(32, 0, 5, 0), kFieldBF | kFieldRB)}},
+};
+
+// Memory routines don't call anything and don't need a stack frame.
+bool IsFramelessLeaf(const xe::be<uint32_t>* code,
+                     uint32_t instruction_count) {
+  for (uint32_t i = 0; i < instruction_count; ++i) {
+    uint32_t instruction = code[i];
+    uint32_t opcode = instruction >> 26;
+    // b/bc/bclr/bcctr with LK set, or sc.
+    if (((opcode == 16 || opcode == 18 || opcode == 19) && (instruction & 1)) ||
+        opcode == 17) {
+      return false;
+    }
+    // stwu/stdu r1.
+    if ((opcode == 37 || (opcode == 62 && (instruction & 3) == 1)) &&
+        ((instruction >> 16) & 0x1F) == 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+const char* GetGuestMemoryRoutineName(GuestMemoryRoutine routine) {
+  switch (routine) {
+    case GuestMemoryRoutine::kMemcpy:
+      return "memcpy";
+    case GuestMemoryRoutine::kMemmove:
+      return "memmove";
+    case GuestMemoryRoutine::kMemset:
+      return "memset";
+  }
+  assert_unhandled_case(routine);
+  return "";
+}
+
+GuestFunction::ExternHandler GetGuestMemoryRoutineHandler(
+    GuestMemoryRoutine routine) {
+  switch (routine) {
+    case GuestMemoryRoutine::kMemcpy:
+      // Same result for the non-overlapping ranges memcpy is defined for.
+      return GuestMemmove;
+    case GuestMemoryRoutine::kMemmove:
+      return GuestMemmove;
+    case GuestMemoryRoutine::kMemset:
+      return GuestMemset;
+  }
+  assert_unhandled_case(routine);
+  return nullptr;
+}
+
+bool RecognizeGuestMemoryRoutine(const xe::be<uint32_t>* code,
+                                 uint32_t instruction_count,
+                                 GuestMemoryRoutine* routine_out) {
+  if (!instruction_count ||
+      instruction_count > kSignatureMaxInstructionCount) {
+    return false;
+  }
+  uint32_t window = std::min(instruction_count, kSignatureWindow);
+  for (const RoutineSignature& signature : kRoutineSignatures) {
+    uint32_t matched_count = 0;
+    for (uint32_t i = 0; i < window && matched_count < signature.pattern_count;
+         ++i) {
+      const InstructionPattern& pattern = signature.patterns[matched_count];
+      if ((uint32_t(code[i]) & pattern.mask) == pattern.value) {
+        ++matched_count;
+      }
+    }
+    if (matched_count == signature.pattern_count &&
+        IsFramelessLeaf(code, instruction_count)) {
+      *routine_out = signature.routine;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace cpu
+}  // namespace xe
@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_CPU_GUEST_MEMORY_ROUTINES_H_
+#define XENIA_CPU_GUEST_MEMORY_ROUTINES_H_
+
+#include "xenia/base/byte_order.h"
+#include "xenia/cpu/function.h"
+
+namespace xe {
+namespace cpu {
+
+// Guest C runtime memory functions that can be replaced with host
+// implementations operating directly on guest memory.
+enum class GuestMemoryRoutine {
+  // void* memcpy(void* dest, const void* src, size_t count)
+  kMemcpy,
+  // void* memmove(void* dest, const void* src, size_t count)
+  kMemmove,
+  // void* memset(void* dest, int value, size_t count)
+  kMemset,
+};
+
+const char* GetGuestMemoryRoutineName(GuestMemoryRoutine routine);
+
+// Handler for GuestFunction::SetupExtern implementing the routine with the
+// guest calling convention (arguments in r3-r5, dest returned in r3). Writes
+// to watched physical memory trigger the invalidation callbacks.
+// PPCContext::scratch is set to 1 if the call has been handled, or to 0 if the
+// guest would fault on the range, in which case the guest code of the function
+// must run instead.
+GuestFunction::ExternHandler GetGuestMemoryRoutineHandler(
+    GuestMemoryRoutine routine);
+
+// Checks whether the instructions of a whole guest function look like one of
+// the C runtime memory routines. memcpy implementations that check for
+// overlapping ranges are recognized as memmove.
+bool RecognizeGuestMemoryRoutine(const xe::be<uint32_t>* code,
+                                 uint32_t instruction_count,
+                                 GuestMemoryRoutine* routine_out);
+
+}  // namespace cpu
+}  // namespace xe
+
+#endif  // XENIA_CPU_GUEST_MEMORY_ROUTINES_H_
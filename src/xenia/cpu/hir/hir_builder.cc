@@ -47,7 +47,8 @@ namespace hir {
 #define ASSERT_TYPES_EQUAL(value1, value2) \
   assert_true((value1->type) == (value2->type))
 thread_local HIRBuilder* thrd_current_hirfunction = nullptr;
-HIRBuilder::HIRBuilder() {
+HIRBuilder::HIRBuilder()
+    : instr_arena_(1_MiB), value_arena_(1_MiB), use_arena_(512_KiB) {
   arena_ = new Arena();
   Reset();
 }
@@ -78,8 +79,14 @@ void HIRBuilder::Reset() {
   current_block_ = NULL;
 #if SCRIBBLE_ARENA_ON_RESET
   arena_->DebugFill();
+  instr_arena_.DebugFill();
+  value_arena_.DebugFill();
+  use_arena_.DebugFill();
 #endif
   arena_->Reset();
+  instr_arena_.Reset();
+  value_arena_.Reset();
+  use_arena_.Reset();
 }
 
 bool HIRBuilder::Finalize() {
@@ -122,7 +129,7 @@ Instr* HIRBuilder::AllocateInstruction() {
   if (result) {
     return result;
   }
-  return arena()->Alloc<Instr>();
+  return instr_arena_.Alloc<Instr>();
 }
 
 Value* HIRBuilder::AllocateValue() {
@@ -130,14 +137,14 @@ Value* HIRBuilder::AllocateValue() {
   if (result) {
     return result;
   }
-  return arena()->Alloc<Value>();
+  return value_arena_.Alloc<Value>();
 }
 Value::Use* HIRBuilder::AllocateUse() {
   Value::Use* result = free_uses_.NewEntry();
   if (result) {
     return result;
   }
-  return arena()->Alloc<Value::Use>();
+  return use_arena_.Alloc<Value::Use>();
 }
 void HIRBuilder::DeallocateInstruction(Instr* instr) {
   // free_instrs_.DeleteEntry(instr);
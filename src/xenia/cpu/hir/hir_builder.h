@@ -316,6 +316,12 @@ class HIRBuilder {
 
  protected:
   Arena* arena_;
+  // Instructions, values and uses are allocated from their own pools rather
+  // than interleaved with everything else in arena_, so passes walking the
+  // instruction list or use lists touch densely packed memory.
+  Arena instr_arena_;
+  Arena value_arena_;
+  Arena use_arena_;
 
   uint32_t attributes_;
 
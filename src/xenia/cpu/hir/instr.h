@@ -36,15 +36,6 @@ enum MovTunnel {
 
 class Instr {
  public:
-  Block* block;
-  Instr* next;
-  Instr* prev;
-
-  const OpcodeInfo* opcode;
-  uint16_t flags;
-  uint16_t backend_flags;  // backends may do whatever they wish with this
-  uint32_t ordinal;
-
   typedef union {
     Function* symbol;
     Label* label;
@@ -52,6 +43,18 @@ class Instr {
     uint64_t offset;
   } Op;
 
+  // The fields every pass looks at while walking the instruction list, up to
+  // and including the sources, come first and take 64 bytes. Instr isn't
+  // aligned to the cache line though, as that would make it 128 bytes rather
+  // than 96.
+  const OpcodeInfo* opcode;
+  uint16_t flags;
+  uint16_t backend_flags;  // backends may do whatever they wish with this
+  uint32_t ordinal;
+
+  Instr* next;
+  Instr* prev;
+
   Value* dest;
   union {
     struct {
@@ -61,6 +64,8 @@ class Instr {
     };
     Op srcs[3];
   };
+
+  Block* block;
   union {
     struct {
       Value::Use* src1_use;
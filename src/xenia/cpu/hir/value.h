@@ -134,13 +134,15 @@ class Value {
 
   Instr* def;
   Use* use_head;
-  // NOTE: for performance reasons this is not maintained during construction.
-  Instr* last_use;
-  RegAssignment reg;
+  // Before the fields used only by the backend, to keep the ones looked at by
+  // the passes together.
   union {
     Value* local_slot;
     ConstantValue constant;
   };
+  // NOTE: for performance reasons this is not maintained during construction.
+  Instr* last_use;
+  RegAssignment reg;
 
   Use* AddUse(Arena* arena, Instr* instr);
   void RemoveUse(Use* use);
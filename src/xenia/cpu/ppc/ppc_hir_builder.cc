@@ -78,6 +78,7 @@ void PPCHIRBuilder::Reset() {
   instr_count_ = 0;
   instr_offset_list_ = NULL;
   label_list_ = NULL;
+  cr_compare_.valid = false;
   with_debug_info_ = false;
   HIRBuilder::Reset();
 }
@@ -102,6 +103,19 @@ bool PPCHIRBuilder::Emit(GuestFunction* function, uint32_t flags) {
                   function_->name().c_str());
   }
 
+  // Functions replaced with a host implementation (not import thunks, which
+  // are rewritten to call their handler with sc 2). The handler may decline
+  // the call by clearing scratch, and then the guest code runs.
+  if (function_->behavior() == Function::Behavior::kExtern &&
+      function_->extern_handler() && !function_->export_data()) {
+    CallExtern(function_);
+    Label* guest_label = NewLabel();
+    BranchFalse(LoadContext(offsetof(PPCContext, scratch), INT64_TYPE),
+                guest_label);
+    Return();
+    MarkLabel(guest_label);
+  }
+
   // Allocate offset list.
   // This is used to quickly map labels to instructions.
   // The list is built as the instructions are traversed, with the values
@@ -116,6 +130,8 @@ bool PPCHIRBuilder::Emit(GuestFunction* function, uint32_t flags) {
 
   // Always mark entry with label.
   label_list_[0] = NewLabel();
+  CreateBranchLabels();
+  cr_compare_.valid = false;
 
   uint32_t start_address = function_->address();
   uint32_t end_address = function_->end_address();
@@ -135,6 +151,14 @@ bool PPCHIRBuilder::Emit(GuestFunction* function, uint32_t flags) {
       MarkLabel(label);
     }
 
+    // Compare operands are only reusable by a conditional branch in the same
+    // block.
+    if (label || address == cvars::break_on_instruction ||
+        (opcode != PPCOpcode::bcx && opcode != PPCOpcode::bclrx &&
+         opcode != PPCOpcode::bcctrx)) {
+      cr_compare_.valid = false;
+    }
+
     Instr* first_instr = 0;
     if (with_debug_info_) {
       if (label) {
@@ -199,6 +223,28 @@ bool PPCHIRBuilder::Emit(GuestFunction* function, uint32_t flags) {
   return Finalize();
 }
 
+void PPCHIRBuilder::CreateBranchLabels() {
+  // A label created after its instruction has been emitted splits the block
+  // containing it, so values emitted before it can't be used past it anymore.
+  // Create the labels of all direct branches within the function before
+  // emitting anything instead, so the block boundaries are known in advance.
+  Memory* memory = frontend_->memory();
+  uint32_t end_address = function_->end_address();
+  for (uint32_t address = function_->address(); address <= end_address;
+       address += 4) {
+    InstrData i;
+    i.code = xe::load_and_swap<uint32_t>(memory->TranslateVirtual(address));
+    PPCOpcode opcode = LookupOpcode(i.code);
+    if (opcode == PPCOpcode::bx) {
+      uint32_t target = uint32_t(XEEXTS26(i.I.LI << 2));
+      LookupLabel(i.I.AA ? target : address + target);
+    } else if (opcode == PPCOpcode::bcx) {
+      uint32_t target = uint32_t(XEEXTS16(i.B.BD << 2));
+      LookupLabel(i.B.AA ? target : address + target);
+    }
+  }
+}
+
 void PPCHIRBuilder::MaybeBreakOnInstruction(uint32_t address) {
   if (address != cvars::break_on_instruction) {
     return;
@@ -360,6 +406,24 @@ Value* PPCHIRBuilder::LoadCR(uint32_t n) {
 }
 
 Value* PPCHIRBuilder::LoadCRField(uint32_t n, uint32_t bit) {
+  // A branch ends the block, so a second branch on the same compare has to
+  // load the stored bit.
+  if (cr_compare_.valid && cr_compare_.field == n &&
+      cr_compare_.block == current_block_) {
+    // Comparing right before the consumer lets a branch use the flags.
+    Value* lhs = cr_compare_.lhs;
+    Value* rhs = cr_compare_.rhs;
+    switch (bit) {
+      case 0:
+        return cr_compare_.is_signed ? CompareSLT(lhs, rhs)
+                                     : CompareULT(lhs, rhs);
+      case 1:
+        return cr_compare_.is_signed ? CompareSGT(lhs, rhs)
+                                     : CompareUGT(lhs, rhs);
+      case 2:
+        return CompareEQ(lhs, rhs);
+    }
+  }
   return LoadContext(offsetof(PPCContext, cr0) + (4 * n) + bit, INT8_TYPE);
 }
 
@@ -372,6 +436,7 @@ void PPCHIRBuilder::StoreCR(Value* value) {
 }
 
 void PPCHIRBuilder::StoreCR(uint32_t n, Value* value) {
+  cr_compare_.valid = false;
   // Pull out the bits we are interested in.
   // Optimization passes will kill any unneeded stores (mostly).
   StoreContext(offsetof(PPCContext, cr0) + (4 * n) + 0,
@@ -389,6 +454,7 @@ void PPCHIRBuilder::StoreCR(uint32_t n, Value* value) {
 }
 
 void PPCHIRBuilder::StoreCRField(uint32_t n, uint32_t bit, Value* value) {
+  cr_compare_.valid = false;
   StoreContext(offsetof(PPCContext, cr0) + (4 * n) + bit, value);
 
   // TODO(benvanik): trace CR.
@@ -417,6 +483,13 @@ void PPCHIRBuilder::UpdateCR(uint32_t n, Value* lhs, Value* rhs,
   // Value* so = AllocValue(UINT8_TYPE);
   // StoreContext(offsetof(PPCContext, cr) + (4 * n) + 3, so);
 
+  cr_compare_.valid = true;
+  cr_compare_.block = current_block_;
+  cr_compare_.field = n;
+  cr_compare_.lhs = lhs;
+  cr_compare_.rhs = rhs;
+  cr_compare_.is_signed = is_signed;
+
   // TOOD(benvanik): trace CR.
 }
 
@@ -85,6 +85,7 @@ class PPCHIRBuilder : public hir::HIRBuilder {
   void SetReturnAddress(Value* value);
 
  private:
+  void CreateBranchLabels();
   void MaybeBreakOnInstruction(uint32_t address);
   void AnnotateLabel(uint32_t address, Label* label);
 
@@ -101,6 +102,20 @@ class PPCHIRBuilder : public hir::HIRBuilder {
   Instr** instr_offset_list_;
   Label** label_list_;
 
+  // Operands of the last integer compare stored to a CR field. A conditional
+  // branch directly following it in the same block compares them again
+  // instead of loading the stored bit, so the backend can fuse the compare
+  // and the jump. Cleared before any other instruction, and only used while
+  // still in the block of the compare, as values can't cross blocks.
+  struct {
+    bool valid;
+    hir::Block* block;
+    uint32_t field;
+    Value* lhs;
+    Value* rhs;
+    bool is_signed;
+  } cr_compare_;
+
   // Reset each instruction.
   struct {
     uint32_t dest_count;
@@ -7,6 +7,8 @@
  ******************************************************************************
  */
 
+#include <chrono>
+
 #include "xenia/base/console_app_main.h"
 #include "xenia/base/cvar.h"
 #include "xenia/base/filesystem.h"
@@ -34,6 +36,10 @@ DEFINE_path(test_path, "src/xenia/cpu/ppc/testing/",
 DEFINE_path(test_bin_path, "src/xenia/cpu/ppc/testing/bin/",
             "Directory with binary outputs of the test files.", "Other");
 DEFINE_transient_string(test_name, "", "Test suite name.", "General");
+DEFINE_uint32(test_compile_iterations, 0,
+              "Instead of running the tests, translate every test function "
+              "this many times and report the time spent compiling.",
+              "Other");
 
 namespace xe {
 namespace cpu {
@@ -272,6 +278,17 @@ class TestRunner {
     return result;
   }
 
+  // Only translates the test function, with a fresh processor from Setup so
+  // nothing is cached.
+  bool Compile(TestCase& test_case,
+               std::chrono::steady_clock::duration& duration) {
+    processor_->set_debug_info_flags(kDebugInfoNone);
+    auto start = std::chrono::steady_clock::now();
+    auto fn = processor_->ResolveFunction(test_case.address);
+    duration = std::chrono::steady_clock::now() - start;
+    return fn != nullptr;
+  }
+
   bool SetupTestState(TestCase& test_case) {
     auto ppc_context = thread_state_->context();
     for (auto& it : test_case.annotations) {
@@ -416,6 +433,34 @@ void ProtectedRunTest(TestSuite& test_suite, TestRunner& runner,
 #endif  // XE_COMPILER_MSVC
 }
 
+bool BenchmarkCompile(std::vector<TestSuite>& test_suites) {
+  TestRunner runner;
+  std::chrono::steady_clock::duration total_duration{};
+  uint32_t function_count = 0;
+  for (uint32_t i = 0; i < cvars::test_compile_iterations; ++i) {
+    for (auto& test_suite : test_suites) {
+      for (auto& test_case : test_suite.test_cases()) {
+        std::chrono::steady_clock::duration duration;
+        if (!runner.Setup(test_suite) || !runner.Compile(test_case, duration)) {
+          XELOGE("{}.s: failed to compile {}", test_suite.name(),
+                 test_case.name);
+          return false;
+        }
+        total_duration += duration;
+        ++function_count;
+      }
+    }
+  }
+  if (!function_count) {
+    return false;
+  }
+  double total_ms =
+      std::chrono::duration<double, std::milli>(total_duration).count();
+  XELOGI("Compiled {} functions in {:.3f} ms, {:.2f} us per function",
+         function_count, total_ms, total_ms * 1000.0 / function_count);
+  return true;
+}
+
 bool RunTests(const std::string_view test_name) {
   int result_code = 1;
   int failed_count = 0;
@@ -456,6 +501,9 @@ bool RunTests(const std::string_view test_name) {
   }
 
   XELOGI("{} tests loaded.", test_suites.size());
+  if (cvars::test_compile_iterations) {
+    return BenchmarkCompile(test_suites);
+  }
   TestRunner runner;
   for (auto& test_suite : test_suites) {
     XELOGI("{}.s:", test_suite.name());
@@ -0,0 +1,89 @@
+test_cmpw_branch_branch_lt:
+  #_ REGISTER_IN r3 0xFFFFFFFF
+  #_ REGISTER_IN r4 1
+  cmpw r3, r4
+  blt cmpw_branch_branch_lt_lt
+  bgt cmpw_branch_branch_lt_gt
+  li r12, 0
+  blr
+cmpw_branch_branch_lt_lt:
+  li r12, 1
+  blr
+cmpw_branch_branch_lt_gt:
+  li r12, 2
+  blr
+  #_ REGISTER_OUT r3 0xFFFFFFFF
+  #_ REGISTER_OUT r4 1
+  #_ REGISTER_OUT r12 1
+
+test_cmpw_branch_branch_gt:
+  #_ REGISTER_IN r3 2
+  #_ REGISTER_IN r4 1
+  cmpw r3, r4
+  blt cmpw_branch_branch_gt_lt
+  bgt cmpw_branch_branch_gt_gt
+  li r12, 0
+  blr
+cmpw_branch_branch_gt_lt:
+  li r12, 1
+  blr
+cmpw_branch_branch_gt_gt:
+  li r12, 2
+  blr
+  #_ REGISTER_OUT r3 2
+  #_ REGISTER_OUT r4 1
+  #_ REGISTER_OUT r12 2
+
+test_cmpw_branch_branch_eq:
+  #_ REGISTER_IN r3 1
+  #_ REGISTER_IN r4 1
+  cmpw r3, r4
+  blt cmpw_branch_branch_eq_lt
+  bgt cmpw_branch_branch_eq_gt
+  li r12, 0
+  blr
+cmpw_branch_branch_eq_lt:
+  li r12, 1
+  blr
+cmpw_branch_branch_eq_gt:
+  li r12, 2
+  blr
+  #_ REGISTER_OUT r3 1
+  #_ REGISTER_OUT r4 1
+  #_ REGISTER_OUT r12 0
+
+test_cmplw_branch_branch_gt:
+  #_ REGISTER_IN r3 0xFFFFFFFF
+  #_ REGISTER_IN r4 1
+  cmplw r3, r4
+  blt cmplw_branch_branch_gt_lt
+  bgt cmplw_branch_branch_gt_gt
+  li r12, 0
+  blr
+cmplw_branch_branch_gt_lt:
+  li r12, 1
+  blr
+cmplw_branch_branch_gt_gt:
+  li r12, 2
+  blr
+  #_ REGISTER_OUT r3 0xFFFFFFFF
+  #_ REGISTER_OUT r4 1
+  #_ REGISTER_OUT r12 2
+
+test_cmplw_branch_branch_lt:
+  #_ REGISTER_IN r3 1
+  #_ REGISTER_IN r4 0xFFFFFFFF
+  cmplw r3, r4
+  blt cmplw_branch_branch_lt_lt
+  bgt cmplw_branch_branch_lt_gt
+  li r12, 0
+  blr
+cmplw_branch_branch_lt_lt:
+  li r12, 1
+  blr
+cmplw_branch_branch_lt_gt:
+  li r12, 2
+  blr
+  #_ REGISTER_OUT r3 1
+  #_ REGISTER_OUT r4 0xFFFFFFFF
+  #_ REGISTER_OUT r12 1
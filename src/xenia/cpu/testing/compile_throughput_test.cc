@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/testing/util.h"
+
+#include <chrono>
+
+using namespace xe::cpu::hir;
+using namespace xe::cpu;
+using namespace xe::cpu::testing;
+
+namespace {
+
+// Straight-line guest-like code split into blocks by conditional branches,
+// with context loads and stores for the promotion and elimination passes to
+// work on.
+void GenerateLargeFunction(HIRBuilder& b, uint32_t block_count) {
+  for (uint32_t i = 0; i < block_count; ++i) {
+    Label* label = b.NewLabel();
+    Value* value = b.Add(LoadGPR(b, i % 32), b.LoadConstantUint64(i));
+    value = b.Xor(value, LoadGPR(b, (i + 1) % 32));
+    value = b.Shl(value, int8_t(i % 7));
+    StoreGPR(b, (i + 3) % 32, value);
+    StoreGPR(b, (i + 4) % 32, b.Add(value, LoadGPR(b, (i + 5) % 32)));
+    b.BranchTrue(b.CompareNE(value, b.LoadConstantUint64(0)), label);
+    StoreGPR(b, (i + 7) % 32, b.LoadConstantUint64(i));
+    b.MarkLabel(label);
+  }
+  b.Return();
+}
+
+}  // namespace
+
+TEST_CASE("HIR compile throughput", "[.benchmark][hir]") {
+  constexpr uint32_t kFunctionCount = 16;
+  const uint32_t kBlockCounts[] = {16, 256, 2048};
+  for (uint32_t block_count : kBlockCounts) {
+    auto memory = std::make_unique<xe::Memory>();
+    REQUIRE(memory->Initialize());
+    std::unique_ptr<xe::cpu::backend::Backend> backend;
+#if XE_ARCH_AMD64
+    backend.reset(new xe::cpu::backend::x64::X64Backend());
+#endif  // XE_ARCH
+    if (!backend) {
+      return;
+    }
+    auto processor = std::make_unique<Processor>(memory.get(), nullptr);
+    REQUIRE(processor->Setup(std::move(backend)));
+    const uint32_t base_address = 0x80000000;
+    processor->AddModule(std::make_unique<TestModule>(
+        processor.get(), "Test",
+        [base_address](uint64_t address) {
+          return address >= base_address &&
+                 address < base_address + kFunctionCount * 4;
+        },
+        [block_count](HIRBuilder& b) {
+          GenerateLargeFunction(b, block_count);
+          return true;
+        }));
+    processor->backend()->CommitExecutableRange(base_address,
+                                                base_address + 0x10000);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kFunctionCount; ++i) {
+      REQUIRE(processor->ResolveFunction(base_address + i * 4));
+    }
+    std::chrono::duration<double> seconds =
+        std::chrono::steady_clock::now() - start;
+    WARN(block_count << " blocks: "
+                     << seconds.count() * 1000.0 / kFunctionCount
+                     << " ms per function");
+  }
+}
@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/testing/util.h"
+
+using namespace xe::cpu::hir;
+using namespace xe::cpu;
+using namespace xe::cpu::testing;
+using xe::cpu::ppc::PPCContext;
+
+TEST_CASE("CONTEXT_STORE_OVERWRITTEN_ON_ALL_PATHS", "[context_promotion]") {
+  TestFunction test([](HIRBuilder& b) {
+    auto taken = b.NewLabel();
+    auto done = b.NewLabel();
+    StoreGPR(b, 3, b.LoadConstantUint64(1));
+    b.BranchTrue(b.CompareNE(LoadGPR(b, 4), b.LoadZeroInt64()), taken);
+    StoreGPR(b, 3, b.LoadConstantUint64(2));
+    b.Branch(done);
+    b.MarkLabel(taken);
+    StoreGPR(b, 3, b.LoadConstantUint64(3));
+    b.MarkLabel(done);
+    b.Return();
+  });
+  test.Run([](PPCContext* ctx) { ctx->r[4] = 0; },
+           [](PPCContext* ctx) { REQUIRE(ctx->r[3] == 2); });
+  test.Run([](PPCContext* ctx) { ctx->r[4] = 1; },
+           [](PPCContext* ctx) { REQUIRE(ctx->r[3] == 3); });
+}
+
+TEST_CASE("CONTEXT_STORE_LIVE_ON_ONE_PATH", "[context_promotion]") {
+  TestFunction test([](HIRBuilder& b) {
+    auto taken = b.NewLabel();
+    StoreGPR(b, 3, LoadGPR(b, 5));
+    b.BranchTrue(b.CompareNE(LoadGPR(b, 4), b.LoadZeroInt64()), taken);
+    StoreGPR(b, 3, b.LoadConstantUint64(2));
+    b.MarkLabel(taken);
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->r[4] = 0;
+        ctx->r[5] = 5;
+      },
+      [](PPCContext* ctx) { REQUIRE(ctx->r[3] == 2); });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->r[4] = 1;
+        ctx->r[5] = 5;
+      },
+      [](PPCContext* ctx) { REQUIRE(ctx->r[3] == 5); });
+}
+
+TEST_CASE("CONTEXT_STORE_READ_BY_LOOP", "[context_promotion]") {
+  TestFunction test([](HIRBuilder& b) {
+    auto loop = b.NewLabel();
+    StoreGPR(b, 3, b.LoadZeroInt64());
+    b.MarkLabel(loop);
+    StoreGPR(b, 3, b.Add(LoadGPR(b, 3), b.LoadConstantUint64(1)));
+    Value* count = b.Sub(LoadGPR(b, 4), b.LoadConstantUint64(1));
+    StoreGPR(b, 4, count);
+    b.BranchTrue(b.CompareNE(count, b.LoadZeroInt64()), loop);
+    b.Return();
+  });
+  test.Run([](PPCContext* ctx) { ctx->r[4] = 7; },
+           [](PPCContext* ctx) {
+             REQUIRE(ctx->r[3] == 7);
+             REQUIRE(ctx->r[4] == 0);
+           });
+}
+
+TEST_CASE("CONTEXT_LOAD_AFTER_NARROWER_STORE", "[context_promotion]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreGPR(b, 3, LoadGPR(b, 4));
+    // The low byte of r3 in the host-endian context.
+    b.StoreContext(offsetof(PPCContext, r) + 3 * 8, b.LoadConstantInt8(0x5A));
+    StoreGPR(b, 5, LoadGPR(b, 3));
+    b.Return();
+  });
+  test.Run([](PPCContext* ctx) { ctx->r[4] = 0x0123456789ABCDEFull; },
+           [](PPCContext* ctx) {
+             REQUIRE(ctx->r[3] == 0x0123456789ABCD5Aull);
+             REQUIRE(ctx->r[5] == 0x0123456789ABCD5Aull);
+           });
+}
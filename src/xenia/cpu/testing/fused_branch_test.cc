@@ -0,0 +1,133 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/testing/util.h"
+
+using namespace xe::cpu::hir;
+using namespace xe::cpu;
+using namespace xe::cpu::testing;
+using xe::cpu::ppc::PPCContext;
+
+namespace {
+
+using CompareFn = Value* (HIRBuilder::*)(Value*, Value*);
+
+struct Condition {
+  const char* name;
+  CompareFn compare;
+  bool (*expected)(int64_t a, int64_t b);
+};
+
+const Condition kConditions[] = {
+    {"EQ", &HIRBuilder::CompareEQ, [](int64_t a, int64_t b) { return a == b; }},
+    {"NE", &HIRBuilder::CompareNE, [](int64_t a, int64_t b) { return a != b; }},
+    {"SLT", &HIRBuilder::CompareSLT,
+     [](int64_t a, int64_t b) { return a < b; }},
+    {"SLE", &HIRBuilder::CompareSLE,
+     [](int64_t a, int64_t b) { return a <= b; }},
+    {"SGT", &HIRBuilder::CompareSGT,
+     [](int64_t a, int64_t b) { return a > b; }},
+    {"SGE", &HIRBuilder::CompareSGE,
+     [](int64_t a, int64_t b) { return a >= b; }},
+    {"ULT", &HIRBuilder::CompareULT,
+     [](int64_t a, int64_t b) { return uint64_t(a) < uint64_t(b); }},
+    {"ULE", &HIRBuilder::CompareULE,
+     [](int64_t a, int64_t b) { return uint64_t(a) <= uint64_t(b); }},
+    {"UGT", &HIRBuilder::CompareUGT,
+     [](int64_t a, int64_t b) { return uint64_t(a) > uint64_t(b); }},
+    {"UGE", &HIRBuilder::CompareUGE,
+     [](int64_t a, int64_t b) { return uint64_t(a) >= uint64_t(b); }},
+};
+
+constexpr int64_t kConstant = 0x10;
+// Below, equal to and above the constant, with -1 ordered differently by the
+// signed and unsigned conditions.
+constexpr int64_t kValues[] = {-1, 0x5, kConstant, 0x20};
+
+// Sets r3 to 1 if the branch on the compare of r4 with the constant is taken
+// and to 0 otherwise.
+void TestBranch(const Condition& condition, bool constant_first,
+                bool branch_if_true) {
+  TestFunction test([&](HIRBuilder& b) {
+    auto taken = b.NewLabel();
+    auto done = b.NewLabel();
+    Value* value = LoadGPR(b, 4);
+    Value* constant = b.LoadConstantInt64(kConstant);
+    Value* compare = constant_first ? (b.*condition.compare)(constant, value)
+                                    : (b.*condition.compare)(value, constant);
+    if (branch_if_true) {
+      b.BranchTrue(compare, taken);
+    } else {
+      b.BranchFalse(compare, taken);
+    }
+    StoreGPR(b, 3, b.LoadConstantUint64(0));
+    b.Branch(done);
+    b.MarkLabel(taken);
+    StoreGPR(b, 3, b.LoadConstantUint64(1));
+    b.MarkLabel(done);
+    b.Return();
+  });
+  for (int64_t value : kValues) {
+    INFO("COMPARE_" << condition.name << (constant_first ? " 0x10, " : " ")
+                    << value << (constant_first ? "" : ", 0x10")
+                    << (branch_if_true ? " BRANCH_TRUE" : " BRANCH_FALSE"));
+    bool result = constant_first ? condition.expected(kConstant, value)
+                                 : condition.expected(value, kConstant);
+    uint64_t expected = result == branch_if_true ? 1 : 0;
+    test.Run([value](PPCContext* ctx) { ctx->r[4] = uint64_t(value); },
+             [expected](PPCContext* ctx) { REQUIRE(ctx->r[3] == expected); });
+  }
+}
+
+}  // namespace
+
+TEST_CASE("BRANCH_TRUE_FUSED_COMPARE", "[instr]") {
+  for (const Condition& condition : kConditions) {
+    TestBranch(condition, false, true);
+    TestBranch(condition, true, true);
+  }
+}
+
+TEST_CASE("BRANCH_FALSE_FUSED_COMPARE", "[instr]") {
+  for (const Condition& condition : kConditions) {
+    TestBranch(condition, false, false);
+    TestBranch(condition, true, false);
+  }
+}
+
+TEST_CASE("BRANCH_TRUE_FLOAT_COMPARE", "[instr]") {
+  // Float compares leave the flags of an unsigned compare, so a signed jump on
+  // them would never be taken.
+  TestFunction test([](HIRBuilder& b) {
+    auto taken = b.NewLabel();
+    StoreGPR(b, 3, b.LoadConstantUint64(1));
+    b.BranchTrue(b.CompareSLT(LoadFPR(b, 4), LoadFPR(b, 5)), taken);
+    StoreGPR(b, 3, b.LoadConstantUint64(0));
+    b.MarkLabel(taken);
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->f[4] = -2.0;
+        ctx->f[5] = 1.0;
+      },
+      [](PPCContext* ctx) { REQUIRE(ctx->r[3] == 1); });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->f[4] = 1.0;
+        ctx->f[5] = 0.5;
+      },
+      [](PPCContext* ctx) { REQUIRE(ctx->r[3] == 0); });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->f[4] = 1.0;
+        ctx->f[5] = 1.0;
+      },
+      [](PPCContext* ctx) { REQUIRE(ctx->r[3] == 0); });
+}
@@ -0,0 +1,155 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/guest_memory_routines.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "xenia/cpu/ppc/ppc_context.h"
+#include "xenia/cpu/processor.h"
+#include "xenia/memory.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace cpu {
+namespace test {
+
+namespace {
+
+bool Recognize(std::initializer_list<uint32_t> instructions,
+               GuestMemoryRoutine* routine_out) {
+  std::vector<xe::be<uint32_t>> code(instructions.begin(),
+                                     instructions.end());
+  return RecognizeGuestMemoryRoutine(code.data(), uint32_t(code.size()),
+                                     routine_out);
+}
+
+}  // namespace
+
+TEST_CASE("Guest memory routine recognition", "[guest_memory_routines]") {
+  GuestMemoryRoutine routine;
+
+  SECTION("memset splatting the value in place") {
+    REQUIRE(Recognize({0x5484063E,  // clrlwi r4, r4, 24
+                       0x7C6B1B78,  // mr r11, r3
+                       0x5084442E,  // insrwi r4, r4, 8, 16
+                       0x5084801E,  // insrwi r4, r4, 16, 0
+                       0x908B0000,  // stw r4, 0(r11)
+                       0x4E800020},  // blr
+                      &routine));
+    REQUIRE(routine == GuestMemoryRoutine::kMemset);
+  }
+
+  SECTION("memset splatting the value to another register") {
+    REQUIRE(Recognize({0x548A063E,  // clrlwi r10, r4, 24
+                       0x514A442E,  // insrwi r10, r10, 8, 16
+                       0x514A801E,  // insrwi r10, r10, 16, 0
+                       0x91430000,  // stw r10, 0(r3)
+                       0x4E800020},  // blr
+                      &routine));
+    REQUIRE(routine == GuestMemoryRoutine::kMemset);
+  }
+
+  SECTION("memmove checking for overlap") {
+    REQUIRE(Recognize({0x7D641850,  // subf r11, r4, r3
+                       0x7F0B2840,  // cmplw cr6, r11, r5
+                       0x4E800020},  // blr
+                      &routine));
+    REQUIRE(routine == GuestMemoryRoutine::kMemmove);
+  }
+
+  SECTION("Functions calling others are not recognized") {
+    REQUIRE_FALSE(Recognize({0x5084442E,  // insrwi r4, r4, 8, 16
+                             0x5084801E,  // insrwi r4, r4, 16, 0
+                             0x48000101,  // bl +0x100
+                             0x4E800020},  // blr
+                            &routine));
+  }
+
+  SECTION("Functions with a stack frame are not recognized") {
+    REQUIRE_FALSE(Recognize({0x9421FFF0,  // stwu r1, -16(r1)
+                             0x7D641850,  // subf r11, r4, r3
+                             0x7F0B2840,  // cmplw cr6, r11, r5
+                             0x4E800020},  // blr
+                            &routine));
+  }
+
+  SECTION("Other functions are not recognized") {
+    REQUIRE_FALSE(Recognize({0x38630001,  // addi r3, r3, 1
+                             0x4E800020},  // blr
+                            &routine));
+  }
+}
+
+TEST_CASE("Guest memory routines fall back on inaccessible ranges",
+          "[guest_memory_routines]") {
+  auto memory = std::make_unique<xe::Memory>();
+  REQUIRE(memory->Initialize());
+  auto processor = std::make_unique<Processor>(memory.get(), nullptr);
+  auto context = std::make_unique<ppc::PPCContext>();
+  std::memset(context.get(), 0, sizeof(ppc::PPCContext));
+  context->processor = processor.get();
+
+  BaseHeap* heap = memory->LookupHeapByType(false, 0x1000);
+  uint32_t writable_address, read_only_address;
+  REQUIRE(heap->Alloc(0x1000, 0x1000,
+                      kMemoryAllocationReserve | kMemoryAllocationCommit,
+                      kMemoryProtectRead | kMemoryProtectWrite, false,
+                      &writable_address));
+  REQUIRE(heap->Alloc(0x1000, 0x1000,
+                      kMemoryAllocationReserve | kMemoryAllocationCommit,
+                      kMemoryProtectRead, false, &read_only_address));
+  auto memset_handler =
+      GetGuestMemoryRoutineHandler(GuestMemoryRoutine::kMemset);
+  auto memmove_handler =
+      GetGuestMemoryRoutineHandler(GuestMemoryRoutine::kMemmove);
+
+  SECTION("Writable range") {
+    context->r[3] = writable_address;
+    context->r[4] = 0xAB;
+    context->r[5] = 0x1000;
+    memset_handler(context.get(), nullptr);
+    REQUIRE(context->scratch == 1);
+    REQUIRE(memory->TranslateVirtual(writable_address)[0xFFF] == 0xAB);
+  }
+
+  SECTION("Read-only destination") {
+    context->r[3] = read_only_address;
+    context->r[4] = 0xAB;
+    context->r[5] = 0x10;
+    memset_handler(context.get(), nullptr);
+    REQUIRE(context->scratch == 0);
+    context->r[4] = writable_address;
+    memmove_handler(context.get(), nullptr);
+    REQUIRE(context->scratch == 0);
+  }
+
+  SECTION("Range running past the allocation") {
+    context->r[3] = writable_address + 0xFF0;
+    context->r[4] = 0;
+    context->r[5] = 0x20;
+    memset_handler(context.get(), nullptr);
+    REQUIRE(context->scratch == 0);
+  }
+
+  SECTION("Unmapped source") {
+    context->r[3] = writable_address;
+    context->r[4] = 0x7F000000;
+    context->r[5] = 0x10;
+    memmove_handler(context.get(), nullptr);
+    REQUIRE(context->scratch == 0);
+  }
+}
+
+}  // namespace test
+}  // namespace cpu
+}  // namespace xe
@@ -111,3 +111,43 @@ TEST_CASE("PACK_SHORT_2", "[instr]") {
         REQUIRE(result == vec128i(0, 0, 0, 0x80018001));
       });
 }
+
+TEST_CASE("PACK_16_IN_32_UNSIGNED_SATURATE", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3,
+            b.Pack(LoadVR(b, 4), LoadVR(b, 5),
+                   PACK_TYPE_16_IN_32 | PACK_TYPE_IN_UNSIGNED |
+                       PACK_TYPE_OUT_UNSIGNED | PACK_TYPE_OUT_SATURATE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128i(1, 0x10000, 0xFFFFFFFF, 0x1234);
+        ctx->v[5] = vec128i(0, 0xFFFF, 0x80000000, 7);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result ==
+                vec128s(1, 0xFFFF, 0xFFFF, 0x1234, 0, 0xFFFF, 0xFFFF, 7));
+      });
+}
+
+TEST_CASE("PACK_16_IN_32_SIGNED_SATURATE", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3,
+            b.Pack(LoadVR(b, 4), LoadVR(b, 5),
+                   PACK_TYPE_16_IN_32 | PACK_TYPE_IN_SIGNED |
+                       PACK_TYPE_OUT_SIGNED | PACK_TYPE_OUT_SATURATE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128i(1, 0x8000, 0xFFFFFFFF, 0x80000000);
+        ctx->v[5] = vec128i(0x7FFF, 0x12345678, 0xFFFF8000, 0xFFFF7FFF);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result == vec128s(1, 0x7FFF, 0xFFFF, 0x8000, 0x7FFF, 0x7FFF,
+                                  0x8000, 0x8000));
+      });
+}
@@ -0,0 +1,124 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/testing/util.h"
+
+using namespace xe;
+using namespace xe::cpu;
+using namespace xe::cpu::hir;
+using namespace xe::cpu::testing;
+using xe::cpu::ppc::PPCContext;
+
+TEST_CASE("VECTOR_COMPARE_UGT_I8", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3, b.VectorCompareUGT(LoadVR(b, 4), LoadVR(b, 5), INT8_TYPE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128b(0x00, 0x01, 0x7F, 0x80, 0xFF, 0x80, 0x10, 0x10,
+                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+        ctx->v[5] = vec128b(0x00, 0x00, 0x80, 0x7F, 0xFE, 0xFF, 0x10, 0x11,
+                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result == vec128b(0x00, 0xFF, 0x00, 0xFF, 0xFF, 0x00, 0x00,
+                                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                  0x00, 0x00));
+      });
+}
+
+TEST_CASE("VECTOR_COMPARE_UGE_I8", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3, b.VectorCompareUGE(LoadVR(b, 4), LoadVR(b, 5), INT8_TYPE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128b(0x00, 0x01, 0x7F, 0x80, 0xFF, 0x80, 0x10, 0x10,
+                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+        ctx->v[5] = vec128b(0x00, 0x00, 0x80, 0x7F, 0xFE, 0xFF, 0x10, 0x11,
+                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result == vec128b(0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0x00, 0xFF,
+                                  0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                  0xFF, 0xFF));
+      });
+}
+
+TEST_CASE("VECTOR_COMPARE_UGT_I16", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3, b.VectorCompareUGT(LoadVR(b, 4), LoadVR(b, 5), INT16_TYPE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128s(0x8000, 0x7FFF, 0xFFFF, 0, 3, 3, 0x1234, 0xFFFE);
+        ctx->v[5] = vec128s(0x7FFF, 0x8000, 0xFFFE, 0, 2, 4, 0x1234, 0xFFFF);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result == vec128s(0xFFFF, 0, 0xFFFF, 0, 0xFFFF, 0, 0, 0));
+      });
+}
+
+TEST_CASE("VECTOR_COMPARE_UGE_I16", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3, b.VectorCompareUGE(LoadVR(b, 4), LoadVR(b, 5), INT16_TYPE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128s(0x8000, 0x7FFF, 0xFFFF, 0, 3, 3, 0x1234, 0xFFFE);
+        ctx->v[5] = vec128s(0x7FFF, 0x8000, 0xFFFE, 0, 2, 4, 0x1234, 0xFFFF);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result ==
+                vec128s(0xFFFF, 0, 0xFFFF, 0xFFFF, 0xFFFF, 0, 0xFFFF, 0));
+      });
+}
+
+TEST_CASE("VECTOR_COMPARE_UGT_I32", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3, b.VectorCompareUGT(LoadVR(b, 4), LoadVR(b, 5), INT32_TYPE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128i(0x80000000, 1, 0xFFFFFFFF, 5);
+        ctx->v[5] = vec128i(0x7FFFFFFF, 1, 0, 6);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result == vec128i(0xFFFFFFFF, 0, 0xFFFFFFFF, 0));
+      });
+}
+
+TEST_CASE("VECTOR_COMPARE_UGE_I32_CONSTANT", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3,
+            b.VectorCompareUGE(
+                LoadVR(b, 4),
+                b.LoadConstantVec128(vec128i(0x7FFFFFFF, 1, 0, 6)),
+                INT32_TYPE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128i(0x80000000, 1, 0xFFFFFFFF, 5);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result == vec128i(0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0));
+      });
+}
@@ -70,3 +70,66 @@ TEST_CASE("VECTOR_ROTATE_LEFT_I32", "[instr]") {
                 vec128i(0x00000001, 0x00000002, 0x00000001, 0x00000002));
       });
 }
+
+TEST_CASE("VECTOR_ROTATE_LEFT_I8_CONSTANT", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3,
+            b.VectorRotateLeft(
+                LoadVR(b, 4),
+                b.LoadConstantVec128(vec128b(0, 1, 4, 7, 8, 9, 12, 15, 1, 1,
+                                             1, 1, 3, 3, 3, 3)),
+                INT8_TYPE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128b(0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81,
+                            0x00, 0xFF, 0x80, 0x7F, 0x12, 0x34, 0xE0, 0x0F);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result == vec128b(0x81, 0x03, 0x18, 0xC0, 0x81, 0x03, 0x18,
+                                  0xC0, 0x00, 0xFF, 0x01, 0xFE, 0x90, 0xA1,
+                                  0x07, 0x78));
+      });
+}
+
+TEST_CASE("VECTOR_ROTATE_LEFT_I16_CONSTANT", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3,
+            b.VectorRotateLeft(
+                LoadVR(b, 4),
+                b.LoadConstantVec128(vec128s(0, 1, 4, 8, 15, 16, 17, 31)),
+                INT16_TYPE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128s(0x8001, 0x8001, 0x1234, 0x1234, 0x8001, 0x8001,
+                            0x8001, 0x8001);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result == vec128s(0x8001, 0x0003, 0x2341, 0x3412, 0xC000,
+                                  0x8001, 0x0003, 0xC000));
+      });
+}
+
+TEST_CASE("VECTOR_ROTATE_LEFT_I32_CONSTANT", "[instr]") {
+  TestFunction test([](HIRBuilder& b) {
+    StoreVR(b, 3,
+            b.VectorRotateLeft(LoadVR(b, 4),
+                               b.LoadConstantVec128(vec128i(0, 1, 33, 2)),
+                               INT32_TYPE));
+    b.Return();
+  });
+  test.Run(
+      [](PPCContext* ctx) {
+        ctx->v[4] = vec128i(0x00000001, 0x00000001, 0x80000000, 0x80000000);
+      },
+      [](PPCContext* ctx) {
+        auto result = ctx->v[3];
+        REQUIRE(result ==
+                vec128i(0x00000001, 0x00000002, 0x00000001, 0x00000002));
+      });
+}
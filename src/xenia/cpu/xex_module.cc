@@ -19,9 +19,12 @@
 #include "xenia/base/math.h"
 #include "xenia/base/memory.h"
 #include "xenia/base/pe_image.h"
+#include "xenia/base/string_util.h"
+#include "xenia/base/utf8.h"
 
 #include "xenia/cpu/cpu_flags.h"
 #include "xenia/cpu/export_resolver.h"
+#include "xenia/cpu/guest_memory_routines.h"
 #include "xenia/cpu/lzx.h"
 #include "xenia/cpu/processor.h"
 #include "xenia/emulator.h"
@@ -48,6 +51,28 @@ DEFINE_bool(
     "finding/stress testing with the JIT",
     "CPU");
 
+DEFINE_bool(guest_memory_routine_recognition, false,
+            "Find the memcpy, memmove and memset implementations in the title "
+            "executable by their code and run them on the host instead. "
+            "Experimental: the recognition is heuristic and may replace "
+            "functions that only look similar.",
+            "CPU");
+DEFINE_string(guest_memcpy_functions, "",
+              "Comma-separated hexadecimal addresses of memcpy implementations "
+              "in the title executable to run on the host instead, for the "
+              "ones not recognized automatically (usually set in the per-game "
+              "configuration). Takes priority over the recognition.",
+              "CPU");
+DEFINE_string(guest_memmove_functions, "",
+              "Comma-separated hexadecimal addresses of memmove "
+              "implementations in the title executable to run on the host "
+              "instead.",
+              "CPU");
+DEFINE_string(guest_memset_functions, "",
+              "Comma-separated hexadecimal addresses of memset implementations "
+              "in the title executable to run on the host instead.",
+              "CPU");
+
 DECLARE_bool(allow_plugins);
 
 static constexpr uint8_t xe_xex1_retail_key[16] = {
@@ -1136,6 +1161,10 @@ void XexModule::Precompile() {
     return;
   }
 
+  if (is_executable()) {
+    SetupGuestMemoryRoutines();
+  }
+
   info_cache_.Init(this);
   PrecompileDiscoveredFunctions();
 }
@@ -1963,5 +1992,79 @@ bool XexModule::FindSaveRest() {
   return true;
 }
 
+void XexModule::SetupGuestMemoryRoutines() {
+  // The C runtime is linked statically and the compiled code differs between
+  // XDK versions. Addresses from the configuration go first, then the
+  // functions listed in .pdata are checked for the shape of the routines.
+  const std::pair<const std::string&, GuestMemoryRoutine> routine_addresses[] =
+      {
+          {cvars::guest_memcpy_functions, GuestMemoryRoutine::kMemcpy},
+          {cvars::guest_memmove_functions, GuestMemoryRoutine::kMemmove},
+          {cvars::guest_memset_functions, GuestMemoryRoutine::kMemset},
+      };
+  for (const auto& [addresses, routine] : routine_addresses) {
+    const char* routine_name = GetGuestMemoryRoutineName(routine);
+    for (std::string_view address_string :
+         xe::utf8::split(addresses, ", ", true)) {
+      uint32_t address =
+          xe::string_util::from_string<uint32_t>(address_string, true);
+      if (!ContainsAddress(address) || (address & 3)) {
+        XELOGW("Ignoring {} at {:08X} outside of {}", routine_name, address,
+               name());
+        continue;
+      }
+      if (!SetupGuestMemoryRoutine(address, routine)) {
+        XELOGW("Ignoring {} at {:08X}, the function is already set up",
+               routine_name, address);
+      }
+    }
+  }
+
+  if (!cvars::guest_memory_routine_recognition) {
+    return;
+  }
+  const PESection* pdata = GetPESection(".pdata");
+  if (!pdata) {
+    return;
+  }
+  auto pdata_entries =
+      memory()->TranslateVirtual<const xe::be<uint32_t>*>(pdata->address);
+  for (uint32_t i = 0; i < pdata->raw_size / 8; ++i) {
+    uint32_t address = pdata_entries[i * 2];
+    if (!ContainsAddress(address)) {
+      // The table ends with zeros.
+      break;
+    }
+    // The function length in instructions is in bits 8:29.
+    uint32_t instruction_count = (pdata_entries[i * 2 + 1] >> 8) & 0x3FFFFF;
+    if ((address & 3) ||
+        uint64_t(address) + instruction_count * 4 > high_address_) {
+      continue;
+    }
+    GuestMemoryRoutine routine;
+    if (RecognizeGuestMemoryRoutine(
+            memory()->TranslateVirtual<const xe::be<uint32_t>*>(address),
+            instruction_count, &routine)) {
+      SetupGuestMemoryRoutine(address, routine);
+    }
+  }
+}
+
+bool XexModule::SetupGuestMemoryRoutine(uint32_t address,
+                                        GuestMemoryRoutine routine) {
+  Function* function;
+  if (DeclareFunction(address, &function) != Symbol::Status::kNew) {
+    return false;
+  }
+  const char* routine_name = GetGuestMemoryRoutineName(routine);
+  function->set_name(
+      fmt::format("__host_{}_{:08X}", routine_name, address));
+  static_cast<GuestFunction*>(function)->SetupExtern(
+      GetGuestMemoryRoutineHandler(routine));
+  function->set_status(Symbol::Status::kDeclared);
+  XELOGI("Running {} at {:08X} on the host", routine_name, address);
+  return true;
+}
+
 }  // namespace cpu
 }  // namespace xe
@@ -29,6 +29,7 @@ constexpr fourcc_t kXEX1Signature = make_fourcc("XEX1");
 constexpr fourcc_t kXEX2Signature = make_fourcc("XEX2");
 constexpr fourcc_t kElfSignature = make_fourcc(0x7F, 'E', 'L', 'F');
 
+enum class GuestMemoryRoutine;
 class Runtime;
 struct InfoCacheFlags {
   uint32_t was_resolved : 1;  // has this address ever been called/requested
@@ -254,6 +255,8 @@ class XexModule : public xe::cpu::Module {
   bool SetupLibraryImports(const std::string_view name,
                            const xex2_import_library* library);
   bool FindSaveRest();
+  void SetupGuestMemoryRoutines();
+  bool SetupGuestMemoryRoutine(uint32_t address, GuestMemoryRoutine routine);
 
   Processor* processor_ = nullptr;
   kernel::KernelState* kernel_state_ = nullptr;
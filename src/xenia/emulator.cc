@@ -18,6 +18,7 @@
 #include "third_party/zarchive/include/zarchive/zarchivecommon.h"
 #include "third_party/zarchive/include/zarchive/zarchivewriter.h"
 #include "third_party/zarchive/src/sha_256.h"
+#include "third_party/zstd/lib/zstd.h"
 #include "xenia/apu/audio_system.h"
 #include "xenia/base/assert.h"
 #include "xenia/base/byte_stream.h"
@@ -27,7 +28,6 @@
 #include "xenia/base/exception_handler.h"
 #include "xenia/base/literals.h"
 #include "xenia/base/logging.h"
-#include "xenia/base/mapped_memory.h"
 #include "xenia/base/platform.h"
 #include "xenia/base/string.h"
 #include "xenia/base/system.h"
@@ -49,6 +49,7 @@
 #include "xenia/kernel/xbdm/xbdm_module.h"
 #include "xenia/kernel/xboxkrnl/xboxkrnl_module.h"
 #include "xenia/memory.h"
+#include "xenia/memory_snapshot.h"
 #include "xenia/ui/file_picker.h"
 #include "xenia/ui/imgui_dialog.h"
 #include "xenia/ui/imgui_drawer.h"
@@ -88,6 +89,8 @@ DECLARE_int32(user_language);
 
 DECLARE_bool(allow_plugins);
 
+DECLARE_int32(save_state_compression_level);
+
 DEFINE_int32(priority_class, 0,
              "Forces Xenia to use different process priority than default one. "
              "It might affect performance and cause unexpected bugs. Possible "
@@ -210,7 +213,9 @@ X_STATUS Emulator::Setup(
   // 360 uses a 50MHz clock.
   Clock::set_guest_tick_frequency(50000000);
   // We could reset this with save state data/constant value to help replays.
-  Clock::set_guest_system_time_base(Clock::QueryHostSystemTime());
+  Clock::set_guest_system_time_base(
+      cvars::clock_deterministic ? cvars::clock_deterministic_system_time
+                                 : Clock::QueryHostSystemTime());
   // This can be adjusted dynamically, as well.
   Clock::set_guest_time_scalar(cvars::time_scalar);
 
@@ -350,6 +355,7 @@ X_STATUS Emulator::TerminateTitle() {
   }
 
   kernel_state_->TerminateTitle();
+  file_system_->EndPrefetchManifest();
   title_id_ = std::nullopt;
   title_name_ = "";
   title_version_ = "";
@@ -1123,69 +1129,232 @@ void Emulator::Resume() {
   }
 }
 
-bool Emulator::SaveToFile(const std::filesystem::path& path) {
-  Pause();
+struct SaveStateHeader {
+  fourcc_t signature;
+  uint32_t version;
+  uint32_t has_title_id;
+  uint32_t title_id;
+  uint64_t state_compressed_size;
+  uint64_t state_uncompressed_size;
+  uint64_t memory_offset;
+  // UTF-8 path of the base save state following the header, if incremental.
+  uint32_t base_path_length;
+  uint32_t reserved;
+};
+static_assert_size(SaveStateHeader, 48);
+
+// Bound on the base save state path, longer than any the host allows.
+constexpr uint32_t kMaxSaveStateBasePathLength = 64_KiB;
+
+// Processor, GPU, APU and kernel state and the page tables. The whole buffer is
+// committed up front, but the host only backs the pages that get written with
+// physical memory.
+constexpr size_t kSaveStateBufferSize = 256_MiB;
+
+static bool ReadSaveStateHeader(FILE* file, SaveStateHeader& header_out,
+                                std::filesystem::path& base_path_out) {
+  if (fread(&header_out, sizeof(header_out), 1, file) != 1 ||
+      header_out.signature != kEmulatorSaveSignature ||
+      header_out.version != kEmulatorSaveVersion) {
+    return false;
+  }
+  // Check the path length before allocating, a damaged file could make it up
+  // to 4 GiB.
+  int64_t path_offset = filesystem::Tell(file);
+  if (header_out.base_path_length > kMaxSaveStateBasePathLength ||
+      !filesystem::Seek(file, 0, SEEK_END)) {
+    return false;
+  }
+  int64_t file_size = filesystem::Tell(file);
+  if (path_offset < 0 || file_size < path_offset ||
+      header_out.base_path_length > uint64_t(file_size - path_offset) ||
+      !filesystem::Seek(file, path_offset, SEEK_SET)) {
+    return false;
+  }
+  std::string base_path(header_out.base_path_length, '\0');
+  if (!base_path.empty() &&
+      fread(base_path.data(), 1, base_path.size(), file) != base_path.size()) {
+    return false;
+  }
+  base_path_out = xe::to_path(base_path);
+  return true;
+}
 
-  filesystem::CreateEmptyFile(path);
-  auto map = MappedMemory::Open(path, MappedMemory::Mode::kReadWrite, 0, 2_GiB);
-  if (!map) {
+static bool LoadBaseMemorySnapshot(const std::filesystem::path& path,
+                                   const std::optional<uint32_t>& title_id,
+                                   MemorySnapshot& snapshot_out) {
+  FILE* file = filesystem::OpenFile(path, "rb");
+  if (!file) {
+    XELOGE("Unable to open the base save state {}", path);
+    return false;
+  }
+  SaveStateHeader header;
+  std::filesystem::path base_base_path;
+  bool header_read = ReadSaveStateHeader(file, header, base_base_path);
+  fclose(file);
+  if (!header_read || !base_base_path.empty() ||
+      bool(header.has_title_id) != title_id.has_value() ||
+      (title_id.has_value() && header.title_id != title_id.value())) {
+    XELOGE("{} is not a full save state of the current title", path);
+    return false;
+  }
+  if (!snapshot_out.Load(path, header.memory_offset)) {
+    XELOGE("Failed to load the memory tables of the base save state {}",
+           path);
     return false;
   }
+  return true;
+}
 
-  // Save the emulator state to a file
-  ByteStream stream(map->data(), map->size());
-  stream.Write(kEmulatorSaveSignature);
-  stream.Write(title_id_.has_value());
-  if (title_id_.has_value()) {
-    stream.Write(title_id_.value());
+bool Emulator::SaveToFile(const std::filesystem::path& path,
+                          const std::filesystem::path& base_path) {
+  Pause();
+  bool result = WriteSaveState(path, base_path);
+  Resume();
+  return result;
+}
+
+bool Emulator::WriteSaveState(const std::filesystem::path& path,
+                              const std::filesystem::path& base_path) {
+  std::unique_ptr<MemorySnapshot> base_snapshot;
+  std::string base_path_utf8;
+  if (!base_path.empty()) {
+    std::filesystem::path base_path_absolute =
+        std::filesystem::absolute(base_path);
+    std::error_code error_code;
+    if (std::filesystem::equivalent(path, base_path_absolute, error_code)) {
+      XELOGE("A save state can't be its own base");
+      return false;
+    }
+    base_snapshot = std::make_unique<MemorySnapshot>();
+    if (!LoadBaseMemorySnapshot(base_path_absolute, title_id_,
+                                *base_snapshot)) {
+      return false;
+    }
+    base_path_utf8 = xe::path_to_utf8(base_path_absolute);
   }
 
   // It's important we don't hold the global lock here! XThreads need to step
   // forward (possibly through guarded regions) without worry!
+  auto state_buffer = reinterpret_cast<uint8_t*>(
+      memory::AllocFixed(nullptr, kSaveStateBufferSize,
+                         memory::AllocationType::kReserveCommit,
+                         memory::PageAccess::kReadWrite));
+  if (!state_buffer) {
+    return false;
+  }
+  ByteStream stream(state_buffer, kSaveStateBufferSize);
   processor_->Save(&stream);
   graphics_system_->Save(&stream);
   audio_system_->Save(&stream);
   kernel_state_->Save(&stream);
   memory_->Save(&stream);
-  map->Close(stream.offset());
+  std::vector<uint8_t> state_compressed(ZSTD_compressBound(stream.offset()));
+  size_t state_compressed_size = ZSTD_compress(
+      state_compressed.data(), state_compressed.size(), state_buffer,
+      stream.offset(), cvars::save_state_compression_level);
+  memory::DeallocFixed(state_buffer, kSaveStateBufferSize,
+                       memory::DeallocationType::kRelease);
+  if (ZSTD_isError(state_compressed_size)) {
+    XELOGE("Failed to compress the save state: {}",
+           ZSTD_getErrorName(state_compressed_size));
+    return false;
+  }
 
-  Resume();
-  return true;
+  SaveStateHeader header = {};
+  header.signature = kEmulatorSaveSignature;
+  header.version = kEmulatorSaveVersion;
+  header.has_title_id = title_id_.has_value();
+  header.title_id = title_id_.value_or(0);
+  header.state_compressed_size = state_compressed_size;
+  header.state_uncompressed_size = stream.offset();
+  header.memory_offset =
+      sizeof(header) + base_path_utf8.size() + state_compressed_size;
+  header.base_path_length = uint32_t(base_path_utf8.size());
+
+  // Streamed to the file directly, the memory is written as its blocks are
+  // compressed.
+  FILE* file = filesystem::OpenFile(path, "wb");
+  if (!file) {
+    XELOGE("Unable to open {} for writing the save state", path);
+    return false;
+  }
+  bool result =
+      fwrite(&header, sizeof(header), 1, file) == 1 &&
+      fwrite(base_path_utf8.data(), 1, base_path_utf8.size(), file) ==
+          base_path_utf8.size() &&
+      fwrite(state_compressed.data(), 1, state_compressed_size, file) ==
+          state_compressed_size &&
+      MemorySnapshot::Write(*memory_, file, base_snapshot.get());
+  fclose(file);
+  return result;
 }
 
 bool Emulator::RestoreFromFile(const std::filesystem::path& path) {
   // Restore the emulator state from a file
-  auto map = MappedMemory::Open(path, MappedMemory::Mode::kReadWrite);
-  if (!map) {
+  FILE* file = filesystem::OpenFile(path, "rb");
+  if (!file) {
     return false;
   }
-
-  restoring_ = true;
-
-  // Terminate any loaded titles.
-  Pause();
-  kernel_state_->TerminateTitle();
-
-  auto lock = global_critical_region::AcquireDirect();
-  ByteStream stream(map->data(), map->size());
-  if (stream.Read<uint32_t>() != kEmulatorSaveSignature) {
+  SaveStateHeader header;
+  std::filesystem::path base_path;
+  std::vector<uint8_t> state_compressed;
+  bool state_read = ReadSaveStateHeader(file, header, base_path);
+  if (state_read) {
+    state_compressed.resize(size_t(header.state_compressed_size));
+    state_read = fread(state_compressed.data(), 1, state_compressed.size(),
+                       file) == state_compressed.size();
+  }
+  fclose(file);
+  if (!state_read) {
+    XELOGE("{} is not a supported save state", path);
     return false;
   }
 
-  auto has_title_id = stream.Read<bool>();
   std::optional<uint32_t> title_id;
-  if (!has_title_id) {
-    title_id = {};
-  } else {
-    title_id = stream.Read<uint32_t>();
+  if (header.has_title_id) {
+    title_id = header.title_id;
   }
-  if (title_id_.has_value() != title_id.has_value() ||
-      title_id_.value() != title_id.value()) {
+  if (title_id_ != title_id) {
     // Swapping between titles is unsupported at the moment.
     assert_always();
     return false;
   }
 
+  std::vector<uint8_t> state(size_t(header.state_uncompressed_size));
+  size_t state_size =
+      ZSTD_decompress(state.data(), state.size(), state_compressed.data(),
+                      state_compressed.size());
+  state_compressed = std::vector<uint8_t>();
+  if (ZSTD_isError(state_size) || state_size != state.size()) {
+    XELOGE("Failed to decompress the save state {}", path);
+    return false;
+  }
+
+  MemorySnapshot memory_snapshot;
+  if (!memory_snapshot.Load(path, header.memory_offset)) {
+    XELOGE("Failed to load the memory tables of the save state {}", path);
+    return false;
+  }
+  std::unique_ptr<MemorySnapshot> base_memory_snapshot;
+  if (!base_path.empty()) {
+    base_memory_snapshot = std::make_unique<MemorySnapshot>();
+    if (!LoadBaseMemorySnapshot(base_path, title_id, *base_memory_snapshot)) {
+      return false;
+    }
+  } else if (memory_snapshot.is_incremental()) {
+    return false;
+  }
+
+  restoring_ = true;
+
+  // Terminate any loaded titles.
+  Pause();
+  kernel_state_->TerminateTitle();
+
+  auto lock = global_critical_region::AcquireDirect();
+  ByteStream stream(state.data(), state.size());
+
   if (!processor_->Restore(&stream)) {
     XELOGE("Could not restore processor!");
     return false;
@@ -1202,10 +1371,12 @@ bool Emulator::RestoreFromFile(const std::filesystem::path& path) {
     XELOGE("Could not restore kernel state!");
     return false;
   }
-  if (!memory_->Restore(&stream)) {
+  if (!memory_->Restore(&stream) ||
+      !memory_snapshot.Restore(*memory_, base_memory_snapshot.get())) {
     XELOGE("Could not restore memory!");
     return false;
   }
+  memory_->RestoreProtection();
 
   // Update the main thread.
   auto threads =
@@ -1600,6 +1771,13 @@ X_STATUS Emulator::CompleteLaunch(const std::filesystem::path& path,
     }
   }
 
+  // After the game config is loaded so per-game prefetch settings apply.
+  if (title_id_.value()) {
+    file_system_->BeginPrefetchManifest(
+        cache_root_ / "prefetch" /
+        fmt::format("{:08X}.txt", title_id_.value()));
+  }
+
   // Initializing the shader storage in a blocking way so the user doesn't
   // miss the initial seconds - for instance, sound from an intro video may
   // start playing before the video can be seen if doing this in parallel with
@@ -56,6 +56,8 @@ class Window;
 namespace xe {
 
 constexpr fourcc_t kEmulatorSaveSignature = make_fourcc("XSAV");
+// Version 2: zstd-compressed state followed by a MemorySnapshot.
+constexpr uint32_t kEmulatorSaveVersion = 2;
 static constexpr std::string_view kDefaultGameSymbolicLink = "GAME:";
 static constexpr std::string_view kDefaultPartitionSymbolicLink = "D:";
 
@@ -294,7 +296,10 @@ class Emulator {
   void Pause();
   void Resume();
   bool is_paused() const { return paused_; }
-  bool SaveToFile(const std::filesystem::path& path);
+  // If base_path is not empty, only the memory that differs from the full save
+  // state at base_path is stored, and the base is needed for restoring.
+  bool SaveToFile(const std::filesystem::path& path,
+                  const std::filesystem::path& base_path = {});
   bool RestoreFromFile(const std::filesystem::path& path);
 
   // The game can request another title to be loaded.
@@ -326,6 +331,9 @@ class Emulator {
   X_STATUS CompleteLaunch(const std::filesystem::path& path,
                           const std::string_view module_path);
 
+  bool WriteSaveState(const std::filesystem::path& path,
+                      const std::filesystem::path& base_path);
+
   std::filesystem::path command_line_;
   std::filesystem::path storage_root_;
   std::filesystem::path content_root_;
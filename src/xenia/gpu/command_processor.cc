@@ -223,6 +223,7 @@ void CommandProcessor::RestoreRegisters(uint32_t first_register,
   } else {
     std::memcpy(register_file_->values + first_register, register_values,
                 sizeof(uint32_t) * register_count);
+    register_file_->MarkAllChanged();
   }
 }
 
@@ -372,7 +373,11 @@ bool CommandProcessor::Restore(ByteStream* stream) {
   return true;
 }
 
-bool CommandProcessor::SetupContext() { return true; }
+bool CommandProcessor::SetupContext() {
+  // The state derived from the registers is cached by the implementations.
+  register_file_->MarkAllChanged();
+  return true;
+}
 
 void CommandProcessor::ShutdownContext() {}
 
@@ -631,6 +636,7 @@ void CommandProcessor::WriteRegister(uint32_t index, uint32_t value) {
   // chrispy: rearrange check order, place set after checks
 
   if (XE_LIKELY(index < RegisterFile::kRegisterCount)) {
+    register_file_->MarkChanged(index, value);
     register_file_->values[index] = value;
 
     // quick pre-test
@@ -1747,6 +1747,7 @@ void D3D12CommandProcessor::WriteRegisterForceinline(uint32_t index,
   __m128i is_above_lower = _mm_cmpgt_epi16(to_rangecheck, lower_bounds);
   __m128i is_below_upper = _mm_cmplt_epi16(to_rangecheck, upper_bounds);
   __m128i is_within_range = _mm_and_si128(is_above_lower, is_below_upper);
+  register_file_->MarkChanged(index, value);
   register_file_->values[index] = value;
 
   uint32_t movmask = static_cast<uint32_t>(_mm_movemask_epi8(is_within_range));
@@ -2054,7 +2055,8 @@ D3D12CommandProcessor::WriteRegisterRangeFromMem_WithKnownBound(
   auto get_end_before_qty = [&end, current_index](uint32_t regnum) {
     return std::min<uint32_t>(regnum, end) - current_index;
   };
-#define REGULAR_WRITE_CALLBACK(s, e, i, b, n) \
+#define REGULAR_WRITE_CALLBACK(s, e, i, b, n)       \
+  register_file_->MarkRangeChangedBigEndian(i, b, n); \
   copy_and_swap_32_unaligned(&register_file_->values[i], b, n)
 #define WRITE_FETCH_CONSTANTS_CALLBACK(str, er, ind, b, n) \
   WriteFetchFromMem(ind, b, n)
@@ -2702,18 +2704,27 @@ bool D3D12CommandProcessor::IssueDraw(xenos::PrimitiveType primitive_type,
       host_render_targets_used &&
           render_target_cache_->depth_float24_convert_in_pixel_shader(),
       host_render_targets_used, pixel_shader && pixel_shader->writes_depth());
-  gviargs.SetupRegisterValues(regs);
+  if (register_file_->ConsumeDirtyGroup(
+          RegisterFile::DirtyGroup::kViewport)) {
+    gviargs.SetupRegisterValues(regs);
+  } else {
+    gviargs.CopyRegisterValues(previous_viewport_info_args_);
+  }
 
   if (gviargs == previous_viewport_info_args_) {
     viewport_info = previous_viewport_info_;
+    register_file_->CountGroupUpdate(false);
   } else {
     draw_util::GetHostViewportInfo(&gviargs, viewport_info);
     previous_viewport_info_args_ = gviargs;
     previous_viewport_info_ = viewport_info;
+    register_file_->CountGroupUpdate(true);
   }
   // todo: use SIMD for getscissor + scaling here, should reduce code size more
-  draw_util::Scissor scissor;
-  draw_util::GetScissor(regs, scissor);
+  if (register_file_->BeginGroupUpdate(RegisterFile::DirtyGroup::kScissor)) {
+    draw_util::GetScissor(regs, previous_scissor_);
+  }
+  draw_util::Scissor scissor = previous_scissor_;
 #if XE_ARCH_AMD64 == 1
   __m128i* scisp = (__m128i*)&scissor;
   *scisp = _mm_mullo_epi32(
@@ -3533,37 +3544,46 @@ void D3D12CommandProcessor::UpdateFixedFunctionState(
 
   if (render_target_cache_->GetPath() ==
       RenderTargetCache::Path::kHostRenderTargets) {
-    const RegisterFile& regs = *register_file_;
+    RegisterFile& regs = *register_file_;
 
     // Blend factor.
-    float blend_factor[] = {
-        regs.Get<float>(XE_GPU_REG_RB_BLEND_RED),
-        regs.Get<float>(XE_GPU_REG_RB_BLEND_GREEN),
-        regs.Get<float>(XE_GPU_REG_RB_BLEND_BLUE),
-        regs.Get<float>(XE_GPU_REG_RB_BLEND_ALPHA),
-    };
+    if (regs.BeginGroupUpdate(RegisterFile::DirtyGroup::kBlendConstants)) {
+      previous_blend_factor_[0] = regs.Get<float>(XE_GPU_REG_RB_BLEND_RED);
+      previous_blend_factor_[1] = regs.Get<float>(XE_GPU_REG_RB_BLEND_GREEN);
+      previous_blend_factor_[2] = regs.Get<float>(XE_GPU_REG_RB_BLEND_BLUE);
+      previous_blend_factor_[3] = regs.Get<float>(XE_GPU_REG_RB_BLEND_ALPHA);
+    }
     // std::memcmp instead of != so in case of NaN, every draw won't be
     // invalidating it.
     ff_blend_factor_update_needed_ |=
-        std::memcmp(ff_blend_factor_, blend_factor, sizeof(float) * 4) != 0;
+        std::memcmp(ff_blend_factor_, previous_blend_factor_,
+                    sizeof(float) * 4) != 0;
     if (ff_blend_factor_update_needed_) {
-      std::memcpy(ff_blend_factor_, blend_factor, sizeof(float) * 4);
+      std::memcpy(ff_blend_factor_, previous_blend_factor_, sizeof(float) * 4);
       deferred_command_list_.D3DOMSetBlendFactor(ff_blend_factor_);
       ff_blend_factor_update_needed_ = false;
     }
 
     // Stencil reference value. Per-face reference not supported by Direct3D 12,
     // choose the back face one only if drawing only back faces.
-    Register stencil_ref_mask_reg;
-    auto pa_su_sc_mode_cntl = regs.Get<reg::PA_SU_SC_MODE_CNTL>();
-    if (primitive_polygonal && normalized_depth_control.backface_enable &&
-        pa_su_sc_mode_cntl.cull_front && !pa_su_sc_mode_cntl.cull_back) {
-      stencil_ref_mask_reg = XE_GPU_REG_RB_STENCILREFMASK_BF;
-    } else {
-      stencil_ref_mask_reg = XE_GPU_REG_RB_STENCILREFMASK;
+    bool stencil_ref_back_face =
+        primitive_polygonal && normalized_depth_control.backface_enable;
+    if (regs.BeginGroupUpdate(
+            RegisterFile::DirtyGroup::kDepthStencil,
+            stencil_ref_back_face != previous_stencil_ref_back_face_)) {
+      Register stencil_ref_mask_reg;
+      auto pa_su_sc_mode_cntl = regs.Get<reg::PA_SU_SC_MODE_CNTL>();
+      if (stencil_ref_back_face && pa_su_sc_mode_cntl.cull_front &&
+          !pa_su_sc_mode_cntl.cull_back) {
+        stencil_ref_mask_reg = XE_GPU_REG_RB_STENCILREFMASK_BF;
+      } else {
+        stencil_ref_mask_reg = XE_GPU_REG_RB_STENCILREFMASK;
+      }
+      previous_stencil_ref_ =
+          regs.Get<reg::RB_STENCILREFMASK>(stencil_ref_mask_reg).stencilref;
+      previous_stencil_ref_back_face_ = stencil_ref_back_face;
     }
-    uint32_t stencil_ref =
-        regs.Get<reg::RB_STENCILREFMASK>(stencil_ref_mask_reg).stencilref;
+    uint32_t stencil_ref = previous_stencil_ref_;
     ff_stencil_ref_update_needed_ |= ff_stencil_ref_ != stencil_ref;
     if (ff_stencil_ref_update_needed_) {
       ff_stencil_ref_ = stencil_ref;
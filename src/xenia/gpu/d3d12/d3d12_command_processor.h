@@ -794,6 +794,13 @@ class D3D12CommandProcessor final : public CommandProcessor {
 
   draw_util::GetViewportInfoArgs previous_viewport_info_args_;
   draw_util::ViewportInfo previous_viewport_info_;
+  // Guest state derived from the registers for the previous draw, reused while
+  // the register file reports that the registers it depends on haven't
+  // changed. Separate from the ff_ state which may be set by other passes.
+  draw_util::Scissor previous_scissor_;
+  float previous_blend_factor_[4] = {};
+  uint32_t previous_stencil_ref_ = 0;
+  bool previous_stencil_ref_back_face_ = false;
 
   std::atomic<bool> pix_capture_requested_ = false;
   bool pix_capturing_;
@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <cfloat>
 #include <cstdint>
+#include <iterator>
 
 #include "xenia/base/assert.h"
 #include "xenia/base/cvar.h"
@@ -53,22 +54,23 @@ namespace xe {
 namespace gpu {
 
 void DrawExtentEstimator::PositionYExportSink::Export(
-    ucode::ExportRegister export_register, const float* value,
+    uint32_t lane, ucode::ExportRegister export_register, const float* value,
     uint32_t value_mask) {
+  Lane& lane_exports = lanes_[lane];
   if (export_register == ucode::ExportRegister::kVSPosition) {
     if (value_mask & 0b0010) {
-      position_y_ = value[1];
+      lane_exports.position_y = value[1];
     }
     if (value_mask & 0b1000) {
-      position_w_ = value[3];
+      lane_exports.position_w = value[3];
     }
   } else if (export_register ==
              ucode::ExportRegister::kVSPointSizeEdgeFlagKillVertex) {
     if (value_mask & 0b0001) {
-      point_size_ = value[0];
+      lane_exports.point_size = value[0];
     }
     if (value_mask & 0b0100) {
-      vertex_kill_ = xe::memory::Reinterpret<uint32_t>(value[2]);
+      lane_exports.vertex_kill = xe::memory::Reinterpret<uint32_t>(value[2]);
     }
   }
 }
@@ -172,6 +174,65 @@ uint32_t DrawExtentEstimator::EstimateVertexMaxY(const Shader& vertex_shader) {
 
   PositionYExportSink position_y_export_sink;
   shader_interpreter_.SetExportSink(&position_y_export_sink);
+  // Vertices are executed in batches of ShaderInterpreter::kMaxLanes.
+  uint32_t lane_count = 0;
+  auto execute_lanes = [&]() {
+    position_y_export_sink.Reset();
+    shader_interpreter_.ExecuteLanes(lane_count);
+    for (uint32_t lane = 0; lane < lane_count; ++lane) {
+      if (position_y_export_sink.vertex_kill(lane).has_value() &&
+          (position_y_export_sink.vertex_kill(lane).value() &
+           ~(UINT32_C(1) << 31))) {
+        continue;
+      }
+      if (!position_y_export_sink.position_y(lane).has_value()) {
+        continue;
+      }
+      float vertex_y = position_y_export_sink.position_y(lane).value();
+      if (!pa_cl_vte_cntl.vtx_xy_fmt) {
+        if (!position_y_export_sink.position_w(lane).has_value()) {
+          continue;
+        }
+        vertex_y /= position_y_export_sink.position_w(lane).value();
+      }
+
+      vertex_y = vertex_y * viewport_y_scale + viewport_y_offset;
+
+      if (vgt_draw_initiator.prim_type == xenos::PrimitiveType::kPointList) {
+        float point_radius_y;
+        if (position_y_export_sink.point_size(lane).has_value()) {
+          // Vertex-specified diameter. Clamped effectively as a signed integer
+          // in the hardware, -NaN, -Infinity ... -0 to the minimum, +Infinity,
+          // +NaN to the maximum.
+          point_radius_y =
+              0.5f *
+              xe::memory::Reinterpret<float>(std::min(
+                  point_vertex_max_diameter_float,
+                  std::max(point_vertex_min_diameter_float,
+                           xe::memory::Reinterpret<int32_t>(
+                               position_y_export_sink.point_size(lane)
+                                   .value()))));
+        } else {
+          // Constant radius.
+          point_radius_y = point_constant_radius_y;
+        }
+        vertex_y += point_radius_y;
+      }
+
+      // std::max is `a < b ? b : a`, thus in case of NaN, the first argument
+      // is always returned - max_y, which is initialized to a normalized
+      // value.
+      max_y = std::max(max_y, vertex_y);
+    }
+    lane_count = 0;
+  };
+  // Like the post-transform vertex cache on the GPU, skip recently executed
+  // vertices - taking the same vertex into account multiple times doesn't
+  // change the maximum, and indexed draws reference most vertices several
+  // times. Indices are 24-bit, so UINT32_MAX is never a valid entry.
+  uint32_t recent_vertex_indices[32];
+  std::fill(std::begin(recent_vertex_indices), std::end(recent_vertex_indices),
+            UINT32_MAX);
   for (uint32_t i = 0; i < vgt_draw_initiator.num_indices; ++i) {
     uint32_t vertex_index;
     if (vgt_draw_initiator.source_select == xenos::SourceSelect::kDMA) {
@@ -198,51 +259,21 @@ uint32_t DrawExtentEstimator::EstimateVertexMaxY(const Shader& vertex_shader) {
         std::min(max_index,
                  std::max(min_index, (vertex_index + index_offset) & 0xFFFFFF));
 
-    position_y_export_sink.Reset();
-
-    shader_interpreter_.temp_registers()[0] = float(vertex_index);
-    shader_interpreter_.Execute();
-
-    if (position_y_export_sink.vertex_kill().has_value() &&
-        (position_y_export_sink.vertex_kill().value() & ~(UINT32_C(1) << 31))) {
+    uint32_t& recent_vertex_index =
+        recent_vertex_indices[vertex_index &
+                              (xe::countof(recent_vertex_indices) - 1)];
+    if (recent_vertex_index == vertex_index) {
       continue;
     }
-    if (!position_y_export_sink.position_y().has_value()) {
-      continue;
-    }
-    float vertex_y = position_y_export_sink.position_y().value();
-    if (!pa_cl_vte_cntl.vtx_xy_fmt) {
-      if (!position_y_export_sink.position_w().has_value()) {
-        continue;
-      }
-      vertex_y /= position_y_export_sink.position_w().value();
-    }
+    recent_vertex_index = vertex_index;
 
-    vertex_y = vertex_y * viewport_y_scale + viewport_y_offset;
-
-    if (vgt_draw_initiator.prim_type == xenos::PrimitiveType::kPointList) {
-      float point_radius_y;
-      if (position_y_export_sink.point_size().has_value()) {
-        // Vertex-specified diameter. Clamped effectively as a signed integer in
-        // the hardware, -NaN, -Infinity ... -0 to the minimum, +Infinity, +NaN
-        // to the maximum.
-        point_radius_y =
-            0.5f *
-            xe::memory::Reinterpret<float>(std::min(
-                point_vertex_max_diameter_float,
-                std::max(point_vertex_min_diameter_float,
-                         xe::memory::Reinterpret<int32_t>(
-                             position_y_export_sink.point_size().value()))));
-      } else {
-        // Constant radius.
-        point_radius_y = point_constant_radius_y;
-      }
-      vertex_y += point_radius_y;
+    shader_interpreter_.temp_registers(lane_count)[0] = float(vertex_index);
+    if (++lane_count >= ShaderInterpreter::kMaxLanes) {
+      execute_lanes();
     }
-
-    // std::max is `a < b ? b : a`, thus in case of NaN, the first argument is
-    // always returned - max_y, which is initialized to a normalized value.
-    max_y = std::max(max_y, vertex_y);
+  }
+  if (lane_count) {
+    execute_lanes();
   }
   shader_interpreter_.SetExportSink(nullptr);
 
@@ -41,26 +41,39 @@ class DrawExtentEstimator {
  private:
   class PositionYExportSink : public ShaderInterpreter::ExportSink {
    public:
-    void Export(ucode::ExportRegister export_register, const float* value,
-                uint32_t value_mask) override;
+    void Export(uint32_t lane, ucode::ExportRegister export_register,
+                const float* value, uint32_t value_mask) override;
 
     void Reset() {
-      position_y_.reset();
-      position_w_.reset();
-      point_size_.reset();
-      vertex_kill_.reset();
+      for (Lane& lane : lanes_) {
+        lane.position_y.reset();
+        lane.position_w.reset();
+        lane.point_size.reset();
+        lane.vertex_kill.reset();
+      }
     }
 
-    const std::optional<float>& position_y() const { return position_y_; }
-    const std::optional<float>& position_w() const { return position_w_; }
-    const std::optional<float>& point_size() const { return point_size_; }
-    const std::optional<uint32_t>& vertex_kill() const { return vertex_kill_; }
+    const std::optional<float>& position_y(uint32_t lane) const {
+      return lanes_[lane].position_y;
+    }
+    const std::optional<float>& position_w(uint32_t lane) const {
+      return lanes_[lane].position_w;
+    }
+    const std::optional<float>& point_size(uint32_t lane) const {
+      return lanes_[lane].point_size;
+    }
+    const std::optional<uint32_t>& vertex_kill(uint32_t lane) const {
+      return lanes_[lane].vertex_kill;
+    }
 
    private:
-    std::optional<float> position_y_;
-    std::optional<float> position_w_;
-    std::optional<float> point_size_;
-    std::optional<uint32_t> vertex_kill_;
+    struct Lane {
+      std::optional<float> position_y;
+      std::optional<float> position_w;
+      std::optional<float> point_size;
+      std::optional<uint32_t> vertex_kill;
+    };
+    Lane lanes_[ShaderInterpreter::kMaxLanes];
   };
 
   const RegisterFile& register_file_;
@@ -382,6 +382,21 @@ struct GetViewportInfoArgs {
     pa_sc_window_offset = regs.Get<reg::PA_SC_WINDOW_OFFSET>();
     depth_format = regs.Get<reg::RB_DEPTH_INFO>().depth_format;
   }
+  // For when the registers haven't changed since the args were set up.
+  void CopyRegisterValues(const GetViewportInfoArgs& other) {
+    pa_cl_clip_cntl = other.pa_cl_clip_cntl;
+    pa_cl_vte_cntl = other.pa_cl_vte_cntl;
+    pa_su_sc_mode_cntl = other.pa_su_sc_mode_cntl;
+    pa_su_vtx_cntl = other.pa_su_vtx_cntl;
+    PA_CL_VPORT_XSCALE = other.PA_CL_VPORT_XSCALE;
+    PA_CL_VPORT_YSCALE = other.PA_CL_VPORT_YSCALE;
+    PA_CL_VPORT_ZSCALE = other.PA_CL_VPORT_ZSCALE;
+    PA_CL_VPORT_XOFFSET = other.PA_CL_VPORT_XOFFSET;
+    PA_CL_VPORT_YOFFSET = other.PA_CL_VPORT_YOFFSET;
+    PA_CL_VPORT_ZOFFSET = other.PA_CL_VPORT_ZOFFSET;
+    pa_sc_window_offset = other.pa_sc_window_offset;
+    depth_format = other.depth_format;
+  }
   XE_FORCEINLINE
   bool operator==(const GetViewportInfoArgs& prev) const {
 #if XE_ARCH_AMD64 == 0
@@ -172,7 +172,16 @@ X_STATUS GraphicsSystem::Setup(cpu::Processor* processor,
                                        1000.0 / static_cast<double>(
                                                     normalized_framerate_limit))
                     : 1.0;
-            uint64_t last_frame_time = Clock::QueryGuestTickCount();
+            // The deterministic guest clock only moves when the guest reads it
+            // and at vblanks, pace the vblanks with the host clock instead.
+            auto query_frame_time = []() {
+              return cvars::clock_deterministic ? Clock::QueryHostTickCount()
+                                                : Clock::QueryGuestTickCount();
+            };
+            const uint64_t tick_freq = cvars::clock_deterministic
+                                           ? Clock::QueryHostTickFrequency()
+                                           : Clock::guest_tick_frequency();
+            uint64_t last_frame_time = query_frame_time();
             // Sleep for 90% of the vblank duration, spin for 10%
             constexpr double duration_scalar = 0.90;
 
@@ -181,8 +190,7 @@ X_STATUS GraphicsSystem::Setup(cpu::Processor* processor,
                   GetInternalDisplayResolution().second;
 
               if (cvars::vsync) {
-                const uint64_t current_time = Clock::QueryGuestTickCount();
-                const uint64_t tick_freq = Clock::guest_tick_frequency();
+                const uint64_t current_time = query_frame_time();
                 const uint64_t time_delta = current_time - last_frame_time;
                 const double elapsed_d =
                     static_cast<double>(time_delta) /
@@ -330,6 +338,7 @@ void GraphicsSystem::WriteRegister(uint32_t addr, uint32_t value) {
   }
 
   assert_true(r < RegisterFile::kRegisterCount);
+  this->register_file()->MarkChanged(r, value);
   this->register_file()->values[r] = value;
 }
 
@@ -360,6 +369,9 @@ void GraphicsSystem::MarkVblank() {
   // Increment vblank counter (so the game sees us making progress).
   command_processor_->increment_counter();
 
+  // A 60 Hz frame of guest time passes with the deterministic clock.
+  Clock::AdvanceGuestFrame(Clock::guest_tick_frequency() / 60);
+
   // TODO(benvanik): we shouldn't need to do the dispatch here, but there's
   //     something wrong and the CP will block waiting for code that
   //     needs to be run in the interrupt.
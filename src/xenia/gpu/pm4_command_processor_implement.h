@@ -663,6 +663,13 @@ bool COMMAND_PROCESSOR::ExecutePacketType3_XE_SWAP(uint32_t packet,
   COMMAND_PROCESSOR::IssueSwap(frontbuffer_ptr, frontbuffer_width,
                                frontbuffer_height);
 
+  // Derived draw state recomputed or reused for the unchanged registers.
+  COUNT_profile_set("gpu/register_groups_recomputed",
+                    register_file_->groups_recomputed());
+  COUNT_profile_set("gpu/register_groups_skipped",
+                    register_file_->groups_skipped());
+  register_file_->ResetGroupUpdateCounters();
+
   ++counter_;
   return true;
 }
@@ -53,3 +53,7 @@ project("xenia-gpu-shader-compiler")
         "1>scratch/stdout-shader-compiler.txt",
       })
     end
+
+if enableTests then
+  include("testing")
+end
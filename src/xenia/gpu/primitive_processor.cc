@@ -62,12 +62,21 @@ DEFINE_bool(
 DEFINE_int32(
     primitive_processor_cache_min_indices, 4096,
     "Smallest number of guest indices to store in the cache to try reusing "
-    "later in the same frame if processing (such as primitive type conversion "
-    "or reset index replacement) is performed.\n"
+    "later if processing (such as primitive type conversion or reset index "
+    "replacement) is performed.\n"
     "Setting this to a very high value may result in excessive CPU processing, "
     "while a very low value may result in excessive locking and lookups.\n"
     "Negative values disable caching.",
     "GPU");
+DEFINE_uint32(
+    primitive_processor_cache_size_mb, 64,
+    "Maximum size of processed guest indices kept by the primitive processor "
+    "cache across frames, in megabytes. Results that haven't been modified by "
+    "the guest are reused in later frames instead of processing the indices "
+    "again, with the least recently used ones evicted when the limit is "
+    "exceeded.\n"
+    "0 to only reuse the results within the same frame.",
+    "GPU");
 
 namespace xe {
 namespace gpu {
@@ -110,6 +119,7 @@ bool PrimitiveProcessor::InitializeCommon(
     bool line_loops_supported, bool quad_lists_supported,
     bool point_sprites_supported_without_vs_expansion,
     bool rectangle_lists_supported_without_vs_expansion) {
+  cache_budget_bytes_ = size_t(cvars::primitive_processor_cache_size_mb) << 20;
   full_32bit_vertex_indices_used_ = full_32bit_vertex_indices_supported;
   convert_triangle_fans_to_lists_ =
       !triangle_fans_supported || cvars::force_convert_triangle_fans_to_lists;
@@ -246,12 +256,8 @@ void PrimitiveProcessor::ShutdownCommon() {
     // callback.
     {
       auto global_lock = global_critical_region_.Acquire();
-      cache_map_.clear();
+      ResetCache(global_lock);
       cache_bucket_free_first_entry_ = SIZE_MAX;
-      std::memset(cache_buckets_non_empty_l1_, 0,
-                  sizeof(cache_buckets_non_empty_l1_));
-      std::memset(cache_buckets_non_empty_l2_, 0,
-                  sizeof(cache_buckets_non_empty_l2_));
     }
     memory_.UnregisterPhysicalMemoryInvalidationCallback(
         memory_invalidation_callback_handle_);
@@ -266,9 +272,34 @@ void PrimitiveProcessor::ClearPerFrameCache() {
     return;
   }
   auto global_lock = global_critical_region_.Acquire();
+  COUNT_profile_set("gpu/primitive_processor/cache_hits", cache_frame_hits_);
+  COUNT_profile_set("gpu/primitive_processor/cache_cross_frame_hits",
+                    cache_frame_cross_frame_hits_);
+  COUNT_profile_set("gpu/primitive_processor/cache_misses",
+                    cache_frame_misses_);
+  COUNT_profile_set("gpu/primitive_processor/cache_evictions",
+                    cache_frame_evictions_);
+  COUNT_profile_set("gpu/primitive_processor/cache_used_kb",
+                    cache_size_bytes_ >> 10);
+  cache_frame_hits_ = 0;
+  cache_frame_cross_frame_hits_ = 0;
+  cache_frame_misses_ = 0;
+  cache_frame_evictions_ = 0;
+  ++cache_frame_;
+  if (cache_budget_bytes_) {
+    // Host buffers of kHostConverted results expire with cache_frame_, the
+    // results themselves stay valid until invalidated or evicted.
+    return;
+  }
+  ResetCache(global_lock);
+}
+
+void PrimitiveProcessor::ResetCache(
+    [[maybe_unused]] const global_unique_lock_type& global_lock) {
   for (const std::pair<CacheKey, size_t>& cache_map_entry : cache_map_) {
-    cache_entry_pool_[cache_map_entry.second].free_next =
-        cache_bucket_free_first_entry_;
+    CacheEntry& entry = cache_entry_pool_[cache_map_entry.second];
+    entry.host_indices.reset();
+    entry.free_next = cache_bucket_free_first_entry_;
     cache_bucket_free_first_entry_ = cache_map_entry.second;
   }
   cache_map_.clear();
@@ -276,6 +307,9 @@ void PrimitiveProcessor::ClearPerFrameCache() {
               sizeof(cache_buckets_non_empty_l1_));
   std::memset(cache_buckets_non_empty_l2_, 0,
               sizeof(cache_buckets_non_empty_l2_));
+  cache_lru_first_entry_ = SIZE_MAX;
+  cache_lru_last_entry_ = SIZE_MAX;
+  cache_size_bytes_ = 0;
 }
 
 bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
@@ -735,7 +769,7 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
                 0, guest_draw_vertex_count, cacheable.host_draw_vertex_count);
           }
           auto host_indices = reinterpret_cast<uint16_t*>(
-              RequestHostConvertedIndexBufferForCurrentFrame(
+              cache_transaction.RequestHostConvertedIndexBuffer(
                   xenos::IndexFormat::kInt16, cacheable.host_draw_vertex_count,
                   false, guest_index_base, cacheable.host_index_buffer_handle));
           if (!host_indices) {
@@ -769,7 +803,7 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
                 0, guest_draw_vertex_count, cacheable.host_draw_vertex_count);
           }
           auto host_indices = reinterpret_cast<uint32_t*>(
-              RequestHostConvertedIndexBufferForCurrentFrame(
+              cache_transaction.RequestHostConvertedIndexBuffer(
                   xenos::IndexFormat::kInt32, cacheable.host_draw_vertex_count,
                   false, guest_index_base, cacheable.host_index_buffer_handle));
           if (!host_indices) {
@@ -868,7 +902,7 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
                                                   ? xenos::IndexFormat::kInt32
                                                   : xenos::IndexFormat::kInt16;
                 void* host_indices_ptr =
-                    RequestHostConvertedIndexBufferForCurrentFrame(
+                    cache_transaction.RequestHostConvertedIndexBuffer(
                         cacheable.host_index_format, guest_draw_vertex_count,
                         true, guest_index_base,
                         cacheable.host_index_buffer_handle);
@@ -920,7 +954,7 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
               cacheable.index_buffer_type =
                   ProcessedIndexBufferType::kHostConverted;
               auto host_indices = reinterpret_cast<uint32_t*>(
-                  RequestHostConvertedIndexBufferForCurrentFrame(
+                  cache_transaction.RequestHostConvertedIndexBuffer(
                       xenos::IndexFormat::kInt32, guest_draw_vertex_count, true,
                       guest_index_base, cacheable.host_index_buffer_handle));
               if (!host_indices) {
@@ -1427,32 +1461,130 @@ PrimitiveProcessor::CacheTransaction::CacheTransaction(
       (key_.format == xenos::IndexFormat::kInt16 ? sizeof(uint16_t)
                                                  : sizeof(uint32_t)) *
       key_.count;
+  // An entry from a previous frame whose converted indices need to be uploaded
+  // to a host buffer for the current frame.
+  size_t expired_entry_index = SIZE_MAX;
+  std::shared_ptr<std::vector<uint8_t>> expired_host_indices;
+  uint32_t expired_host_indices_offset = 0;
   {
     auto global_lock = processor_.global_critical_region_.Acquire();
     auto cache_map_it = processor_.cache_map_.find(key_);
     if (cache_map_it != processor_.cache_map_.end()) {
-      result_ = processor_.cache_entry_pool_[cache_map_it->second].result;
-      result_type_ = ResultType::kExisting;
-    } else {
+      const CacheEntry& entry =
+          processor_.cache_entry_pool_[cache_map_it->second];
+      result_ = entry.result;
+      if (result_.index_buffer_type !=
+              ProcessedIndexBufferType::kHostConverted ||
+          entry.handle_frame == processor_.cache_frame_) {
+        result_type_ = ResultType::kExisting;
+      } else {
+        assert_not_null(entry.host_indices);
+        expired_entry_index = cache_map_it->second;
+        expired_host_indices = entry.host_indices;
+        expired_host_indices_offset = entry.host_indices_offset;
+      }
+      // Move to the head of the least recently used list.
+      processor_.UnlinkCacheEntryLru(cache_map_it->second, global_lock);
+      processor_.LinkCacheEntryLru(cache_map_it->second, global_lock);
+    }
+    if (result_type_ != ResultType::kExisting && !expired_host_indices) {
       // Inhibit writing the new result if the range happens to be modified
       // during the processing outside the lock.
       processor_.cache_currently_processing_base_ = key_.base;
       processor_.cache_currently_processing_size_bytes_ = size_bytes;
     }
   }
-  if (result_type_ != ResultType::kExisting) {
-    // Enable the invalidation callback before reading the indices.
-    // Also, only enable invalidation callbacks if anything needed processing at
-    // all - don't waste time in the access violation handler doing nothing if
-    // the guest doesn't use anything requiring host conversion.
-    if (!processor_.memory_invalidation_callback_handle_) {
-      processor_.memory_invalidation_callback_handle_ =
-          processor_.memory_.RegisterPhysicalMemoryInvalidationCallback(
-              MemoryInvalidationCallbackThunk, &processor_);
+  if (expired_host_indices) {
+    // Upload the indices converted in a previous frame outside the lock since
+    // this may take some time. The entry may be invalidated meanwhile, but the
+    // guest memory has been read before the modification in this case, as it
+    // would have been if the entry was found before the modification.
+    size_t host_index_buffer_handle;
+    void* mapping = processor_.RequestHostConvertedIndexBufferForCurrentFrame(
+        result_.host_index_format, result_.host_draw_vertex_count, false, 0,
+        host_index_buffer_handle);
+    if (!mapping) {
+      // Processing will fail to get a host buffer too.
+      key_.key = 0;
+      return;
     }
-    processor_.memory_.EnablePhysicalMemoryAccessCallbacks(
-        key_.base, size_bytes, true, false);
+    std::memcpy(mapping,
+                expired_host_indices->data() + expired_host_indices_offset,
+                result_.host_draw_vertex_count *
+                    (result_.host_index_format == xenos::IndexFormat::kInt16
+                         ? sizeof(uint16_t)
+                         : sizeof(uint32_t)));
+    result_.host_index_buffer_handle = host_index_buffer_handle;
+    result_type_ = ResultType::kExisting;
+    ++processor_.cache_frame_cross_frame_hits_;
+    auto global_lock = processor_.global_critical_region_.Acquire();
+    CacheEntry& entry = processor_.cache_entry_pool_[expired_entry_index];
+    // Check if the entry hasn't been invalidated, and the slot hasn't been
+    // reused for another entry.
+    auto cache_map_it = processor_.cache_map_.find(key_);
+    if (cache_map_it != processor_.cache_map_.end() &&
+        cache_map_it->second == expired_entry_index &&
+        entry.host_indices == expired_host_indices) {
+      entry.result.host_index_buffer_handle = host_index_buffer_handle;
+      entry.handle_frame = processor_.cache_frame_;
+    }
+    return;
   }
+  if (result_type_ == ResultType::kExisting) {
+    ++processor_.cache_frame_hits_;
+    return;
+  }
+  ++processor_.cache_frame_misses_;
+  // Enable the invalidation callback before reading the indices.
+  // Also, only enable invalidation callbacks if anything needed processing at
+  // all - don't waste time in the access violation handler doing nothing if
+  // the guest doesn't use anything requiring host conversion.
+  if (!processor_.memory_invalidation_callback_handle_) {
+    processor_.memory_invalidation_callback_handle_ =
+        processor_.memory_.RegisterPhysicalMemoryInvalidationCallback(
+            MemoryInvalidationCallbackThunk, &processor_);
+  }
+  processor_.memory_.EnablePhysicalMemoryAccessCallbacks(key_.base, size_bytes,
+                                                         true, false);
+}
+
+void* PrimitiveProcessor::CacheTransaction::RequestHostConvertedIndexBuffer(
+    xenos::IndexFormat format, uint32_t index_count, bool coalign_for_simd,
+    uint32_t coalignment_original_address, size_t& backend_handle_out) {
+  assert_true(result_type_ == ResultType::kNewUnset);
+  if (!key_.count || !processor_.cache_budget_bytes_) {
+    return processor_.RequestHostConvertedIndexBufferForCurrentFrame(
+        format, index_count, coalign_for_simd, coalignment_original_address,
+        backend_handle_out);
+  }
+  // Only copying from the cache copy to the host buffer, no need to coalign it.
+  void* mapping = processor_.RequestHostConvertedIndexBufferForCurrentFrame(
+      format, index_count, false, 0, backend_handle_out);
+  if (!mapping) {
+    return nullptr;
+  }
+  host_indices_size_bytes_ =
+      index_count * (format == xenos::IndexFormat::kInt16 ? sizeof(uint16_t)
+                                                          : sizeof(uint32_t));
+  host_indices_ = std::make_shared<std::vector<uint8_t>>(
+      host_indices_size_bytes_ +
+      (coalign_for_simd ? XE_GPU_PRIMITIVE_PROCESSOR_SIMD_SIZE : 0));
+  host_indices_offset_ = 0;
+  if (coalign_for_simd) {
+    host_indices_offset_ = uint32_t(GetSimdCoalignmentOffset(
+        host_indices_->data(), coalignment_original_address));
+  }
+  host_mapping_ = mapping;
+  return host_indices_->data() + host_indices_offset_;
+}
+
+void PrimitiveProcessor::CacheTransaction::UploadHostIndices() {
+  if (!host_mapping_) {
+    return;
+  }
+  std::memcpy(host_mapping_, host_indices_->data() + host_indices_offset_,
+              host_indices_size_bytes_);
+  host_mapping_ = nullptr;
 }
 
 PrimitiveProcessor::CacheTransaction::~CacheTransaction() {
@@ -1511,11 +1643,112 @@ PrimitiveProcessor::CacheTransaction::~CacheTransaction() {
 
     new_entry.key = key_;
     new_entry.result = result_;
+    new_entry.handle_frame = processor_.cache_frame_;
+    new_entry.host_indices = std::move(host_indices_);
+    new_entry.host_indices_offset = host_indices_offset_;
 
     processor_.cache_map_.emplace(key_, new_entry_index);
+    processor_.LinkCacheEntryLru(new_entry_index, global_lock);
+    processor_.cache_size_bytes_ += new_entry.GetCacheSizeBytes();
+
+    if (processor_.cache_budget_bytes_) {
+      // Evict the least recently used entries (possibly including the new one
+      // if it alone exceeds the budget - the result for this draw has already
+      // been obtained).
+      while (processor_.cache_size_bytes_ > processor_.cache_budget_bytes_ &&
+             processor_.cache_lru_last_entry_ != SIZE_MAX) {
+        processor_.RemoveCacheEntry(processor_.cache_lru_last_entry_,
+                                    global_lock);
+        ++processor_.cache_frame_evictions_;
+      }
+    }
+  }
+}
+
+void PrimitiveProcessor::LinkCacheEntryLru(
+    size_t entry_index,
+    [[maybe_unused]] const global_unique_lock_type& global_lock) {
+  CacheEntry& entry = cache_entry_pool_[entry_index];
+  entry.lru_prev = SIZE_MAX;
+  entry.lru_next = cache_lru_first_entry_;
+  if (cache_lru_first_entry_ != SIZE_MAX) {
+    cache_entry_pool_[cache_lru_first_entry_].lru_prev = entry_index;
+  } else {
+    cache_lru_last_entry_ = entry_index;
+  }
+  cache_lru_first_entry_ = entry_index;
+}
+
+void PrimitiveProcessor::UnlinkCacheEntryLru(
+    size_t entry_index,
+    [[maybe_unused]] const global_unique_lock_type& global_lock) {
+  CacheEntry& entry = cache_entry_pool_[entry_index];
+  if (entry.lru_prev != SIZE_MAX) {
+    cache_entry_pool_[entry.lru_prev].lru_next = entry.lru_next;
+  } else {
+    cache_lru_first_entry_ = entry.lru_next;
+  }
+  if (entry.lru_next != SIZE_MAX) {
+    cache_entry_pool_[entry.lru_next].lru_prev = entry.lru_prev;
+  } else {
+    cache_lru_last_entry_ = entry.lru_prev;
   }
 }
 
+void PrimitiveProcessor::RemoveCacheEntry(
+    size_t entry_index, const global_unique_lock_type& global_lock) {
+  CacheEntry& entry = cache_entry_pool_[entry_index];
+  CacheKey entry_key = entry.key;
+  // Remove the entry from the cache map.
+  auto entry_map_it = cache_map_.find(entry_key);
+  assert_true(entry_map_it != cache_map_.end());
+  if (entry_map_it != cache_map_.end()) {
+    cache_map_.erase(entry_map_it);
+  }
+  // Unlink the entry from the bucket's list.
+  uint32_t entry_bucket_index_first =
+      entry_key.base >> kCacheBucketSizeBytesLog2;
+  uint32_t entry_link_index_last =
+      ((entry_key.base + entry_key.GetSizeBytes() - 1) >>
+       kCacheBucketSizeBytesLog2) -
+      entry_bucket_index_first;
+  assert_true(entry_link_index_last <= 1,
+              "Cache entries only store list links within two buckets");
+  for (uint32_t entry_link_index = 0; entry_link_index <= entry_link_index_last;
+       ++entry_link_index) {
+    uint32_t entry_bucket_index = entry_bucket_index_first + entry_link_index;
+    size_t entry_link_prev = entry.buckets_prev[entry_link_index];
+    size_t entry_link_next = entry.buckets_next[entry_link_index];
+    if (entry_link_prev != SIZE_MAX) {
+      CacheEntry& entry_prev = cache_entry_pool_[entry_link_prev];
+      entry_prev.buckets_next[size_t(
+          (entry_prev.key.base >> kCacheBucketSizeBytesLog2) !=
+          entry_bucket_index)] = entry_link_next;
+    } else {
+      if (entry_link_next != SIZE_MAX) {
+        cache_bucket_first_entries_[entry_bucket_index] = entry_link_next;
+      } else {
+        // The only entry that was remaining in the bucket - it's empty now.
+        cache_buckets_non_empty_l1_[entry_bucket_index >> 6] &=
+            ~(uint64_t(1) << (entry_bucket_index & 63));
+        UpdateCacheBucketsNonEmptyL2(entry_bucket_index >> 6, global_lock);
+      }
+    }
+    if (entry_link_next != SIZE_MAX) {
+      CacheEntry& entry_next = cache_entry_pool_[entry_link_next];
+      entry_next.buckets_prev[size_t(
+          (entry_next.key.base >> kCacheBucketSizeBytesLog2) !=
+          entry_bucket_index)] = entry_link_prev;
+    }
+  }
+  UnlinkCacheEntryLru(entry_index, global_lock);
+  cache_size_bytes_ -= entry.GetCacheSizeBytes();
+  entry.host_indices.reset();
+  // Make the entry free for reuse.
+  entry.free_next = cache_bucket_free_first_entry_;
+  cache_bucket_free_first_entry_ = entry_index;
+}
+
 std::pair<uint32_t, uint32_t> PrimitiveProcessor::MemoryInvalidationCallback(
     uint32_t physical_address_start, uint32_t length, bool exact_range) {
   if (length == 0 || physical_address_start >= SharedMemory::kBufferSize) {
@@ -1608,60 +1841,11 @@ std::pair<uint32_t, uint32_t> PrimitiveProcessor::MemoryInvalidationCallback(
               entry.buckets_next[bucket_index - entry_bucket_index_first];
           // For exact_range, don't invalidate bucket entries that are outside
           // the specified range.
-          if (entry_key.base < physical_address_end) {
-            uint32_t entry_end = entry_key.base + entry_key.GetSizeBytes();
-            if (entry_end > physical_address_end) {
-              // Invalidate the entry.
-              any_invalidated = true;
-              // Remove the entry from the cache map.
-              auto entry_map_it = cache_map_.find(entry_key);
-              assert_true(entry_map_it != cache_map_.end());
-              if (entry_map_it != cache_map_.end()) {
-                cache_map_.erase(entry_map_it);
-              }
-              // Unlink the entry from the bucket's list.
-              uint32_t entry_link_index_last =
-                  ((entry_end - 1) >> kCacheBucketSizeBytesLog2) -
-                  entry_bucket_index_first;
-              assert_true(
-                  entry_link_index_last <= 1,
-                  "Cache entries only store list links within two buckets");
-              for (uint32_t entry_link_index = 0;
-                   entry_link_index <= entry_link_index_last;
-                   ++entry_link_index) {
-                uint32_t entry_bucket_index =
-                    entry_bucket_index_first + entry_link_index;
-                size_t entry_link_prev = entry.buckets_prev[entry_link_index];
-                size_t entry_link_next = entry.buckets_next[entry_link_index];
-                if (entry_link_prev != SIZE_MAX) {
-                  CacheEntry& entry_prev = cache_entry_pool_[entry_link_prev];
-                  entry_prev.buckets_next[size_t(
-                      (entry_prev.key.base >> kCacheBucketSizeBytesLog2) !=
-                      entry_bucket_index)] = entry_link_next;
-                } else {
-                  if (entry_link_next != SIZE_MAX) {
-                    cache_bucket_first_entries_[entry_bucket_index] =
-                        entry_link_next;
-                  } else {
-                    // The only entry that was remaining in the bucket - it's
-                    // empty now.
-                    cache_buckets_non_empty_l1_[entry_bucket_index >> 6] &=
-                        ~(uint64_t(1) << (entry_bucket_index & 63));
-                    UpdateCacheBucketsNonEmptyL2(entry_bucket_index >> 6,
-                                                 global_lock);
-                  }
-                }
-                if (entry_link_next != SIZE_MAX) {
-                  CacheEntry& entry_next = cache_entry_pool_[entry_link_next];
-                  entry_next.buckets_prev[size_t(
-                      (entry_next.key.base >> kCacheBucketSizeBytesLog2) !=
-                      entry_bucket_index)] = entry_link_prev;
-                }
-              }
-              // Make the entry free for reuse.
-              entry.free_next = cache_bucket_free_first_entry_;
-              cache_bucket_free_first_entry_ = entry_index;
-            }
+          if (entry_key.base < physical_address_end &&
+              entry_key.base + entry_key.GetSizeBytes() >
+                  physical_address_start) {
+            any_invalidated = true;
+            RemoveCacheEntry(entry_index, global_lock);
           }
           entry_index = next_entry_index;
         } while (entry_index != SIZE_MAX);
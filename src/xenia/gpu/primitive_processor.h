@@ -17,9 +17,11 @@
 #include <cstring>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "xenia/base/assert.h"
 #include "xenia/base/cvar.h"
@@ -272,7 +274,9 @@ class PrimitiveProcessor {
 
   // Call at boundaries of lifespans of converted data (between frames,
   // preferably in the end of a frame so between the swap and the next draw,
-  // access violation handlers need to do less work).
+  // access violation handlers need to do less work). If the cache is kept
+  // across frames, only marks the host buffers of the cached results as
+  // expired so they're uploaded again on the next use.
   void ClearPerFrameCache();
 
   static constexpr size_t GetBuiltinIndexBufferOffsetBytes(size_t handle) {
@@ -709,7 +713,9 @@ class PrimitiveProcessor {
 
   std::deque<SinglePrimitiveRange> single_primitive_ranges_;
 
-  // Caching for reuse of converted indices within a frame.
+  // Caching for reuse of converted indices within a frame, and, if
+  // primitive_processor_cache_size_mb is not 0, across frames until the guest
+  // modifies the indices or the entry is evicted as the least recently used.
 
   // 256 KB as the largest possible guest index buffer - 0xFFFF 32-bit indices -
   // is slightly smaller than 256 KB, thus cache entries need store links within
@@ -792,6 +798,21 @@ class PrimitiveProcessor {
     size_t buckets_next[2];
     CacheKey key;
     CachedResult result;
+    // Least recently used list links, the head is the most recently used.
+    size_t lru_prev;
+    size_t lru_next;
+    // cache_frame_ when result.host_index_buffer_handle was obtained - for
+    // kHostConverted, the host buffer only lives until the end of that frame.
+    uint64_t handle_frame;
+    // For kHostConverted if the cache is kept across frames, the converted
+    // indices, starting at host_indices_offset, to upload to a new host buffer
+    // in later frames. Shared so an upload can be done outside the global
+    // critical region while the entry may be invalidated.
+    std::shared_ptr<std::vector<uint8_t>> host_indices;
+    uint32_t host_indices_offset;
+    size_t GetCacheSizeBytes() const {
+      return sizeof(CacheEntry) + (host_indices ? host_indices->size() : 0);
+    }
     static uint32_t GetBucketCount(CacheKey key) {
       uint32_t count =
           ((key.base + (key.GetSizeBytes() - 1)) >> kCacheBucketSizeBytesLog2) -
@@ -824,7 +845,11 @@ class PrimitiveProcessor {
   //     entry in the cache.
   // If an entry was found in the cache (GetFoundResult results non-null), it
   // MUST be used instead of processing - this class doesn't provide the
-  // possibility replace existing entries.
+  // possibility replace existing entries. An entry from a previous frame is
+  // uploaded to a host buffer for the current frame during the lookup.
+  // When processing, host buffers for kHostConverted results MUST be requested
+  // via RequestHostConvertedIndexBuffer of the transaction so the converted
+  // indices can be kept for later frames.
   class CacheTransaction final {
    public:
     CacheTransaction(PrimitiveProcessor& processor, CacheKey key);
@@ -836,7 +861,13 @@ class PrimitiveProcessor {
       assert_true(result_type_ != ResultType::kExisting);
       result_ = new_result;
       result_type_ = ResultType::kNewSet;
+      UploadHostIndices();
     }
+    void* RequestHostConvertedIndexBuffer(xenos::IndexFormat format,
+                                          uint32_t index_count,
+                                          bool coalign_for_simd,
+                                          uint32_t coalignment_original_address,
+                                          size_t& backend_handle_out);
     ~CacheTransaction();
 
    private:
@@ -853,12 +884,29 @@ class PrimitiveProcessor {
       kExisting,
     };
     ResultType result_type_ = ResultType::kNewUnset;
+    // If the cache is kept across frames, the indices are converted to
+    // host_indices_ first, then copied to host_mapping_ in SetNewResult.
+    std::shared_ptr<std::vector<uint8_t>> host_indices_;
+    uint32_t host_indices_offset_ = 0;
+    uint32_t host_indices_size_bytes_ = 0;
+    void* host_mapping_ = nullptr;
+
+    void UploadHostIndices();
   };
 
   std::deque<CacheEntry> cache_entry_pool_;
 
   void* memory_invalidation_callback_handle_ = nullptr;
 
+  // 0 if the cache is cleared at the end of every frame.
+  size_t cache_budget_bytes_ = 0;
+  // Incremented in ClearPerFrameCache to expire host buffer handles.
+  uint64_t cache_frame_ = 0;
+  // Statistics for the current frame, modified by the processor.
+  uint32_t cache_frame_hits_ = 0;
+  uint32_t cache_frame_cross_frame_hits_ = 0;
+  uint32_t cache_frame_misses_ = 0;
+
   xe::global_critical_region global_critical_region_;
   // Modified by both the processor and the invalidation callback.
   std::unordered_map<CacheKey, size_t, CacheKey::Hasher> cache_map_;
@@ -874,6 +922,11 @@ class PrimitiveProcessor {
   // Modified by both the processor and the invalidation callback.
   size_t cache_bucket_free_first_entry_ = SIZE_MAX;
   // Modified by both the processor and the invalidation callback.
+  size_t cache_lru_first_entry_ = SIZE_MAX;
+  size_t cache_lru_last_entry_ = SIZE_MAX;
+  size_t cache_size_bytes_ = 0;
+  uint32_t cache_frame_evictions_ = 0;
+  // Modified by both the processor and the invalidation callback.
   uint64_t cache_buckets_non_empty_l1_[(kCacheBucketCount + 63) / 64] = {};
   // For even faster handling of memory invalidation - whether any bit is set in
   // each cache_buckets_non_empty_l1_.
@@ -894,6 +947,17 @@ class PrimitiveProcessor {
       cache_buckets_non_empty_l2_ref &= ~cache_buckets_non_empty_l2_bit;
     }
   }
+  // Must be called in a global critical region.
+  void LinkCacheEntryLru(size_t entry_index,
+                         const global_unique_lock_type& global_lock);
+  void UnlinkCacheEntryLru(size_t entry_index,
+                           const global_unique_lock_type& global_lock);
+  // Removes the entry from the map, the buckets and the least recently used
+  // list, and frees it. Must be called in a global critical region.
+  void RemoveCacheEntry(size_t entry_index,
+                        const global_unique_lock_type& global_lock);
+  // Must be called in a global critical region.
+  void ResetCache(const global_unique_lock_type& global_lock);
   // cache_buckets_non_empty_l1_ (along with cache_buckets_non_empty_l2_, which
   // must be kept in sync) used for indication whether each entry is non-empty,
   // for faster clearing (there's no special index here for an empty entry).
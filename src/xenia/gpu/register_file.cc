@@ -11,6 +11,7 @@
 #include <array>
 #include <cstring>
 
+#include "xenia/base/byte_order.h"
 #include "xenia/base/math.h"
 
 namespace xe {
@@ -93,5 +94,90 @@ bool RegisterFile::IsValidRegister(uint32_t index) {
   return (valid_register_bitset[register_linear_index / 64] &
           (1ULL << (register_linear_index % 64))) != 0;
 }
+
+namespace {
+
+struct RegisterDirtyGroup {
+  uint32_t reg;
+  RegisterFile::DirtyGroup group;
+};
+
+// Registers read by draw_util::GetHostViewportInfo, draw_util::GetScissor and
+// the fixed-function state updates in the backends.
+constexpr RegisterDirtyGroup kRegisterDirtyGroupList[] = {
+    {XE_GPU_REG_PA_CL_CLIP_CNTL, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_CL_VTE_CNTL, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_SU_SC_MODE_CNTL, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_SU_VTX_CNTL, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_SC_WINDOW_OFFSET, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_CL_VPORT_XSCALE, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_CL_VPORT_XOFFSET, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_CL_VPORT_YSCALE, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_CL_VPORT_YOFFSET, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_CL_VPORT_ZSCALE, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_CL_VPORT_ZOFFSET, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_RB_DEPTH_INFO, RegisterFile::DirtyGroup::kViewport},
+    {XE_GPU_REG_PA_SC_WINDOW_SCISSOR_TL, RegisterFile::DirtyGroup::kScissor},
+    {XE_GPU_REG_PA_SC_WINDOW_SCISSOR_BR, RegisterFile::DirtyGroup::kScissor},
+    {XE_GPU_REG_PA_SC_WINDOW_OFFSET, RegisterFile::DirtyGroup::kScissor},
+    {XE_GPU_REG_PA_SC_SCREEN_SCISSOR_TL, RegisterFile::DirtyGroup::kScissor},
+    {XE_GPU_REG_PA_SC_SCREEN_SCISSOR_BR, RegisterFile::DirtyGroup::kScissor},
+    {XE_GPU_REG_RB_SURFACE_INFO, RegisterFile::DirtyGroup::kScissor},
+    {XE_GPU_REG_RB_BLEND_RED, RegisterFile::DirtyGroup::kBlendConstants},
+    {XE_GPU_REG_RB_BLEND_GREEN, RegisterFile::DirtyGroup::kBlendConstants},
+    {XE_GPU_REG_RB_BLEND_BLUE, RegisterFile::DirtyGroup::kBlendConstants},
+    {XE_GPU_REG_RB_BLEND_ALPHA, RegisterFile::DirtyGroup::kBlendConstants},
+    {XE_GPU_REG_RB_STENCILREFMASK, RegisterFile::DirtyGroup::kDepthStencil},
+    {XE_GPU_REG_RB_STENCILREFMASK_BF, RegisterFile::DirtyGroup::kDepthStencil},
+    {XE_GPU_REG_PA_SU_SC_MODE_CNTL, RegisterFile::DirtyGroup::kDepthStencil},
+    {XE_GPU_REG_PA_SU_POLY_OFFSET_FRONT_SCALE,
+     RegisterFile::DirtyGroup::kDepthStencil},
+    {XE_GPU_REG_PA_SU_POLY_OFFSET_FRONT_OFFSET,
+     RegisterFile::DirtyGroup::kDepthStencil},
+    {XE_GPU_REG_PA_SU_POLY_OFFSET_BACK_SCALE,
+     RegisterFile::DirtyGroup::kDepthStencil},
+    {XE_GPU_REG_PA_SU_POLY_OFFSET_BACK_OFFSET,
+     RegisterFile::DirtyGroup::kDepthStencil},
+    {XE_GPU_REG_RB_DEPTH_INFO, RegisterFile::DirtyGroup::kDepthStencil},
+};
+
+using RegisterDirtyGroupTable =
+    std::array<uint8_t, RegisterFile::kDirtyGroupRegisterCount>;
+
+constexpr RegisterDirtyGroupTable BuildRegisterDirtyGroupTable() {
+  RegisterDirtyGroupTable result{};
+  for (const RegisterDirtyGroup& entry : kRegisterDirtyGroupList) {
+    result[entry.reg - RegisterFile::kDirtyGroupRegisterFirst] |=
+        uint8_t(1 << uint32_t(entry.group));
+  }
+  return result;
+}
+
+}  // namespace
+
+const RegisterDirtyGroupTable RegisterFile::kRegisterDirtyGroups =
+    BuildRegisterDirtyGroupTable();
+
+void RegisterFile::MarkRangeChangedBigEndian(uint32_t first_reg,
+                                             const uint32_t* source,
+                                             uint32_t count) {
+  if (first_reg >= kDirtyGroupRegisterFirst + kDirtyGroupRegisterCount ||
+      first_reg + count <= kDirtyGroupRegisterFirst) {
+    return;
+  }
+  // Only a few registers belong to groups, check them rather than the whole
+  // range.
+  for (const RegisterDirtyGroup& entry : kRegisterDirtyGroupList) {
+    uint32_t group_bit = UINT32_C(1) << uint32_t(entry.group);
+    uint32_t source_index = entry.reg - first_reg;
+    if (source_index < count &&
+        !(dirty_groups_.load(std::memory_order_relaxed) & group_bit) &&
+        xe::load_and_swap<uint32_t>(source + source_index) !=
+            values[entry.reg]) {
+      dirty_groups_.fetch_or(group_bit, std::memory_order_relaxed);
+    }
+  }
+}
+
 }  //  namespace gpu
 }  //  namespace xe
@@ -10,6 +10,8 @@
 #ifndef XENIA_GPU_REGISTER_FILE_H_
 #define XENIA_GPU_REGISTER_FILE_H_
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -86,6 +88,82 @@ class RegisterFile {
         sizeof(stream));
     return stream;
   }
+
+  // Groups of registers that host draw state is derived from. Changes of the
+  // register values mark their groups as dirty, so draw setup can reuse the
+  // state derived for the previous draw if none of its inputs have changed.
+  enum class DirtyGroup : uint32_t {
+    kViewport,
+    kScissor,
+    kBlendConstants,
+    kDepthStencil,
+
+    kCount,
+  };
+  static constexpr uint32_t kAllDirtyGroups =
+      (UINT32_C(1) << uint32_t(DirtyGroup::kCount)) - 1;
+  // All the registers in the groups are context registers.
+  static constexpr uint32_t kDirtyGroupRegisterFirst = 0x2000;
+  static constexpr uint32_t kDirtyGroupRegisterCount = 0x400;
+
+  // Must be called before writing a new value to a register directly.
+  void MarkChanged(uint32_t reg, uint32_t new_value) {
+    uint32_t context_index = reg - kDirtyGroupRegisterFirst;
+    if (context_index < kDirtyGroupRegisterCount && values[reg] != new_value) {
+      dirty_groups_.fetch_or(kRegisterDirtyGroups[context_index],
+                             std::memory_order_relaxed);
+    }
+  }
+  // Must be called before copying big-endian values from the source to a range
+  // of registers directly.
+  void MarkRangeChangedBigEndian(uint32_t first_reg, const uint32_t* source,
+                                 uint32_t count);
+  // For writes that may have changed any register, such as restoring a state.
+  void MarkAllChanged() {
+    dirty_groups_.store(kAllDirtyGroups, std::memory_order_relaxed);
+  }
+
+  // Returns whether any register in the group has changed since the previous
+  // call for the group, and clears the dirty flag of the group.
+  bool ConsumeDirtyGroup(DirtyGroup group) {
+    uint32_t group_bit = UINT32_C(1) << uint32_t(group);
+    return (dirty_groups_.fetch_and(~group_bit, std::memory_order_relaxed) &
+            group_bit) != 0;
+  }
+  void CountGroupUpdate(bool recomputed) {
+    if (recomputed) {
+      ++groups_recomputed_;
+    } else {
+      ++groups_skipped_;
+    }
+  }
+  // Returns whether the state derived from the group needs to be recomputed,
+  // because its registers or the inputs outside the register file have
+  // changed.
+  bool BeginGroupUpdate(DirtyGroup group, bool other_inputs_changed = false) {
+    bool recompute = ConsumeDirtyGroup(group) || other_inputs_changed;
+    CountGroupUpdate(recompute);
+    return recompute;
+  }
+  // Statistics since the last reset (done every frame by the command
+  // processor).
+  uint32_t groups_recomputed() const { return groups_recomputed_; }
+  uint32_t groups_skipped() const { return groups_skipped_; }
+  void ResetGroupUpdateCounters() {
+    groups_recomputed_ = 0;
+    groups_skipped_ = 0;
+  }
+
+ private:
+  // Masks of the groups each context register belongs to.
+  static const std::array<uint8_t, kDirtyGroupRegisterCount>
+      kRegisterDirtyGroups;
+
+  // Set by MMIO register writes on guest threads and cleared by the command
+  // processor thread.
+  std::atomic<uint32_t> dirty_groups_{kAllDirtyGroups};
+  uint32_t groups_recomputed_ = 0;
+  uint32_t groups_skipped_ = 0;
 };
 
 }  // namespace gpu
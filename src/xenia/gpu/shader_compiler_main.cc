@@ -7,21 +7,32 @@
  ******************************************************************************
  */
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <cinttypes>
 #include <cstring>
+#include <filesystem>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "third_party/fmt/include/fmt/format.h"
 #include "third_party/glslang/SPIRV/disassemble.h"
 #include "xenia/base/assert.h"
+#include "xenia/base/byte_order.h"
 #include "xenia/base/console_app_main.h"
 #include "xenia/base/cvar.h"
+#include "xenia/base/filesystem.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/platform.h"
 #include "xenia/base/string.h"
 #include "xenia/base/string_buffer.h"
+#include "xenia/base/threading.h"
+#include "xenia/base/xxhash.h"
 #include "xenia/gpu/dxbc_shader_translator.h"
 #include "xenia/gpu/shader_translator.h"
 #include "xenia/gpu/spirv_shader_translator.h"
@@ -33,7 +44,14 @@
 #include "xenia/ui/d3d12/d3d12_api.h"
 #endif  // XE_PLATFORM_WIN32
 
-DEFINE_path(shader_input, "", "Input shader binary file path.", "GPU");
+DEFINE_path(
+    shader_input, "",
+    "Input shader binary file path.\n"
+    "Batch mode: a directory with .vs and .ps files (searched recursively), or "
+    "a Direct3D 12 shader storage file (.xsh) - all shaders are translated "
+    "using all cores, and the results are written as CSV to --shader_output "
+    "(or to the standard output if not specified).",
+    "GPU");
 DEFINE_string(shader_input_type, "",
               "'vs', 'ps', or unspecified to infer from the given filename.",
               "GPU");
@@ -52,6 +70,14 @@ DEFINE_string(
     "[vertex or unspecified, linedomaincp, linedomainpatch, triangledomaincp, "
     "triangledomainpatch, quaddomaincp, quaddomainpatch].",
     "GPU");
+DEFINE_string(
+    shader_output_spirv_optimization_passes, "",
+    "SPIRV-Tools optimizer passes to apply to SPIR-V output, as "
+    "space-separated spirv-opt command line flags (such as -O), or empty to "
+    "output the shader unoptimized. The instruction counts before and after "
+    "optimization are logged. Requires the Vulkan SDK (the VULKAN_SDK "
+    "environment variable).",
+    "GPU");
 DEFINE_bool(shader_output_bindless_resources, false,
             "Output host shader with bindless resources used.", "GPU");
 DEFINE_bool(
@@ -59,11 +85,343 @@ DEFINE_bool(
     "Output host shader with a render backend implementation based on pixel "
     "shader interlock.",
     "GPU");
+DEFINE_uint32(shader_batch_threads, 0,
+              "Number of threads to translate shaders on in batch mode, or 0 "
+              "to use all logical processors.",
+              "GPU");
 
 namespace xe {
 namespace gpu {
 
+static bool GetShaderTypeFromPath(const std::filesystem::path& path,
+                                  xenos::ShaderType& shader_type_out) {
+  if (!path.has_extension()) {
+    return false;
+  }
+  auto extension = path.extension();
+  if (extension == ".vs") {
+    shader_type_out = xenos::ShaderType::kVertex;
+    return true;
+  }
+  if (extension == ".ps") {
+    shader_type_out = xenos::ShaderType::kPixel;
+    return true;
+  }
+  return false;
+}
+
+// Returns nullptr if only the microcode disassembly is requested.
+static std::unique_ptr<ShaderTranslator> CreateTranslator(
+    const SpirvShaderTranslator::Features& spirv_features) {
+  if (cvars::shader_output_type == "spirv" ||
+      cvars::shader_output_type == "spirvtext") {
+    return std::make_unique<SpirvShaderTranslator>(
+        spirv_features, true, true,
+        cvars::shader_output_pixel_shader_interlock);
+  }
+  if (cvars::shader_output_type == "dxbc" ||
+      cvars::shader_output_type == "dxbctext") {
+    return std::make_unique<DxbcShaderTranslator>(
+        ui::GraphicsProvider::GpuVendorID(0),
+        cvars::shader_output_bindless_resources,
+        cvars::shader_output_pixel_shader_interlock);
+  }
+  return nullptr;
+}
+
+static uint64_t GetDefaultModification(const ShaderTranslator& translator,
+                                       xenos::ShaderType shader_type) {
+  if (shader_type != xenos::ShaderType::kVertex) {
+    return translator.GetDefaultPixelShaderModification(
+        xenos::kMaxShaderTempRegisters);
+  }
+  Shader::HostVertexShaderType host_vertex_shader_type =
+      Shader::HostVertexShaderType::kVertex;
+  if (cvars::vertex_shader_output_type == "linedomaincp") {
+    host_vertex_shader_type =
+        Shader::HostVertexShaderType::kLineDomainCPIndexed;
+  } else if (cvars::vertex_shader_output_type == "linedomainpatch") {
+    host_vertex_shader_type =
+        Shader::HostVertexShaderType::kLineDomainPatchIndexed;
+  } else if (cvars::vertex_shader_output_type == "triangledomaincp") {
+    host_vertex_shader_type =
+        Shader::HostVertexShaderType::kTriangleDomainCPIndexed;
+  } else if (cvars::vertex_shader_output_type == "triangledomainpatch") {
+    host_vertex_shader_type =
+        Shader::HostVertexShaderType::kTriangleDomainPatchIndexed;
+  } else if (cvars::vertex_shader_output_type == "quaddomaincp") {
+    host_vertex_shader_type =
+        Shader::HostVertexShaderType::kQuadDomainCPIndexed;
+  } else if (cvars::vertex_shader_output_type == "quaddomainpatch") {
+    host_vertex_shader_type =
+        Shader::HostVertexShaderType::kQuadDomainPatchIndexed;
+  }
+  return translator.GetDefaultVertexShaderModification(
+      xenos::kMaxShaderTempRegisters, host_vertex_shader_type);
+}
+
+struct BatchShader {
+  std::string name;
+  xenos::ShaderType type;
+  uint64_t ucode_data_hash;
+  std::vector<uint32_t> ucode_dwords;
+  std::endian ucode_source_endian;
+};
+
+struct BatchShaderResult {
+  double analysis_us = 0.0;
+  double translation_us = 0.0;
+  size_t output_bytes = 0;
+  bool translated = false;
+};
+
+static bool LoadBatchDirectory(const std::filesystem::path& path,
+                               std::vector<BatchShader>& shaders_out) {
+  std::error_code error_code;
+  using directory_iterator = std::filesystem::recursive_directory_iterator;
+  for (auto it = directory_iterator(path, error_code);
+       it != directory_iterator(); it.increment(error_code)) {
+    if (error_code) {
+      XELOGE("Failed to list the shader directory {}: {}", path,
+             error_code.message());
+      return false;
+    }
+    xenos::ShaderType shader_type;
+    if (!it->is_regular_file() ||
+        !GetShaderTypeFromPath(it->path(), shader_type)) {
+      continue;
+    }
+    FILE* file = filesystem::OpenFile(it->path(), "rb");
+    if (!file) {
+      XELOGE("Unable to open input file: {}", it->path());
+      continue;
+    }
+    BatchShader& shader = shaders_out.emplace_back();
+    shader.name = xe::path_to_utf8(
+        std::filesystem::relative(it->path(), path, error_code));
+    shader.type = shader_type;
+    shader.ucode_data_hash = 0;
+    shader.ucode_dwords.resize(it->file_size() / sizeof(uint32_t));
+    shader.ucode_dwords.resize(fread(shader.ucode_dwords.data(),
+                                     sizeof(uint32_t),
+                                     shader.ucode_dwords.size(), file));
+    shader.ucode_source_endian = cvars::shader_input_little_endian
+                                     ? std::endian::little
+                                     : std::endian::big;
+    fclose(file);
+  }
+  // Stable order of the report.
+  std::sort(shaders_out.begin(), shaders_out.end(),
+            [](const BatchShader& a, const BatchShader& b) {
+              return a.name < b.name;
+            });
+  return true;
+}
+
+// The format of the shader storage of the Direct3D 12 PipelineCache - the
+// header of the file, then, for each shader, ShaderStoredHeader followed by the
+// big-endian microcode.
+static bool LoadBatchShaderStorage(const std::filesystem::path& path,
+                                   std::vector<BatchShader>& shaders_out) {
+  FILE* file = filesystem::OpenFile(path, "rb");
+  if (!file) {
+    XELOGE("Unable to open the shader storage file: {}", path);
+    return false;
+  }
+  struct {
+    uint32_t magic;
+    uint32_t version_swapped;
+  } file_header;
+  // 'XESH'.
+  constexpr uint32_t kShaderStorageMagic = 0x48534558;
+  // ShaderStoredHeader::kVersion.
+  constexpr uint32_t kShaderStorageVersion = 0x20201219;
+  if (!fread(&file_header, sizeof(file_header), 1, file) ||
+      file_header.magic != kShaderStorageMagic ||
+      xe::byte_swap(file_header.version_swapped) != kShaderStorageVersion) {
+    XELOGE("{} is not a supported shader storage file", path);
+    fclose(file);
+    return false;
+  }
+  std::error_code error_code;
+  uint64_t file_size = std::filesystem::file_size(path, error_code);
+  if (error_code) {
+    XELOGE("Unable to get the size of the shader storage file {}: {}", path,
+           error_code.message());
+    fclose(file);
+    return false;
+  }
+  uint64_t file_offset = sizeof(file_header);
+  while (true) {
+    // ShaderStoredHeader, packed.
+    uint64_t ucode_data_hash;
+    uint32_t ucode_dword_count_and_type;
+    if (!fread(&ucode_data_hash, sizeof(ucode_data_hash), 1, file) ||
+        !fread(&ucode_dword_count_and_type, sizeof(ucode_dword_count_and_type),
+               1, file)) {
+      break;
+    }
+    file_offset += sizeof(ucode_data_hash) + sizeof(ucode_dword_count_and_type);
+    uint32_t ucode_dword_count = ucode_dword_count_and_type & 0x7FFFFFFF;
+    uint64_t ucode_byte_count = uint64_t(ucode_dword_count) * sizeof(uint32_t);
+    if (ucode_byte_count > file_size - std::min(file_offset, file_size)) {
+      // Truncated at the end, like if the emulator was closed while writing,
+      // or a corrupted size that must not be allocated.
+      break;
+    }
+    BatchShader shader;
+    shader.type = xenos::ShaderType(ucode_dword_count_and_type >> 31);
+    shader.name = fmt::format(
+        "{:016X}.{}", ucode_data_hash,
+        shader.type == xenos::ShaderType::kVertex ? "vs" : "ps");
+    shader.ucode_data_hash = ucode_data_hash;
+    shader.ucode_dwords.resize(ucode_dword_count);
+    if (fread(shader.ucode_dwords.data(), sizeof(uint32_t),
+              shader.ucode_dwords.size(),
+              file) != shader.ucode_dwords.size()) {
+      break;
+    }
+    file_offset += ucode_byte_count;
+    if (XXH3_64bits(shader.ucode_dwords.data(), size_t(ucode_byte_count)) !=
+        ucode_data_hash) {
+      // Like the pipeline cache, don't trust anything after corrupted data.
+      XELOGW("Shader {} in {} doesn't match its hash, stopping there",
+             shader.name, path);
+      break;
+    }
+    shader.ucode_source_endian = std::endian::big;
+    shaders_out.push_back(std::move(shader));
+  }
+  fclose(file);
+  return true;
+}
+
+static int shader_compiler_batch_main(
+    const SpirvShaderTranslator::Features& spirv_features) {
+  if (!CreateTranslator(spirv_features)) {
+    XELOGE(
+        "Batch mode requires a translator: --shader_output_type=spirv or "
+        "dxbc.");
+    return 1;
+  }
+
+  std::vector<BatchShader> shaders;
+  if (std::filesystem::is_directory(cvars::shader_input)) {
+    if (!LoadBatchDirectory(cvars::shader_input, shaders)) {
+      return 1;
+    }
+  } else if (!LoadBatchShaderStorage(cvars::shader_input, shaders)) {
+    return 1;
+  }
+
+  uint32_t thread_count = cvars::shader_batch_threads;
+  if (!thread_count) {
+    thread_count = std::max(xe::threading::logical_processor_count(),
+                            uint32_t(1));
+  }
+  thread_count = uint32_t(std::max(
+      std::min(size_t(thread_count), shaders.size()), size_t(1)));
+  XELOGI("Translating {} shaders from {} on {} threads.", shaders.size(),
+         cvars::shader_input, thread_count);
+
+  std::vector<BatchShaderResult> results(shaders.size());
+  std::atomic<size_t> next_shader_index(0);
+  auto translation_thread_function = [&]() {
+    // Translators are not thread-safe, one per thread.
+    std::unique_ptr<ShaderTranslator> translator =
+        CreateTranslator(spirv_features);
+    StringBuffer ucode_disasm_buffer;
+    while (true) {
+      size_t shader_index = next_shader_index.fetch_add(1);
+      if (shader_index >= shaders.size()) {
+        break;
+      }
+      const BatchShader& batch_shader = shaders[shader_index];
+      BatchShaderResult& result = results[shader_index];
+      Shader shader(batch_shader.type, batch_shader.ucode_data_hash,
+                    batch_shader.ucode_dwords.data(),
+                    batch_shader.ucode_dwords.size(),
+                    batch_shader.ucode_source_endian);
+      auto analysis_start = std::chrono::steady_clock::now();
+      shader.AnalyzeUcode(ucode_disasm_buffer);
+      auto translation_start = std::chrono::steady_clock::now();
+      Shader::Translation* translation = shader.GetOrCreateTranslation(
+          GetDefaultModification(*translator, batch_shader.type));
+      result.translated = translator->TranslateAnalyzedShader(*translation);
+      auto translation_end = std::chrono::steady_clock::now();
+      result.analysis_us = std::chrono::duration<double, std::micro>(
+                               translation_start - analysis_start)
+                               .count();
+      result.translation_us = std::chrono::duration<double, std::micro>(
+                                  translation_end - translation_start)
+                                  .count();
+      result.output_bytes = translation->translated_binary().size();
+    }
+  };
+  auto batch_start = std::chrono::steady_clock::now();
+  std::vector<std::unique_ptr<xe::threading::Thread>> threads;
+  for (uint32_t i = 1; i < thread_count; ++i) {
+    std::unique_ptr<xe::threading::Thread> thread =
+        xe::threading::Thread::Create({}, translation_thread_function);
+    assert_not_null(thread);
+    thread->set_name("Shader Translation");
+    threads.push_back(std::move(thread));
+  }
+  // Use the main thread as one of the translation threads.
+  translation_thread_function();
+  for (const std::unique_ptr<xe::threading::Thread>& thread : threads) {
+    xe::threading::Wait(thread.get(), false);
+  }
+  double batch_ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - batch_start)
+                        .count();
+
+  std::string csv =
+      "shader,type,ucode_dwords,analysis_us,translation_us,output_bytes,"
+      "result\n";
+  size_t translated_count = 0;
+  double translation_total_us = 0.0;
+  size_t output_total_bytes = 0;
+  for (size_t i = 0; i < shaders.size(); ++i) {
+    const BatchShader& shader = shaders[i];
+    const BatchShaderResult& result = results[i];
+    fmt::format_to(std::back_inserter(csv), "{},{},{},{:.3f},{:.3f},{},{}\n",
+                   shader.name,
+                   shader.type == xenos::ShaderType::kVertex ? "vs" : "ps",
+                   shader.ucode_dwords.size(), result.analysis_us,
+                   result.translation_us, result.output_bytes,
+                   result.translated ? "ok" : "failed");
+    translated_count += size_t(result.translated);
+    translation_total_us += result.analysis_us + result.translation_us;
+    output_total_bytes += result.output_bytes;
+  }
+  if (!cvars::shader_output.empty()) {
+    FILE* output_file = filesystem::OpenFile(cvars::shader_output, "wb");
+    if (!output_file) {
+      XELOGE("Unable to open the output file: {}", cvars::shader_output);
+      return 1;
+    }
+    fwrite(csv.data(), 1, csv.size(), output_file);
+    fclose(output_file);
+  } else {
+    fwrite(csv.data(), 1, csv.size(), stdout);
+  }
+
+  XELOGI(
+      "Translated {} of {} shaders in {:.3f} ms ({:.3f} ms of analysis and "
+      "translation in total, {} bytes of output).",
+      translated_count, shaders.size(), batch_ms,
+      translation_total_us / 1000.0, output_total_bytes);
+  return translated_count == shaders.size() ? 0 : 1;
+}
+
 int shader_compiler_main(const std::vector<std::string>& args) {
+  SpirvShaderTranslator::Features spirv_features(true);
+  if (std::filesystem::is_directory(cvars::shader_input) ||
+      cvars::shader_input.extension() == ".xsh") {
+    return shader_compiler_batch_main(spirv_features);
+  }
+
   xenos::ShaderType shader_type;
   if (!cvars::shader_input_type.empty()) {
     if (cvars::shader_input_type == "vs") {
@@ -75,18 +433,7 @@ int shader_compiler_main(const std::vector<std::string>& args) {
       return 1;
     }
   } else {
-    bool valid_type = false;
-    if (cvars::shader_input.has_extension()) {
-      auto extension = cvars::shader_input.extension();
-      if (extension == ".vs") {
-        shader_type = xenos::ShaderType::kVertex;
-        valid_type = true;
-      } else if (extension == ".ps") {
-        shader_type = xenos::ShaderType::kPixel;
-        valid_type = true;
-      }
-    }
-    if (!valid_type) {
+    if (!GetShaderTypeFromPath(cvars::shader_input, shader_type)) {
       XELOGE(
           "File type not recognized (use .vs, .ps or "
           "--shader_input_type=vs|ps).");
@@ -118,20 +465,9 @@ int shader_compiler_main(const std::vector<std::string>& args) {
   StringBuffer ucode_disasm_buffer;
   shader->AnalyzeUcode(ucode_disasm_buffer);
 
-  std::unique_ptr<ShaderTranslator> translator;
-  SpirvShaderTranslator::Features spirv_features(true);
-  if (cvars::shader_output_type == "spirv" ||
-      cvars::shader_output_type == "spirvtext") {
-    translator = std::make_unique<SpirvShaderTranslator>(
-        spirv_features, true, true,
-        cvars::shader_output_pixel_shader_interlock);
-  } else if (cvars::shader_output_type == "dxbc" ||
-             cvars::shader_output_type == "dxbctext") {
-    translator = std::make_unique<DxbcShaderTranslator>(
-        ui::GraphicsProvider::GpuVendorID(0),
-        cvars::shader_output_bindless_resources,
-        cvars::shader_output_pixel_shader_interlock);
-  } else {
+  std::unique_ptr<ShaderTranslator> translator =
+      CreateTranslator(spirv_features);
+  if (!translator) {
     // Just output microcode disassembly generated during microcode information
     // gathering.
     if (!cvars::shader_output.empty()) {
@@ -143,43 +479,7 @@ int shader_compiler_main(const std::vector<std::string>& args) {
     return 0;
   }
 
-  Shader::HostVertexShaderType host_vertex_shader_type =
-      Shader::HostVertexShaderType::kVertex;
-  if (shader_type == xenos::ShaderType::kVertex) {
-    if (cvars::vertex_shader_output_type == "linedomaincp") {
-      host_vertex_shader_type =
-          Shader::HostVertexShaderType::kLineDomainCPIndexed;
-    } else if (cvars::vertex_shader_output_type == "linedomainpatch") {
-      host_vertex_shader_type =
-          Shader::HostVertexShaderType::kLineDomainPatchIndexed;
-    } else if (cvars::vertex_shader_output_type == "triangledomaincp") {
-      host_vertex_shader_type =
-          Shader::HostVertexShaderType::kTriangleDomainCPIndexed;
-    } else if (cvars::vertex_shader_output_type == "triangledomainpatch") {
-      host_vertex_shader_type =
-          Shader::HostVertexShaderType::kTriangleDomainPatchIndexed;
-    } else if (cvars::vertex_shader_output_type == "quaddomaincp") {
-      host_vertex_shader_type =
-          Shader::HostVertexShaderType::kQuadDomainCPIndexed;
-    } else if (cvars::vertex_shader_output_type == "quaddomainpatch") {
-      host_vertex_shader_type =
-          Shader::HostVertexShaderType::kQuadDomainPatchIndexed;
-    }
-  }
-  uint64_t modification;
-  switch (shader_type) {
-    case xenos::ShaderType::kVertex:
-      modification = translator->GetDefaultVertexShaderModification(
-          xenos::kMaxShaderTempRegisters, host_vertex_shader_type);
-      break;
-    case xenos::ShaderType::kPixel:
-      modification = translator->GetDefaultPixelShaderModification(
-          xenos::kMaxShaderTempRegisters);
-      break;
-    default:
-      assert_unhandled_case(shader_type);
-      return 1;
-  }
+  uint64_t modification = GetDefaultModification(*translator, shader_type);
 
   Shader::Translation* translation =
       shader->GetOrCreateTranslation(modification);
@@ -188,6 +488,37 @@ int shader_compiler_main(const std::vector<std::string>& args) {
   const void* source_data = translation->translated_binary().data();
   size_t source_data_size = translation->translated_binary().size();
 
+  std::vector<uint32_t> spirv_optimized;
+  if (cvars::shader_output_type == "spirv" ||
+      cvars::shader_output_type == "spirvtext") {
+    size_t spirv_instruction_count =
+        ui::vulkan::SpirvToolsContext::CountInstructions(
+            reinterpret_cast<const uint32_t*>(source_data),
+            source_data_size / sizeof(uint32_t));
+    XELOGI("SPIR-V shader: {} instructions.", spirv_instruction_count);
+    if (!cvars::shader_output_spirv_optimization_passes.empty()) {
+      ui::vulkan::SpirvToolsContext spirv_tools_context;
+      if (!spirv_tools_context.Initialize(spirv_features.spirv_version) ||
+          spirv_tools_context.Optimize(
+              reinterpret_cast<const uint32_t*>(source_data),
+              source_data_size / sizeof(uint32_t),
+              cvars::shader_output_spirv_optimization_passes,
+              spirv_optimized) != SPV_SUCCESS) {
+        XELOGE("Failed to optimize the SPIR-V shader.");
+        return 1;
+      }
+      size_t spirv_optimized_instruction_count =
+          ui::vulkan::SpirvToolsContext::CountInstructions(
+              spirv_optimized.data(), spirv_optimized.size());
+      XELOGI("Optimized SPIR-V shader: {} instructions ({:+}).",
+             spirv_optimized_instruction_count,
+             ptrdiff_t(spirv_optimized_instruction_count) -
+                 ptrdiff_t(spirv_instruction_count));
+      source_data = spirv_optimized.data();
+      source_data_size = sizeof(uint32_t) * spirv_optimized.size();
+    }
+  }
+
   std::string spirv_disasm;
   if (cvars::shader_output_type == "spirvtext") {
     std::ostringstream spirv_disasm_stream;
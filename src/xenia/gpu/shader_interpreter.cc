@@ -9,25 +9,35 @@
 
 #include "xenia/gpu/shader_interpreter.h"
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 #include <cstring>
 
+#include "xenia/base/math.h"
+
 namespace xe {
 namespace gpu {
 
-void ShaderInterpreter::Execute() {
+void ShaderInterpreter::ExecuteLanes(uint32_t lane_count) {
+  assert_true(lane_count && lane_count <= kMaxLanes);
+  lane_count = std::min(lane_count, kMaxLanes);
+  if (!lane_count) {
+    return;
+  }
   // For more consistency between invocations in case of a malformed shader.
-  state_.Reset();
+  for (uint32_t lane = 0; lane < lane_count; ++lane) {
+    states_[lane].Reset();
+  }
+  ExecuteControlFlow(0, (UINT32_C(1) << lane_count) - 1);
+}
 
+void ShaderInterpreter::ExecuteControlFlow(uint32_t cf_index,
+                                           uint32_t lane_mask) {
   const uint32_t* bool_constants =
       &register_file_[XE_GPU_REG_SHADER_CONSTANT_BOOL_000_031];
 
-  bool exec_ended = false;
-  uint32_t cf_index_next = 1;
-  for (uint32_t cf_index = 0; !exec_ended; cf_index = cf_index_next) {
-    cf_index_next = cf_index + 1;
-
+  while (lane_mask) {
     const uint32_t* cf_pair = &ucode_[3 * (cf_index >> 1)];
     ucode::ControlFlowInstruction cf_instr;
     if (cf_index & 1) {
@@ -39,223 +49,282 @@ void ShaderInterpreter::Execute() {
     }
 
     ucode::ControlFlowOpcode cf_opcode = cf_instr.opcode();
-    switch (cf_opcode) {
-      case ucode::ControlFlowOpcode::kNop: {
-      } break;
-
-      case ucode::ControlFlowOpcode::kExec:
-      case ucode::ControlFlowOpcode::kExecEnd:
-      case ucode::ControlFlowOpcode::kCondExec:
-      case ucode::ControlFlowOpcode::kCondExecEnd:
-      case ucode::ControlFlowOpcode::kCondExecPred:
-      case ucode::ControlFlowOpcode::kCondExecPredEnd:
-      case ucode::ControlFlowOpcode::kCondExecPredClean:
-      case ucode::ControlFlowOpcode::kCondExecPredCleanEnd: {
-        ucode::ControlFlowExecInstruction cf_exec =
-            *reinterpret_cast<const ucode::ControlFlowExecInstruction*>(
-                &cf_instr);
+    if (ucode::IsControlFlowOpcodeExec(cf_opcode)) {
+      ucode::ControlFlowExecInstruction cf_exec =
+          *reinterpret_cast<const ucode::ControlFlowExecInstruction*>(
+              &cf_instr);
 
-        switch (cf_opcode) {
-          case ucode::ControlFlowOpcode::kCondExec:
-          case ucode::ControlFlowOpcode::kCondExecEnd:
-          case ucode::ControlFlowOpcode::kCondExecPredClean:
-          case ucode::ControlFlowOpcode::kCondExecPredCleanEnd: {
-            const ucode::ControlFlowCondExecInstruction cf_cond_exec =
-                *reinterpret_cast<const ucode::ControlFlowCondExecInstruction*>(
-                    &cf_exec);
-            uint32_t bool_address = cf_cond_exec.bool_address();
-            if (cf_cond_exec.condition() !=
-                ((bool_constants[bool_address >> 5] &
-                  (UINT32_C(1) << (bool_address & 31))) != 0)) {
-              continue;
-            }
-          } break;
-          case ucode::ControlFlowOpcode::kCondExecPred:
-          case ucode::ControlFlowOpcode::kCondExecPredEnd: {
-            const ucode::ControlFlowCondExecPredInstruction cf_cond_exec_pred =
-                *reinterpret_cast<
-                    const ucode::ControlFlowCondExecPredInstruction*>(&cf_exec);
-            if (cf_cond_exec_pred.condition() != state_.predicate) {
-              continue;
-            }
-          } break;
-          default:
-            break;
-        }
-
-        for (uint32_t exec_index = 0; exec_index < cf_exec.count();
-             ++exec_index) {
-          const uint32_t* exec_instruction =
-              &ucode_[3 * (cf_exec.address() + exec_index)];
-          if ((cf_exec.sequence() >> (exec_index << 1)) & 0b01) {
-            const ucode::FetchInstruction& fetch_instr =
-                *reinterpret_cast<const ucode::FetchInstruction*>(
-                    exec_instruction);
-            if (fetch_instr.is_predicated() &&
-                fetch_instr.predicate_condition() != state_.predicate) {
-              continue;
-            }
-            if (fetch_instr.opcode() == ucode::FetchOpcode::kVertexFetch) {
-              ExecuteVertexFetchInstruction(fetch_instr.vertex_fetch());
-            } else {
-              // Not supporting texture fetching (very complex).
-              float zero_result[4] = {};
-              StoreFetchResult(fetch_instr.dest(),
-                               fetch_instr.is_dest_relative(),
-                               fetch_instr.dest_swizzle(), zero_result);
-            }
-          } else {
-            const ucode::AluInstruction& alu_instr =
-                *reinterpret_cast<const ucode::AluInstruction*>(
-                    exec_instruction);
-            if (alu_instr.is_predicated() &&
-                alu_instr.predicate_condition() != state_.predicate) {
-              continue;
-            }
-            ExecuteAluInstruction(alu_instr);
+      uint32_t exec_lane_mask = lane_mask;
+      switch (cf_opcode) {
+        case ucode::ControlFlowOpcode::kCondExec:
+        case ucode::ControlFlowOpcode::kCondExecEnd:
+        case ucode::ControlFlowOpcode::kCondExecPredClean:
+        case ucode::ControlFlowOpcode::kCondExecPredCleanEnd: {
+          const ucode::ControlFlowCondExecInstruction cf_cond_exec =
+              *reinterpret_cast<const ucode::ControlFlowCondExecInstruction*>(
+                  &cf_exec);
+          uint32_t bool_address = cf_cond_exec.bool_address();
+          if (cf_cond_exec.condition() !=
+              ((bool_constants[bool_address >> 5] &
+                (UINT32_C(1) << (bool_address & 31))) != 0)) {
+            exec_lane_mask = 0;
           }
-        }
+        } break;
+        case ucode::ControlFlowOpcode::kCondExecPred:
+        case ucode::ControlFlowOpcode::kCondExecPredEnd: {
+          const ucode::ControlFlowCondExecPredInstruction cf_cond_exec_pred =
+              *reinterpret_cast<
+                  const ucode::ControlFlowCondExecPredInstruction*>(&cf_exec);
+          exec_lane_mask =
+              GetPredicatedLaneMask(lane_mask, cf_cond_exec_pred.condition());
+        } break;
+        default:
+          break;
+      }
 
+      if (exec_lane_mask) {
+        ExecuteExec(cf_exec, exec_lane_mask);
         if (ucode::DoesControlFlowOpcodeEndShader(cf_opcode)) {
-          exec_ended = true;
+          lane_mask &= ~exec_lane_mask;
         }
-      } break;
+      }
+      ++cf_index;
+      continue;
+    }
 
-      case ucode::ControlFlowOpcode::kLoopStart: {
-        ucode::ControlFlowLoopStartInstruction cf_loop_start =
-            *reinterpret_cast<const ucode::ControlFlowLoopStartInstruction*>(
-                &cf_instr);
-        assert_true(state_.loop_stack_depth < 4);
-        if (++state_.loop_stack_depth > 4) {
-          cf_index_next = cf_loop_start.address();
-          continue;
-        }
-        auto loop_constant = register_file_.Get<xenos::LoopConstant>(
-            XE_GPU_REG_SHADER_CONSTANT_LOOP_00 + cf_loop_start.loop_id());
-        state_.loop_constants[state_.loop_stack_depth] = loop_constant;
-        uint32_t& loop_iterator_ref =
-            state_.loop_iterators[state_.loop_stack_depth];
-        if (!cf_loop_start.is_repeat()) {
-          loop_iterator_ref = 0;
-        }
-        if (loop_iterator_ref >= loop_constant.count) {
-          cf_index_next = cf_loop_start.address();
-          continue;
+    // Other control flow instructions may go to different places in different
+    // lanes.
+    uint32_t lane_cf_index_next[kMaxLanes];
+    for (uint32_t lanes = lane_mask; lanes; lanes &= lanes - 1) {
+      uint32_t lane = xe::tzcnt(lanes);
+      lane_cf_index_next[lane] =
+          ExecuteControlFlowInstructionLane(cf_instr, cf_index, lane);
+    }
+    // Continue with the lanes going to the same place as the first one, and
+    // execute the diverged ones separately - the lanes are independent.
+    cf_index = lane_cf_index_next[xe::tzcnt(lane_mask)];
+    uint32_t diverged_lane_mask = 0;
+    for (uint32_t lanes = lane_mask; lanes; lanes &= lanes - 1) {
+      uint32_t lane = xe::tzcnt(lanes);
+      if (lane_cf_index_next[lane] != cf_index) {
+        diverged_lane_mask |= UINT32_C(1) << lane;
+      }
+    }
+    lane_mask &= ~diverged_lane_mask;
+    while (diverged_lane_mask) {
+      uint32_t group_cf_index =
+          lane_cf_index_next[xe::tzcnt(diverged_lane_mask)];
+      uint32_t group_lane_mask = 0;
+      for (uint32_t lanes = diverged_lane_mask; lanes; lanes &= lanes - 1) {
+        uint32_t lane = xe::tzcnt(lanes);
+        if (lane_cf_index_next[lane] == group_cf_index) {
+          group_lane_mask |= UINT32_C(1) << lane;
         }
-        ++state_.loop_stack_depth;
-      } break;
+      }
+      diverged_lane_mask &= ~group_lane_mask;
+      ExecuteControlFlow(group_cf_index, group_lane_mask);
+    }
+  }
+}
 
-      case ucode::ControlFlowOpcode::kLoopEnd: {
-        assert_not_zero(state_.loop_stack_depth);
-        if (!state_.loop_stack_depth) {
-          continue;
-        }
-        assert_true(state_.loop_stack_depth <= 4);
-        if (state_.loop_stack_depth > 4) {
-          --state_.loop_stack_depth;
-          continue;
-        }
-        ucode::ControlFlowLoopEndInstruction cf_loop_end =
-            *reinterpret_cast<const ucode::ControlFlowLoopEndInstruction*>(
-                &cf_instr);
-        xenos::LoopConstant loop_constant =
-            state_.loop_constants[state_.loop_stack_depth - 1];
-        assert_zero(
-            std::memcmp(&loop_constant,
-                        &register_file_[XE_GPU_REG_SHADER_CONSTANT_LOOP_00 +
-                                        cf_loop_end.loop_id()],
-                        sizeof(loop_constant)));
-        uint32_t loop_iterator =
-            ++state_.loop_iterators[state_.loop_stack_depth - 1];
-        if (loop_iterator < loop_constant.count &&
-            (!cf_loop_end.is_predicated_break() ||
-             cf_loop_end.condition() != state_.predicate)) {
-          cf_index_next = cf_loop_end.address();
-          continue;
-        }
-        --state_.loop_stack_depth;
-      } break;
+uint32_t ShaderInterpreter::ExecuteControlFlowInstructionLane(
+    ucode::ControlFlowInstruction cf_instr, uint32_t cf_index, uint32_t lane) {
+  State& state = states_[lane];
+  const uint32_t* bool_constants =
+      &register_file_[XE_GPU_REG_SHADER_CONSTANT_BOOL_000_031];
 
-      case ucode::ControlFlowOpcode::kCondCall: {
-        assert_true(state_.call_stack_depth < 4);
-        if (state_.call_stack_depth >= 4) {
-          continue;
-        }
-        const ucode::ControlFlowCondCallInstruction cf_cond_call =
-            *reinterpret_cast<const ucode::ControlFlowCondCallInstruction*>(
-                &cf_instr);
-        if (!cf_cond_call.is_unconditional()) {
-          if (cf_cond_call.is_predicated()) {
-            if (cf_cond_call.condition() != state_.predicate) {
-              continue;
-            }
-          } else {
-            uint32_t bool_address = cf_cond_call.bool_address();
-            if (cf_cond_call.condition() !=
-                ((bool_constants[bool_address >> 5] &
-                  (UINT32_C(1) << (bool_address & 31))) != 0)) {
-              continue;
-            }
+  uint32_t cf_index_next = cf_index + 1;
+  ucode::ControlFlowOpcode cf_opcode = cf_instr.opcode();
+  switch (cf_opcode) {
+    case ucode::ControlFlowOpcode::kNop: {
+    } break;
+
+    case ucode::ControlFlowOpcode::kLoopStart: {
+      ucode::ControlFlowLoopStartInstruction cf_loop_start =
+          *reinterpret_cast<const ucode::ControlFlowLoopStartInstruction*>(
+              &cf_instr);
+      assert_true(state.loop_stack_depth < 4);
+      if (++state.loop_stack_depth > 4) {
+        return cf_loop_start.address();
+      }
+      auto loop_constant = register_file_.Get<xenos::LoopConstant>(
+          XE_GPU_REG_SHADER_CONSTANT_LOOP_00 + cf_loop_start.loop_id());
+      state.loop_constants[state.loop_stack_depth] = loop_constant;
+      uint32_t& loop_iterator_ref =
+          state.loop_iterators[state.loop_stack_depth];
+      if (!cf_loop_start.is_repeat()) {
+        loop_iterator_ref = 0;
+      }
+      if (loop_iterator_ref >= loop_constant.count) {
+        return cf_loop_start.address();
+      }
+      ++state.loop_stack_depth;
+    } break;
+
+    case ucode::ControlFlowOpcode::kLoopEnd: {
+      assert_not_zero(state.loop_stack_depth);
+      if (!state.loop_stack_depth) {
+        break;
+      }
+      assert_true(state.loop_stack_depth <= 4);
+      if (state.loop_stack_depth > 4) {
+        --state.loop_stack_depth;
+        break;
+      }
+      ucode::ControlFlowLoopEndInstruction cf_loop_end =
+          *reinterpret_cast<const ucode::ControlFlowLoopEndInstruction*>(
+              &cf_instr);
+      xenos::LoopConstant loop_constant =
+          state.loop_constants[state.loop_stack_depth - 1];
+      assert_zero(std::memcmp(
+          &loop_constant,
+          &register_file_[XE_GPU_REG_SHADER_CONSTANT_LOOP_00 +
+                          cf_loop_end.loop_id()],
+          sizeof(loop_constant)));
+      uint32_t loop_iterator =
+          ++state.loop_iterators[state.loop_stack_depth - 1];
+      if (loop_iterator < loop_constant.count &&
+          (!cf_loop_end.is_predicated_break() ||
+           cf_loop_end.condition() != state.predicate)) {
+        return cf_loop_end.address();
+      }
+      --state.loop_stack_depth;
+    } break;
+
+    case ucode::ControlFlowOpcode::kCondCall: {
+      assert_true(state.call_stack_depth < 4);
+      if (state.call_stack_depth >= 4) {
+        break;
+      }
+      const ucode::ControlFlowCondCallInstruction cf_cond_call =
+          *reinterpret_cast<const ucode::ControlFlowCondCallInstruction*>(
+              &cf_instr);
+      if (!cf_cond_call.is_unconditional()) {
+        if (cf_cond_call.is_predicated()) {
+          if (cf_cond_call.condition() != state.predicate) {
+            break;
+          }
+        } else {
+          uint32_t bool_address = cf_cond_call.bool_address();
+          if (cf_cond_call.condition() !=
+              ((bool_constants[bool_address >> 5] &
+                (UINT32_C(1) << (bool_address & 31))) != 0)) {
+            break;
           }
         }
-        state_.call_return_addresses[state_.call_stack_depth++] = cf_index + 1;
-        cf_index_next = cf_cond_call.address();
-      } break;
+      }
+      state.call_return_addresses[state.call_stack_depth++] = cf_index + 1;
+      cf_index_next = cf_cond_call.address();
+    } break;
 
-      case ucode::ControlFlowOpcode::kReturn: {
-        // No stack depth assertion - skipping the return is a well-defined
-        // behavior for `return` outside a function call.
-        if (!state_.call_stack_depth) {
-          continue;
-        }
-        cf_index_next = state_.call_return_addresses[--state_.call_stack_depth];
-      } break;
+    case ucode::ControlFlowOpcode::kReturn: {
+      // No stack depth assertion - skipping the return is a well-defined
+      // behavior for `return` outside a function call.
+      if (!state.call_stack_depth) {
+        break;
+      }
+      cf_index_next = state.call_return_addresses[--state.call_stack_depth];
+    } break;
 
-      case ucode::ControlFlowOpcode::kCondJmp: {
-        const ucode::ControlFlowCondJmpInstruction cf_cond_jmp =
-            *reinterpret_cast<const ucode::ControlFlowCondJmpInstruction*>(
-                &cf_instr);
-        if (!cf_cond_jmp.is_unconditional()) {
-          if (cf_cond_jmp.is_predicated()) {
-            if (cf_cond_jmp.condition() != state_.predicate) {
-              continue;
-            }
-          } else {
-            uint32_t bool_address = cf_cond_jmp.bool_address();
-            if (cf_cond_jmp.condition() !=
-                ((bool_constants[bool_address >> 5] &
-                  (UINT32_C(1) << (bool_address & 31))) != 0)) {
-              continue;
-            }
+    case ucode::ControlFlowOpcode::kCondJmp: {
+      const ucode::ControlFlowCondJmpInstruction cf_cond_jmp =
+          *reinterpret_cast<const ucode::ControlFlowCondJmpInstruction*>(
+              &cf_instr);
+      if (!cf_cond_jmp.is_unconditional()) {
+        if (cf_cond_jmp.is_predicated()) {
+          if (cf_cond_jmp.condition() != state.predicate) {
+            break;
+          }
+        } else {
+          uint32_t bool_address = cf_cond_jmp.bool_address();
+          if (cf_cond_jmp.condition() !=
+              ((bool_constants[bool_address >> 5] &
+                (UINT32_C(1) << (bool_address & 31))) != 0)) {
+            break;
           }
         }
-        cf_index_next = cf_cond_jmp.address();
-      } break;
+      }
+      cf_index_next = cf_cond_jmp.address();
+    } break;
 
-      case ucode::ControlFlowOpcode::kAlloc: {
-        if (export_sink_) {
-          const ucode::ControlFlowAllocInstruction& cf_alloc =
-              *reinterpret_cast<const ucode::ControlFlowAllocInstruction*>(
-                  &cf_instr);
-          export_sink_->AllocExport(cf_alloc.alloc_type(), cf_alloc.size());
-        }
-      } break;
+    case ucode::ControlFlowOpcode::kAlloc: {
+      if (export_sink_) {
+        const ucode::ControlFlowAllocInstruction& cf_alloc =
+            *reinterpret_cast<const ucode::ControlFlowAllocInstruction*>(
+                &cf_instr);
+        export_sink_->AllocExport(lane, cf_alloc.alloc_type(), cf_alloc.size());
+      }
+    } break;
 
-      case ucode::ControlFlowOpcode::kMarkVsFetchDone: {
-      } break;
+    case ucode::ControlFlowOpcode::kMarkVsFetchDone: {
+    } break;
 
-      default:
-        assert_unhandled_case(cf_opcode);
+    default:
+      assert_unhandled_case(cf_opcode);
+  }
+  return cf_index_next;
+}
+
+void ShaderInterpreter::ExecuteExec(ucode::ControlFlowExecInstruction cf_exec,
+                                    uint32_t lane_mask) {
+  for (uint32_t exec_index = 0; exec_index < cf_exec.count(); ++exec_index) {
+    const uint32_t* exec_instruction =
+        &ucode_[3 * (cf_exec.address() + exec_index)];
+    if ((cf_exec.sequence() >> (exec_index << 1)) & 0b01) {
+      const ucode::FetchInstruction& fetch_instr =
+          *reinterpret_cast<const ucode::FetchInstruction*>(exec_instruction);
+      uint32_t fetch_lane_mask =
+          fetch_instr.is_predicated()
+              ? GetPredicatedLaneMask(lane_mask,
+                                      fetch_instr.predicate_condition())
+              : lane_mask;
+      for (uint32_t lanes = fetch_lane_mask; lanes; lanes &= lanes - 1) {
+        uint32_t lane = xe::tzcnt(lanes);
+        if (fetch_instr.opcode() == ucode::FetchOpcode::kVertexFetch) {
+          ExecuteVertexFetchInstruction(fetch_instr.vertex_fetch(), lane);
+        } else {
+          // Not supporting texture fetching (very complex).
+          float zero_result[4] = {};
+          StoreFetchResult(lane, fetch_instr.dest(),
+                           fetch_instr.is_dest_relative(),
+                           fetch_instr.dest_swizzle(), zero_result);
+        }
+      }
+    } else {
+      const ucode::AluInstruction& alu_instr =
+          *reinterpret_cast<const ucode::AluInstruction*>(exec_instruction);
+      uint32_t alu_lane_mask =
+          alu_instr.is_predicated()
+              ? GetPredicatedLaneMask(lane_mask,
+                                      alu_instr.predicate_condition())
+              : lane_mask;
+      if (alu_lane_mask) {
+        ExecuteAluInstruction(alu_instr, alu_lane_mask);
+      }
+    }
+  }
+}
+
+uint32_t ShaderInterpreter::GetPredicatedLaneMask(uint32_t lane_mask,
+                                                  bool condition) const {
+  uint32_t predicated_lane_mask = 0;
+  for (uint32_t lanes = lane_mask; lanes; lanes &= lanes - 1) {
+    uint32_t lane = xe::tzcnt(lanes);
+    if (states_[lane].predicate == condition) {
+      predicated_lane_mask |= UINT32_C(1) << lane;
     }
   }
+  return predicated_lane_mask;
 }
 
 const std::array<float, 4> ShaderInterpreter::GetFloatConstant(
-    uint32_t address, bool is_relative, bool relative_address_is_a0) const {
+    uint32_t lane, uint32_t address, bool is_relative,
+    bool relative_address_is_a0) const {
   int32_t index = int32_t(address);
   if (is_relative) {
-    index += relative_address_is_a0 ? state_.address_register
-                                    : state_.GetLoopAddress();
+    const State& state = states_[lane];
+    index += relative_address_is_a0 ? state.address_register
+                                    : state.GetLoopAddress();
   }
   if (index < 0) {
     return std::array<float, 4>();
@@ -277,13 +346,40 @@ const std::array<float, 4> ShaderInterpreter::GetFloatConstant(
   return value;
 }
 
-void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
+void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr,
+                                              uint32_t lane_mask) {
+  // Decode the parts not depending on the lane once for all lanes.
+  AluInstructionInfo info;
+  info.vector_opcode_info =
+      &ucode::GetAluVectorOpcodeInfo(instr.vector_opcode());
+  info.scalar_opcode_info =
+      &ucode::GetAluScalarOpcodeInfo(instr.scalar_opcode());
+  info.vector_result_write_mask = instr.GetVectorOpResultWriteMask();
+  info.scalar_result_write_mask = instr.GetScalarOpResultWriteMask();
+  for (uint32_t i = 0; i < 3; ++i) {
+    uint32_t src_swizzle = instr.src_swizzle(1 + i);
+    for (uint32_t j = 0; j < 4; ++j) {
+      info.src_components[i][j] = uint8_t(
+          ucode::AluInstruction::GetSwizzledComponentIndex(src_swizzle, j));
+    }
+  }
+
+  for (uint32_t lanes = lane_mask; lanes; lanes &= lanes - 1) {
+    ExecuteAluInstructionLane(instr, info, xe::tzcnt(lanes));
+  }
+}
+
+void ShaderInterpreter::ExecuteAluInstructionLane(
+    ucode::AluInstruction instr, const AluInstructionInfo& info,
+    uint32_t lane) {
+  State& state = states_[lane];
+
   // Vector operation.
   float vector_result[4] = {};
   ucode::AluVectorOpcode vector_opcode = instr.vector_opcode();
   const ucode::AluVectorOpcodeInfo& vector_opcode_info =
-      ucode::GetAluVectorOpcodeInfo(vector_opcode);
-  uint32_t vector_result_write_mask = instr.GetVectorOpResultWriteMask();
+      *info.vector_opcode_info;
+  uint32_t vector_result_write_mask = info.vector_result_write_mask;
   if (vector_result_write_mask || vector_opcode_info.changed_state) {
     float vector_operands[3][4];
     for (uint32_t i = 0; i < 3; ++i) {
@@ -296,24 +392,22 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
       std::array<float, 4> vector_src_float_constant;
       if (instr.src_is_temp(1 + i)) {
         vector_src_ptr = GetTempRegister(
-            ucode::AluInstruction::src_temp_reg(vector_src_register),
+            lane, ucode::AluInstruction::src_temp_reg(vector_src_register),
             ucode::AluInstruction::is_src_temp_relative(vector_src_register));
         vector_src_absolute = ucode::AluInstruction::is_src_temp_value_absolute(
             vector_src_register);
       } else {
         vector_src_float_constant = GetFloatConstant(
-            vector_src_register, instr.src_const_is_addressed(1 + i),
+            lane, vector_src_register, instr.src_const_is_addressed(1 + i),
             instr.is_const_address_register_relative());
         vector_src_ptr = vector_src_float_constant.data();
       }
       uint32_t vector_src_absolute_mask =
           ~(uint32_t(vector_src_absolute) << 31);
       uint32_t vector_src_negate_bit = uint32_t(instr.src_negate(1 + i)) << 31;
-      uint32_t vector_src_swizzle = instr.src_swizzle(1 + i);
       for (uint32_t j = 0; j < 4; ++j) {
-        float vector_src_component = FlushDenormal(
-            vector_src_ptr[ucode::AluInstruction::GetSwizzledComponentIndex(
-                vector_src_swizzle, j)]);
+        float vector_src_component =
+            FlushDenormal(vector_src_ptr[info.src_components[i][j]]);
         *reinterpret_cast<uint32_t*>(&vector_src_component) =
             (*reinterpret_cast<const uint32_t*>(&vector_src_component) &
              vector_src_absolute_mask) ^
@@ -512,7 +606,7 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
         replicate_vector_result_x = true;
       } break;
       case ucode::AluVectorOpcode::kSetpEqPush: {
-        state_.predicate =
+        state.predicate =
             vector_operands[0][3] == 0.0f && vector_operands[1][3] == 0.0f;
         vector_result[0] =
             (vector_operands[0][0] == 0.0f && vector_operands[1][0] == 0.0f)
@@ -521,7 +615,7 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
         replicate_vector_result_x = true;
       } break;
       case ucode::AluVectorOpcode::kSetpNePush: {
-        state_.predicate =
+        state.predicate =
             vector_operands[0][3] == 0.0f && vector_operands[1][3] != 0.0f;
         vector_result[0] =
             (vector_operands[0][0] == 0.0f && vector_operands[1][0] != 0.0f)
@@ -530,7 +624,7 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
         replicate_vector_result_x = true;
       } break;
       case ucode::AluVectorOpcode::kSetpGtPush: {
-        state_.predicate = vector_operands[0][3] == 0.0f &&
+        state.predicate = vector_operands[0][3] == 0.0f &&
                            std::isgreater(vector_operands[1][3], 0.0f);
         vector_result[0] = (vector_operands[0][0] == 0.0f &&
                             std::isgreater(vector_operands[1][0], 0.0f))
@@ -539,7 +633,7 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
         replicate_vector_result_x = true;
       } break;
       case ucode::AluVectorOpcode::kSetpGePush: {
-        state_.predicate = vector_operands[0][3] == 0.0f &&
+        state.predicate = vector_operands[0][3] == 0.0f &&
                            std::isgreaterequal(vector_operands[1][3], 0.0f);
         vector_result[0] = (vector_operands[0][0] == 0.0f &&
                             std::isgreaterequal(vector_operands[1][0], 0.0f))
@@ -591,7 +685,7 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
         vector_result[3] = vector_operands[1][3];
       } break;
       case ucode::AluVectorOpcode::kMaxA: {
-        state_.address_register = int32_t(std::floor(
+        state.address_register = int32_t(std::floor(
             xe::clamp_float(vector_operands[0][3], -256.0f, 255.0f) + 0.5f));
         for (uint32_t i = 0; i < 4; ++i) {
           vector_result[i] =
@@ -614,7 +708,7 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
   // Scalar operation.
   ucode::AluScalarOpcode scalar_opcode = instr.scalar_opcode();
   const ucode::AluScalarOpcodeInfo& scalar_opcode_info =
-      ucode::GetAluScalarOpcodeInfo(scalar_opcode);
+      *info.scalar_opcode_info;
   float scalar_operands[2];
   uint32_t scalar_operand_component_count = 0;
   bool scalar_src_absolute = false;
@@ -626,23 +720,21 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
       std::array<float, 4> scalar_src_float_constant;
       if (instr.src_is_temp(3)) {
         scalar_src_ptr = GetTempRegister(
-            ucode::AluInstruction::src_temp_reg(scalar_src_register),
+            lane, ucode::AluInstruction::src_temp_reg(scalar_src_register),
             ucode::AluInstruction::is_src_temp_relative(scalar_src_register));
         scalar_src_absolute = ucode::AluInstruction::is_src_temp_value_absolute(
             scalar_src_register);
       } else {
         scalar_src_float_constant = GetFloatConstant(
-            scalar_src_register, instr.src_const_is_addressed(3),
+            lane, scalar_src_register, instr.src_const_is_addressed(3),
             instr.is_const_address_register_relative());
         scalar_src_ptr = scalar_src_float_constant.data();
       }
-      uint32_t scalar_src_swizzle = instr.src_swizzle(3);
       scalar_operand_component_count =
           scalar_opcode_info.single_operand_is_two_component ? 2 : 1;
       for (uint32_t i = 0; i < scalar_operand_component_count; ++i) {
         scalar_operands[i] =
-            scalar_src_ptr[ucode::AluInstruction::GetSwizzledComponentIndex(
-                scalar_src_swizzle, (3 + i) & 3)];
+            scalar_src_ptr[info.src_components[2][(3 + i) & 3]];
       }
     } break;
     case 2: {
@@ -650,18 +742,16 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
       uint32_t scalar_src_absolute_mask =
           ~(uint32_t(instr.abs_constants()) << 31);
       uint32_t scalar_src_negate_bit = uint32_t(instr.src_negate(3)) << 31;
-      uint32_t scalar_src_swizzle = instr.src_swizzle(3);
       // c#.w.
       scalar_operands[0] =
-          GetFloatConstant(instr.src_reg(3), instr.src_const_is_addressed(3),
+          GetFloatConstant(lane, instr.src_reg(3),
+                           instr.src_const_is_addressed(3),
                            instr.is_const_address_register_relative())
-              [ucode::AluInstruction::GetSwizzledComponentIndex(
-                  scalar_src_swizzle, 3)];
+              [info.src_components[2][3]];
       // r#.x.
       scalar_operands[1] = GetTempRegister(
-          instr.scalar_const_reg_op_src_temp_reg(),
-          false)[ucode::AluInstruction::GetSwizzledComponentIndex(
-          scalar_src_swizzle, 0)];
+          lane, instr.scalar_const_reg_op_src_temp_reg(),
+          false)[info.src_components[2][0]];
     } break;
   }
   if (scalar_operand_component_count) {
@@ -680,136 +770,136 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
     case ucode::AluScalarOpcode::kAdds:
     case ucode::AluScalarOpcode::kAddsc0:
     case ucode::AluScalarOpcode::kAddsc1: {
-      state_.previous_scalar = scalar_operands[0] + scalar_operands[1];
+      state.previous_scalar = scalar_operands[0] + scalar_operands[1];
     } break;
     case ucode::AluScalarOpcode::kAddsPrev: {
-      state_.previous_scalar = scalar_operands[0] + state_.previous_scalar;
+      state.previous_scalar = scalar_operands[0] + state.previous_scalar;
     } break;
     case ucode::AluScalarOpcode::kMuls:
     case ucode::AluScalarOpcode::kMulsc0:
     case ucode::AluScalarOpcode::kMulsc1: {
       // Direct3D 9 behavior (0 or denormal * anything = +0).
-      state_.previous_scalar = (scalar_operands[0] && scalar_operands[1])
+      state.previous_scalar = (scalar_operands[0] && scalar_operands[1])
                                    ? scalar_operands[0] * scalar_operands[1]
                                    : 0.0f;
     } break;
     case ucode::AluScalarOpcode::kMulsPrev: {
       // Direct3D 9 behavior (0 or denormal * anything = +0).
-      state_.previous_scalar = (scalar_operands[0] && state_.previous_scalar)
-                                   ? scalar_operands[0] * state_.previous_scalar
+      state.previous_scalar = (scalar_operands[0] && state.previous_scalar)
+                                   ? scalar_operands[0] * state.previous_scalar
                                    : 0.0f;
     } break;
     case ucode::AluScalarOpcode::kMulsPrev2: {
-      if (state_.previous_scalar == -FLT_MAX ||
-          !std::isfinite(state_.previous_scalar) ||
+      if (state.previous_scalar == -FLT_MAX ||
+          !std::isfinite(state.previous_scalar) ||
           !std::isfinite(scalar_operands[1]) ||
           std::islessequal(scalar_operands[1], 0.0f)) {
-        state_.previous_scalar = -FLT_MAX;
+        state.previous_scalar = -FLT_MAX;
       } else {
         // Direct3D 9 behavior (0 or denormal * anything = +0).
-        state_.previous_scalar =
-            (scalar_operands[0] && state_.previous_scalar)
-                ? scalar_operands[0] * state_.previous_scalar
+        state.previous_scalar =
+            (scalar_operands[0] && state.previous_scalar)
+                ? scalar_operands[0] * state.previous_scalar
                 : 0.0f;
       }
     } break;
     case ucode::AluScalarOpcode::kMaxs: {
-      state_.previous_scalar =
+      state.previous_scalar =
           std::isgreaterequal(scalar_operands[0], scalar_operands[1])
               ? scalar_operands[0]
               : scalar_operands[1];
     } break;
     case ucode::AluScalarOpcode::kMins: {
-      state_.previous_scalar =
+      state.previous_scalar =
           std::isless(scalar_operands[0], scalar_operands[1])
               ? scalar_operands[0]
               : scalar_operands[1];
     } break;
     case ucode::AluScalarOpcode::kSeqs: {
-      state_.previous_scalar = float(scalar_operands[0] == 0.0f);
+      state.previous_scalar = float(scalar_operands[0] == 0.0f);
     } break;
     case ucode::AluScalarOpcode::kSgts: {
-      state_.previous_scalar = float(std::isgreater(scalar_operands[0], 0.0f));
+      state.previous_scalar = float(std::isgreater(scalar_operands[0], 0.0f));
     } break;
     case ucode::AluScalarOpcode::kSges: {
-      state_.previous_scalar =
+      state.previous_scalar =
           float(std::isgreaterequal(scalar_operands[0], 0.0f));
     } break;
     case ucode::AluScalarOpcode::kSnes: {
-      state_.previous_scalar = float(scalar_operands[0] != 0.0f);
+      state.previous_scalar = float(scalar_operands[0] != 0.0f);
     } break;
     case ucode::AluScalarOpcode::kFrcs: {
-      state_.previous_scalar =
+      state.previous_scalar =
           scalar_operands[0] - std::floor(scalar_operands[0]);
     } break;
     case ucode::AluScalarOpcode::kTruncs: {
-      state_.previous_scalar = std::trunc(scalar_operands[0]);
+      state.previous_scalar = std::trunc(scalar_operands[0]);
     } break;
     case ucode::AluScalarOpcode::kFloors: {
-      state_.previous_scalar = std::floor(scalar_operands[0]);
+      state.previous_scalar = std::floor(scalar_operands[0]);
     } break;
     case ucode::AluScalarOpcode::kExp: {
-      state_.previous_scalar = std::exp2(scalar_operands[0]);
+      state.previous_scalar = std::exp2(scalar_operands[0]);
     } break;
     case ucode::AluScalarOpcode::kLogc: {
-      state_.previous_scalar = std::log2(scalar_operands[0]);
-      if (state_.previous_scalar == -INFINITY) {
-        state_.previous_scalar = -FLT_MAX;
+      state.previous_scalar = std::log2(scalar_operands[0]);
+      if (state.previous_scalar == -INFINITY) {
+        state.previous_scalar = -FLT_MAX;
       }
     } break;
     case ucode::AluScalarOpcode::kLog: {
-      state_.previous_scalar = std::log2(scalar_operands[0]);
+      state.previous_scalar = std::log2(scalar_operands[0]);
     } break;
     case ucode::AluScalarOpcode::kRcpc: {
-      state_.previous_scalar = 1.0f / scalar_operands[0];
-      if (state_.previous_scalar == -INFINITY) {
-        state_.previous_scalar = -FLT_MAX;
-      } else if (state_.previous_scalar == INFINITY) {
-        state_.previous_scalar = FLT_MAX;
+      state.previous_scalar = 1.0f / scalar_operands[0];
+      if (state.previous_scalar == -INFINITY) {
+        state.previous_scalar = -FLT_MAX;
+      } else if (state.previous_scalar == INFINITY) {
+        state.previous_scalar = FLT_MAX;
       }
     } break;
     case ucode::AluScalarOpcode::kRcpf: {
-      state_.previous_scalar = 1.0f / scalar_operands[0];
-      if (state_.previous_scalar == -INFINITY) {
-        state_.previous_scalar = -0.0f;
-      } else if (state_.previous_scalar == INFINITY) {
-        state_.previous_scalar = 0.0f;
+      state.previous_scalar = 1.0f / scalar_operands[0];
+      if (state.previous_scalar == -INFINITY) {
+        state.previous_scalar = -0.0f;
+      } else if (state.previous_scalar == INFINITY) {
+        state.previous_scalar = 0.0f;
       }
     } break;
     case ucode::AluScalarOpcode::kRcp: {
-      state_.previous_scalar = 1.0f / scalar_operands[0];
+      state.previous_scalar = 1.0f / scalar_operands[0];
     } break;
     case ucode::AluScalarOpcode::kRsqc: {
-      state_.previous_scalar = 1.0f / std::sqrt(scalar_operands[0]);
-      if (state_.previous_scalar == -INFINITY) {
-        state_.previous_scalar = -FLT_MAX;
-      } else if (state_.previous_scalar == INFINITY) {
-        state_.previous_scalar = FLT_MAX;
+      state.previous_scalar = 1.0f / std::sqrt(scalar_operands[0]);
+      if (state.previous_scalar == -INFINITY) {
+        state.previous_scalar = -FLT_MAX;
+      } else if (state.previous_scalar == INFINITY) {
+        state.previous_scalar = FLT_MAX;
       }
     } break;
     case ucode::AluScalarOpcode::kRsqf: {
-      state_.previous_scalar = 1.0f / std::sqrt(scalar_operands[0]);
-      if (state_.previous_scalar == -INFINITY) {
-        state_.previous_scalar = -0.0f;
-      } else if (state_.previous_scalar == INFINITY) {
-        state_.previous_scalar = 0.0f;
+      state.previous_scalar = 1.0f / std::sqrt(scalar_operands[0]);
+      if (state.previous_scalar == -INFINITY) {
+        state.previous_scalar = -0.0f;
+      } else if (state.previous_scalar == INFINITY) {
+        state.previous_scalar = 0.0f;
       }
     } break;
     case ucode::AluScalarOpcode::kRsq: {
-      state_.previous_scalar = 1.0f / std::sqrt(scalar_operands[0]);
+      state.previous_scalar = 1.0f / std::sqrt(scalar_operands[0]);
     } break;
     case ucode::AluScalarOpcode::kMaxAs: {
-      state_.address_register = int32_t(std::floor(
+      state.address_register = int32_t(std::floor(
           xe::clamp_float(scalar_operands[0], -256.0f, 255.0f) + 0.5f));
-      state_.previous_scalar =
+      state.previous_scalar =
           std::isgreaterequal(scalar_operands[0], scalar_operands[1])
               ? scalar_operands[0]
               : scalar_operands[1];
     } break;
     case ucode::AluScalarOpcode::kMaxAsf: {
-      state_.address_register = int32_t(
+      state.address_register = int32_t(
           std::floor(xe::clamp_float(scalar_operands[0], -256.0f, 255.0f)));
-      state_.previous_scalar =
+      state.previous_scalar =
           std::isgreaterequal(scalar_operands[0], scalar_operands[1])
               ? scalar_operands[0]
               : scalar_operands[1];
@@ -817,73 +907,73 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
     case ucode::AluScalarOpcode::kSubs:
     case ucode::AluScalarOpcode::kSubsc0:
     case ucode::AluScalarOpcode::kSubsc1: {
-      state_.previous_scalar = scalar_operands[0] - scalar_operands[1];
+      state.previous_scalar = scalar_operands[0] - scalar_operands[1];
     } break;
     case ucode::AluScalarOpcode::kSubsPrev: {
-      state_.previous_scalar = scalar_operands[0] - state_.previous_scalar;
+      state.previous_scalar = scalar_operands[0] - state.previous_scalar;
     } break;
     case ucode::AluScalarOpcode::kSetpEq: {
-      state_.predicate = scalar_operands[0] == 0.0f;
-      state_.previous_scalar = float(!state_.predicate);
+      state.predicate = scalar_operands[0] == 0.0f;
+      state.previous_scalar = float(!state.predicate);
     } break;
     case ucode::AluScalarOpcode::kSetpNe: {
-      state_.predicate = scalar_operands[0] != 0.0f;
-      state_.previous_scalar = float(!state_.predicate);
+      state.predicate = scalar_operands[0] != 0.0f;
+      state.previous_scalar = float(!state.predicate);
     } break;
     case ucode::AluScalarOpcode::kSetpGt: {
-      state_.predicate = std::isgreater(scalar_operands[0], 0.0f);
-      state_.previous_scalar = float(!state_.predicate);
+      state.predicate = std::isgreater(scalar_operands[0], 0.0f);
+      state.previous_scalar = float(!state.predicate);
     } break;
     case ucode::AluScalarOpcode::kSetpGe: {
-      state_.predicate = std::isgreaterequal(scalar_operands[0], 0.0f);
-      state_.previous_scalar = float(!state_.predicate);
+      state.predicate = std::isgreaterequal(scalar_operands[0], 0.0f);
+      state.previous_scalar = float(!state.predicate);
     } break;
     case ucode::AluScalarOpcode::kSetpInv: {
-      state_.predicate = scalar_operands[0] == 1.0f;
-      state_.previous_scalar =
-          state_.predicate
+      state.predicate = scalar_operands[0] == 1.0f;
+      state.previous_scalar =
+          state.predicate
               ? 0.0f
               : (scalar_operands[0] == 0.0f ? 1.0f : scalar_operands[0]);
     } break;
     case ucode::AluScalarOpcode::kSetpPop: {
       float new_counter = scalar_operands[0] - 1.0f;
-      state_.predicate = std::islessequal(new_counter, 0.0f);
-      state_.previous_scalar = state_.predicate ? 0.0f : new_counter;
+      state.predicate = std::islessequal(new_counter, 0.0f);
+      state.previous_scalar = state.predicate ? 0.0f : new_counter;
     } break;
     case ucode::AluScalarOpcode::kSetpClr: {
-      state_.predicate = false;
-      state_.previous_scalar = FLT_MAX;
+      state.predicate = false;
+      state.previous_scalar = FLT_MAX;
     } break;
     case ucode::AluScalarOpcode::kSetpRstr: {
-      state_.predicate = scalar_operands[0] == 0.0f;
-      state_.previous_scalar = state_.predicate ? 0.0f : scalar_operands[0];
+      state.predicate = scalar_operands[0] == 0.0f;
+      state.previous_scalar = state.predicate ? 0.0f : scalar_operands[0];
     } break;
     // Not implementing pixel kill currently, the interpreter is currently used
     // only for vertex shaders.
     case ucode::AluScalarOpcode::kKillsEq: {
-      state_.previous_scalar = float(scalar_operands[0] == 0.0f);
+      state.previous_scalar = float(scalar_operands[0] == 0.0f);
     } break;
     case ucode::AluScalarOpcode::kKillsGt: {
-      state_.previous_scalar = float(std::isgreater(scalar_operands[0], 0.0f));
+      state.previous_scalar = float(std::isgreater(scalar_operands[0], 0.0f));
     } break;
     case ucode::AluScalarOpcode::kKillsGe: {
-      state_.previous_scalar =
+      state.previous_scalar =
           float(std::isgreaterequal(scalar_operands[0], 0.0f));
     } break;
     case ucode::AluScalarOpcode::kKillsNe: {
-      state_.previous_scalar = float(scalar_operands[0] != 0.0f);
+      state.previous_scalar = float(scalar_operands[0] != 0.0f);
     } break;
     case ucode::AluScalarOpcode::kKillsOne: {
-      state_.previous_scalar = float(scalar_operands[0] == 1.0f);
+      state.previous_scalar = float(scalar_operands[0] == 1.0f);
     } break;
     case ucode::AluScalarOpcode::kSqrt: {
-      state_.previous_scalar = std::sqrt(scalar_operands[0]);
+      state.previous_scalar = std::sqrt(scalar_operands[0]);
     } break;
     case ucode::AluScalarOpcode::kSin: {
-      state_.previous_scalar = std::sin(scalar_operands[0]);
+      state.previous_scalar = std::sin(scalar_operands[0]);
     } break;
     case ucode::AluScalarOpcode::kCos: {
-      state_.previous_scalar = std::cos(scalar_operands[0]);
+      state.previous_scalar = std::cos(scalar_operands[0]);
     } break;
     case ucode::AluScalarOpcode::kRetainPrev: {
     } break;
@@ -898,10 +988,10 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
     }
   }
   float scalar_result = instr.scalar_clamp()
-                            ? xe::saturate(state_.previous_scalar)
-                            : state_.previous_scalar;
+                            ? xe::saturate(state.previous_scalar)
+                            : state.previous_scalar;
 
-  uint32_t scalar_result_write_mask = instr.GetScalarOpResultWriteMask();
+  uint32_t scalar_result_write_mask = info.scalar_result_write_mask;
   if (instr.is_export()) {
     if (export_sink_) {
       float export_value[4];
@@ -924,14 +1014,14 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
         export_value[i] = export_component;
       }
       export_sink_->Export(
-          ucode::ExportRegister(instr.vector_dest()), export_value,
+          lane, ucode::ExportRegister(instr.vector_dest()), export_value,
           vector_result_write_mask | scalar_result_write_mask |
               instr.GetConstant0WriteMask() | export_constant_1_mask);
     }
   } else {
     if (vector_result_write_mask) {
-      float* vector_dest =
-          GetTempRegister(instr.vector_dest(), instr.is_vector_dest_relative());
+      float* vector_dest = GetTempRegister(lane, instr.vector_dest(),
+                                           instr.is_vector_dest_relative());
       for (uint32_t i = 0; i < 4; ++i) {
         if (vector_result_write_mask & (UINT32_C(1) << i)) {
           vector_dest[i] = vector_result[i];
@@ -939,8 +1029,8 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
       }
     }
     if (scalar_result_write_mask) {
-      float* scalar_dest =
-          GetTempRegister(instr.scalar_dest(), instr.is_scalar_dest_relative());
+      float* scalar_dest = GetTempRegister(lane, instr.scalar_dest(),
+                                           instr.is_scalar_dest_relative());
       for (uint32_t i = 0; i < 4; ++i) {
         if (scalar_result_write_mask & (UINT32_C(1) << i)) {
           scalar_dest[i] = scalar_result;
@@ -950,9 +1040,10 @@ void ShaderInterpreter::ExecuteAluInstruction(ucode::AluInstruction instr) {
   }
 }
 
-void ShaderInterpreter::StoreFetchResult(uint32_t dest, bool is_dest_relative,
+void ShaderInterpreter::StoreFetchResult(uint32_t lane, uint32_t dest,
+                                         bool is_dest_relative,
                                          uint32_t swizzle, const float* value) {
-  float* dest_data = GetTempRegister(dest, is_dest_relative);
+  float* dest_data = GetTempRegister(lane, dest, is_dest_relative);
   for (uint32_t i = 0; i < 4; ++i) {
     ucode::FetchDestinationSwizzle component_swizzle =
         ucode::GetFetchDestinationComponentSwizzle(swizzle, i);
@@ -985,25 +1076,27 @@ void ShaderInterpreter::StoreFetchResult(uint32_t dest, bool is_dest_relative,
 }
 
 void ShaderInterpreter::ExecuteVertexFetchInstruction(
-    ucode::VertexFetchInstruction instr) {
+    ucode::VertexFetchInstruction instr, uint32_t lane) {
+  State& state = states_[lane];
+
   // FIXME(Triang3l): Bit scan loops over components cause a link-time
   // optimization internal error in Visual Studio 2019, mainly in the format
   // unpacking. Using loops with up to 4 iterations here instead.
 
   if (!instr.is_mini_fetch()) {
-    state_.vfetch_full_last = instr;
+    state.vfetch_full_last = instr;
   }
 
   xenos::xe_gpu_vertex_fetch_t fetch_constant = register_file_.GetVertexFetch(
-      state_.vfetch_full_last.fetch_constant_index());
+      state.vfetch_full_last.fetch_constant_index());
 
   if (!instr.is_mini_fetch()) {
     // Get the part of the address that depends on vfetch_full data.
     uint32_t vertex_index = uint32_t(std::floor(
-        GetTempRegister(instr.src(),
+        GetTempRegister(lane, instr.src(),
                         instr.is_src_relative())[instr.src_swizzle()] +
         (instr.is_index_rounded() ? 0.5f : 0.0f)));
-    state_.vfetch_address_dwords =
+    state.vfetch_address_dwords =
         instr.stride() * vertex_index + fetch_constant.address;
   }
 
@@ -1025,7 +1118,7 @@ void ShaderInterpreter::ExecuteVertexFetchInstruction(
         reinterpret_cast<const uint32_t*>(memory_.physical_membase());
     uint32_t buffer_end_dwords = fetch_constant.address + fetch_constant.size;
     uint32_t dword_0_address_dwords =
-        uint32_t(int32_t(state_.vfetch_address_dwords) + instr.offset());
+        uint32_t(int32_t(state.vfetch_address_dwords) + instr.offset());
     for (uint32_t i = 0; i < 4; ++i) {
       if (!(needed_dwords & (UINT32_C(1) << i))) {
         continue;
@@ -1215,8 +1308,8 @@ void ShaderInterpreter::ExecuteVertexFetchInstruction(
     }
   }
 
-  StoreFetchResult(instr.dest(), instr.is_dest_relative(), instr.dest_swizzle(),
-                   result);
+  StoreFetchResult(lane, instr.dest(), instr.is_dest_relative(),
+                   instr.dest_swizzle(), result);
 }
 
 }  // namespace gpu
@@ -25,14 +25,19 @@ namespace gpu {
 
 class ShaderInterpreter {
  public:
+  // Maximum number of invocations executed together by ExecuteLanes, with the
+  // instructions decoded once for all of them.
+  static constexpr uint32_t kMaxLanes = 8;
+
   ShaderInterpreter(const RegisterFile& register_file, const Memory& memory)
       : register_file_(register_file), memory_(memory) {}
 
   class ExportSink {
    public:
     virtual ~ExportSink() = default;
-    virtual void AllocExport(ucode::AllocType type, uint32_t size) {}
-    virtual void Export(ucode::ExportRegister export_register,
+    virtual void AllocExport(uint32_t lane, ucode::AllocType type,
+                             uint32_t size) {}
+    virtual void Export(uint32_t lane, ucode::ExportRegister export_register,
                         const float* value, uint32_t value_mask) {}
   };
 
@@ -45,8 +50,12 @@ class ShaderInterpreter {
     export_sink_ = new_export_sink;
   }
 
-  const float* temp_registers() const { return &temp_registers_[0][0]; }
-  float* temp_registers() { return &temp_registers_[0][0]; }
+  const float* temp_registers(uint32_t lane = 0) const {
+    return &temp_registers_[lane][0][0];
+  }
+  float* temp_registers(uint32_t lane = 0) {
+    return &temp_registers_[lane][0][0];
+  }
 
   static bool CanInterpretShader(const Shader& shader) {
     assert_true(shader.is_ucode_analyzed());
@@ -67,7 +76,12 @@ class ShaderInterpreter {
     SetShader(shader.type(), shader.ucode_dwords());
   }
 
-  void Execute();
+  void Execute() { ExecuteLanes(1); }
+  // Executes the shader for lanes 0 to lane_count - 1, each with its own
+  // temporary registers and state, giving the same results as executing them
+  // one by one. Lanes are kept together as long as their control flow doesn't
+  // diverge.
+  void ExecuteLanes(uint32_t lane_count);
 
  private:
   struct State {
@@ -108,23 +122,52 @@ class ShaderInterpreter {
     return *reinterpret_cast<const float*>(&bits);
   }
 
-  uint32_t GetTempRegisterIndex(uint32_t address, bool is_relative) const {
-    return (int32_t(address) + (is_relative ? state_.GetLoopAddress() : 0)) &
+  // Parts of an ALU instruction that are the same for all lanes.
+  struct AluInstructionInfo {
+    const ucode::AluVectorOpcodeInfo* vector_opcode_info;
+    const ucode::AluScalarOpcodeInfo* scalar_opcode_info;
+    uint32_t vector_result_write_mask;
+    uint32_t scalar_result_write_mask;
+    // Source component indices after swizzling.
+    uint8_t src_components[3][4];
+  };
+
+  uint32_t GetTempRegisterIndex(uint32_t lane, uint32_t address,
+                                bool is_relative) const {
+    return (int32_t(address) +
+            (is_relative ? states_[lane].GetLoopAddress() : 0)) &
            ((UINT32_C(1) << xenos::kMaxShaderTempRegistersLog2) - 1);
   }
-  const float* GetTempRegister(uint32_t address, bool is_relative) const {
-    return temp_registers_[GetTempRegisterIndex(address, is_relative)];
+  const float* GetTempRegister(uint32_t lane, uint32_t address,
+                               bool is_relative) const {
+    return temp_registers_[lane][GetTempRegisterIndex(lane, address,
+                                                      is_relative)];
   }
-  float* GetTempRegister(uint32_t address, bool is_relative) {
-    return temp_registers_[GetTempRegisterIndex(address, is_relative)];
+  float* GetTempRegister(uint32_t lane, uint32_t address, bool is_relative) {
+    return temp_registers_[lane][GetTempRegisterIndex(lane, address,
+                                                      is_relative)];
   }
   const std::array<float, 4> GetFloatConstant(
-      uint32_t address, bool is_relative, bool relative_address_is_a0) const;
-
-  void ExecuteAluInstruction(ucode::AluInstruction instr);
-  void StoreFetchResult(uint32_t dest, bool is_dest_relative, uint32_t swizzle,
-                        const float* value);
-  void ExecuteVertexFetchInstruction(ucode::VertexFetchInstruction instr);
+      uint32_t lane, uint32_t address, bool is_relative,
+      bool relative_address_is_a0) const;
+  uint32_t GetPredicatedLaneMask(uint32_t lane_mask, bool condition) const;
+
+  void ExecuteControlFlow(uint32_t cf_index, uint32_t lane_mask);
+  // For non-exec control flow instructions, returns the index of the next
+  // control flow instruction for the lane.
+  uint32_t ExecuteControlFlowInstructionLane(
+      ucode::ControlFlowInstruction cf_instr, uint32_t cf_index,
+      uint32_t lane);
+  void ExecuteExec(ucode::ControlFlowExecInstruction cf_exec,
+                   uint32_t lane_mask);
+  void ExecuteAluInstruction(ucode::AluInstruction instr, uint32_t lane_mask);
+  void ExecuteAluInstructionLane(ucode::AluInstruction instr,
+                                 const AluInstructionInfo& info,
+                                 uint32_t lane);
+  void StoreFetchResult(uint32_t lane, uint32_t dest, bool is_dest_relative,
+                        uint32_t swizzle, const float* value);
+  void ExecuteVertexFetchInstruction(ucode::VertexFetchInstruction instr,
+                                     uint32_t lane);
 
   const RegisterFile& register_file_;
   const Memory& memory_;
@@ -137,9 +180,9 @@ class ShaderInterpreter {
   const uint32_t* ucode_ = nullptr;
 
   // For both inputs and locals.
-  float temp_registers_[xenos::kMaxShaderTempRegisters][4];
+  float temp_registers_[kMaxLanes][xenos::kMaxShaderTempRegisters][4];
 
-  State state_;
+  State states_[kMaxLanes];
 };
 
 }  // namespace gpu
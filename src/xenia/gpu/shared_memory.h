@@ -24,6 +24,9 @@ class SharedMemory {
   static constexpr uint32_t kBufferSize = 1 << kBufferSizeLog2;
 
   virtual ~SharedMemory();
+
+  Memory& memory() const { return memory_; }
+
   // Call in the implementation-specific ClearCache.
   virtual void ClearCache();
   virtual void SetSystemPageBlocksValidWithGpuDataWritten();
@@ -117,8 +120,6 @@ class SharedMemory {
   static constexpr uint32_t kHostGpuMemoryOptimalSparseAllocationLog2 = 22;
   static_assert(kHostGpuMemoryOptimalSparseAllocationLog2 <= kBufferSizeLog2);
 
-  Memory& memory() const { return memory_; }
-
   uint32_t page_size_log2() const { return page_size_log2_; }
 
   uint32_t host_gpu_memory_sparse_granularity_log2() const {
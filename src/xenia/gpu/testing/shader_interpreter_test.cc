@@ -0,0 +1,292 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/gpu/shader_interpreter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "xenia/base/math.h"
+#include "xenia/gpu/register_file.h"
+#include "xenia/gpu/registers.h"
+#include "xenia/gpu/ucode.h"
+#include "xenia/gpu/xenos.h"
+#include "xenia/memory.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe::gpu::test {
+
+namespace {
+
+struct RecordedExport {
+  uint32_t export_register;
+  uint32_t value[4];
+  uint32_t value_mask;
+
+  bool operator==(const RecordedExport& other) const {
+    return export_register == other.export_register &&
+           !std::memcmp(value, other.value, sizeof(value)) &&
+           value_mask == other.value_mask;
+  }
+};
+
+class RecordingExportSink : public ShaderInterpreter::ExportSink {
+ public:
+  void Export(uint32_t lane, ucode::ExportRegister export_register,
+              const float* value, uint32_t value_mask) override {
+    RecordedExport recorded_export;
+    recorded_export.export_register = uint32_t(export_register);
+    std::memcpy(recorded_export.value, value, sizeof(recorded_export.value));
+    recorded_export.value_mask = value_mask;
+    exports[lane].push_back(recorded_export);
+  }
+
+  std::vector<RecordedExport> exports[ShaderInterpreter::kMaxLanes];
+};
+
+// Control flow instructions, as (dword_0, 16-bit dword_1).
+struct ControlFlow {
+  uint32_t dword_0;
+  uint32_t dword_1;
+};
+
+ControlFlow Exec(ucode::ControlFlowOpcode opcode, uint32_t address,
+                 uint32_t count, uint32_t sequence) {
+  return {address | (count << 12) | (sequence << 16),
+          uint32_t(opcode) << 12};
+}
+
+ControlFlow CondExecPred(bool end, uint32_t address, uint32_t count,
+                         bool condition) {
+  ucode::ControlFlowOpcode opcode =
+      end ? ucode::ControlFlowOpcode::kCondExecPredEnd
+          : ucode::ControlFlowOpcode::kCondExecPred;
+  return {address | (count << 12),
+          (uint32_t(condition) << 10) | (uint32_t(opcode) << 12)};
+}
+
+ControlFlow PredicatedJump(uint32_t address, bool condition) {
+  return {address | (1 << 14),
+          (uint32_t(condition) << 10) |
+              (uint32_t(ucode::ControlFlowOpcode::kCondJmp) << 12)};
+}
+
+// Swizzles are relative to the component, 0 for xyzw.
+struct AluSource {
+  bool is_temp;
+  uint32_t reg;
+  uint32_t swizzle;
+};
+
+void EncodeAlu(uint32_t* dwords, ucode::AluVectorOpcode vector_opcode,
+               ucode::AluScalarOpcode scalar_opcode, uint32_t vector_dest,
+               uint32_t vector_write_mask, bool is_export,
+               const AluSource& src1, const AluSource& src2,
+               const AluSource& src3, bool const_a0_relative = false) {
+  dwords[0] = vector_dest | (uint32_t(is_export) << 15) |
+              (vector_write_mask << 16) | (uint32_t(scalar_opcode) << 26);
+  dwords[1] = src3.swizzle | (src2.swizzle << 8) | (src1.swizzle << 16) |
+              (uint32_t(const_a0_relative) << 29) |
+              (uint32_t(const_a0_relative) << 30) |
+              (uint32_t(const_a0_relative) << 31);
+  dwords[2] = src3.reg | (src2.reg << 8) | (src1.reg << 16) |
+              (uint32_t(vector_opcode) << 24) | (uint32_t(src3.is_temp) << 29) |
+              (uint32_t(src2.is_temp) << 30) | (uint32_t(src1.is_temp) << 31);
+}
+
+constexpr uint32_t kVertexBufferAddress = 0x10000;
+constexpr uint32_t kVertexCount = 37;
+
+std::vector<uint32_t> BuildShader() {
+  // Exec addresses are in instructions from the beginning of the shader, the
+  // control flow takes the first 3.
+  constexpr uint32_t kFirstInstruction = 3;
+  // 0: exec (vfetch, predicate and a0 setup)
+  // 1: (p0) jmp 4
+  // 2: exec (non-positive Y path, with an a0-relative constant)
+  // 3: (!p0) exece (export for the non-positive Y path)
+  // 4: exece (export for the positive Y path)
+  const ControlFlow control_flow[] = {
+      Exec(ucode::ControlFlowOpcode::kExec, kFirstInstruction, 3, 0b000001),
+      PredicatedJump(4, true),
+      Exec(ucode::ControlFlowOpcode::kExec, kFirstInstruction + 3, 1, 0),
+      CondExecPred(true, kFirstInstruction + 4, 1, false),
+      Exec(ucode::ControlFlowOpcode::kExecEnd, kFirstInstruction + 5, 1, 0),
+  };
+  constexpr uint32_t kInstructionCount = 6;
+  std::vector<uint32_t> ucode(3 * (kFirstInstruction + kInstructionCount));
+  for (uint32_t i = 0; i < xe::countof(control_flow); ++i) {
+    uint32_t* pair = &ucode[3 * (i >> 1)];
+    if (i & 1) {
+      pair[1] |= control_flow[i].dword_0 << 16;
+      pair[2] = (control_flow[i].dword_0 >> 16) |
+                (control_flow[i].dword_1 << 16);
+    } else {
+      pair[0] = control_flow[i].dword_0;
+      pair[1] = control_flow[i].dword_1;
+    }
+  }
+  uint32_t* instructions = &ucode[3 * kFirstInstruction];
+
+  // vfetch r1.xyz1, r0.x, vf0 (float3, 3 dwords stride).
+  instructions[0] = uint32_t(ucode::FetchOpcode::kVertexFetch) | (1 << 12) |
+                    (1 << 19);
+  instructions[1] = 0 | (1 << 3) | (2 << 6) |
+                    (uint32_t(ucode::FetchDestinationSwizzle::k1) << 9) |
+                    (1 << 13) |
+                    (uint32_t(xenos::VertexFormat::k_32_32_32_FLOAT) << 16);
+  instructions[2] = 3;
+
+  // r2 = r1 * c0, p0 = r1.y > 0.
+  EncodeAlu(&instructions[3], ucode::AluVectorOpcode::kMul,
+            ucode::AluScalarOpcode::kSetpGt, 2, 0b1111, false, {true, 1, 0},
+            {false, 0, 0}, {true, 1, 2 << 6});
+  // a0 = floor(r1.x + 0.5) (clamped).
+  EncodeAlu(&instructions[6], ucode::AluVectorOpcode::kAdd,
+            ucode::AluScalarOpcode::kMaxAs, 0, 0b0000, false, {true, 1, 0},
+            {true, 1, 0}, {true, 1, 1 << 6});
+
+  // r2 = r2 + c[1 + a0].
+  EncodeAlu(&instructions[9], ucode::AluVectorOpcode::kAdd,
+            ucode::AluScalarOpcode::kRetainPrev, 2, 0b1111, false,
+            {true, 2, 0}, {false, 1, 0}, {true, 0, 0}, true);
+
+  // oPos = r2 * c5 on the non-positive path, max(r2, r2) on the positive one.
+  EncodeAlu(&instructions[12], ucode::AluVectorOpcode::kMul,
+            ucode::AluScalarOpcode::kRetainPrev, 62, 0b1111, true,
+            {true, 2, 0}, {false, 5, 0}, {true, 0, 0});
+  EncodeAlu(&instructions[15], ucode::AluVectorOpcode::kMax,
+            ucode::AluScalarOpcode::kRetainPrev, 62, 0b1111, true,
+            {true, 2, 0}, {true, 2, 0}, {true, 0, 0});
+
+  return ucode;
+}
+
+void SetUpRegisters(RegisterFile& regs) {
+  auto sq_vs_const = regs.Get<reg::SQ_VS_CONST>();
+  sq_vs_const.base = 0;
+  sq_vs_const.size = 255;
+  regs[XE_GPU_REG_SQ_VS_CONST] = sq_vs_const.value;
+
+  const float constants[][4] = {
+      {2.0f, -3.0f, 0.5f, 1.0f},   {1.0f, 2.0f, 3.0f, 4.0f},
+      {-1.0f, 0.25f, 8.0f, 0.0f},  {16.0f, -16.0f, 0.0f, 2.0f},
+      {0.0f, 1e-40f, -0.0f, 1.5f}, {0.5f, 0.5f, 0.5f, 2.0f},
+  };
+  std::memcpy(&regs[XE_GPU_REG_SHADER_CONSTANT_000_X], constants,
+              sizeof(constants));
+
+  xenos::xe_gpu_vertex_fetch_t fetch = {};
+  fetch.type = xenos::FetchConstantType::kVertex;
+  fetch.address = kVertexBufferAddress >> 2;
+  fetch.endian = xenos::Endian::kNone;
+  fetch.size = 3 * kVertexCount;
+  std::memcpy(&regs[XE_GPU_REG_SHADER_CONSTANT_FETCH_00_0], &fetch,
+              sizeof(fetch));
+}
+
+void FillVertexBuffer(Memory& memory) {
+  float* vertices = memory.TranslatePhysical<float*>(kVertexBufferAddress);
+  for (uint32_t i = 0; i < kVertexCount; ++i) {
+    vertices[3 * i] = float(i % 5) - 0.6f;
+    // Alternate between the two control flow paths, with some zeros.
+    vertices[3 * i + 1] = (i % 3) ? float(i) * 0.75f : -float(i) * 1.25f;
+    vertices[3 * i + 2] = float(i) * 0.125f;
+  }
+}
+
+// oPos of every vertex, worked out from the shader and the inputs - positive Y
+// exports r1 * c0, other vertices (every third) export (r1 * c0 + c[1 + a0]) *
+// c5.
+const float kExpectedPositions[kVertexCount][4] = {
+    {0.39999998f, -1.5f, 0.25f, 4.0f},  // 0
+    {0.79999995f, -2.25f, 0.0625f, 1.0f},  // 1
+    {2.8f, -4.5f, 0.125f, 1.0f},  // 2
+    {10.4f, -2.375f, 0.09375f, 6.0f},  // 3
+    {6.8f, -9.0f, 0.25f, 1.0f},  // 4
+    {-1.2f, -11.25f, 0.3125f, 1.0f},  // 5
+    {0.9f, 12.25f, 1.6875f, 10.0f},  // 6
+    {2.8f, -15.75f, 0.4375f, 1.0f},  // 7
+    {4.8f, -18.0f, 0.5f, 1.0f},  // 8
+    {3.4f, 16.875f, 0.28125f, 5.0f},  // 9
+    {-1.2f, -22.5f, 0.625f, 1.0f},  // 10
+    {0.79999995f, -24.75f, 0.6875f, 1.0f},  // 11
+    {0.9f, 22.625f, 4.375f, 2.0f},  // 12
+    {4.8f, -29.25f, 0.8125f, 1.0f},  // 13
+    {6.8f, -31.5f, 0.875f, 1.0f},  // 14
+    {0.39999998f, 26.625f, 0.71875f, 4.0f},  // 15
+    {0.79999995f, -36.0f, 1.0f, 1.0f},  // 16
+    {2.8f, -38.25f, 1.0625f, 1.0f},  // 17
+    {10.4f, 25.75f, 0.5625f, 6.0f},  // 18
+    {6.8f, -42.75f, 1.1875f, 1.0f},  // 19
+    {-1.2f, -45.0f, 1.25f, 1.0f},  // 20
+    {0.9f, 40.375f, 2.15625f, 10.0f},  // 21
+    {2.8f, -49.5f, 1.375f, 1.0f},  // 22
+    {4.8f, -51.75f, 1.4375f, 1.0f},  // 23
+    {3.4f, 45.0f, 0.75f, 5.0f},  // 24
+    {-1.2f, -56.25f, 1.5625f, 1.0f},  // 25
+    {0.79999995f, -58.5f, 1.625f, 1.0f},  // 26
+    {0.9f, 50.75f, 4.84375f, 2.0f},  // 27
+    {4.8f, -63.0f, 1.75f, 1.0f},  // 28
+    {6.8f, -65.25f, 1.8125f, 1.0f},  // 29
+    {0.39999998f, 54.75f, 1.1875f, 4.0f},  // 30
+    {0.79999995f, -69.75f, 1.9375f, 1.0f},  // 31
+    {2.8f, -72.0f, 2.0f, 1.0f},  // 32
+    {10.4f, 53.875f, 1.03125f, 6.0f},  // 33
+    {6.8f, -76.5f, 2.125f, 1.0f},  // 34
+    {-1.2f, -78.75f, 2.1875f, 1.0f},  // 35
+    {0.9f, 68.5f, 2.625f, 10.0f},  // 36
+};
+
+}  // namespace
+
+TEST_CASE("Shader interpreter lanes produce the expected exports",
+          "[shader_interpreter]") {
+  auto memory = std::make_unique<Memory>();
+  REQUIRE(memory->Initialize());
+  FillVertexBuffer(*memory);
+  auto regs = std::make_unique<RegisterFile>();
+  SetUpRegisters(*regs);
+  std::vector<uint32_t> ucode = BuildShader();
+
+  std::vector<RecordedExport> expected_exports(kVertexCount);
+  for (uint32_t i = 0; i < kVertexCount; ++i) {
+    RecordedExport& expected_export = expected_exports[i];
+    expected_export.export_register =
+        uint32_t(ucode::ExportRegister::kVSPosition);
+    std::memcpy(expected_export.value, kExpectedPositions[i],
+                sizeof(expected_export.value));
+    expected_export.value_mask = 0b1111;
+  }
+
+  // Different lane counts to cover partial batches.
+  for (uint32_t lane_count = 1; lane_count <= ShaderInterpreter::kMaxLanes;
+       ++lane_count) {
+    ShaderInterpreter interpreter(*regs, *memory);
+    interpreter.SetShader(xenos::ShaderType::kVertex, ucode.data());
+    for (uint32_t first = 0; first < kVertexCount; first += lane_count) {
+      uint32_t batch_size = std::min(lane_count, kVertexCount - first);
+      RecordingExportSink sink;
+      interpreter.SetExportSink(&sink);
+      for (uint32_t lane = 0; lane < batch_size; ++lane) {
+        interpreter.temp_registers(lane)[0] = float(first + lane);
+      }
+      interpreter.ExecuteLanes(batch_size);
+      for (uint32_t lane = 0; lane < batch_size; ++lane) {
+        REQUIRE(sink.exports[lane].size() == 1);
+        REQUIRE(sink.exports[lane][0] == expected_exports[first + lane]);
+      }
+    }
+  }
+}
+
+}  // namespace xe::gpu::test
@@ -0,0 +1,142 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/gpu/texture_conversion.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "xenia/gpu/texture_info.h"
+#include "xenia/gpu/xenos.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe::gpu::test {
+
+namespace {
+
+// Formats with 1, 2, 4, 8 and 16 bytes per block.
+const xenos::TextureFormat kFormats[] = {
+    xenos::TextureFormat::k_8,
+    xenos::TextureFormat::k_8_8,
+    xenos::TextureFormat::k_8_8_8_8,
+    xenos::TextureFormat::k_16_16_16_16,
+    xenos::TextureFormat::k_32_32_32_32_FLOAT,
+};
+
+const xenos::Endian kEndians[] = {
+    xenos::Endian::kNone,
+    xenos::Endian::k8in16,
+    xenos::Endian::k8in32,
+    xenos::Endian::k16in32,
+};
+
+// Input covering a tiled surface with the given pitch in blocks (aligned to 32)
+// and height, with unique bytes.
+std::vector<uint8_t> CreateTiledInput(uint32_t pitch, uint32_t height,
+                                      uint32_t bytes_per_block) {
+  std::vector<uint8_t> input(size_t(pitch) * xe::align(height, UINT32_C(32)) *
+                             bytes_per_block);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = uint8_t(i * 7 + (i >> 8));
+  }
+  return input;
+}
+
+}  // namespace
+
+TEST_CASE("Specialized untiling matches the generic loop",
+          "[texture_conversion]") {
+  struct Region {
+    uint32_t offset_x;
+    uint32_t offset_y;
+    uint32_t width;
+    uint32_t height;
+  };
+  const Region kRegions[] = {
+      {0, 0, 64, 32}, {0, 0, 13, 7}, {3, 5, 41, 19}, {17, 1, 1, 3},
+      {8, 32, 40, 9},
+  };
+  constexpr uint32_t kPitch = 96;
+  constexpr uint32_t kSurfaceHeight = 64;
+  for (xenos::TextureFormat format : kFormats) {
+    const FormatInfo* format_info = FormatInfo::Get(format);
+    uint32_t bytes_per_block = format_info->bytes_per_block();
+    std::vector<uint8_t> input =
+        CreateTiledInput(kPitch, kSurfaceHeight, bytes_per_block);
+    for (xenos::Endian endian : kEndians) {
+      for (const Region& region : kRegions) {
+        texture_conversion::UntileInfo untile_info = {};
+        untile_info.offset_x = region.offset_x;
+        untile_info.offset_y = region.offset_y;
+        untile_info.width = region.width;
+        untile_info.height = region.height;
+        untile_info.input_pitch = kPitch;
+        // Padding in the output rows, which must not be written.
+        untile_info.output_pitch = region.width + 3;
+        untile_info.input_format_info = format_info;
+        untile_info.output_format_info = format_info;
+        untile_info.endian = endian;
+        size_t output_size =
+            size_t(untile_info.output_pitch) * region.height * bytes_per_block;
+        std::vector<uint8_t> expected(output_size, 0xCD);
+        std::vector<uint8_t> actual(output_size, 0xCD);
+        texture_conversion::UntileGeneric(expected.data(), input.data(),
+                                          &untile_info);
+        texture_conversion::Untile(actual.data(), input.data(), &untile_info);
+        INFO("Bytes per block: " << bytes_per_block
+                                 << ", endian: " << uint32_t(endian)
+                                 << ", offset: " << region.offset_x << ", "
+                                 << region.offset_y);
+        REQUIRE(actual == expected);
+      }
+    }
+  }
+}
+
+TEST_CASE("Untiling throughput", "[.benchmark][texture_conversion]") {
+  constexpr uint32_t kWidth = 1280;
+  constexpr uint32_t kHeight = 720;
+  constexpr uint32_t kIterations = 20;
+  for (xenos::TextureFormat format : kFormats) {
+    const FormatInfo* format_info = FormatInfo::Get(format);
+    uint32_t bytes_per_block = format_info->bytes_per_block();
+    std::vector<uint8_t> input =
+        CreateTiledInput(kWidth, kHeight, bytes_per_block);
+    std::vector<uint8_t> output(size_t(kWidth) * kHeight * bytes_per_block);
+    texture_conversion::UntileInfo untile_info = {};
+    untile_info.width = kWidth;
+    untile_info.height = kHeight;
+    untile_info.input_pitch = kWidth;
+    untile_info.output_pitch = kWidth;
+    untile_info.input_format_info = format_info;
+    untile_info.output_format_info = format_info;
+    untile_info.endian = bytes_per_block >= 4 ? xenos::Endian::k8in32
+                         : bytes_per_block >= 2 ? xenos::Endian::k8in16
+                                                : xenos::Endian::kNone;
+    auto measure = [&](auto untile) {
+      auto start = std::chrono::steady_clock::now();
+      for (uint32_t i = 0; i < kIterations; ++i) {
+        untile(output.data(), input.data(), &untile_info);
+      }
+      std::chrono::duration<double> seconds =
+          std::chrono::steady_clock::now() - start;
+      return double(output.size()) * kIterations / seconds.count() /
+             (1024.0 * 1024.0);
+    };
+    double generic_mb_per_second = measure(texture_conversion::UntileGeneric);
+    double specialized_mb_per_second = measure(texture_conversion::Untile);
+    WARN(bytes_per_block << " bytes per block: generic "
+                         << generic_mb_per_second << " MB/s, specialized "
+                         << specialized_mb_per_second << " MB/s");
+  }
+}
+
+}  // namespace xe::gpu::test
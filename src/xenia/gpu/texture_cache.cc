@@ -13,6 +13,7 @@
 #include "xenia/base/cvar.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/profiling.h"
+#include "xenia/base/xxhash.h"
 #include "xenia/gpu/gpu_flags.h"
 
 DEFINE_int32(
@@ -59,6 +60,25 @@ DEFINE_uint32(
     "textures - so with 2x2 resolution scaling, the soft limit will be 360 + "
     "96 MB, and with 3x3, it will be 360 + 216 MB.",
     "GPU");
+DEFINE_uint32(
+    texture_cache_eviction_candidates, 16,
+    "Number of the least recently used textures considered for destruction "
+    "when the texture memory limits are exceeded. Among them, the texture that "
+    "is used the least frequently and is the cheapest to reload relatively to "
+    "its size is destroyed first. 1 to destroy textures strictly in the least "
+    "recently used order.",
+    "GPU");
+DEFINE_uint32(
+    texture_cache_staging_size_mb, 32,
+    "Maximum host memory usage (in megabytes) of recently destroyed textures "
+    "kept alive in case they're used again soon, in addition to "
+    "texture_cache_memory_limit_soft and texture_cache_memory_limit_hard.",
+    "GPU");
+DEFINE_bool(
+    texture_cache_content_hash, true,
+    "Hash the guest data of textures when loading them, and skip reloading "
+    "the textures if the game writes the same data to their memory again.",
+    "GPU");
 
 namespace xe {
 namespace gpu {
@@ -205,6 +225,9 @@ void TextureCache::CompletedSubmissionUpdated(
       cvars::texture_cache_memory_limit_hard + limit_scaled_resolve_add_mb;
   uint32_t limit_soft_lifetime =
       cvars::texture_cache_memory_limit_soft_lifetime * 1000;
+  uint32_t max_candidates =
+      std::max(cvars::texture_cache_eviction_candidates, UINT32_C(1));
+  uint64_t staging_size = uint64_t(cvars::texture_cache_staging_size_mb) << 20;
   bool destroyed_any = false;
   while (texture_used_first_ != nullptr) {
     uint64_t total_host_memory_usage_mb =
@@ -213,12 +236,34 @@ void TextureCache::CompletedSubmissionUpdated(
     if (total_host_memory_usage_mb <= limit_soft_mb && !limit_hard_exceeded) {
       break;
     }
-    Texture* texture = texture_used_first_;
-    if (texture->last_usage_submission_index() > completed_submission_index) {
-      break;
+    // Choose the texture that's the least valuable to keep among the least
+    // recently used ones. The list is sorted by the last usage, so if a texture
+    // can't be destroyed yet, more recently used ones can't too.
+    Texture* texture = nullptr;
+    double texture_retention = 0.0;
+    uint32_t candidate_count = 0;
+    for (Texture* candidate = texture_used_first_;
+         candidate != nullptr && candidate_count < max_candidates;
+         candidate = candidate->used_next(), ++candidate_count) {
+      if (candidate->last_usage_submission_index() >
+          completed_submission_index) {
+        break;
+      }
+      if (!limit_hard_exceeded &&
+          (candidate->last_usage_time() + limit_soft_lifetime) >
+              current_time) {
+        break;
+      }
+      double candidate_retention =
+          double(candidate->GetRecentUsageCount()) *
+          double(candidate->GetReloadCost()) /
+          double(std::max(candidate->GetHostMemoryUsage(), UINT64_C(1)));
+      if (!texture || candidate_retention < texture_retention) {
+        texture = candidate;
+        texture_retention = candidate_retention;
+      }
     }
-    if (!limit_hard_exceeded &&
-        (texture->last_usage_time() + limit_soft_lifetime) > current_time) {
+    if (!texture) {
       break;
     }
     if (!destroyed_any) {
@@ -230,17 +275,36 @@ void TextureCache::CompletedSubmissionUpdated(
       // any texture has been destroyed.
       ResetTextureBindings();
     }
-    // Remove the texture from the map and destroy it via its unique_ptr.
+    ++textures_evicted_;
+    // Remove the texture from the map and either move it to the staging cache
+    // or destroy it via its unique_ptr.
     auto found_texture_it = textures_.find(texture->key());
     assert_true(found_texture_it != textures_.end());
     if (found_texture_it != textures_.end()) {
       assert_true(found_texture_it->second.get() == texture);
+      std::unique_ptr<Texture> evicted_texture =
+          std::move(found_texture_it->second);
       textures_.erase(found_texture_it);
-      // `texture` is invalid now.
+      if (texture->GetHostMemoryUsage() <= staging_size) {
+        texture->SetStaged(true);
+        staged_textures_.emplace(texture->key(), std::move(evicted_texture));
+      }
+      // `texture` is invalid now if it hasn't been staged.
     }
   }
+  // Keep the most recently evicted textures within the staging budget.
+  while (texture_staged_first_ != nullptr &&
+         textures_staged_host_memory_usage_ > staging_size) {
+    staged_textures_.erase(texture_staged_first_->key());
+  }
   if (destroyed_any) {
     COUNT_profile_set("gpu/texture_cache/textures", textures_.size());
+    COUNT_profile_set("gpu/texture_cache/staged_textures",
+                      staged_textures_.size());
+    COUNT_profile_set("gpu/texture_cache/staged_host_memory_usage_mb",
+                      uint32_t((textures_staged_host_memory_usage_ +
+                                ((UINT32_C(1) << 20) - 1)) >>
+                               20));
   }
 }
 
@@ -255,6 +319,23 @@ void TextureCache::BeginFrame() {
   // sure bindings are reset so a new attempt will surely be made if the texture
   // is requested again.
   ResetTextureBindings();
+
+  COUNT_profile_set("gpu/texture_cache/loads_performed",
+                    texture_loads_performed_);
+  COUNT_profile_set("gpu/texture_cache/loads_skipped", texture_loads_skipped_);
+  COUNT_profile_set("gpu/texture_cache/loads_performed_kb",
+                    texture_loads_performed_bytes_ >> 10);
+  COUNT_profile_set("gpu/texture_cache/loads_skipped_kb",
+                    texture_loads_skipped_bytes_ >> 10);
+  texture_loads_performed_ = 0;
+  texture_loads_skipped_ = 0;
+  texture_loads_performed_bytes_ = 0;
+  texture_loads_skipped_bytes_ = 0;
+
+  COUNT_profile_set("gpu/texture_cache/evicted", textures_evicted_);
+  COUNT_profile_set("gpu/texture_cache/unstaged", textures_unstaged_);
+  textures_evicted_ = 0;
+  textures_unstaged_ = 0;
 }
 
 void TextureCache::MarkRangeAsResolved(uint32_t start_unscaled,
@@ -469,14 +550,9 @@ TextureCache::Texture::Texture(TextureCache& texture_cache,
       mips_resolved_(key.scaled_resolve),
       last_usage_submission_index_(texture_cache.current_submission_index_),
       last_usage_time_(texture_cache.current_submission_time_),
-      used_previous_(texture_cache.texture_used_last_),
+      used_previous_(nullptr),
       used_next_(nullptr) {
-  if (texture_cache.texture_used_last_) {
-    texture_cache.texture_used_last_->used_next_ = this;
-  } else {
-    texture_cache.texture_used_first_ = this;
-  }
-  texture_cache.texture_used_last_ = this;
+  LinkAsLast();
 
   // Never try to upload data that doesn't exist.
   base_outdated_ = guest_layout().base.level_data_extent_bytes != 0;
@@ -491,18 +567,74 @@ TextureCache::Texture::~Texture() {
     texture_cache().shared_memory().UnwatchMemoryRange(base_watch_handle_);
   }
 
+  Unlink();
+
+  if (staged_) {
+    texture_cache_.textures_staged_host_memory_usage_ -= host_memory_usage_;
+  } else {
+    texture_cache_.UpdateTexturesTotalHostMemoryUsage(0, host_memory_usage_);
+  }
+}
+
+void TextureCache::Texture::LinkAsLast() {
+  Texture*& list_first = staged_ ? texture_cache_.texture_staged_first_
+                                 : texture_cache_.texture_used_first_;
+  Texture*& list_last = staged_ ? texture_cache_.texture_staged_last_
+                                : texture_cache_.texture_used_last_;
+  used_previous_ = list_last;
+  used_next_ = nullptr;
+  if (list_last) {
+    list_last->used_next_ = this;
+  } else {
+    list_first = this;
+  }
+  list_last = this;
+}
+
+void TextureCache::Texture::Unlink() {
+  Texture*& list_first = staged_ ? texture_cache_.texture_staged_first_
+                                 : texture_cache_.texture_used_first_;
+  Texture*& list_last = staged_ ? texture_cache_.texture_staged_last_
+                                : texture_cache_.texture_used_last_;
   if (used_previous_) {
     used_previous_->used_next_ = used_next_;
   } else {
-    texture_cache_.texture_used_first_ = used_next_;
+    list_first = used_next_;
   }
   if (used_next_) {
     used_next_->used_previous_ = used_previous_;
   } else {
-    texture_cache_.texture_used_last_ = used_previous_;
+    list_last = used_previous_;
   }
+  used_previous_ = nullptr;
+  used_next_ = nullptr;
+}
 
-  texture_cache_.UpdateTexturesTotalHostMemoryUsage(0, host_memory_usage_);
+uint32_t TextureCache::Texture::GetRecentUsageCount() const {
+  uint64_t idle_submissions = texture_cache_.current_submission_index_ -
+                              last_usage_submission_index_;
+  return usage_count_ >> std::min(
+                             idle_submissions / kUsageCountHalfLifeSubmissions,
+                             UINT64_C(31));
+}
+
+void TextureCache::Texture::SetStaged(bool staged) {
+  if (staged_ == staged) {
+    return;
+  }
+  Unlink();
+  staged_ = staged;
+  if (staged) {
+    texture_cache_.UpdateTexturesTotalHostMemoryUsage(0, host_memory_usage_);
+    texture_cache_.textures_staged_host_memory_usage_ += host_memory_usage_;
+  } else {
+    texture_cache_.textures_staged_host_memory_usage_ -= host_memory_usage_;
+    texture_cache_.UpdateTexturesTotalHostMemoryUsage(host_memory_usage_, 0);
+    // Keep the recent usage list sorted by the last usage.
+    last_usage_submission_index_ = texture_cache_.current_submission_index_;
+    last_usage_time_ = texture_cache_.current_submission_time_;
+  }
+  LinkAsLast();
 }
 
 void TextureCache::Texture::MakeUpToDateAndWatch(
@@ -532,6 +664,7 @@ void TextureCache::Texture::MarkAsUsed() {
       texture_cache_.current_submission_index_) {
     return;
   }
+  usage_count_ = std::min(GetRecentUsageCount() + 1, UINT32_C(1) << 16);
   last_usage_submission_index_ = texture_cache_.current_submission_index_;
   last_usage_time_ = texture_cache_.current_submission_time_;
   if (used_next_ == nullptr) {
@@ -551,7 +684,8 @@ void TextureCache::Texture::MarkAsUsed() {
 }
 
 void TextureCache::Texture::WatchCallback(
-    [[maybe_unused]] const global_unique_lock_type& global_lock, bool is_mip) {
+    [[maybe_unused]] const global_unique_lock_type& global_lock, bool is_mip,
+    bool invalidated_by_gpu) {
   if (is_mip) {
     assert_not_zero(GetGuestMipsSize());
     mips_outdated_ = true;
@@ -561,13 +695,17 @@ void TextureCache::Texture::WatchCallback(
     base_outdated_ = true;
     base_watch_handle_ = nullptr;
   }
+  if (invalidated_by_gpu) {
+    // The new data is not in the guest memory, can't compare the hashes.
+    set_content_hash(is_mip, std::nullopt);
+  }
 }
 
 void TextureCache::WatchCallback(const global_unique_lock_type& global_lock,
                                  void* context, void* data, uint64_t argument,
                                  bool invalidated_by_gpu) {
   Texture& texture = *static_cast<Texture*>(context);
-  texture.WatchCallback(global_lock, argument != 0);
+  texture.WatchCallback(global_lock, argument != 0, invalidated_by_gpu);
   texture.texture_cache().texture_became_outdated_.store(
       true, std::memory_order_release);
 }
@@ -575,7 +713,9 @@ void TextureCache::WatchCallback(const global_unique_lock_type& global_lock,
 void TextureCache::DestroyAllTextures(bool from_destructor) {
   ResetTextureBindings(from_destructor);
   textures_.clear();
+  staged_textures_.clear();
   COUNT_profile_set("gpu/texture_cache/textures", 0);
+  COUNT_profile_set("gpu/texture_cache/staged_textures", 0);
 }
 
 TextureCache::Texture* TextureCache::FindOrCreateTexture(TextureKey key) {
@@ -623,6 +763,22 @@ TextureCache::Texture* TextureCache::FindOrCreateTexture(TextureKey key) {
     return found_texture_it->second.get();
   }
 
+  // Reuse the texture if it has been evicted recently. If its memory hasn't
+  // been modified since, it won't need reloading too.
+  auto staged_texture_it = staged_textures_.find(key);
+  if (staged_texture_it != staged_textures_.end()) {
+    Texture* texture = staged_texture_it->second.get();
+    texture->SetStaged(false);
+    textures_.emplace(key, std::move(staged_texture_it->second));
+    staged_textures_.erase(staged_texture_it);
+    ++textures_unstaged_;
+    COUNT_profile_set("gpu/texture_cache/textures", textures_.size());
+    COUNT_profile_set("gpu/texture_cache/staged_textures",
+                      staged_textures_.size());
+    texture->LogAction("Unstaged");
+    return texture;
+  }
+
   // Create the texture and add it to the map.
   Texture* texture;
   {
@@ -699,8 +855,13 @@ void TextureCache::LoadTexturesData(Texture** textures, uint32_t n_textures) {
     // portion of its pages is invalidated, in this case we'll need the texture
     // from the shared memory to load the unscaled parts.
     // TODO(Triang3l): Load unscaled parts.
+    bool base_outdated = (index_base_outdated & (1ULL << i)) != 0;
+    bool mips_outdated = (index_mips_outdated & (1ULL << i)) != 0;
+    std::optional<uint64_t> base_hash, mips_hash;
+    HashTextureGuestData(texture, base_outdated, mips_outdated, base_hash,
+                         mips_hash);
     bool base_resolved = texture.GetBaseResolved();
-    if (index_base_outdated & (1ULL << i)) {
+    if (base_outdated) {
       if (!shared_memory().RequestRange(
               texture_key.base_page << 12,
               xe::align(texture.GetGuestBaseSize(), UINT32_C(16)),
@@ -709,7 +870,7 @@ void TextureCache::LoadTexturesData(Texture** textures, uint32_t n_textures) {
       }
     }
     bool mips_resolved = texture.GetMipsResolved();
-    if (index_mips_outdated & (1ULL << i)) {
+    if (mips_outdated) {
       if (!shared_memory().RequestRange(
               texture_key.mip_page << 12,
               xe::align(texture.GetGuestMipsSize(), UINT32_C(16)),
@@ -733,11 +894,21 @@ void TextureCache::LoadTexturesData(Texture** textures, uint32_t n_textures) {
     }
 
     // Actually load the texture data.
-    if (!LoadTextureDataFromResidentMemoryImpl(
-            texture, (index_base_outdated & (1ULL << i)) != 0,
-            (index_mips_outdated & (1ULL << i)) != 0)) {
+    bool load_base = base_outdated, load_mips = mips_outdated;
+    SkipUnchangedTextureData(texture, base_resolved, mips_resolved, load_base,
+                             load_mips, base_hash, mips_hash);
+    if ((load_base || load_mips) &&
+        !LoadTextureDataFromResidentMemoryImpl(texture, load_base,
+                                               load_mips)) {
       continue;
     }
+    CountTextureLoads(texture, load_base, load_mips);
+    if (base_outdated) {
+      texture.set_content_hash(false, base_hash);
+    }
+    if (mips_outdated) {
+      texture.set_content_hash(true, mips_hash);
+    }
 
     // Update the source of the texture (resolve vs. CPU or memexport) for
     // purposes of handling piecewise gamma emulation via sRGB and for
@@ -795,6 +966,9 @@ bool TextureCache::LoadTextureData(Texture& texture) {
   // its pages is invalidated, in this case we'll need the texture from the
   // shared memory to load the unscaled parts.
   // TODO(Triang3l): Load unscaled parts.
+  std::optional<uint64_t> base_hash, mips_hash;
+  HashTextureGuestData(texture, base_outdated, mips_outdated, base_hash,
+                       mips_hash);
   bool base_resolved = texture.GetBaseResolved();
   if (base_outdated) {
     if (!shared_memory().RequestRange(
@@ -829,10 +1003,20 @@ bool TextureCache::LoadTextureData(Texture& texture) {
   }
 
   // Actually load the texture data.
-  if (!LoadTextureDataFromResidentMemoryImpl(texture, base_outdated,
-                                             mips_outdated)) {
+  bool load_base = base_outdated, load_mips = mips_outdated;
+  SkipUnchangedTextureData(texture, base_resolved, mips_resolved, load_base,
+                           load_mips, base_hash, mips_hash);
+  if ((load_base || load_mips) &&
+      !LoadTextureDataFromResidentMemoryImpl(texture, load_base, load_mips)) {
     return false;
   }
+  CountTextureLoads(texture, load_base, load_mips);
+  if (base_outdated) {
+    texture.set_content_hash(false, base_hash);
+  }
+  if (mips_outdated) {
+    texture.set_content_hash(true, mips_hash);
+  }
 
   // Update the source of the texture (resolve vs. CPU or memexport) for
   // purposes of handling piecewise gamma emulation via sRGB and for resolution
@@ -853,6 +1037,66 @@ bool TextureCache::LoadTextureData(Texture& texture) {
   return true;
 }
 
+void TextureCache::HashTextureGuestData(
+    const Texture& texture, bool base_outdated, bool mips_outdated,
+    std::optional<uint64_t>& base_hash_out,
+    std::optional<uint64_t>& mips_hash_out) {
+  base_hash_out.reset();
+  mips_hash_out.reset();
+  const TextureKey& texture_key = texture.key();
+  if (!cvars::texture_cache_content_hash || texture_key.scaled_resolve) {
+    return;
+  }
+  for (uint32_t i = 0; i < 2; ++i) {
+    bool is_mip = i != 0;
+    // Resolved data is only in the shared memory, not in the guest memory.
+    if (!(is_mip ? mips_outdated : base_outdated) ||
+        (is_mip ? texture.GetMipsResolved() : texture.GetBaseResolved())) {
+      continue;
+    }
+    uint32_t page = is_mip ? texture_key.mip_page : texture_key.base_page;
+    uint32_t size =
+        is_mip ? texture.GetGuestMipsSize() : texture.GetGuestBaseSize();
+    (is_mip ? mips_hash_out : base_hash_out) = XXH3_64bits(
+        shared_memory().memory().TranslatePhysical<const void*>(page << 12),
+        size);
+  }
+}
+
+void TextureCache::SkipUnchangedTextureData(
+    const Texture& texture, bool base_resolved, bool mips_resolved,
+    bool& load_base, bool& load_mips, std::optional<uint64_t>& base_hash,
+    std::optional<uint64_t>& mips_hash) {
+  for (uint32_t i = 0; i < 2; ++i) {
+    bool is_mip = i != 0;
+    std::optional<uint64_t>& hash = is_mip ? mips_hash : base_hash;
+    // Resolved while being requested.
+    if (is_mip ? mips_resolved : base_resolved) {
+      hash.reset();
+    }
+    bool& load = is_mip ? load_mips : load_base;
+    if (!load || !hash || texture.content_hash(is_mip) != hash) {
+      continue;
+    }
+    load = false;
+    ++texture_loads_skipped_;
+    texture_loads_skipped_bytes_ +=
+        is_mip ? texture.GetGuestMipsSize() : texture.GetGuestBaseSize();
+  }
+}
+
+void TextureCache::CountTextureLoads(const Texture& texture, bool load_base,
+                                     bool load_mips) {
+  if (load_base) {
+    ++texture_loads_performed_;
+    texture_loads_performed_bytes_ += texture.GetGuestBaseSize();
+  }
+  if (load_mips) {
+    ++texture_loads_performed_;
+    texture_loads_performed_bytes_ += texture.GetGuestMipsSize();
+  }
+}
+
 void TextureCache::BindingInfoFromFetchConstant(
     const xenos::xe_gpu_texture_fetch_t& fetch, TextureKey& key_out,
     uint8_t* swizzled_signs_out) {
@@ -15,6 +15,7 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 
 #include "xenia/base/assert.h"
@@ -244,6 +245,25 @@ class TextureCache {
       return last_usage_submission_index_;
     }
     uint64_t last_usage_time() const { return last_usage_time_; }
+    // The next more recently used texture.
+    Texture* used_next() const { return used_next_; }
+
+    // Number of submissions the texture has been used in, halved for every
+    // kUsageCountHalfLifeSubmissions submissions it hasn't been used in.
+    uint32_t GetRecentUsageCount() const;
+    // Approximate cost of reloading the texture after it has been evicted - the
+    // number of bytes read from the guest memory and written to the host
+    // texture, so textures expanded by format conversion (decompression of
+    // compressed formats, for instance) are more expensive to reload.
+    uint64_t GetReloadCost() const {
+      return uint64_t(GetGuestBaseSize()) + GetGuestMipsSize() +
+             host_memory_usage_;
+    }
+
+    bool staged() const { return staged_; }
+    // Moves the texture between the recent usage list and the list of the
+    // evicted textures kept in the staging cache.
+    void SetStaged(bool staged);
 
     bool GetBaseResolved() const { return base_resolved_; }
     void SetBaseResolved(bool base_resolved) {
@@ -265,7 +285,15 @@ class TextureCache {
     }
     void MakeUpToDateAndWatch(const global_unique_lock_type& global_lock);
 
-    void WatchCallback(const global_unique_lock_type& global_lock, bool is_mip);
+    void WatchCallback(const global_unique_lock_type& global_lock, bool is_mip,
+                       bool invalidated_by_gpu);
+
+    const std::optional<uint64_t>& content_hash(bool is_mip) const {
+      return is_mip ? mips_content_hash_ : base_content_hash_;
+    }
+    void set_content_hash(bool is_mip, std::optional<uint64_t> content_hash) {
+      (is_mip ? mips_content_hash_ : base_content_hash_) = content_hash;
+    }
 
     // For LRU caching - updates the last usage frame and moves the texture to
     // the end of the usage queue. Must be called any time the texture is
@@ -285,6 +313,11 @@ class TextureCache {
     }
 
    private:
+    // Links to or unlinks from the recent usage list or the staging list,
+    // depending on staged_.
+    void LinkAsLast();
+    void Unlink();
+
     TextureCache& texture_cache_;
 
     TextureKey key_;
@@ -295,8 +328,11 @@ class TextureCache {
 
     uint64_t last_usage_submission_index_;
     uint64_t last_usage_time_;
+    uint32_t usage_count_ = 1;
+    // Links in the recent usage list, or in the staging list if staged.
     Texture* used_previous_;
     Texture* used_next_;
+    bool staged_ = false;
 
     // Whether the most up-to-date base / mips contain pages with data from a
     // resolve operation (rather than from the CPU or memexport), primarily for
@@ -314,6 +350,12 @@ class TextureCache {
     // Watch handles for the memory ranges.
     SharedMemory::WatchHandle base_watch_handle_ = nullptr;
     SharedMemory::WatchHandle mips_watch_handle_ = nullptr;
+
+    // XXH3 of the guest data as of the last load, if it was written by the CPU
+    // (resolves and memexport don't write to the guest memory), for skipping
+    // reloading if the same data has been written again.
+    std::optional<uint64_t> base_content_hash_;
+    std::optional<uint64_t> mips_content_hash_;
   };
 
   // Rules of data access in load shaders:
@@ -570,6 +612,25 @@ class TextureCache {
   }
   bool LoadTextureData(Texture& texture);
   void LoadTexturesData(Texture** textures, uint32_t n_textures);
+  // Hashes the outdated guest data of the texture written by the CPU. Must be
+  // done before requesting the ranges from the shared memory, so if the CPU
+  // writes the data again during or after the upload, the hash describes data
+  // not newer than what has been uploaded, and the rewrite isn't skipped.
+  void HashTextureGuestData(const Texture& texture, bool base_outdated,
+                            bool mips_outdated,
+                            std::optional<uint64_t>& base_hash_out,
+                            std::optional<uint64_t>& mips_hash_out);
+  // Drops the hashes of the parts that turned out to be resolved when they were
+  // requested, and clears load_base / load_mips for the parts that haven't
+  // changed since the previous load. The hashes must be stored in the texture
+  // after a successful load.
+  void SkipUnchangedTextureData(const Texture& texture, bool base_resolved,
+                                bool mips_resolved, bool& load_base,
+                                bool& load_mips,
+                                std::optional<uint64_t>& base_hash,
+                                std::optional<uint64_t>& mips_hash);
+  void CountTextureLoads(const Texture& texture, bool load_base,
+                         bool load_mips);
   // Writes the texture data (for base, mips or both - but not neither) from the
   // shared memory or the scaled resolve memory. The shared memory management is
   // done outside this function, the implementation just needs to load the data
@@ -651,11 +712,32 @@ class TextureCache {
   Texture* texture_used_first_ = nullptr;
   Texture* texture_used_last_ = nullptr;
 
+  static constexpr uint32_t kUsageCountHalfLifeSubmissions = 256;
+
+  // Recently evicted textures, kept alive within texture_cache_staging_size_mb
+  // so they can be reused without recreation and, if their memory hasn't been
+  // modified, without reloading if requested again soon. Not included in
+  // textures_total_host_memory_usage_. The list is in the order of eviction.
+  std::unordered_map<TextureKey, std::unique_ptr<Texture>, TextureKey::Hasher>
+      staged_textures_;
+  Texture* texture_staged_first_ = nullptr;
+  Texture* texture_staged_last_ = nullptr;
+  uint64_t textures_staged_host_memory_usage_ = 0;
+  // Reset every frame.
+  uint32_t textures_evicted_ = 0;
+  uint32_t textures_unstaged_ = 0;
+
   // Whether a texture has become outdated (a memory watch has been triggered),
   // so need to recheck if textures aren't outdated, disregarding whether fetch
   // constants have been changed.
   std::atomic<bool> texture_became_outdated_{false};
 
+  // Loads of texture base levels or mips, reset every frame.
+  uint32_t texture_loads_performed_ = 0;
+  uint32_t texture_loads_skipped_ = 0;
+  uint64_t texture_loads_performed_bytes_ = 0;
+  uint64_t texture_loads_skipped_bytes_ = 0;
+
   std::array<TextureBinding, xenos::kTextureFetchConstantCount>
       texture_bindings_;
   // Bit vector with bits reset on fetch constant writes to avoid parsing fetch
@@ -14,9 +14,11 @@
 #include <cstring>
 #include <functional>
 
+#include "xenia/base/byte_order.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/math.h"
 #include "xenia/base/memory.h"
+#include "xenia/base/platform.h"
 #include "xenia/base/profiling.h"
 #include "xenia/base/xxhash.h"
 
@@ -37,7 +39,7 @@ void CopySwapBlock(xenos::Endian endian, void* output, const void* input,
       break;
     case xenos::Endian::k16in32:  // Swap high and low 16 bits within a 32 bit
                                   // word
-      xe::copy_and_swap_16_in_32_unaligned(output, input, length);
+      xe::copy_and_swap_16_in_32_unaligned(output, input, length / 4);
       break;
     default:
     case xenos::Endian::kNone:
@@ -109,8 +111,8 @@ static uint32_t TiledOffset2DColumn(uint32_t x, uint32_t y, uint32_t log2_bpp,
          ((y & 16) << 7) + (((((y & 8) >> 2) + (x >> 3)) & 3) << 6);
 }
 
-void Untile(uint8_t* output_buffer, const uint8_t* input_buffer,
-            const UntileInfo* untile_info) {
+void UntileGeneric(uint8_t* output_buffer, const uint8_t* input_buffer,
+                   const UntileInfo* untile_info) {
   SCOPE_profile_cpu_f("gpu");
   assert_not_null(untile_info);
   assert_not_null(untile_info->input_format_info);
@@ -126,6 +128,14 @@ void Untile(uint8_t* output_buffer, const uint8_t* input_buffer,
   auto log2_bpp = (input_bytes_per_block / 4) +
                   ((input_bytes_per_block / 2) >> (input_bytes_per_block / 4));
 
+  xenos::Endian endian = untile_info->endian;
+  UntileCopyBlockCallback copy_callback = untile_info->copy_callback;
+  if (!copy_callback) {
+    copy_callback = [endian](void* output, const void* input, size_t length) {
+      CopySwapBlock(endian, output, input, length);
+    };
+  }
+
   // Offset to the current row, in bytes.
   uint32_t output_row_offset = 0;
   for (uint32_t y = 0; y < untile_info->height; y++) {
@@ -141,10 +151,9 @@ void Untile(uint8_t* output_buffer, const uint8_t* input_buffer,
                                               log2_bpp, input_row_offset);
       input_offset >>= log2_bpp;
 
-      untile_info->copy_callback(
-          &output_buffer[output_offset],
-          &input_buffer[input_offset * input_bytes_per_block],
-          output_bytes_per_block);
+      copy_callback(&output_buffer[output_offset],
+                    &input_buffer[input_offset * input_bytes_per_block],
+                    output_bytes_per_block);
 
       output_offset += output_bytes_per_block;
     }
@@ -153,6 +162,217 @@ void Untile(uint8_t* output_buffer, const uint8_t* input_buffer,
   }
 }
 
+namespace {
+
+// Copies kBytes with the endianness swap, kBytes must be a multiple of the swap
+// granularity.
+template <uint32_t kBytes, xenos::Endian kEndian>
+XE_FORCEINLINE void CopySwapBytes(uint8_t* output, const uint8_t* input) {
+#if XE_ARCH_AMD64
+  if constexpr (kBytes == 16) {
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    if constexpr (kEndian == xenos::Endian::k8in16) {
+      data = _mm_shuffle_epi8(data, _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8,
+                                                  11, 10, 13, 12, 15, 14));
+    } else if constexpr (kEndian == xenos::Endian::k8in32) {
+      data = _mm_shuffle_epi8(data, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11,
+                                                  10, 9, 8, 15, 14, 13, 12));
+    } else if constexpr (kEndian == xenos::Endian::k16in32) {
+      data = _mm_shuffle_epi8(data, _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10,
+                                                  11, 8, 9, 14, 15, 12, 13));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), data);
+    return;
+  }
+#endif  // XE_ARCH_AMD64
+  if constexpr (kEndian == xenos::Endian::k8in16) {
+    for (uint32_t i = 0; i < kBytes; i += sizeof(uint16_t)) {
+      uint16_t value;
+      std::memcpy(&value, input + i, sizeof(value));
+      value = xe::byte_swap(value);
+      std::memcpy(output + i, &value, sizeof(value));
+    }
+  } else if constexpr (kEndian == xenos::Endian::k8in32 ||
+                       kEndian == xenos::Endian::k16in32) {
+    for (uint32_t i = 0; i < kBytes; i += sizeof(uint32_t)) {
+      uint32_t value;
+      std::memcpy(&value, input + i, sizeof(value));
+      if constexpr (kEndian == xenos::Endian::k8in32) {
+        value = xe::byte_swap(value);
+      } else {
+        value = (value >> 16) | (value << 16);
+      }
+      std::memcpy(output + i, &value, sizeof(value));
+    }
+  } else {
+    std::memcpy(output, input, kBytes);
+  }
+}
+
+#if XE_ARCH_AMD64
+// Copies two 16-byte pieces 32 bytes apart in the input to 32 contiguous bytes
+// of the output.
+template <xenos::Endian kEndian>
+XE_FORCEINLINE void CopySwapPiecePairAVX2(uint8_t* output,
+                                          const uint8_t* input) {
+  __m256i data = _mm256_inserti128_si256(
+      _mm256_castsi128_si256(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(input))),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 32)), 1);
+  if constexpr (kEndian == xenos::Endian::k8in16) {
+    data = _mm256_shuffle_epi8(
+        data, _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15,
+                               14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12,
+                               15, 14));
+  } else if constexpr (kEndian == xenos::Endian::k8in32) {
+    data = _mm256_shuffle_epi8(
+        data, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13,
+                               12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14,
+                               13, 12));
+  } else if constexpr (kEndian == xenos::Endian::k16in32) {
+    data = _mm256_shuffle_epi8(
+        data, _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12,
+                               13, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15,
+                               12, 13));
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), data);
+}
+#endif  // XE_ARCH_AMD64
+
+// Within a row of a tile, blocks are stored in contiguous 16-byte pieces (8
+// bytes for 8bpb, where a whole group of 8 blocks is contiguous), and for
+// 32bpb and larger, the next piece is 32 bytes after the previous one. Copies
+// whole pieces (or pairs of pieces with AVX2) where the row is aligned to them,
+// and individual blocks at the unaligned edges.
+template <uint32_t kLog2BytesPerBlock, xenos::Endian kEndian, bool kAVX2>
+void UntileSpecialized(uint8_t* output_buffer, const uint8_t* input_buffer,
+                       const UntileInfo& untile_info) {
+  constexpr uint32_t kBytesPerBlock = UINT32_C(1) << kLog2BytesPerBlock;
+  constexpr uint32_t kPieceBytes = std::min(UINT32_C(16), kBytesPerBlock * 8);
+  constexpr uint32_t kBlocksPerPiece = kPieceBytes >> kLog2BytesPerBlock;
+  constexpr bool kPiecePairs = kAVX2 && kLog2BytesPerBlock >= 2;
+  constexpr uint32_t kBlocksPerStep =
+      kPiecePairs ? kBlocksPerPiece * 2 : kBlocksPerPiece;
+
+  uint32_t width = untile_info.width;
+  uint32_t output_pitch = untile_info.output_pitch << kLog2BytesPerBlock;
+  uint8_t* output_row = output_buffer;
+  for (uint32_t y = 0; y < untile_info.height; ++y) {
+    uint32_t tiled_y = untile_info.offset_y + y;
+    uint32_t input_row_offset =
+        TiledOffset2DRow(tiled_y, untile_info.input_pitch, kLog2BytesPerBlock);
+    uint32_t x = 0;
+    while (x < width) {
+      uint32_t tiled_x = untile_info.offset_x + x;
+      uint32_t input_offset = TiledOffset2DColumn(
+          tiled_x, tiled_y, kLog2BytesPerBlock, input_row_offset);
+      const uint8_t* input =
+          input_buffer + (input_offset & ~(kBytesPerBlock - 1));
+      uint8_t* output = output_row + (x << kLog2BytesPerBlock);
+      if (!(tiled_x & (kBlocksPerStep - 1)) && width - x >= kBlocksPerStep) {
+#if XE_ARCH_AMD64
+        if constexpr (kPiecePairs) {
+          CopySwapPiecePairAVX2<kEndian>(output, input);
+        } else
+#endif  // XE_ARCH_AMD64
+        {
+          CopySwapBytes<kPieceBytes, kEndian>(output, input);
+        }
+        x += kBlocksPerStep;
+      } else {
+        CopySwapBytes<kBytesPerBlock, kEndian>(output, input);
+        ++x;
+      }
+    }
+    output_row += output_pitch;
+  }
+}
+
+typedef void (*UntileSpecializedFunction)(uint8_t* output_buffer,
+                                          const uint8_t* input_buffer,
+                                          const UntileInfo& untile_info);
+
+template <uint32_t kLog2BytesPerBlock, bool kAVX2>
+UntileSpecializedFunction GetUntileSpecializedFunction(xenos::Endian endian) {
+  switch (endian) {
+    case xenos::Endian::kNone:
+      return UntileSpecialized<kLog2BytesPerBlock, xenos::Endian::kNone,
+                               kAVX2>;
+    case xenos::Endian::k8in16:
+      if constexpr (kLog2BytesPerBlock >= 1) {
+        return UntileSpecialized<kLog2BytesPerBlock, xenos::Endian::k8in16,
+                                 kAVX2>;
+      }
+      break;
+    case xenos::Endian::k8in32:
+      if constexpr (kLog2BytesPerBlock >= 2) {
+        return UntileSpecialized<kLog2BytesPerBlock, xenos::Endian::k8in32,
+                                 kAVX2>;
+      }
+      break;
+    case xenos::Endian::k16in32:
+      if constexpr (kLog2BytesPerBlock >= 2) {
+        return UntileSpecialized<kLog2BytesPerBlock, xenos::Endian::k16in32,
+                                 kAVX2>;
+      }
+      break;
+  }
+  // Swapping in units larger than a block - not handled per block the same way
+  // by CopySwapBlock.
+  return nullptr;
+}
+
+template <bool kAVX2>
+UntileSpecializedFunction GetUntileSpecializedFunction(
+    uint32_t bytes_per_block, xenos::Endian endian) {
+  switch (bytes_per_block) {
+    case 1:
+      return GetUntileSpecializedFunction<0, kAVX2>(endian);
+    case 2:
+      return GetUntileSpecializedFunction<1, kAVX2>(endian);
+    case 4:
+      return GetUntileSpecializedFunction<2, kAVX2>(endian);
+    case 8:
+      return GetUntileSpecializedFunction<3, kAVX2>(endian);
+    case 16:
+      return GetUntileSpecializedFunction<4, kAVX2>(endian);
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+void Untile(uint8_t* output_buffer, const uint8_t* input_buffer,
+            const UntileInfo* untile_info) {
+  SCOPE_profile_cpu_f("gpu");
+  assert_not_null(untile_info);
+  assert_not_null(untile_info->input_format_info);
+  assert_not_null(untile_info->output_format_info);
+
+  uint32_t bytes_per_block = untile_info->input_format_info->bytes_per_block();
+  UntileSpecializedFunction specialized_function = nullptr;
+  if (!untile_info->copy_callback &&
+      bytes_per_block ==
+          untile_info->output_format_info->bytes_per_block()) {
+#if XE_ARCH_AMD64
+    if (amd64::GetFeatureFlags() & amd64::kX64EmitAVX2) {
+      specialized_function = GetUntileSpecializedFunction<true>(
+          bytes_per_block, untile_info->endian);
+    } else
+#endif  // XE_ARCH_AMD64
+    {
+      specialized_function = GetUntileSpecializedFunction<false>(
+          bytes_per_block, untile_info->endian);
+    }
+  }
+  if (!specialized_function) {
+    UntileGeneric(output_buffer, input_buffer, untile_info);
+    return;
+  }
+  specialized_function(output_buffer, input_buffer, *untile_info);
+}
+
 }  //  namespace texture_conversion
 }  //  namespace gpu
 }  //  namespace xe
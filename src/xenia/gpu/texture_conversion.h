@@ -43,11 +43,19 @@ typedef struct UntileInfo {
   uint32_t output_pitch;
   const FormatInfo* input_format_info;
   const FormatInfo* output_format_info;
+  // If empty, the blocks are copied with CopySwapBlock using the endianness
+  // below, with loops specialized for the block size and the endianness when
+  // the input and the output block sizes are the same.
   UntileCopyBlockCallback copy_callback;
+  xenos::Endian endian;
 } UntileInfo;
 
 void Untile(uint8_t* output_buffer, const uint8_t* input_buffer,
             const UntileInfo* untile_info);
+// Untile with the block-by-block loop calling the copy callback (or
+// CopySwapBlock) for every block, for verification of the specialized loops.
+void UntileGeneric(uint8_t* output_buffer, const uint8_t* input_buffer,
+                   const UntileInfo* untile_info);
 
 }  // namespace texture_conversion
 }  // namespace gpu
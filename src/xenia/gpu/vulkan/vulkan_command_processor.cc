@@ -2293,10 +2293,17 @@ bool VulkanCommandProcessor::IssueDraw(xenos::PrimitiveType prim_type,
                            pixel_shader->GetOrCreateTranslation(
                                pixel_shader_modification.value))
                      : nullptr;
-    if (!pipeline_cache_->EnsureShadersTranslated(vertex_shader_translation,
-                                                  pixel_shader_translation)) {
+    bool shaders_translation_pending;
+    if (!pipeline_cache_->EnsureShadersTranslated(
+            vertex_shader_translation, pixel_shader_translation,
+            &shaders_translation_pending)) {
       return false;
     }
+    if (shaders_translation_pending) {
+      // Asynchronous translation enabled, and the shaders are not ready yet -
+      // drop the draw rather than stalling the command processor.
+      return true;
+    }
 
     // Obtain the samplers. Note that the bindings don't depend on the shader
     // modification, so if on the second iteration of this loop it becomes
@@ -2474,9 +2481,22 @@ bool VulkanCommandProcessor::IssueDraw(xenos::PrimitiveType prim_type,
                 device_info.maxViewportDimensions[1], true,
                 normalized_depth_control, false, host_render_targets_used,
                 pixel_shader && pixel_shader->writes_depth());
-  gviargs.SetupRegisterValues(regs);
+  if (register_file_->ConsumeDirtyGroup(
+          RegisterFile::DirtyGroup::kViewport)) {
+    gviargs.SetupRegisterValues(regs);
+  } else {
+    gviargs.CopyRegisterValues(previous_viewport_info_args_);
+  }
 
-  draw_util::GetHostViewportInfo(&gviargs, viewport_info);
+  if (gviargs == previous_viewport_info_args_) {
+    viewport_info = previous_viewport_info_;
+    register_file_->CountGroupUpdate(false);
+  } else {
+    draw_util::GetHostViewportInfo(&gviargs, viewport_info);
+    previous_viewport_info_args_ = gviargs;
+    previous_viewport_info_ = viewport_info;
+    register_file_->CountGroupUpdate(true);
+  }
 
   // Update dynamic graphics pipeline state.
   UpdateDynamicState(viewport_info, primitive_polygonal,
@@ -2777,6 +2797,8 @@ void VulkanCommandProcessor::CheckSubmissionFenceAndDeviceLoss(
 
   render_target_cache_->CompletedSubmissionUpdated();
 
+  pipeline_cache_->CompletedSubmissionUpdated();
+
   texture_cache_->CompletedSubmissionUpdated(submission_completed_);
 
   // Destroy objects scheduled for destruction.
@@ -3280,7 +3302,7 @@ void VulkanCommandProcessor::UpdateDynamicState(
   SCOPE_profile_cpu_f("gpu");
 #endif  // XE_UI_VULKAN_FINE_GRAINED_DRAW_SCOPES
 
-  const RegisterFile& regs = *register_file_;
+  RegisterFile& regs = *register_file_;
 
   // Window parameters.
   // http://ftp.tku.edu.tw/NetBSD/NetBSD-current/xsrc/external/mit/xf86-video-ati/dist/src/r600_reg_auto_r6xx.h
@@ -3309,46 +3331,121 @@ void VulkanCommandProcessor::UpdateDynamicState(
   SetViewport(viewport);
 
   // Scissor.
-  draw_util::Scissor scissor;
-  draw_util::GetScissor(regs, scissor);
+  if (regs.BeginGroupUpdate(RegisterFile::DirtyGroup::kScissor)) {
+    draw_util::GetScissor(regs, previous_scissor_);
+  }
   VkRect2D scissor_rect;
-  scissor_rect.offset.x = int32_t(scissor.offset[0]);
-  scissor_rect.offset.y = int32_t(scissor.offset[1]);
-  scissor_rect.extent.width = scissor.extent[0];
-  scissor_rect.extent.height = scissor.extent[1];
+  scissor_rect.offset.x = int32_t(previous_scissor_.offset[0]);
+  scissor_rect.offset.y = int32_t(previous_scissor_.offset[1]);
+  scissor_rect.extent.width = previous_scissor_.extent[0];
+  scissor_rect.extent.height = previous_scissor_.extent[1];
   SetScissor(scissor_rect);
 
   if (render_target_cache_->GetPath() ==
       RenderTargetCache::Path::kHostRenderTargets) {
-    // Depth bias.
-    float depth_bias_constant_factor, depth_bias_slope_factor;
-    draw_util::GetPreferredFacePolygonOffset(regs, primitive_polygonal,
-                                             depth_bias_slope_factor,
-                                             depth_bias_constant_factor);
-    depth_bias_constant_factor *=
-        regs.Get<reg::RB_DEPTH_INFO>().depth_format ==
-                xenos::DepthRenderTargetFormat::kD24S8
-            ? draw_util::kD3D10PolygonOffsetFactorUnorm24
-            : draw_util::kD3D10PolygonOffsetFactorFloat24;
-    // With non-square resolution scaling, make sure the worst-case impact is
-    // reverted (slope only along the scaled axis), thus max. More bias is
-    // better than less bias, because less bias means Z fighting with the
-    // background is more likely.
-    depth_bias_slope_factor *=
-        xenos::kPolygonOffsetScaleSubpixelUnit *
-        float(std::max(render_target_cache_->draw_resolution_scale_x(),
-                       render_target_cache_->draw_resolution_scale_y()));
-    // std::memcmp instead of != so in case of NaN, every draw won't be
-    // invalidating it.
-    dynamic_depth_bias_update_needed_ |=
-        std::memcmp(&dynamic_depth_bias_constant_factor_,
-                    &depth_bias_constant_factor, sizeof(float)) != 0;
-    dynamic_depth_bias_update_needed_ |=
-        std::memcmp(&dynamic_depth_bias_slope_factor_, &depth_bias_slope_factor,
-                    sizeof(float)) != 0;
-    if (dynamic_depth_bias_update_needed_) {
+    // Depth bias and stencil masks and references, derived from the registers
+    // in the depth / stencil group and the primitive type.
+    if (regs.BeginGroupUpdate(
+            RegisterFile::DirtyGroup::kDepthStencil,
+            primitive_polygonal !=
+                    previous_depth_stencil_primitive_polygonal_ ||
+                normalized_depth_control.value !=
+                    previous_depth_stencil_normalized_depth_control_.value)) {
+      previous_depth_stencil_primitive_polygonal_ = primitive_polygonal;
+      previous_depth_stencil_normalized_depth_control_ =
+          normalized_depth_control;
+
+      // Depth bias.
+      float depth_bias_constant_factor, depth_bias_slope_factor;
+      draw_util::GetPreferredFacePolygonOffset(regs, primitive_polygonal,
+                                               depth_bias_slope_factor,
+                                               depth_bias_constant_factor);
+      depth_bias_constant_factor *=
+          regs.Get<reg::RB_DEPTH_INFO>().depth_format ==
+                  xenos::DepthRenderTargetFormat::kD24S8
+              ? draw_util::kD3D10PolygonOffsetFactorUnorm24
+              : draw_util::kD3D10PolygonOffsetFactorFloat24;
+      // With non-square resolution scaling, make sure the worst-case impact is
+      // reverted (slope only along the scaled axis), thus max. More bias is
+      // better than less bias, because less bias means Z fighting with the
+      // background is more likely.
+      depth_bias_slope_factor *=
+          xenos::kPolygonOffsetScaleSubpixelUnit *
+          float(std::max(render_target_cache_->draw_resolution_scale_x(),
+                         render_target_cache_->draw_resolution_scale_y()));
+      // std::memcmp instead of != so in case of NaN, every draw won't be
+      // invalidating it.
+      dynamic_depth_bias_update_needed_ |=
+          std::memcmp(&dynamic_depth_bias_constant_factor_,
+                      &depth_bias_constant_factor, sizeof(float)) != 0;
+      dynamic_depth_bias_update_needed_ |=
+          std::memcmp(&dynamic_depth_bias_slope_factor_,
+                      &depth_bias_slope_factor, sizeof(float)) != 0;
       dynamic_depth_bias_constant_factor_ = depth_bias_constant_factor;
       dynamic_depth_bias_slope_factor_ = depth_bias_slope_factor;
+
+      // Stencil masks and references.
+      // Due to pretty complex conditions involving registers not directly
+      // related to stencil (primitive type, culling), changing the values only
+      // when stencil is actually needed. However, due to the way dynamic state
+      // needs to be set in Vulkan, which doesn't take into account whether the
+      // state actually has effect on drawing, and because the masks and the
+      // references are always dynamic in Xenia guest pipelines, they must be
+      // set in the command buffer before any draw.
+      if (normalized_depth_control.stencil_enable) {
+        Register stencil_ref_mask_front_reg, stencil_ref_mask_back_reg;
+        if (primitive_polygonal && normalized_depth_control.backface_enable) {
+          if (GetVulkanProvider().device_info().separateStencilMaskRef) {
+            stencil_ref_mask_front_reg = XE_GPU_REG_RB_STENCILREFMASK;
+            stencil_ref_mask_back_reg = XE_GPU_REG_RB_STENCILREFMASK_BF;
+          } else {
+            // Choose the back face values only if drawing only back faces.
+            stencil_ref_mask_front_reg =
+                regs.Get<reg::PA_SU_SC_MODE_CNTL>().cull_front
+                    ? XE_GPU_REG_RB_STENCILREFMASK_BF
+                    : XE_GPU_REG_RB_STENCILREFMASK;
+            stencil_ref_mask_back_reg = stencil_ref_mask_front_reg;
+          }
+        } else {
+          stencil_ref_mask_front_reg = XE_GPU_REG_RB_STENCILREFMASK;
+          stencil_ref_mask_back_reg = XE_GPU_REG_RB_STENCILREFMASK;
+        }
+        auto stencil_ref_mask_front =
+            regs.Get<reg::RB_STENCILREFMASK>(stencil_ref_mask_front_reg);
+        auto stencil_ref_mask_back =
+            regs.Get<reg::RB_STENCILREFMASK>(stencil_ref_mask_back_reg);
+        // Compare mask.
+        dynamic_stencil_compare_mask_front_update_needed_ |=
+            dynamic_stencil_compare_mask_front_ !=
+            stencil_ref_mask_front.stencilmask;
+        dynamic_stencil_compare_mask_front_ =
+            stencil_ref_mask_front.stencilmask;
+        dynamic_stencil_compare_mask_back_update_needed_ |=
+            dynamic_stencil_compare_mask_back_ !=
+            stencil_ref_mask_back.stencilmask;
+        dynamic_stencil_compare_mask_back_ = stencil_ref_mask_back.stencilmask;
+        // Write mask.
+        dynamic_stencil_write_mask_front_update_needed_ |=
+            dynamic_stencil_write_mask_front_ !=
+            stencil_ref_mask_front.stencilwritemask;
+        dynamic_stencil_write_mask_front_ =
+            stencil_ref_mask_front.stencilwritemask;
+        dynamic_stencil_write_mask_back_update_needed_ |=
+            dynamic_stencil_write_mask_back_ !=
+            stencil_ref_mask_back.stencilwritemask;
+        dynamic_stencil_write_mask_back_ =
+            stencil_ref_mask_back.stencilwritemask;
+        // Reference.
+        dynamic_stencil_reference_front_update_needed_ |=
+            dynamic_stencil_reference_front_ !=
+            stencil_ref_mask_front.stencilref;
+        dynamic_stencil_reference_front_ = stencil_ref_mask_front.stencilref;
+        dynamic_stencil_reference_back_update_needed_ |=
+            dynamic_stencil_reference_back_ != stencil_ref_mask_back.stencilref;
+        dynamic_stencil_reference_back_ = stencil_ref_mask_back.stencilref;
+      }
+    }
+    if (dynamic_depth_bias_update_needed_) {
       deferred_command_buffer_.CmdVkSetDepthBias(
           dynamic_depth_bias_constant_factor_, 0.0f,
           dynamic_depth_bias_slope_factor_);
@@ -3356,78 +3453,24 @@ void VulkanCommandProcessor::UpdateDynamicState(
     }
 
     // Blend constants.
-    float blend_constants[] = {
-        regs.Get<float>(XE_GPU_REG_RB_BLEND_RED),
-        regs.Get<float>(XE_GPU_REG_RB_BLEND_GREEN),
-        regs.Get<float>(XE_GPU_REG_RB_BLEND_BLUE),
-        regs.Get<float>(XE_GPU_REG_RB_BLEND_ALPHA),
-    };
-    dynamic_blend_constants_update_needed_ |=
-        std::memcmp(dynamic_blend_constants_, blend_constants,
-                    sizeof(float) * 4) != 0;
+    if (regs.BeginGroupUpdate(RegisterFile::DirtyGroup::kBlendConstants)) {
+      float blend_constants[] = {
+          regs.Get<float>(XE_GPU_REG_RB_BLEND_RED),
+          regs.Get<float>(XE_GPU_REG_RB_BLEND_GREEN),
+          regs.Get<float>(XE_GPU_REG_RB_BLEND_BLUE),
+          regs.Get<float>(XE_GPU_REG_RB_BLEND_ALPHA),
+      };
+      dynamic_blend_constants_update_needed_ |=
+          std::memcmp(dynamic_blend_constants_, blend_constants,
+                      sizeof(float) * 4) != 0;
+      std::memcpy(dynamic_blend_constants_, blend_constants,
+                  sizeof(float) * 4);
+    }
     if (dynamic_blend_constants_update_needed_) {
-      std::memcpy(dynamic_blend_constants_, blend_constants, sizeof(float) * 4);
       deferred_command_buffer_.CmdVkSetBlendConstants(dynamic_blend_constants_);
       dynamic_blend_constants_update_needed_ = false;
     }
 
-    // Stencil masks and references.
-    // Due to pretty complex conditions involving registers not directly related
-    // to stencil (primitive type, culling), changing the values only when
-    // stencil is actually needed. However, due to the way dynamic state needs
-    // to be set in Vulkan, which doesn't take into account whether the state
-    // actually has effect on drawing, and because the masks and the references
-    // are always dynamic in Xenia guest pipelines, they must be set in the
-    // command buffer before any draw.
-    if (normalized_depth_control.stencil_enable) {
-      Register stencil_ref_mask_front_reg, stencil_ref_mask_back_reg;
-      if (primitive_polygonal && normalized_depth_control.backface_enable) {
-        if (GetVulkanProvider().device_info().separateStencilMaskRef) {
-          stencil_ref_mask_front_reg = XE_GPU_REG_RB_STENCILREFMASK;
-          stencil_ref_mask_back_reg = XE_GPU_REG_RB_STENCILREFMASK_BF;
-        } else {
-          // Choose the back face values only if drawing only back faces.
-          stencil_ref_mask_front_reg =
-              regs.Get<reg::PA_SU_SC_MODE_CNTL>().cull_front
-                  ? XE_GPU_REG_RB_STENCILREFMASK_BF
-                  : XE_GPU_REG_RB_STENCILREFMASK;
-          stencil_ref_mask_back_reg = stencil_ref_mask_front_reg;
-        }
-      } else {
-        stencil_ref_mask_front_reg = XE_GPU_REG_RB_STENCILREFMASK;
-        stencil_ref_mask_back_reg = XE_GPU_REG_RB_STENCILREFMASK;
-      }
-      auto stencil_ref_mask_front =
-          regs.Get<reg::RB_STENCILREFMASK>(stencil_ref_mask_front_reg);
-      auto stencil_ref_mask_back =
-          regs.Get<reg::RB_STENCILREFMASK>(stencil_ref_mask_back_reg);
-      // Compare mask.
-      dynamic_stencil_compare_mask_front_update_needed_ |=
-          dynamic_stencil_compare_mask_front_ !=
-          stencil_ref_mask_front.stencilmask;
-      dynamic_stencil_compare_mask_front_ = stencil_ref_mask_front.stencilmask;
-      dynamic_stencil_compare_mask_back_update_needed_ |=
-          dynamic_stencil_compare_mask_back_ !=
-          stencil_ref_mask_back.stencilmask;
-      dynamic_stencil_compare_mask_back_ = stencil_ref_mask_back.stencilmask;
-      // Write mask.
-      dynamic_stencil_write_mask_front_update_needed_ |=
-          dynamic_stencil_write_mask_front_ !=
-          stencil_ref_mask_front.stencilwritemask;
-      dynamic_stencil_write_mask_front_ =
-          stencil_ref_mask_front.stencilwritemask;
-      dynamic_stencil_write_mask_back_update_needed_ |=
-          dynamic_stencil_write_mask_back_ !=
-          stencil_ref_mask_back.stencilwritemask;
-      dynamic_stencil_write_mask_back_ = stencil_ref_mask_back.stencilwritemask;
-      // Reference.
-      dynamic_stencil_reference_front_update_needed_ |=
-          dynamic_stencil_reference_front_ != stencil_ref_mask_front.stencilref;
-      dynamic_stencil_reference_front_ = stencil_ref_mask_front.stencilref;
-      dynamic_stencil_reference_back_update_needed_ |=
-          dynamic_stencil_reference_back_ != stencil_ref_mask_back.stencilref;
-      dynamic_stencil_reference_back_ = stencil_ref_mask_back.stencilref;
-    }
     // Using VK_STENCIL_FACE_FRONT_AND_BACK for higher safety when running on
     // the Vulkan portability subset without separateStencilMaskRef.
     if (dynamic_stencil_compare_mask_front_update_needed_ ||
@@ -689,6 +689,15 @@ class VulkanCommandProcessor final : public CommandProcessor {
   bool dynamic_stencil_reference_front_update_needed_;
   bool dynamic_stencil_reference_back_update_needed_;
 
+  // Guest state derived from the registers for the previous draw, reused while
+  // the register file reports that the registers it depends on haven't
+  // changed.
+  draw_util::GetViewportInfoArgs previous_viewport_info_args_ = {};
+  draw_util::ViewportInfo previous_viewport_info_ = {};
+  draw_util::Scissor previous_scissor_;
+  bool previous_depth_stencil_primitive_polygonal_ = false;
+  reg::RB_DEPTHCONTROL previous_depth_stencil_normalized_depth_control_ = {};
+
   // Currently used samplers.
   std::vector<std::pair<VulkanTextureCache::SamplerParameters, VkSampler>>
       current_samplers_vertex_;
@@ -19,6 +19,7 @@
 
 #include "third_party/fmt/include/fmt/format.h"
 #include "xenia/base/assert.h"
+#include "xenia/base/cvar.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/math.h"
 #include "xenia/base/profiling.h"
@@ -34,6 +35,35 @@
 #include "xenia/gpu/xenos.h"
 #include "xenia/ui/vulkan/vulkan_util.h"
 
+DEFINE_bool(
+    vulkan_shader_optimization, false,
+    "Optimize translated shaders on a background thread using the SPIRV-Tools "
+    "library from the Vulkan SDK (located via the VULKAN_SDK environment "
+    "variable). Shaders are used unoptimized until their optimized versions "
+    "are ready, after which the pipelines using them are recreated.",
+    "Vulkan");
+DEFINE_string(
+    vulkan_shader_optimization_passes, "-O",
+    "SPIRV-Tools optimizer passes for vulkan_shader_optimization, as "
+    "space-separated spirv-opt command line flags, such as -O, -Os, or a list "
+    "of individual passes like \"--eliminate-dead-code-aggressive "
+    "--merge-blocks\".",
+    "Vulkan");
+DEFINE_int32(
+    vulkan_shader_translation_threads, -1,
+    "Number of threads used for translating shaders to SPIR-V. -1 to calculate "
+    "automatically (25% of logical CPU cores, at least 2), a positive number "
+    "to specify the number of threads explicitly (up to the number of logical "
+    "CPU cores), 0 to translate shaders on the command processor thread.",
+    "Vulkan");
+DEFINE_bool(
+    vulkan_async_shader_translation, false,
+    "Skip draws using shaders that are still being translated on the shader "
+    "translation threads instead of waiting for the translation. Reduces "
+    "stuttering when new shaders are encountered, but objects may be missing "
+    "for a few frames. Requires vulkan_shader_translation_threads.",
+    "Vulkan");
+
 namespace xe {
 namespace gpu {
 namespace vulkan {
@@ -58,11 +88,9 @@ bool VulkanPipelineCache::Initialize() {
       render_target_cache_.GetPath() ==
       RenderTargetCache::Path::kPixelShaderInterlock;
 
-  shader_translator_ = std::make_unique<SpirvShaderTranslator>(
-      SpirvShaderTranslator::Features(provider.device_info()),
-      render_target_cache_.msaa_2x_attachments_supported(),
-      render_target_cache_.msaa_2x_no_attachments_supported(),
-      edram_fragment_shader_interlock);
+  SpirvShaderTranslator::Features shader_translator_features(
+      provider.device_info());
+  shader_translator_ = CreateShaderTranslator();
 
   if (edram_fragment_shader_interlock) {
     std::vector<uint8_t> depth_only_fragment_shader_code =
@@ -81,6 +109,52 @@ bool VulkanPipelineCache::Initialize() {
     }
   }
 
+  if (cvars::vulkan_shader_optimization) {
+    spirv_tools_context_ = std::make_unique<ui::vulkan::SpirvToolsContext>();
+    if (spirv_tools_context_->Initialize(
+            shader_translator_features.spirv_version) &&
+        spirv_tools_context_->IsOptimizerAvailable()) {
+      shader_optimization_thread_shutdown_ = false;
+      shader_optimization_thread_ = xe::threading::Thread::Create(
+          {}, [this]() { ShaderOptimizationThread(); });
+      assert_not_null(shader_optimization_thread_);
+      shader_optimization_thread_->set_name("Vulkan Shader Optimization");
+    } else {
+      XELOGW(
+          "VulkanPipelineCache: The SPIRV-Tools optimizer is not available, "
+          "shaders won't be optimized");
+      spirv_tools_context_.reset();
+    }
+  }
+
+  if (cvars::vulkan_shader_translation_threads != 0) {
+    uint32_t logical_processor_count =
+        xe::threading::logical_processor_count();
+    if (!logical_processor_count) {
+      // Pick some reasonable amount if couldn't determine the number of cores.
+      logical_processor_count = 6;
+    }
+    size_t translation_thread_count;
+    if (cvars::vulkan_shader_translation_threads < 0) {
+      // At least one for each of the vertex and the pixel shader of a draw.
+      translation_thread_count =
+          std::max(logical_processor_count / 4, uint32_t(2));
+    } else {
+      translation_thread_count =
+          std::min(uint32_t(cvars::vulkan_shader_translation_threads),
+                   logical_processor_count);
+    }
+    shader_translation_threads_shutdown_ = false;
+    for (size_t i = 0; i < translation_thread_count; ++i) {
+      std::unique_ptr<xe::threading::Thread> translation_thread =
+          xe::threading::Thread::Create(
+              {}, [this]() { ShaderTranslationThread(); });
+      assert_not_null(translation_thread);
+      translation_thread->set_name("Vulkan Shader Translation");
+      shader_translation_threads_.push_back(std::move(translation_thread));
+    }
+  }
+
   return true;
 }
 
@@ -90,6 +164,39 @@ void VulkanPipelineCache::Shutdown() {
   const ui::vulkan::VulkanProvider::DeviceFunctions& dfn = provider.dfn();
   VkDevice device = provider.device();
 
+  // Stop shader translation (which may also request optimization) before
+  // destroying the translations.
+  if (!shader_translation_threads_.empty()) {
+    {
+      std::lock_guard<std::mutex> lock(shader_translation_lock_);
+      shader_translation_threads_shutdown_ = true;
+    }
+    shader_translation_request_cond_.notify_all();
+    for (const std::unique_ptr<xe::threading::Thread>& translation_thread :
+         shader_translation_threads_) {
+      xe::threading::Wait(translation_thread.get(), false);
+    }
+    shader_translation_threads_.clear();
+  }
+  shader_translation_queue_.clear();
+  shader_translations_pending_.clear();
+  shaders_translating_.clear();
+
+  // Stop shader optimization before destroying the translations referenced by
+  // the requests.
+  if (shader_optimization_thread_) {
+    {
+      std::lock_guard<std::mutex> lock(shader_optimization_lock_);
+      shader_optimization_thread_shutdown_ = true;
+    }
+    shader_optimization_cond_.notify_all();
+    xe::threading::Wait(shader_optimization_thread_.get(), false);
+    shader_optimization_thread_.reset();
+  }
+  shader_optimization_requests_.clear();
+  shader_optimization_results_.clear();
+  spirv_tools_context_.reset();
+
   // Destroy all pipelines.
   last_pipeline_ = nullptr;
   for (const auto& pipeline_pair : pipelines_) {
@@ -98,6 +205,10 @@ void VulkanPipelineCache::Shutdown() {
     }
   }
   pipelines_.clear();
+  for (const auto& retired_pipeline : retired_pipelines_) {
+    dfn.vkDestroyPipeline(device, retired_pipeline.first, nullptr);
+  }
+  retired_pipelines_.clear();
 
   // Destroy all internal shaders.
   ui::vulkan::util::DestroyAndNullHandle(dfn.vkDestroyShaderModule, device,
@@ -121,6 +232,60 @@ void VulkanPipelineCache::Shutdown() {
   shader_translator_.reset();
 }
 
+void VulkanPipelineCache::CompletedSubmissionUpdated() {
+  const ui::vulkan::VulkanProvider& provider =
+      command_processor_.GetVulkanProvider();
+  const ui::vulkan::VulkanProvider::DeviceFunctions& dfn = provider.dfn();
+  VkDevice device = provider.device();
+
+  uint64_t submission_completed = command_processor_.GetCompletedSubmission();
+  while (!retired_pipelines_.empty() &&
+         retired_pipelines_.front().second <= submission_completed) {
+    dfn.vkDestroyPipeline(device, retired_pipelines_.front().first, nullptr);
+    retired_pipelines_.pop_front();
+  }
+
+  if (!shader_optimization_thread_) {
+    return;
+  }
+  std::deque<ShaderOptimizationRequest> optimized_shaders;
+  {
+    std::lock_guard<std::mutex> lock(shader_optimization_lock_);
+    optimized_shaders.swap(shader_optimization_results_);
+  }
+  for (const ShaderOptimizationRequest& optimized_shader : optimized_shaders) {
+    VkShaderModule shader_module = ui::vulkan::util::CreateShaderModule(
+        provider, optimized_shader.spirv.data(),
+        sizeof(uint32_t) * optimized_shader.spirv.size());
+    if (shader_module == VK_NULL_HANDLE) {
+      // Keep using the unoptimized shader.
+      continue;
+    }
+    VulkanShader::VulkanTranslation& translation =
+        *optimized_shader.translation;
+    translation.ReplaceShaderModule(shader_module);
+    // Recreate the pipelines using the shader when they're needed next time.
+    uint64_t shader_hash = translation.shader().ucode_data_hash();
+    uint64_t shader_modification = translation.modification();
+    bool is_vertex_shader =
+        translation.shader().type() == xenos::ShaderType::kVertex;
+    for (auto& pipeline_pair : pipelines_) {
+      const PipelineDescription& description = pipeline_pair.first;
+      if (is_vertex_shader
+              ? (description.vertex_shader_hash == shader_hash &&
+                 description.vertex_shader_modification == shader_modification)
+              : (description.pixel_shader_hash == shader_hash &&
+                 description.pixel_shader_modification ==
+                     shader_modification)) {
+        pipeline_pair.second.shaders_outdated = true;
+      }
+    }
+  }
+  if (!optimized_shaders.empty()) {
+    last_pipeline_ = nullptr;
+  }
+}
+
 VulkanShader* VulkanPipelineCache::LoadShader(xenos::ShaderType shader_type,
                                               const uint32_t* host_address,
                                               uint32_t dword_count) {
@@ -225,40 +390,121 @@ VulkanPipelineCache::GetCurrentPixelShaderModification(
 
 bool VulkanPipelineCache::EnsureShadersTranslated(
     VulkanShader::VulkanTranslation* vertex_shader,
-    VulkanShader::VulkanTranslation* pixel_shader) {
+    VulkanShader::VulkanTranslation* pixel_shader,
+    bool* translation_pending_out) {
   // Edge flags are not supported yet (because polygon primitives are not).
   assert_true(register_file_.Get<reg::SQ_PROGRAM_CNTL>().vs_export_mode !=
                   xenos::VertexShaderExportMode::kPosition2VectorsEdge &&
               register_file_.Get<reg::SQ_PROGRAM_CNTL>().vs_export_mode !=
                   xenos::VertexShaderExportMode::kPosition2VectorsEdgeKill);
   assert_false(register_file_.Get<reg::SQ_PROGRAM_CNTL>().gen_index_vtx);
-  if (!vertex_shader->is_translated()) {
-    vertex_shader->shader().AnalyzeUcode(ucode_disasm_buffer_);
-    if (!TranslateAnalyzedShader(*shader_translator_, *vertex_shader)) {
-      XELOGE("Failed to translate the vertex shader!");
-      return false;
+  if (translation_pending_out) {
+    *translation_pending_out = false;
+  }
+  if (shader_translation_threads_.empty()) {
+    if (!vertex_shader->is_translated()) {
+      vertex_shader->shader().AnalyzeUcode(ucode_disasm_buffer_);
+      if (!TranslateAnalyzedShader(*shader_translator_, *vertex_shader)) {
+        XELOGE("Failed to translate the vertex shader!");
+        return false;
+      }
     }
-  }
-  if (!vertex_shader->is_valid()) {
-    // Translation attempted previously, but not valid.
-    return false;
-  }
-  if (pixel_shader != nullptr) {
-    if (!pixel_shader->is_translated()) {
+    if (pixel_shader != nullptr && !pixel_shader->is_translated()) {
       pixel_shader->shader().AnalyzeUcode(ucode_disasm_buffer_);
       if (!TranslateAnalyzedShader(*shader_translator_, *pixel_shader)) {
         XELOGE("Failed to translate the pixel shader!");
         return false;
       }
     }
-    if (!pixel_shader->is_valid()) {
-      // Translation attempted previously, but not valid.
-      return false;
+  } else {
+    VulkanShader::VulkanTranslation* const translations[] = {vertex_shader,
+                                                             pixel_shader};
+    std::unique_lock<std::mutex> lock(shader_translation_lock_);
+    bool translations_queued = false;
+    for (VulkanShader::VulkanTranslation* translation : translations) {
+      // is_translated is only modified by the translation threads while the
+      // translation is pending.
+      if (!translation || shader_translations_pending_.count(translation) ||
+          translation->is_translated()) {
+        continue;
+      }
+      // Analysis is not thread-safe, do it on this thread.
+      translation->shader().AnalyzeUcode(ucode_disasm_buffer_);
+      shader_translations_pending_.insert(translation);
+      ++shaders_translating_[&translation->shader()];
+      shader_translation_queue_.push_back(translation);
+      translations_queued = true;
+    }
+    if (translations_queued) {
+      shader_translation_request_cond_.notify_all();
+    }
+    auto translations_complete = [this, &translations]() {
+      for (const VulkanShader::VulkanTranslation* translation : translations) {
+        if (translation && !IsShaderTranslationComplete(translation)) {
+          return false;
+        }
+      }
+      return true;
+    };
+    if (!translations_complete()) {
+      if (translation_pending_out &&
+          cvars::vulkan_async_shader_translation) {
+        *translation_pending_out = true;
+        return true;
+      }
+      SCOPE_profile_cpu_i("gpu", "WaitForShaderTranslation");
+      shader_translation_completion_cond_.wait(lock, translations_complete);
     }
   }
+  // Translation attempted previously, but not valid.
+  if (!vertex_shader->is_valid()) {
+    return false;
+  }
+  if (pixel_shader != nullptr && !pixel_shader->is_valid()) {
+    return false;
+  }
   return true;
 }
 
+bool VulkanPipelineCache::IsShaderTranslationComplete(
+    const VulkanShader::VulkanTranslation* translation) const {
+  return !shader_translations_pending_.count(translation) &&
+         !shaders_translating_.count(&translation->shader());
+}
+
+void VulkanPipelineCache::ShaderTranslationThread() {
+  std::unique_ptr<SpirvShaderTranslator> translator = CreateShaderTranslator();
+  while (true) {
+    VulkanShader::VulkanTranslation* translation;
+    {
+      std::unique_lock<std::mutex> lock(shader_translation_lock_);
+      shader_translation_request_cond_.wait(lock, [this]() {
+        return shader_translation_threads_shutdown_ ||
+               !shader_translation_queue_.empty();
+      });
+      if (shader_translation_threads_shutdown_) {
+        return;
+      }
+      translation = shader_translation_queue_.front();
+      shader_translation_queue_.pop_front();
+    }
+
+    // Failures are logged, and the translation is marked as invalid.
+    TranslateAnalyzedShader(*translator, *translation);
+
+    {
+      std::lock_guard<std::mutex> lock(shader_translation_lock_);
+      shader_translations_pending_.erase(translation);
+      auto shader_it = shaders_translating_.find(&translation->shader());
+      assert_true(shader_it != shaders_translating_.end());
+      if (!--shader_it->second) {
+        shaders_translating_.erase(shader_it);
+      }
+    }
+    shader_translation_completion_cond_.notify_all();
+  }
+}
+
 bool VulkanPipelineCache::ConfigurePipeline(
     VulkanShader::VulkanTranslation* vertex_shader,
     VulkanShader::VulkanTranslation* pixel_shader,
@@ -290,7 +536,7 @@ bool VulkanPipelineCache::ConfigurePipeline(
     return true;
   }
   auto it = pipelines_.find(description);
-  if (it != pipelines_.end()) {
+  if (it != pipelines_.end() && !it->second.shaders_outdated) {
     last_pipeline_ = &*it;
     pipeline_out = it->second.pipeline;
     pipeline_layout_out = it->second.pipeline_layout;
@@ -342,21 +588,49 @@ bool VulkanPipelineCache::ConfigurePipeline(
     return false;
   }
   PipelineCreationArguments creation_arguments;
+  // If recreating the pipeline with optimized shaders, keep the previous one
+  // in case of a failure.
+  VkPipeline outdated_pipeline = VK_NULL_HANDLE;
+  if (it != pipelines_.end()) {
+    outdated_pipeline = it->second.pipeline;
+    it->second.pipeline = VK_NULL_HANDLE;
+    it->second.shaders_outdated = false;
+  }
   auto& pipeline =
-      *pipelines_.emplace(description, Pipeline(pipeline_layout)).first;
+      it != pipelines_.end()
+          ? *it
+          : *pipelines_.emplace(description, Pipeline(pipeline_layout)).first;
   creation_arguments.pipeline = &pipeline;
   creation_arguments.vertex_shader = vertex_shader;
   creation_arguments.pixel_shader = pixel_shader;
   creation_arguments.geometry_shader = geometry_shader;
   creation_arguments.render_pass = render_pass;
   if (!EnsurePipelineCreated(creation_arguments)) {
-    return false;
+    if (outdated_pipeline == VK_NULL_HANDLE) {
+      return false;
+    }
+    pipeline.second.pipeline = outdated_pipeline;
+  } else if (outdated_pipeline != VK_NULL_HANDLE) {
+    // May still be used by submissions in flight.
+    retired_pipelines_.emplace_back(outdated_pipeline,
+                                    command_processor_.GetCurrentSubmission());
   }
   pipeline_out = pipeline.second.pipeline;
   pipeline_layout_out = pipeline_layout;
   return true;
 }
 
+std::unique_ptr<SpirvShaderTranslator>
+VulkanPipelineCache::CreateShaderTranslator() const {
+  return std::make_unique<SpirvShaderTranslator>(
+      SpirvShaderTranslator::Features(
+          command_processor_.GetVulkanProvider().device_info()),
+      render_target_cache_.msaa_2x_attachments_supported(),
+      render_target_cache_.msaa_2x_no_attachments_supported(),
+      render_target_cache_.GetPath() ==
+          RenderTargetCache::Path::kPixelShaderInterlock);
+}
+
 bool VulkanPipelineCache::TranslateAnalyzedShader(
     SpirvShaderTranslator& translator,
     VulkanShader::VulkanTranslation& translation) {
@@ -373,10 +647,28 @@ bool VulkanPipelineCache::TranslateAnalyzedShader(
     return false;
   }
 
+  // Use the unoptimized shader until the optimized version is ready.
+  if (shader_optimization_thread_) {
+    const std::vector<uint8_t>& translated_binary =
+        translation.translated_binary();
+    ShaderOptimizationRequest request;
+    request.translation = &translation;
+    request.spirv.resize(translated_binary.size() / sizeof(uint32_t));
+    std::memcpy(request.spirv.data(), translated_binary.data(),
+                sizeof(uint32_t) * request.spirv.size());
+    {
+      std::lock_guard<std::mutex> lock(shader_optimization_lock_);
+      shader_optimization_requests_.push_back(std::move(request));
+    }
+    shader_optimization_cond_.notify_one();
+  }
+
   // TODO(Triang3l): Log that the shader has been successfully translated in
   // common code.
 
-  // Set up the texture binding layout.
+  // Set up the texture binding layout. Translations of the same shader may be
+  // done on different threads.
+  std::lock_guard<std::mutex> layouts_lock(layouts_mutex_);
   if (shader.EnterBindingLayoutUserUIDSetup()) {
     // Obtain the unique IDs of the binding layout if there are any texture
     // bindings, for invalidation in the command processor.
@@ -436,6 +728,51 @@ bool VulkanPipelineCache::TranslateAnalyzedShader(
   return true;
 }
 
+void VulkanPipelineCache::ShaderOptimizationThread() {
+  while (true) {
+    ShaderOptimizationRequest request;
+    {
+      std::unique_lock<std::mutex> lock(shader_optimization_lock_);
+      shader_optimization_cond_.wait(lock, [this]() {
+        return shader_optimization_thread_shutdown_ ||
+               !shader_optimization_requests_.empty();
+      });
+      if (shader_optimization_thread_shutdown_) {
+        return;
+      }
+      request = std::move(shader_optimization_requests_.front());
+      shader_optimization_requests_.pop_front();
+    }
+
+    std::vector<uint32_t> optimized_spirv;
+    spv_result_t result = spirv_tools_context_->Optimize(
+        request.spirv.data(), request.spirv.size(),
+        cvars::vulkan_shader_optimization_passes, optimized_spirv);
+    if (result != SPV_SUCCESS || optimized_spirv.empty()) {
+      XELOGW(
+          "VulkanPipelineCache: Failed to optimize shader {:016X} modification "
+          "{:016X} (error {}), keeping the unoptimized version",
+          request.translation->shader().ucode_data_hash(),
+          request.translation->modification(), int(result));
+      continue;
+    }
+    XELOGGPU(
+        "Optimized shader {:016X} modification {:016X}: {} -> {} instructions",
+        request.translation->shader().ucode_data_hash(),
+        request.translation->modification(),
+        ui::vulkan::SpirvToolsContext::CountInstructions(request.spirv.data(),
+                                                         request.spirv.size()),
+        ui::vulkan::SpirvToolsContext::CountInstructions(
+            optimized_spirv.data(), optimized_spirv.size()));
+    request.spirv = std::move(optimized_spirv);
+
+    {
+      std::lock_guard<std::mutex> lock(shader_optimization_lock_);
+      shader_optimization_results_.push_back(std::move(request));
+    }
+  }
+}
+
 void VulkanPipelineCache::WritePipelineRenderTargetDescription(
     reg::RB_BLENDCONTROL blend_control, uint32_t write_mask,
     PipelineRenderTarget& render_target_out) const {
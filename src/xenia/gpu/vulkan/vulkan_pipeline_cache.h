@@ -10,15 +10,21 @@
 #ifndef XENIA_GPU_VULKAN_VULKAN_PIPELINE_STATE_CACHE_H_
 #define XENIA_GPU_VULKAN_VULKAN_PIPELINE_STATE_CACHE_H_
 
+#include <condition_variable>
 #include <cstddef>
 #include <cstring>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "xenia/base/hash.h"
 #include "xenia/base/platform.h"
+#include "xenia/base/threading.h"
 #include "xenia/base/xxhash.h"
 #include "xenia/gpu/primitive_processor.h"
 #include "xenia/gpu/register_file.h"
@@ -27,6 +33,7 @@
 #include "xenia/gpu/vulkan/vulkan_render_target_cache.h"
 #include "xenia/gpu/vulkan/vulkan_shader.h"
 #include "xenia/gpu/xenos.h"
+#include "xenia/ui/vulkan/spirv_tools_context.h"
 #include "xenia/ui/vulkan/vulkan_provider.h"
 
 namespace xe {
@@ -59,6 +66,10 @@ class VulkanPipelineCache {
   bool Initialize();
   void Shutdown();
 
+  // Destroys pipelines replaced with ones using optimized shaders that are not
+  // used anymore, and switches to shaders optimized in the background.
+  void CompletedSubmissionUpdated();
+
   VulkanShader* LoadShader(xenos::ShaderType shader_type,
                            const uint32_t* host_address, uint32_t dword_count);
   // Analyze shader microcode on the translator thread.
@@ -76,8 +87,13 @@ class VulkanPipelineCache {
       const Shader& shader, uint32_t interpolator_mask,
       uint32_t param_gen_pos) const;
 
+  // With translation threads, the shaders are translated in parallel. If
+  // translation_pending_out is not null and asynchronous translation is
+  // enabled, returns true without waiting and sets it to true if the shaders
+  // are still being translated, so the draw can be skipped.
   bool EnsureShadersTranslated(VulkanShader::VulkanTranslation* vertex_shader,
-                               VulkanShader::VulkanTranslation* pixel_shader);
+                               VulkanShader::VulkanTranslation* pixel_shader,
+                               bool* translation_pending_out = nullptr);
   // TODO(Triang3l): Return a deferred creation handle.
   bool ConfigurePipeline(
       VulkanShader::VulkanTranslation* vertex_shader,
@@ -205,6 +221,9 @@ class VulkanPipelineCache {
     // The layouts are owned by the VulkanCommandProcessor, and must not be
     // destroyed by it while the pipeline cache is active.
     const PipelineLayoutProvider* pipeline_layout;
+    // An optimized version of one of the shaders has become available since
+    // the creation, the pipeline needs to be recreated on the next use.
+    bool shaders_outdated = false;
     Pipeline(const PipelineLayoutProvider* pipeline_layout_provider)
         : pipeline_layout(pipeline_layout_provider) {}
   };
@@ -246,10 +265,26 @@ class VulkanPipelineCache {
     }
   };
 
+  std::unique_ptr<SpirvShaderTranslator> CreateShaderTranslator() const;
+
   // Can be called from multiple threads.
   bool TranslateAnalyzedShader(SpirvShaderTranslator& translator,
                                VulkanShader::VulkanTranslation& translation);
 
+  void ShaderTranslationThread();
+  // Whether the translation is done, and the bindings of its shader are
+  // available (no other modification of the shader, which may be setting them
+  // up, is being translated). Must be called with shader_translation_lock_.
+  bool IsShaderTranslationComplete(
+      const VulkanShader::VulkanTranslation* translation) const;
+
+  struct ShaderOptimizationRequest {
+    VulkanShader::VulkanTranslation* translation;
+    // The translated code for requests, the optimized code for results.
+    std::vector<uint32_t> spirv;
+  };
+  void ShaderOptimizationThread();
+
   void WritePipelineRenderTargetDescription(
       reg::RB_BLENDCONTROL blend_control, uint32_t write_mask,
       PipelineRenderTarget& render_target_out) const;
@@ -288,6 +323,24 @@ class VulkanPipelineCache {
   // Reusable shader translator on the command processor thread.
   std::unique_ptr<SpirvShaderTranslator> shader_translator_;
 
+  // Translation of shaders on multiple threads, each with its own translator.
+  std::mutex shader_translation_lock_;
+  // Notify_all when translations are queued and on shutdown.
+  std::condition_variable shader_translation_request_cond_;
+  // Notify_all when translations are completed.
+  std::condition_variable shader_translation_completion_cond_;
+  // Protected with shader_translation_lock_.
+  std::deque<VulkanShader::VulkanTranslation*> shader_translation_queue_;
+  // Queued or being translated, protected with shader_translation_lock_.
+  std::unordered_set<const VulkanShader::VulkanTranslation*>
+      shader_translations_pending_;
+  // Number of pending translations of each shader, protected with
+  // shader_translation_lock_.
+  std::unordered_map<const Shader*, uint32_t> shaders_translating_;
+  bool shader_translation_threads_shutdown_ = false;
+  std::vector<std::unique_ptr<xe::threading::Thread>>
+      shader_translation_threads_;
+
   struct LayoutUID {
     size_t uid;
     size_t vector_span_offset;
@@ -324,6 +377,22 @@ class VulkanPipelineCache {
   // Previously used pipeline, to avoid lookups if the state wasn't changed.
   const std::pair<const PipelineDescription, Pipeline>* last_pipeline_ =
       nullptr;
+
+  // Pipelines replaced with ones using optimized shaders, with the submission
+  // in which they were last used.
+  std::deque<std::pair<VkPipeline, uint64_t>> retired_pipelines_;
+
+  // Background optimization of translated shaders, which are used unoptimized
+  // until the optimized version is ready.
+  std::unique_ptr<ui::vulkan::SpirvToolsContext> spirv_tools_context_;
+  std::mutex shader_optimization_lock_;
+  std::condition_variable shader_optimization_cond_;
+  // Protected with shader_optimization_lock_, notify_one
+  // shader_optimization_cond_ when pushing requests.
+  std::deque<ShaderOptimizationRequest> shader_optimization_requests_;
+  std::deque<ShaderOptimizationRequest> shader_optimization_results_;
+  bool shader_optimization_thread_shutdown_ = false;
+  std::unique_ptr<xe::threading::Thread> shader_optimization_thread_;
 };
 
 }  // namespace vulkan
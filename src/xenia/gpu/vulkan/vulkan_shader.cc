@@ -56,6 +56,17 @@ VkShaderModule VulkanShader::VulkanTranslation::GetOrCreateShaderModule() {
   return shader_module_;
 }
 
+void VulkanShader::VulkanTranslation::ReplaceShaderModule(
+    VkShaderModule shader_module) {
+  if (shader_module_) {
+    const ui::vulkan::VulkanProvider& provider =
+        static_cast<const VulkanShader&>(shader()).provider_;
+    provider.dfn().vkDestroyShaderModule(provider.device(), shader_module_,
+                                         nullptr);
+  }
+  shader_module_ = shader_module;
+}
+
 VulkanShader::VulkanShader(const ui::vulkan::VulkanProvider& provider,
                            xenos::ShaderType shader_type,
                            uint64_t ucode_data_hash,
@@ -30,6 +30,10 @@ class VulkanShader : public SpirvShader {
 
     VkShaderModule GetOrCreateShaderModule();
     VkShaderModule shader_module() const { return shader_module_; }
+    // Replaces the module created from the translated binary (such as with an
+    // optimized version), destroying the previous one. Pipelines already
+    // created with the previous module stay usable.
+    void ReplaceShaderModule(VkShaderModule shader_module);
 
    private:
     VkShaderModule shader_module_ = VK_NULL_HANDLE;
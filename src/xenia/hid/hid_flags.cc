@@ -11,3 +11,7 @@
 
 DEFINE_bool(guide_button, true, "Forward guide button presses to guest.",
             "HID");
+DEFINE_bool(hid_log_input_latency, false,
+            "Log the distribution of the time between receiving input events "
+            "from the host and the guest reading them on shutdown.",
+            "HID");
@@ -13,5 +13,6 @@
 #include "xenia/base/cvar.h"
 
 DECLARE_bool(guide_button);
+DECLARE_bool(hid_log_input_latency);
 
 #endif  // XENIA_HID_HID_FLAGS_H_
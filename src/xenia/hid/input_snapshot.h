@@ -0,0 +1,130 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_HID_INPUT_SNAPSHOT_H_
+#define XENIA_HID_INPUT_SNAPSHOT_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "xenia/base/clock.h"
+#include "xenia/base/logging.h"
+
+namespace xe {
+namespace hid {
+
+// Latest value of a plain structure (possibly with endian_store fields, which
+// can be copied with memcpy), published by one writer thread and read by any
+// number of threads without locking (a sequence lock). Readers never block the
+// writer, and retry if the value was being modified while they were copying
+// it.
+//
+// The value is stored as relaxed atomic words so torn copies, which are
+// discarded, are not data races.
+template <typename T>
+class InputSnapshot {
+  static_assert(std::is_standard_layout_v<T> &&
+                std::is_trivially_destructible_v<T>);
+  static_assert(sizeof(T) % sizeof(uint32_t) == 0);
+
+ public:
+  InputSnapshot() { Publish(T()); }
+
+  // Must not be called concurrently with itself.
+  void Publish(const T& value) {
+    uint32_t words[kWordCount];
+    std::memcpy(words, &value, sizeof(T));
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    // Odd while writing.
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWordCount; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  T Read() const {
+    uint32_t words[kWordCount];
+    while (true) {
+      uint32_t sequence = sequence_.load(std::memory_order_acquire);
+      if (sequence & 1) {
+        continue;
+      }
+      for (size_t i = 0; i < kWordCount; ++i) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence) {
+        break;
+      }
+    }
+    T value;
+    std::memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+ private:
+  static constexpr size_t kWordCount = sizeof(T) / sizeof(uint32_t);
+
+  std::atomic<uint32_t> sequence_{0};
+  std::array<std::atomic<uint32_t>, kWordCount> words_;
+};
+
+// Distribution of the time between an input event being received from the
+// host and the guest reading the state containing it, in power of two
+// microsecond buckets.
+class InputLatencyHistogram {
+ public:
+  void Record(uint64_t event_host_tick_count) {
+    uint64_t ticks = Clock::QueryHostTickCount() - event_host_tick_count;
+    uint64_t microseconds = ticks * 1000000 / Clock::QueryHostTickFrequency();
+    size_t bucket = 0;
+    while (bucket + 1 < kBucketCount &&
+           (uint64_t(1) << bucket) <= microseconds) {
+      ++bucket;
+    }
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void Log(std::string_view name) const {
+    uint64_t total = 0;
+    for (const auto& bucket : buckets_) {
+      total += bucket.load(std::memory_order_relaxed);
+    }
+    if (!total) {
+      return;
+    }
+    XELOGI("{} input latency, {} reads:", name, total);
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      uint64_t count = buckets_[i].load(std::memory_order_relaxed);
+      if (!count) {
+        continue;
+      }
+      XELOGI("  {} {} us: {} ({:.1f}%)", i + 1 < kBucketCount ? "<" : ">=",
+             uint64_t(1) << (i + 1 < kBucketCount ? i : i - 1), count,
+             double(count) * 100.0 / double(total));
+    }
+  }
+
+ private:
+  // Up to about 1 second, the last bucket also receives everything longer.
+  static constexpr size_t kBucketCount = 21;
+
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets_ = {};
+};
+
+}  // namespace hid
+}  // namespace xe
+
+#endif  // XENIA_HID_INPUT_SNAPSHOT_H_
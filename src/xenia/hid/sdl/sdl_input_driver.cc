@@ -9,7 +9,9 @@
 
 #include "xenia/hid/sdl/sdl_input_driver.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 
 #if XE_PLATFORM_WIN32
 #include "xenia/base/platform_win.h"
@@ -28,6 +30,10 @@
 DEFINE_path(mappings_file, "gamecontrollerdb.txt",
             "Filename of a database with custom game controller mappings.",
             "SDL");
+DEFINE_uint32(sdl_input_poll_rate, 500,
+              "Rate in Hz at which SDL controller events are pumped. 0 to pump "
+              "them whenever the guest reads the controller state instead.",
+              "SDL");
 
 namespace xe {
 namespace hid {
@@ -43,6 +49,14 @@ SDLInputDriver::SDLInputDriver(xe::ui::Window* window, size_t window_z_order)
       keystroke_states_() {}
 
 SDLInputDriver::~SDLInputDriver() {
+  if (poll_thread_) {
+    poll_thread_shutdown_event_->Set();
+    xe::threading::Wait(poll_thread_.get(), false);
+    poll_thread_.reset();
+  }
+  if (cvars::hid_log_input_latency) {
+    latency_histogram_.Log("SDL");
+  }
   // Make sure the CallInUIThread is executed before destroying the references.
   if (sdl_pumpevents_queued_) {
     window()->app_context().CallInUIThreadSynchronous([this]() {
@@ -117,9 +131,23 @@ X_STATUS SDLInputDriver::Setup() {
     LoadGameControllerDB();
   });
 
-  return (sdl_events_initialized_ && sdl_gamecontroller_initialized_)
-             ? X_STATUS_SUCCESS
-             : X_STATUS_UNSUCCESSFUL;
+  if (!sdl_events_initialized_ || !sdl_gamecontroller_initialized_) {
+    return X_STATUS_UNSUCCESSFUL;
+  }
+
+  if (cvars::sdl_input_poll_rate) {
+    poll_thread_shutdown_event_ =
+        xe::threading::Event::CreateManualResetEvent(false);
+    poll_thread_ =
+        xe::threading::Thread::Create({}, [this]() { PollThread(); });
+    if (poll_thread_) {
+      poll_thread_->set_name("SDL Input Poll");
+    } else {
+      XELOGW("SDL: Failed to create the input polling thread");
+    }
+  }
+
+  return X_STATUS_SUCCESS;
 }
 
 void SDLInputDriver::LoadGameControllerDB() {
@@ -223,26 +251,36 @@ X_RESULT SDLInputDriver::GetState(uint32_t user_index,
 
   auto is_active = this->is_active();
 
-  if (is_active) {
+  if (is_active && !poll_thread_) {
     QueueControllerUpdate();
   }
 
-  auto controller = GetControllerState(user_index);
-  if (!controller) {
+  // Only the published snapshot is read here, so frequent calls don't contend
+  // with the event handling.
+  const ControllerSnapshot snapshot = controller_snapshots_[user_index].Read();
+  if (!snapshot.connected) {
     return X_ERROR_DEVICE_NOT_CONNECTED;
   }
 
   // Make sure packet_number is only incremented by 1, even if there have been
   // multiple updates between GetState calls. Also track `is_active` to
   // increment the packet number if it changed.
-  if ((is_active != controller->is_active) ||
-      (is_active && controller->state_changed)) {
-    controller->state.packet_number++;
-    controller->is_active = is_active;
-    controller->state_changed = false;
-  }
-  std::memcpy(out_state, &controller->state, sizeof(*out_state));
-  if (!is_active) {
+  ReaderState& reader = reader_states_[user_index];
+  bool state_changed = snapshot.change_count != reader.change_count;
+  if ((is_active != reader.is_active) || (is_active && state_changed)) {
+    reader.packet_number++;
+    reader.is_active = is_active;
+    if (state_changed) {
+      reader.change_count = snapshot.change_count;
+      if (cvars::hid_log_input_latency) {
+        latency_histogram_.Record(snapshot.event_host_tick_count);
+      }
+    }
+  }
+  out_state->packet_number = reader.packet_number;
+  if (is_active) {
+    out_state->gamepad = snapshot.gamepad;
+  } else {
     // Simulate an "untouched" controller. When we become active again the
     // pressed buttons aren't lost and will be visible again.
     std::memset(&out_state->gamepad, 0, sizeof(out_state->gamepad));
@@ -336,14 +374,15 @@ X_RESULT SDLInputDriver::GetKeystroke(uint32_t users, uint32_t flags,
 
   auto is_active = this->is_active();
 
-  if (is_active) {
+  if (is_active && !poll_thread_) {
     QueueControllerUpdate();
   }
 
   for (uint32_t user_index = (user_any ? 0 : users);
        user_index < (user_any ? HID_SDL_USER_COUNT : users + 1); user_index++) {
-    auto controller = GetControllerState(user_index);
-    if (!controller) {
+    const ControllerSnapshot snapshot =
+        controller_snapshots_[user_index].Read();
+    if (!snapshot.connected) {
       if (user_any) {
         continue;
       } else {
@@ -355,8 +394,8 @@ X_RESULT SDLInputDriver::GetKeystroke(uint32_t users, uint32_t flags,
     // "unpressed". The algorithm will automatically send UP events when
     // `is_active()` goes low and DOWN events when it goes high again.
     const uint64_t curr_butts =
-        is_active ? (controller->state.gamepad.buttons |
-                     AnalogToKeyfield(controller->state.gamepad))
+        is_active ? (snapshot.gamepad.buttons |
+                     AnalogToKeyfield(snapshot.gamepad))
                   : uint64_t(0);
     KeystrokeState& last = keystroke_states_.at(user_index);
 
@@ -525,9 +564,10 @@ void SDLInputDriver::OnControllerDeviceAdded(const SDL_Event& event) {
   if (user_id >= 0) {
     auto& state = controllers_.at(user_id);
     state = {controller, {}};
-    // XInput seems to start with packet_number = 1 .
-    state.state_changed = true;
     UpdateXCapabilities(state);
+    // XInput seems to start with packet_number = 1, publishing the new
+    // controller counts as a change.
+    PublishControllerState(user_id);
 
     XELOGI("SDL OnControllerDeviceAdded: Added at index {}.", user_id);
     XELOGI("SDL Controller {}: {}", user_id,
@@ -546,6 +586,7 @@ void SDLInputDriver::OnControllerDeviceRemoved(const SDL_Event& event) {
     SDL_GameControllerClose(controllers_.at(*idx).sdl);
     controllers_.at(*idx) = {};
     keystroke_states_.at(*idx) = {};
+    PublishControllerState(*idx);
     XELOGI("SDL OnControllerDeviceRemoved: Removed at player index {}.", *idx);
   } else {
     // Can happen in case all slots where full previously.
@@ -580,7 +621,7 @@ void SDLInputDriver::OnControllerDeviceAxisMotion(const SDL_Event& event) {
       assert_always();
       break;
   }
-  controllers_.at(*idx).state_changed = true;
+  PublishControllerState(*idx);
 }
 
 void SDLInputDriver::OnControllerDeviceButtonChanged(const SDL_Event& event) {
@@ -642,7 +683,7 @@ void SDLInputDriver::OnControllerDeviceButtonChanged(const SDL_Event& event) {
     xbuttons &= ~xbutton;
   }
   controller.state.gamepad.buttons = xbuttons;
-  controller.state_changed = true;
+  PublishControllerState(*idx);
 }
 
 std::optional<size_t> SDLInputDriver::GetControllerIndexFromInstanceID(
@@ -746,6 +787,17 @@ void SDLInputDriver::UpdateXCapabilities(ControllerState& state) {
   c.vibration.right_motor_speed = 0xFFFFu;
 }
 
+void SDLInputDriver::PublishControllerState(size_t user_index) {
+  // Called from the event watch, which SDL doesn't run concurrently.
+  const ControllerState& controller = controllers_.at(user_index);
+  ControllerSnapshot snapshot = {};
+  snapshot.gamepad = controller.state.gamepad;
+  snapshot.connected = controller.sdl != nullptr;
+  snapshot.change_count = ++controller_change_counts_.at(user_index);
+  snapshot.event_host_tick_count = Clock::QueryHostTickCount();
+  controller_snapshots_.at(user_index).Publish(snapshot);
+}
+
 void SDLInputDriver::QueueControllerUpdate() {
   // To minimize consecutive event pumps do not queue before previous pump is
   // finished.
@@ -759,6 +811,17 @@ void SDLInputDriver::QueueControllerUpdate() {
   }
 }
 
+void SDLInputDriver::PollThread() {
+  // SDL_PumpEvents must be called on the UI thread, this thread only requests
+  // it so the guest threads calling GetState don't have to.
+  auto interval = std::chrono::milliseconds(
+      std::max(uint32_t(1000) / cvars::sdl_input_poll_rate, uint32_t(1)));
+  while (xe::threading::Wait(poll_thread_shutdown_event_.get(), false,
+                             interval) == xe::threading::WaitResult::kTimeout) {
+    QueueControllerUpdate();
+  }
+}
+
 // Check if the analog inputs exceed their thresholds to become a button press
 // and build the bitfield.
 inline uint64_t SDLInputDriver::AnalogToKeyfield(
@@ -12,12 +12,15 @@
 
 #include <array>
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <optional>
 
 #include "SDL.h"
 #include "third_party/rapidcsv/src/rapidcsv.h"
+#include "xenia/base/threading.h"
 #include "xenia/hid/input_driver.h"
+#include "xenia/hid/input_snapshot.h"
 
 #define HID_SDL_USER_COUNT 4
 #define HID_SDL_THUMB_THRES 0x4E00
@@ -51,7 +54,23 @@ class SDLInputDriver final : public InputDriver {
     SDL_GameController* sdl;
     X_INPUT_CAPABILITIES caps;
     X_INPUT_STATE state;
-    bool state_changed;
+  };
+
+  // State of a controller as seen by the guest, published by the thread
+  // handling the SDL events.
+  struct ControllerSnapshot {
+    X_INPUT_GAMEPAD gamepad;
+    uint32_t connected;
+    // Incremented on every change, including reconnection.
+    uint32_t change_count;
+    // Host tick count when the last change was received.
+    uint64_t event_host_tick_count;
+  };
+
+  // Bookkeeping of GetState, which is called with the input system lock held.
+  struct ReaderState {
+    uint32_t change_count;
+    uint32_t packet_number;
     bool is_active;
   };
 
@@ -81,7 +100,9 @@ class SDLInputDriver final : public InputDriver {
   ControllerState* GetControllerState(uint32_t user_index);
   bool TestSDLVersion() const;
   void UpdateXCapabilities(ControllerState& state);
+  void PublishControllerState(size_t user_index);
   void QueueControllerUpdate();
+  void PollThread();
 
   bool sdl_events_initialized_;
   bool sdl_gamecontroller_initialized_;
@@ -89,6 +110,16 @@ class SDLInputDriver final : public InputDriver {
   std::atomic<bool> sdl_pumpevents_queued_;
   std::array<ControllerState, HID_SDL_USER_COUNT> controllers_;
   std::array<KeystrokeState, HID_SDL_USER_COUNT> keystroke_states_;
+
+  std::array<InputSnapshot<ControllerSnapshot>, HID_SDL_USER_COUNT>
+      controller_snapshots_;
+  std::array<uint32_t, HID_SDL_USER_COUNT> controller_change_counts_ = {};
+  std::array<ReaderState, HID_SDL_USER_COUNT> reader_states_ = {};
+  InputLatencyHistogram latency_histogram_;
+
+  // Requests event pumps at a fixed rate so GetState doesn't have to.
+  std::unique_ptr<xe::threading::Thread> poll_thread_;
+  std::unique_ptr<xe::threading::Event> poll_thread_shutdown_event_;
 };
 
 }  // namespace sdl
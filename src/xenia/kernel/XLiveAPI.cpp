@@ -7,6 +7,9 @@
  ******************************************************************************
  */
 
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
 #include <random>
 
 #include "third_party/rapidcsv/src/rapidcsv.h"
@@ -60,6 +63,12 @@ DEFINE_int32(discord_presence_user_index, 0,
              "User profile index used for Discord rich presence [0, 3].",
              "Live");
 
+DEFINE_uint32(live_api_cache_ttl, 2000,
+              "Time in milliseconds for which responses to repeated lookups "
+              "(QoS data, session details) are reused instead of requesting "
+              "them from the server again. 0 to disable.",
+              "Live");
+
 DECLARE_string(upnp_root);
 
 DECLARE_bool(upnp);
@@ -72,7 +81,6 @@ using namespace rapidjson;
 // libcurl + wolfssl + TLS Support
 //
 // Asynchronous UPnP
-// Use the overlapped task for asynchronous curl requests.
 // API endpoint lookup table
 //
 // Extract stat descriptions from XDBF.
@@ -406,68 +414,65 @@ void XLiveAPI::clearXnaddrCache() {
   macAddressCache.clear();
 }
 
+util::HttpClient& XLiveAPI::http_client() {
+  // Intentionally never destroyed, requests may be made until the very end.
+  static util::HttpClient* client = new util::HttpClient();
+  return *client;
+}
+
+util::HttpClient::Request XLiveAPI::CreateRequest(std::string method,
+                                                  std::string endpoint) {
+  util::HttpClient::Request request;
+  request.method = std::move(method);
+  request.url = fmt::format("{}{}", GetApiAddress(), endpoint);
+  request.verbose = cvars::logging;
+
+  if (cvars::logging) {
+    XELOGI("cURL: {}", request.url);
+  }
+
+  return request;
+}
+
+void XLiveAPI::InvalidateSessionCache(uint64_t sessionId) {
+  response_cache_.InvalidatePrefix(
+      fmt::format("{}title/{:08X}/sessions/{:016x}/", GetApiAddress(),
+                  kernel_state()->title_id(), sessionId));
+}
+
 // Request data from the server
 std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Get(std::string endpoint,
-                                                      const uint32_t timeout) {
+                                                      const uint32_t timeout,
+                                                      const bool cacheable) {
   response_data chunk = {};
-  CURL* curl_handle = curl_easy_init();
-  CURLcode result;
 
   if (GetInitState() == InitState::Failed) {
     XELOGE("XLiveAPI::Get: Initialization failed");
     return PraseResponse(chunk);
   }
 
-  if (!curl_handle) {
-    XELOGE("XLiveAPI::Get: Cannot initialize CURL");
-    return PraseResponse(chunk);
-  }
-
-  std::string endpoint_API = fmt::format("{}{}", GetApiAddress(), endpoint);
-
-  if (cvars::logging) {
-    XELOGI("cURL: {}", endpoint_API);
-
-    curl_easy_setopt(curl_handle, CURLOPT_VERBOSE, 1);
-    curl_easy_setopt(curl_handle, CURLOPT_STDERR, stderr);
-  }
-
-  curl_slist* headers = NULL;
-  headers = curl_slist_append(headers, "Content-Type: application/json");
-  headers = curl_slist_append(headers, "Accept: application/json");
-  headers = curl_slist_append(headers, "charset: utf-8");
+  util::HttpClient::Request request = CreateRequest("GET", endpoint);
+  request.timeout_seconds = timeout;
 
-  if (headers == NULL) {
+  const bool use_cache = cacheable && cvars::live_api_cache_ttl != 0;
+  if (use_cache && response_cache_.Lookup(request.url, chunk)) {
     return PraseResponse(chunk);
   }
 
-  if (timeout > 0) {
-    curl_easy_setopt(curl_handle, CURLOPT_TIMEOUT, timeout);
-  }
-
-  curl_easy_setopt(curl_handle, CURLOPT_URL, endpoint_API.c_str());
-  curl_easy_setopt(curl_handle, CURLOPT_CUSTOMREQUEST, "GET");
-  curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, headers);
-  curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "xenia");
-  curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, callback);
-  curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void*)&chunk);
-
-  result = curl_easy_perform(curl_handle);
+  std::string url = request.url;
+  CURLcode result = http_client().Perform(std::move(request), chunk);
 
   if (result != CURLE_OK) {
     XELOGE("XLiveAPI::Get: CURL Error Code: {}", static_cast<uint32_t>(result));
     return PraseResponse(chunk);
   }
 
-  result =
-      curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &chunk.http_code);
-
-  curl_easy_cleanup(curl_handle);
-  curl_slist_free_all(headers);
-
-  if (result == CURLE_OK &&
-      (chunk.http_code == HTTP_STATUS_CODE::HTTP_OK ||
-       chunk.http_code == HTTP_STATUS_CODE::HTTP_NO_CONTENT)) {
+  if (chunk.http_code == HTTP_STATUS_CODE::HTTP_OK ||
+      chunk.http_code == HTTP_STATUS_CODE::HTTP_NO_CONTENT) {
+    if (use_cache) {
+      response_cache_.Insert(
+          url, chunk, std::chrono::milliseconds(cvars::live_api_cache_ttl));
+    }
     return PraseResponse(chunk);
   }
 
@@ -480,55 +485,26 @@ std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Post(std::string endpoint,
                                                        const uint8_t* data,
                                                        size_t data_size) {
   response_data chunk = {};
-  CURL* curl_handle = curl_easy_init();
-  CURLcode result;
 
   if (GetInitState() == InitState::Failed) {
     XELOGE("XLiveAPI::Post: Initialization failed");
     return PraseResponse(chunk);
   }
 
-  if (!curl_handle) {
-    XELOGE("XLiveAPI::Post: Cannot initialize CURL");
-    return PraseResponse(chunk);
-  }
-
-  std::string endpoint_API = fmt::format("{}{}", GetApiAddress(), endpoint);
-
-  if (cvars::logging) {
-    XELOGI("cURL: {}", endpoint_API);
-
-    curl_easy_setopt(curl_handle, CURLOPT_VERBOSE, 1);
-    curl_easy_setopt(curl_handle, CURLOPT_STDERR, stderr);
-  }
-
-  curl_slist* headers = NULL;
-
-  curl_easy_setopt(curl_handle, CURLOPT_URL, endpoint_API.c_str());
-  curl_easy_setopt(curl_handle, CURLOPT_CUSTOMREQUEST, "POST");
-  curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "xenia");
-  curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, data);
+  util::HttpClient::Request request = CreateRequest("POST", endpoint);
 
+  // FindPlayers, QoS, SessionSearch
   if (data_size > 0) {
-    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE_LARGE,
-                     (curl_off_t)data_size);
-  } else {
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    headers = curl_slist_append(headers, "Accept: application/json");
-    headers = curl_slist_append(headers, "charset: utf-8");
-
-    if (headers == NULL) {
-      return PraseResponse(chunk);
-    }
-
-    curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, headers);
+    // Binary data.
+    request.json_headers = false;
+    request.body.assign(data, data + data_size);
+  } else if (data) {
+    // Null-terminated JSON.
+    request.body.assign(
+        data, data + std::strlen(reinterpret_cast<const char*>(data)));
   }
 
-  // FindPlayers, QoS, SessionSearch
-  curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void*)&chunk);
-  curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, callback);
-
-  result = curl_easy_perform(curl_handle);
+  CURLcode result = http_client().Perform(std::move(request), chunk);
 
   if (result != CURLE_OK) {
     XELOGE("XLiveAPI::Post: CURL Error Code: {}",
@@ -536,13 +512,7 @@ std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Post(std::string endpoint,
     return PraseResponse(chunk);
   }
 
-  result =
-      curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &chunk.http_code);
-
-  curl_easy_cleanup(curl_handle);
-  curl_slist_free_all(headers);
-
-  if (CURLE_OK == result && chunk.http_code == HTTP_STATUS_CODE::HTTP_CREATED) {
+  if (chunk.http_code == HTTP_STATUS_CODE::HTTP_CREATED) {
     return PraseResponse(chunk);
   }
 
@@ -553,33 +523,14 @@ std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Post(std::string endpoint,
 // Delete data from the server
 std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Delete(std::string endpoint) {
   response_data chunk = {};
-  CURL* curl_handle = curl_easy_init();
-  CURLcode result;
 
   if (GetInitState() == InitState::Failed) {
     XELOGE("XLiveAPI::Delete: Initialization failed");
     return PraseResponse(chunk);
   }
 
-  if (!curl_handle) {
-    XELOGE("XLiveAPI::Delete: Cannot initialize CURL");
-    return PraseResponse(chunk);
-  }
-
-  std::string endpoint_API = fmt::format("{}{}", GetApiAddress(), endpoint);
-
-  struct curl_slist* headers = NULL;
-  headers = curl_slist_append(headers, "Content-Type: application/json");
-  headers = curl_slist_append(headers, "Accept: application/json");
-  headers = curl_slist_append(headers, "charset: utf-8");
-
-  curl_easy_setopt(curl_handle, CURLOPT_URL, endpoint_API.c_str());
-
-  curl_easy_setopt(curl_handle, CURLOPT_CUSTOMREQUEST, "DELETE");
-  curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, headers);
-  curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "xenia");
-
-  result = curl_easy_perform(curl_handle);
+  CURLcode result =
+      http_client().Perform(CreateRequest("DELETE", endpoint), chunk);
 
   if (result != CURLE_OK) {
     XELOGE("XLiveAPI::Delete: CURL Error Code: {}",
@@ -587,13 +538,7 @@ std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Delete(std::string endpoint) {
     return PraseResponse(chunk);
   }
 
-  result =
-      curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &chunk.http_code);
-
-  curl_easy_cleanup(curl_handle);
-  curl_slist_free_all(headers);
-
-  if (result == CURLE_OK && chunk.http_code == HTTP_STATUS_CODE::HTTP_OK) {
+  if (chunk.http_code == HTTP_STATUS_CODE::HTTP_OK) {
     return PraseResponse(chunk);
   }
 
@@ -801,6 +746,8 @@ void XLiveAPI::QoSPost(uint64_t sessionId, uint8_t* qosData, size_t qosLength) {
   std::unique_ptr<HTTPResponseObjectJSON> response =
       Post(endpoint, qosData, qosLength);
 
+  InvalidateSessionCache(sessionId);
+
   if (response->StatusCode() != HTTP_STATUS_CODE::HTTP_CREATED) {
     assert_always();
     return;
@@ -811,25 +758,74 @@ void XLiveAPI::QoSPost(uint64_t sessionId, uint8_t* qosData, size_t qosLength) {
 
 // Get QoS binary data from the server
 response_data XLiveAPI::QoSGet(uint64_t sessionId) {
-  std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}/qos",
-                                     kernel_state()->title_id(), sessionId);
+  return QoSGet(std::vector<uint64_t>{sessionId})[0];
+}
 
-  std::unique_ptr<HTTPResponseObjectJSON> response = Get(endpoint);
+// Get QoS binary data of multiple sessions from the server, with all the
+// requests in flight at once.
+std::vector<response_data> XLiveAPI::QoSGet(
+    const std::vector<uint64_t>& session_ids) {
+  std::vector<response_data> chunks(session_ids.size());
 
-  if (response->StatusCode() != HTTP_STATUS_CODE::HTTP_OK &&
-      response->StatusCode() != HTTP_STATUS_CODE::HTTP_NO_CONTENT) {
-    XELOGE("QoSGet error message: {}", response->Message());
-    assert_always();
+  if (GetInitState() == InitState::Failed) {
+    XELOGE("XLiveAPI::QoSGet: Initialization failed");
+    return chunks;
+  }
+
+  const bool use_cache = cvars::live_api_cache_ttl != 0;
 
-    return response->RawResponse();
+  std::mutex completion_mutex;
+  std::condition_variable completion_cond;
+  size_t pending_count = 0;
+
+  for (size_t i = 0; i < session_ids.size(); ++i) {
+    std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}/qos",
+                                       kernel_state()->title_id(),
+                                       session_ids[i]);
+    util::HttpClient::Request request = CreateRequest("GET", endpoint);
+    if (use_cache && response_cache_.Lookup(request.url, chunks[i])) {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(completion_mutex);
+      ++pending_count;
+    }
+    std::string url = request.url;
+    http_client().Submit(
+        std::move(request), [&, i, url, use_cache](CURLcode result,
+                                                   response_data response) {
+          if (result != CURLE_OK) {
+            XELOGE("XLiveAPI::QoSGet: CURL Error Code: {}",
+                   static_cast<uint32_t>(result));
+          } else if (response.http_code != HTTP_STATUS_CODE::HTTP_OK &&
+                     response.http_code != HTTP_STATUS_CODE::HTTP_NO_CONTENT) {
+            XELOGE("XLiveAPI::QoSGet: Failed! HTTP Error Code: {}",
+                   response.http_code);
+          } else if (use_cache) {
+            response_cache_.Insert(
+                url, response,
+                std::chrono::milliseconds(cvars::live_api_cache_ttl));
+          }
+          std::lock_guard<std::mutex> lock(completion_mutex);
+          chunks[i] = response;
+          --pending_count;
+          // Notifying with the mutex locked because the condition variable is
+          // destroyed as soon as the waiting thread wakes up.
+          completion_cond.notify_one();
+        });
   }
 
+  std::unique_lock<std::mutex> lock(completion_mutex);
+  completion_cond.wait(lock, [&pending_count]() { return !pending_count; });
+
   XELOGI("Requesting QoS data.");
 
-  return response->RawResponse();
+  return chunks;
 }
 
 void XLiveAPI::SessionModify(uint64_t sessionId, XGI_SESSION_MODIFY* data) {
+  InvalidateSessionCache(sessionId);
+
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}/modify",
                                      kernel_state()->title_id(), sessionId);
 
@@ -950,7 +946,7 @@ const std::unique_ptr<SessionObjectJSON> XLiveAPI::SessionDetails(
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}/details",
                                      kernel_state()->title_id(), sessionId);
 
-  std::unique_ptr<HTTPResponseObjectJSON> response = Get(endpoint);
+  std::unique_ptr<HTTPResponseObjectJSON> response = Get(endpoint, 0, true);
 
   std::unique_ptr<SessionObjectJSON> session =
       std::make_unique<SessionObjectJSON>();
@@ -971,6 +967,8 @@ const std::unique_ptr<SessionObjectJSON> XLiveAPI::SessionDetails(
 
 std::unique_ptr<SessionObjectJSON> XLiveAPI::XSessionMigration(
     uint64_t sessionId, XGI_SESSION_MIGRATE* data) {
+  InvalidateSessionCache(sessionId);
+
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}/migrate",
                                      kernel_state()->title_id(), sessionId);
 
@@ -1096,6 +1094,8 @@ std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::LeaderboardsFind(
 }
 
 void XLiveAPI::DeleteSession(uint64_t sessionId) {
+  InvalidateSessionCache(sessionId);
+
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}",
                                      kernel_state()->title_id(), sessionId);
 
@@ -1195,6 +1195,8 @@ void XLiveAPI::XSessionCreate(uint64_t sessionId, XGI_SESSION_CREATE* data) {
 }
 
 void XLiveAPI::SessionPropertiesSet(uint64_t session_id, uint32_t user_index) {
+  InvalidateSessionCache(session_id);
+
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}/properties",
                                      kernel_state()->title_id(), session_id);
 
@@ -1351,6 +1353,8 @@ std::unique_ptr<ServicesObjectJSON> XLiveAPI::GetServices() {
 
 void XLiveAPI::SessionJoinRemote(uint64_t sessionId,
                                  std::unordered_map<uint64_t, bool> members) {
+  InvalidateSessionCache(sessionId);
+
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}/join",
                                      kernel_state()->title_id(), sessionId);
 
@@ -1389,6 +1393,8 @@ void XLiveAPI::SessionJoinRemote(uint64_t sessionId,
 
 void XLiveAPI::SessionLeaveRemote(uint64_t sessionId,
                                   const std::vector<xe::be<uint64_t>> xuids) {
+  InvalidateSessionCache(sessionId);
+
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}/leave",
                                      kernel_state()->title_id(), sessionId);
 
@@ -1422,6 +1428,8 @@ void XLiveAPI::SessionLeaveRemote(uint64_t sessionId,
 
 void XLiveAPI::SessionPreJoin(uint64_t sessionId,
                               const std::set<uint64_t>& xuids) {
+  InvalidateSessionCache(sessionId);
+
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016X}/prejoin",
                                      kernel_state()->title_id(), sessionId);
 
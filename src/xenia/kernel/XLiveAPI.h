@@ -17,6 +17,7 @@
 
 #include "xenia/base/byte_order.h"
 #include "xenia/kernel/upnp.h"
+#include "xenia/kernel/util/http_client.h"
 #include "xenia/kernel/util/net_utils.h"
 #include "xenia/kernel/xsession.h"
 
@@ -105,6 +106,9 @@ class XLiveAPI {
 
   static response_data QoSGet(uint64_t sessionId);
 
+  static std::vector<response_data> QoSGet(
+      const std::vector<uint64_t>& session_ids);
+
   static void SessionModify(uint64_t sessionId, XGI_SESSION_MODIFY* data);
 
   static std::vector<std::unique_ptr<SessionObjectJSON>> GetTitleSessions(
@@ -248,8 +252,20 @@ class XLiveAPI {
 
   inline static InitState initialized_ = InitState::Pending;
 
+  static util::HttpClient& http_client();
+
+  inline static util::HttpResponseCache response_cache_;
+
+  static util::HttpClient::Request CreateRequest(std::string method,
+                                                 std::string endpoint);
+
+  // Drops the cached responses about the session after it has been modified.
+  static void InvalidateSessionCache(uint64_t sessionId);
+
+  // Cacheable requests may be served from response_cache_.
   static std::unique_ptr<HTTPResponseObjectJSON> Get(
-      std::string endpoint, const uint32_t timeout = 0);
+      std::string endpoint, const uint32_t timeout = 0,
+      const bool cacheable = false);
 
   static std::unique_ptr<HTTPResponseObjectJSON> Post(std::string endpoint,
                                                       const uint8_t* data,
@@ -257,22 +273,6 @@ class XLiveAPI {
 
   static std::unique_ptr<HTTPResponseObjectJSON> Delete(std::string endpoint);
 
-  // https://curl.se/libcurl/c/CURLOPT_WRITEFUNCTION.html
-  static size_t callback(void* data, size_t size, size_t nmemb, void* clientp) {
-    size_t realsize = size * nmemb;
-    struct response_data* mem = (struct response_data*)clientp;
-
-    char* ptr = (char*)realloc(mem->response, mem->size + realsize + 1);
-    if (ptr == NULL) return 0; /* out of memory! */
-
-    mem->response = ptr;
-    memcpy(&(mem->response[mem->size]), data, realsize);
-    mem->size += realsize;
-    mem->response[mem->size] = 0;
-
-    return realsize;
-  };
-
   inline static sockaddr_in online_ip_{};
 
   inline static sockaddr_in local_ip_{};
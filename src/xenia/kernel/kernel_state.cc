@@ -36,6 +36,12 @@ DEFINE_bool(allow_incompatible_title_update, true,
 DEFINE_uint32(kernel_build_version, 1888, "Define current kernel version",
               "Kernel");
 
+DEFINE_uint32(async_file_io_threads, 2,
+              "Number of host threads performing reads for files opened for "
+              "overlapped I/O, letting the guest continue while the data is "
+              "loaded. 0 to complete all reads on the calling thread.",
+              "Kernel");
+
 DECLARE_string(cl);
 
 DECLARE_int32(network_mode);
@@ -78,13 +84,25 @@ KernelState::KernelState(Emulator* emulator)
       kMemoryProtectRead | kMemoryProtectWrite);
 
   xenia_assert(fixed_alloc_worked);
+
+  if (cvars::async_file_io_threads) {
+    async_io_queue_ =
+        std::make_unique<util::AsyncIOQueue>(cvars::async_file_io_threads);
+  }
 }
 
 KernelState::~KernelState() {
+  // Finish in-flight reads while their completions can still be dispatched,
+  // the dispatch thread runs everything queued before stopping.
+  async_io_queue_.reset();
+
   SetExecutableModule(nullptr);
 
   if (dispatch_thread_running_) {
-    dispatch_thread_running_ = false;
+    {
+      auto global_lock = global_critical_region_.Acquire();
+      dispatch_thread_running_ = false;
+    }
     dispatch_cond_.notify_all();
     dispatch_thread_->Wait(0, 0, 0, nullptr);
   }
@@ -441,14 +459,16 @@ void KernelState::SetExecutableModule(object_ref<UserModule> module) {
           dispatch_thread_->set_can_debugger_suspend(true);
 
           auto global_lock = global_critical_region_.AcquireDeferred();
-          while (dispatch_thread_running_) {
+          while (true) {
             global_lock.lock();
-            if (dispatch_queue_.empty()) {
+            while (dispatch_queue_.empty() && dispatch_thread_running_) {
               dispatch_cond_.wait(global_lock);
-              if (!dispatch_thread_running_) {
-                global_lock.unlock();
-                break;
-              }
+            }
+            if (dispatch_queue_.empty()) {
+              // Stopping, only once everything queued before has run, so
+              // completions of host work aren't lost.
+              global_lock.unlock();
+              break;
             }
             auto fn = std::move(dispatch_queue_.front());
             dispatch_queue_.pop_front();
@@ -997,6 +1017,12 @@ void KernelState::CompleteOverlappedImmediateEx(uint32_t overlapped_ptr,
   CompleteOverlappedEx(overlapped_ptr, result, extended_error, length);
 }
 
+void KernelState::EnqueueDispatch(std::function<void()> fn) {
+  auto global_lock = global_critical_region_.Acquire();
+  dispatch_queue_.push_back(std::move(fn));
+  dispatch_cond_.notify_all();
+}
+
 void KernelState::CompleteOverlappedDeferred(
     std::function<void()> completion_callback, uint32_t overlapped_ptr,
     X_RESULT result, std::function<void()> pre_callback,
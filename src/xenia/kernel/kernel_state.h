@@ -20,6 +20,7 @@
 #include "xenia/cpu/backend/backend.h"
 #include "xenia/cpu/export_resolver.h"
 #include "xenia/kernel/smc.h"
+#include "xenia/kernel/util/async_io_queue.h"
 #include "xenia/kernel/util/kernel_fwd.h"
 #include "xenia/kernel/util/native_list.h"
 #include "xenia/kernel/util/object_table.h"
@@ -301,6 +302,13 @@ class KernelState {
       uint32_t overlapped_ptr, std::function<void()> pre_callback = nullptr,
       std::function<void()> post_callback = nullptr);
 
+  // Runs the function on the kernel dispatch thread, which has a guest
+  // context, for work completed on host threads.
+  void EnqueueDispatch(std::function<void()> fn);
+
+  // Null if overlapped file I/O is disabled.
+  util::AsyncIOQueue* async_io_queue() const { return async_io_queue_.get(); }
+
   bool Save(ByteStream* stream);
   bool Restore(ByteStream* stream);
 
@@ -372,6 +380,8 @@ class KernelState {
   std::condition_variable_any dispatch_cond_;
   std::list<std::function<void()>> dispatch_queue_;
 
+  std::unique_ptr<util::AsyncIOQueue> async_io_queue_;
+
   BitMap tls_bitmap_;
   uint32_t ke_timestamp_bundle_ptr_ = 0;
   std::unique_ptr<xe::threading::HighResolutionTimer> timestamp_timer_;
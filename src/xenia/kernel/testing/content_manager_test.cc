@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/xam/content_manager.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include "xenia/base/filesystem.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe::kernel::xam::test {
+
+namespace {
+
+constexpr uint64_t kXuid = 0xE000000000000001;
+constexpr uint32_t kTitleId = 0x41560817;
+constexpr XContentType kContentType = XContentType::kSavedGame;
+
+XCONTENT_AGGREGATE_DATA MakeContentData(const std::u16string_view name) {
+  XCONTENT_AGGREGATE_DATA data;
+  data.device_id = 1;
+  data.content_type = kContentType;
+  data.set_display_name(name);
+  data.set_file_name("package");
+  data.xuid = kXuid;
+  data.title_id = kTitleId;
+  return data;
+}
+
+std::u16string ListDisplayName(const ContentManager& content_manager) {
+  auto content = content_manager.ListContent(1, kXuid, kTitleId, kContentType);
+  return content.size() == 1 ? content[0].display_name() : u"";
+}
+
+}  // namespace
+
+TEST_CASE("Content catalog cache", "[content_manager]") {
+  std::filesystem::path root = std::filesystem::temp_directory_path() /
+                               "xenia_content_manager_test";
+  std::filesystem::remove_all(root);
+
+  ContentManager content_manager(nullptr, root);
+  std::filesystem::path package_path =
+      root / "E000000000000001" / "41560817" / "00000001" / "package";
+  std::filesystem::path header_root =
+      root / "E000000000000001" / "41560817" / "Headers" / "00000001";
+  std::filesystem::path header_path = header_root / "package.header";
+
+  REQUIRE(content_manager.ListContent(1, kXuid, kTitleId, kContentType)
+              .empty());
+  REQUIRE(std::filesystem::create_directories(package_path));
+  REQUIRE(content_manager.WriteContentHeaderFile(
+              kXuid, MakeContentData(u"A")) == X_STATUS_SUCCESS);
+  REQUIRE(ListDisplayName(content_manager) == u"A");
+
+  // Changing the header in place keeps the modification time of the header
+  // directory, so the cached listing is still returned.
+  auto header_time = std::filesystem::last_write_time(header_root);
+  XCONTENT_AGGREGATE_DATA external = MakeContentData(u"B");
+  FILE* file = xe::filesystem::OpenFile(header_path, "r+b");
+  REQUIRE(file);
+  fwrite(&external, 1, sizeof(external), file);
+  fclose(file);
+  std::filesystem::last_write_time(header_root, header_time);
+  REQUIRE(ListDisplayName(content_manager) == u"A");
+
+  // External changes to the directories are picked up.
+  std::filesystem::last_write_time(header_root,
+                                   header_time + std::chrono::hours(1));
+  REQUIRE(ListDisplayName(content_manager) == u"B");
+
+  // Headers written by the content manager invalidate the listing.
+  REQUIRE(content_manager.WriteContentHeaderFile(
+              kXuid, MakeContentData(u"C")) == X_STATUS_SUCCESS);
+  std::filesystem::last_write_time(header_root,
+                                   header_time + std::chrono::hours(1));
+  REQUIRE(ListDisplayName(content_manager) == u"C");
+
+  // So do deleted packages.
+  REQUIRE(content_manager.DeleteContent(kXuid, MakeContentData(u"C")) ==
+          X_ERROR_SUCCESS);
+  REQUIRE(content_manager.ListContent(1, kXuid, kTitleId, kContentType)
+              .empty());
+
+  std::filesystem::remove_all(root);
+}
+
+}  // namespace xe::kernel::xam::test
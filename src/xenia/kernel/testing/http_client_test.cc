@@ -0,0 +1,369 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/http_client.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "third_party/fmt/include/fmt/format.h"
+#include "xenia/base/platform.h"
+#include "xenia/base/utf8.h"
+
+#if XE_PLATFORM_WIN32
+// Winsock is included by net_utils.h.
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe::kernel::util::test {
+
+namespace {
+
+#if XE_PLATFORM_WIN32
+using SocketHandle = SOCKET;
+constexpr SocketHandle kInvalidSocket = INVALID_SOCKET;
+void ShutdownSocket(SocketHandle socket) { shutdown(socket, SD_BOTH); }
+void CloseSocket(SocketHandle socket) { closesocket(socket); }
+#else
+using SocketHandle = int;
+constexpr SocketHandle kInvalidSocket = -1;
+void ShutdownSocket(SocketHandle socket) { shutdown(socket, SHUT_RDWR); }
+void CloseSocket(SocketHandle socket) { close(socket); }
+#endif
+
+// Minimal HTTP/1.1 server on the loopback interface, replying to every request
+// with a keep-alive response echoing the method, the path and the body.
+// Requests for /hang are never replied to, and requests for /missing are
+// replied to with 404.
+class LoopbackServer {
+ public:
+  LoopbackServer() {
+#if XE_PLATFORM_WIN32
+    WSADATA wsa_data;
+    WSAStartup(MAKEWORD(2, 2), &wsa_data);
+#endif
+    listen_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    REQUIRE(listen_socket_ != kInvalidSocket);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    REQUIRE(bind(listen_socket_, reinterpret_cast<sockaddr*>(&address),
+                 sizeof(address)) == 0);
+    REQUIRE(listen(listen_socket_, 8) == 0);
+    socklen_t address_length = sizeof(address);
+    REQUIRE(getsockname(listen_socket_, reinterpret_cast<sockaddr*>(&address),
+                        &address_length) == 0);
+    port_ = ntohs(address.sin_port);
+    accept_thread_ = std::thread([this]() { AcceptThread(); });
+  }
+
+  ~LoopbackServer() {
+    stopping_ = true;
+    // Wake up the accept with a connection of our own.
+    SocketHandle wake_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port_);
+    connect(wake_socket, reinterpret_cast<sockaddr*>(&address),
+            sizeof(address));
+    accept_thread_.join();
+    CloseSocket(wake_socket);
+    CloseSocket(listen_socket_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (SocketHandle connection : connections_) {
+        ShutdownSocket(connection);
+      }
+    }
+    for (std::thread& thread : connection_threads_) {
+      thread.join();
+    }
+#if XE_PLATFORM_WIN32
+    WSACleanup();
+#endif
+  }
+
+  std::string url(const std::string_view path) const {
+    return fmt::format("http://127.0.0.1:{}{}", port_, path);
+  }
+
+  // Waits until a request for /hang has been received.
+  void WaitForHang() { hang_received_.get_future().wait(); }
+
+ private:
+  void AcceptThread() {
+    while (true) {
+      SocketHandle connection = accept(listen_socket_, nullptr, nullptr);
+      if (stopping_) {
+        if (connection != kInvalidSocket) {
+          CloseSocket(connection);
+        }
+        break;
+      }
+      if (connection == kInvalidSocket) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      connections_.push_back(connection);
+      connection_threads_.emplace_back(
+          [this, connection]() { ConnectionThread(connection); });
+    }
+  }
+
+  void ConnectionThread(SocketHandle connection) {
+    std::string buffer;
+    char chunk[4096];
+    while (true) {
+      size_t header_end = buffer.find("\r\n\r\n");
+      size_t content_length = 0;
+      if (header_end != std::string::npos) {
+        std::string headers = xe::utf8::lower_ascii(
+            std::string_view(buffer).substr(0, header_end));
+        size_t length_pos = headers.find("\r\ncontent-length:");
+        if (length_pos != std::string::npos) {
+          content_length = std::strtoull(
+              headers.c_str() + length_pos + sizeof("\r\ncontent-length:") - 1,
+              nullptr, 10);
+        }
+      }
+      if (header_end == std::string::npos ||
+          buffer.size() < header_end + 4 + content_length) {
+        int received = recv(connection, chunk, int(sizeof(chunk)), 0);
+        if (received <= 0) {
+          break;
+        }
+        buffer.append(chunk, size_t(received));
+        continue;
+      }
+
+      // "METHOD /path HTTP/1.1".
+      size_t method_end = buffer.find(' ');
+      size_t path_end = buffer.find(' ', method_end + 1);
+      std::string method = buffer.substr(0, method_end);
+      std::string path =
+          buffer.substr(method_end + 1, path_end - method_end - 1);
+      std::string body = buffer.substr(header_end + 4, content_length);
+      buffer.erase(0, header_end + 4 + content_length);
+
+      if (path == "/hang") {
+        hang_received_.set_value();
+        continue;
+      }
+      std::string response_body = method + " " + path;
+      if (!body.empty()) {
+        response_body += " " + body;
+      }
+      std::string response = fmt::format(
+          "HTTP/1.1 {}\r\nContent-Type: text/plain\r\n"
+          "Content-Length: {}\r\n\r\n{}",
+          path == "/missing" ? "404 Not Found" : "200 OK",
+          response_body.size(), response_body);
+      send(connection, response.data(), int(response.size()), 0);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::erase(connections_, connection);
+    CloseSocket(connection);
+  }
+
+  SocketHandle listen_socket_ = kInvalidSocket;
+  uint16_t port_ = 0;
+  std::atomic<bool> stopping_ = false;
+  std::thread accept_thread_;
+  std::mutex mutex_;
+  std::vector<SocketHandle> connections_;
+  std::vector<std::thread> connection_threads_;
+  std::promise<void> hang_received_;
+};
+
+response_data MakeResponse(const char* body, uint64_t http_code) {
+  response_data response = {};
+  response.response = const_cast<char*>(body);
+  response.size = std::strlen(body);
+  response.http_code = http_code;
+  return response;
+}
+
+std::string TakeBody(response_data& response) {
+  std::string body;
+  if (response.response) {
+    body.assign(response.response, response.size);
+    std::free(response.response);
+    response.response = nullptr;
+  }
+  return body;
+}
+
+HttpClient::Request MakeRequest(const std::string& method,
+                                const std::string& url) {
+  HttpClient::Request request;
+  request.method = method;
+  request.url = url;
+  request.json_headers = false;
+  request.timeout_seconds = 10;
+  return request;
+}
+
+}  // namespace
+
+TEST_CASE("Response cache expiry", "[http_client]") {
+  HttpResponseCache cache;
+  response_data response;
+
+  cache.Insert("http://host/expired", MakeResponse("expired", 200),
+               std::chrono::milliseconds(0));
+  REQUIRE_FALSE(cache.Lookup("http://host/expired", response));
+  // The expired entry is dropped by the lookup.
+  REQUIRE(cache.size() == 0);
+
+  cache.Insert("http://host/live", MakeResponse("live", 201),
+               std::chrono::hours(1));
+  REQUIRE(cache.Lookup("http://host/live", response));
+  REQUIRE(response.http_code == 201);
+  REQUIRE(TakeBody(response) == "live");
+
+  // Reinserting replaces the entry and its expiry.
+  cache.Insert("http://host/live", MakeResponse("live", 201),
+               std::chrono::milliseconds(0));
+  REQUIRE_FALSE(cache.Lookup("http://host/live", response));
+}
+
+TEST_CASE("Response cache prefix invalidation", "[http_client]") {
+  HttpResponseCache cache;
+  cache.Insert("http://host/sessions/1", MakeResponse("1", 200),
+               std::chrono::hours(1));
+  cache.Insert("http://host/sessions/2", MakeResponse("2", 200),
+               std::chrono::hours(1));
+  cache.Insert("http://host/players/1", MakeResponse("player", 200),
+               std::chrono::hours(1));
+
+  cache.InvalidatePrefix("http://host/sessions/");
+
+  response_data response;
+  REQUIRE_FALSE(cache.Lookup("http://host/sessions/1", response));
+  REQUIRE_FALSE(cache.Lookup("http://host/sessions/2", response));
+  REQUIRE(cache.Lookup("http://host/players/1", response));
+  REQUIRE(TakeBody(response) == "player");
+  REQUIRE(cache.size() == 1);
+}
+
+TEST_CASE("Response cache sweep of expired entries", "[http_client]") {
+  HttpResponseCache cache;
+  // Expired entries are only dropped once the cache reaches 256 entries.
+  for (int i = 0; i < 255; ++i) {
+    cache.Insert(fmt::format("http://host/{}", i), MakeResponse("", 200),
+                 std::chrono::milliseconds(0));
+  }
+  cache.Insert("http://host/live", MakeResponse("live", 200),
+               std::chrono::hours(1));
+  REQUIRE(cache.size() == 256);
+
+  cache.Insert("http://host/new", MakeResponse("new", 200),
+               std::chrono::hours(1));
+  REQUIRE(cache.size() == 2);
+
+  response_data response;
+  REQUIRE(cache.Lookup("http://host/live", response));
+  REQUIRE(TakeBody(response) == "live");
+  REQUIRE(cache.Lookup("http://host/new", response));
+  REQUIRE(TakeBody(response) == "new");
+}
+
+TEST_CASE("HTTP client perform", "[http_client]") {
+  LoopbackServer server;
+  HttpClient client;
+  response_data response = {};
+
+  REQUIRE(client.Perform(MakeRequest("GET", server.url("/get")), response) ==
+          CURLE_OK);
+  REQUIRE(response.http_code == 200);
+  REQUIRE(TakeBody(response) == "GET /get");
+
+  HttpClient::Request post = MakeRequest("POST", server.url("/post"));
+  const std::string post_body = "{\"key\":1}";
+  post.body.assign(post_body.begin(), post_body.end());
+  REQUIRE(client.Perform(post, response) == CURLE_OK);
+  REQUIRE(response.http_code == 200);
+  REQUIRE(TakeBody(response) == "POST /post {\"key\":1}");
+
+  // Reuses the kept alive connection.
+  REQUIRE(client.Perform(MakeRequest("DELETE", server.url("/missing")),
+                         response) == CURLE_OK);
+  REQUIRE(response.http_code == 404);
+  REQUIRE(TakeBody(response) == "DELETE /missing");
+}
+
+TEST_CASE("HTTP client submit", "[http_client]") {
+  LoopbackServer server;
+  HttpClient client;
+
+  constexpr int kRequestCount = 8;
+  std::mutex mutex;
+  std::condition_variable completed_cond;
+  int completed = 0;
+  std::vector<std::string> bodies(kRequestCount);
+  std::vector<CURLcode> results(kRequestCount, CURLE_FAILED_INIT);
+  for (int i = 0; i < kRequestCount; ++i) {
+    client.Submit(MakeRequest("GET", server.url(fmt::format("/{}", i))),
+                  [&, i](CURLcode result, response_data response) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    results[i] = result;
+                    bodies[i] = TakeBody(response);
+                    ++completed;
+                    completed_cond.notify_one();
+                  });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    completed_cond.wait(lock, [&]() { return completed == kRequestCount; });
+  }
+  for (int i = 0; i < kRequestCount; ++i) {
+    REQUIRE(results[i] == CURLE_OK);
+    REQUIRE(bodies[i] == fmt::format("GET /{}", i));
+  }
+}
+
+TEST_CASE("HTTP client abort on shutdown", "[http_client]") {
+  LoopbackServer server;
+  auto client = std::make_unique<HttpClient>();
+
+  std::atomic<int> callback_count = 0;
+  CURLcode result = CURLE_OK;
+  client->Submit(MakeRequest("GET", server.url("/hang")),
+                 [&](CURLcode transfer_result, response_data response) {
+                   result = transfer_result;
+                   TakeBody(response);
+                   ++callback_count;
+                 });
+  // Destroy the client while the request is in flight.
+  server.WaitForHang();
+  client.reset();
+
+  REQUIRE(callback_count == 1);
+  REQUIRE(result == CURLE_ABORTED_BY_CALLBACK);
+}
+
+}  // namespace xe::kernel::util::test
@@ -0,0 +1,17 @@
+project_root = "../../../.."
+include(project_root.."/tools/build")
+
+test_suite("xenia-kernel-tests", project_root, ".", {
+  links = {
+    "fmt",
+    "libcurl",
+    "xenia-base",
+    "xenia-core",
+    "xenia-cpu",
+    "xenia-kernel",
+    "xenia-vfs",
+  },
+  defines = {
+    "CURL_STATICLIB",
+  },
+})
@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/async_io_queue.h"
+
+#include "third_party/fmt/include/fmt/format.h"
+#include "xenia/base/assert.h"
+
+namespace xe {
+namespace kernel {
+namespace util {
+
+AsyncIOQueue::AsyncIOQueue(uint32_t worker_count) {
+  assert_not_zero(worker_count);
+  worker_threads_.reserve(worker_count);
+  for (uint32_t i = 0; i < worker_count; ++i) {
+    xe::threading::Thread::CreationParameters params;
+    params.stack_size = 256 * 1024;
+    auto thread = xe::threading::Thread::Create(
+        params, [this]() { WorkerThread(); });
+    assert_not_null(thread);
+    thread->set_name(fmt::format("Async I/O Worker {}", i));
+    worker_threads_.push_back(std::move(thread));
+  }
+}
+
+AsyncIOQueue::~AsyncIOQueue() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    shutting_down_ = true;
+  }
+  queue_cond_.notify_all();
+  for (auto& thread : worker_threads_) {
+    xe::threading::Wait(thread.get(), false);
+  }
+}
+
+void AsyncIOQueue::Submit(std::function<void()> request) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_.push_back(std::move(request));
+  }
+  queue_cond_.notify_one();
+}
+
+void AsyncIOQueue::WorkerThread() {
+  while (true) {
+    std::function<void()> request;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cond_.wait(lock,
+                       [this]() { return shutting_down_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        // Shutting down and drained.
+        break;
+      }
+      request = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    request();
+  }
+}
+
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
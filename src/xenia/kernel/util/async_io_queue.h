@@ -0,0 +1,55 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_KERNEL_UTIL_ASYNC_IO_QUEUE_H_
+#define XENIA_KERNEL_UTIL_ASYNC_IO_QUEUE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "xenia/base/threading.h"
+
+namespace xe {
+namespace kernel {
+namespace util {
+
+// Host worker threads performing blocking file I/O on behalf of guest requests
+// made on handles opened for overlapped access, so the guest thread can
+// continue while the host reads the data.
+//
+// Requests run on host threads without a guest context - anything that needs
+// one (APCs, for instance) must be forwarded to the kernel dispatch thread.
+class AsyncIOQueue {
+ public:
+  explicit AsyncIOQueue(uint32_t worker_count);
+  ~AsyncIOQueue();
+
+  // Requests submitted before destruction are all executed.
+  void Submit(std::function<void()> request);
+
+ private:
+  void WorkerThread();
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cond_;
+  std::deque<std::function<void()>> queue_;
+  bool shutting_down_ = false;
+
+  std::vector<std::unique_ptr<xe::threading::Thread>> worker_threads_;
+};
+
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
+
+#endif  // XENIA_KERNEL_UTIL_ASYNC_IO_QUEUE_H_
@@ -0,0 +1,298 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/http_client.h"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "xenia/base/assert.h"
+#include "xenia/base/logging.h"
+
+namespace xe {
+namespace kernel {
+namespace util {
+
+HttpClient::HttpClient() {
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+  multi_ = curl_multi_init();
+  assert_not_null(multi_);
+  // Idle connections kept alive for reuse by later requests.
+  curl_multi_setopt(multi_, CURLMOPT_MAXCONNECTS, long(8));
+
+  worker_thread_ =
+      xe::threading::Thread::Create({}, [this]() { WorkerThread(); });
+  assert_not_null(worker_thread_);
+  worker_thread_->set_name("HTTP Client");
+}
+
+HttpClient::~HttpClient() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    shutting_down_ = true;
+  }
+  curl_multi_wakeup(multi_);
+  xe::threading::Wait(worker_thread_.get(), false);
+  curl_multi_cleanup(multi_);
+  curl_global_cleanup();
+}
+
+void HttpClient::Submit(Request request, Callback callback) {
+  auto transfer = std::make_unique<Transfer>();
+  transfer->request = std::move(request);
+  transfer->callback = std::move(callback);
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_.push_back(std::move(transfer));
+  }
+  curl_multi_wakeup(multi_);
+}
+
+CURLcode HttpClient::Perform(Request request, response_data& response_out) {
+  std::mutex completion_mutex;
+  std::condition_variable completion_cond;
+  bool completed = false;
+  CURLcode result = CURLE_OK;
+  Submit(std::move(request), [&](CURLcode transfer_result,
+                                 response_data response) {
+    std::lock_guard<std::mutex> lock(completion_mutex);
+    result = transfer_result;
+    response_out = response;
+    completed = true;
+    // Notifying with the mutex locked because the waiting thread owns the
+    // condition variable and may destroy it as soon as it wakes up.
+    completion_cond.notify_one();
+  });
+  std::unique_lock<std::mutex> lock(completion_mutex);
+  completion_cond.wait(lock, [&completed]() { return completed; });
+  return result;
+}
+
+// https://curl.se/libcurl/c/CURLOPT_WRITEFUNCTION.html
+size_t HttpClient::WriteCallback(void* data, size_t size, size_t nmemb,
+                                 void* clientp) {
+  size_t realsize = size * nmemb;
+  response_data* mem = static_cast<response_data*>(clientp);
+  char* ptr =
+      static_cast<char*>(std::realloc(mem->response, mem->size + realsize + 1));
+  if (!ptr) {
+    // Out of memory.
+    return 0;
+  }
+  mem->response = ptr;
+  std::memcpy(&mem->response[mem->size], data, realsize);
+  mem->size += realsize;
+  mem->response[mem->size] = 0;
+  return realsize;
+}
+
+bool HttpClient::StartTransfer(Transfer& transfer) {
+  const Request& request = transfer.request;
+  CURL* easy = curl_easy_init();
+  if (!easy) {
+    XELOGE("HttpClient: Cannot initialize CURL");
+    return false;
+  }
+  transfer.easy = easy;
+
+  if (request.verbose) {
+    curl_easy_setopt(easy, CURLOPT_VERBOSE, long(1));
+    curl_easy_setopt(easy, CURLOPT_STDERR, stderr);
+  }
+
+  if (request.json_headers) {
+    curl_slist* headers = nullptr;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    headers = curl_slist_append(headers, "Accept: application/json");
+    headers = curl_slist_append(headers, "charset: utf-8");
+    if (!headers) {
+      return false;
+    }
+    transfer.headers = headers;
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, headers);
+  }
+
+  if (request.timeout_seconds) {
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT, long(request.timeout_seconds));
+  }
+
+  curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+  curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+  curl_easy_setopt(easy, CURLOPT_USERAGENT, "xenia");
+  curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, long(1));
+  if (request.method == "POST") {
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS,
+                     request.body.empty()
+                         ? ""
+                         : reinterpret_cast<const char*>(request.body.data()));
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE,
+                     curl_off_t(request.body.size()));
+  }
+  curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, WriteCallback);
+  curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer.response);
+
+  if (curl_multi_add_handle(multi_, easy) != CURLM_OK) {
+    XELOGE("HttpClient: Cannot add the request to the multi handle");
+    return false;
+  }
+  return true;
+}
+
+void HttpClient::FinishTransfer(std::unique_ptr<Transfer> transfer,
+                                CURLcode result) {
+  if (transfer->easy) {
+    if (result == CURLE_OK) {
+      long http_code = 0;
+      result =
+          curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &http_code);
+      transfer->response.http_code = uint64_t(http_code);
+    }
+    curl_easy_cleanup(transfer->easy);
+  }
+  curl_slist_free_all(transfer->headers);
+  transfer->callback(result, transfer->response);
+}
+
+void HttpClient::WorkerThread() {
+  while (true) {
+    std::deque<std::unique_ptr<Transfer>> new_transfers;
+    bool shutting_down;
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      new_transfers.swap(queue_);
+      shutting_down = shutting_down_;
+    }
+
+    if (shutting_down) {
+      for (std::unique_ptr<Transfer>& transfer : new_transfers) {
+        FinishTransfer(std::move(transfer), CURLE_ABORTED_BY_CALLBACK);
+      }
+      for (auto& active_transfer : active_transfers_) {
+        curl_multi_remove_handle(multi_, active_transfer.first);
+        FinishTransfer(std::move(active_transfer.second),
+                       CURLE_ABORTED_BY_CALLBACK);
+      }
+      active_transfers_.clear();
+      break;
+    }
+
+    for (std::unique_ptr<Transfer>& transfer : new_transfers) {
+      if (!StartTransfer(*transfer)) {
+        FinishTransfer(std::move(transfer), CURLE_FAILED_INIT);
+        continue;
+      }
+      CURL* easy = transfer->easy;
+      active_transfers_.emplace(easy, std::move(transfer));
+    }
+
+    int running_handles;
+    curl_multi_perform(multi_, &running_handles);
+
+    CURLMsg* message;
+    int messages_left;
+    while ((message = curl_multi_info_read(multi_, &messages_left))) {
+      if (message->msg != CURLMSG_DONE) {
+        continue;
+      }
+      CURL* easy = message->easy_handle;
+      // The message is invalidated by removing the handle.
+      CURLcode result = message->data.result;
+      auto transfer_it = active_transfers_.find(easy);
+      assert_true(transfer_it != active_transfers_.end());
+      std::unique_ptr<Transfer> transfer = std::move(transfer_it->second);
+      active_transfers_.erase(transfer_it);
+      curl_multi_remove_handle(multi_, easy);
+      FinishTransfer(std::move(transfer), result);
+    }
+
+    // Sleep until there's activity on the sockets, a new request or shutdown.
+    curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+  }
+}
+
+bool HttpResponseCache::Lookup(const std::string& key,
+                               response_data& response_out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return false;
+  }
+  if (std::chrono::steady_clock::now() >= it->second.expiry) {
+    entries_.erase(it);
+    return false;
+  }
+  const Entry& entry = it->second;
+  response_out = {};
+  response_out.http_code = entry.http_code;
+  if (!entry.body.empty()) {
+    // Null-terminated like responses received from the server.
+    response_out.response =
+        static_cast<char*>(std::malloc(entry.body.size() + 1));
+    if (!response_out.response) {
+      return false;
+    }
+    std::memcpy(response_out.response, entry.body.data(), entry.body.size());
+    response_out.response[entry.body.size()] = 0;
+    response_out.size = entry.body.size();
+  }
+  return true;
+}
+
+void HttpResponseCache::Insert(const std::string& key,
+                               const response_data& response,
+                               std::chrono::milliseconds time_to_live) {
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Titles query many different sessions over time, drop the expired ones
+  // from time to time.
+  if (entries_.size() >= 256) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (now >= it->second.expiry) {
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  Entry& entry = entries_[key];
+  if (response.response) {
+    entry.body.assign(response.response, response.response + response.size);
+  } else {
+    entry.body.clear();
+  }
+  entry.http_code = response.http_code;
+  entry.expiry = now + time_to_live;
+}
+
+void HttpResponseCache::InvalidatePrefix(std::string_view prefix) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (std::string_view(it->first).substr(0, prefix.size()) == prefix) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void HttpResponseCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+}
+
+size_t HttpResponseCache::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
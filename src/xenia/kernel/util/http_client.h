@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_KERNEL_UTIL_HTTP_CLIENT_H_
+#define XENIA_KERNEL_UTIL_HTTP_CLIENT_H_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "third_party/libcurl/include/curl/curl.h"
+
+#include "xenia/base/threading.h"
+#include "xenia/kernel/util/net_utils.h"
+
+namespace xe {
+namespace kernel {
+namespace util {
+
+// HTTP requests serviced by a single worker thread driving a curl multi handle,
+// so connections to the same host are kept alive and reused between requests,
+// and multiple requests can be in flight at once.
+//
+// Responses are returned as response_data with the body allocated with
+// malloc, like the rest of the XLiveAPI code expects.
+class HttpClient {
+ public:
+  struct Request {
+    // "GET", "POST", "DELETE".
+    std::string method;
+    std::string url;
+    std::vector<uint8_t> body;
+    // Content-Type, Accept and charset headers for JSON.
+    bool json_headers = true;
+    // 0 for no timeout.
+    uint32_t timeout_seconds = 0;
+    bool verbose = false;
+  };
+
+  // Called on the worker thread.
+  using Callback = std::function<void(CURLcode result, response_data response)>;
+
+  HttpClient();
+  ~HttpClient();
+
+  // Requests still in flight on destruction are completed with
+  // CURLE_ABORTED_BY_CALLBACK.
+  void Submit(Request request, Callback callback);
+  // Submits the request and waits for it to be completed.
+  CURLcode Perform(Request request, response_data& response_out);
+
+ private:
+  struct Transfer {
+    Request request;
+    Callback callback;
+    CURL* easy = nullptr;
+    curl_slist* headers = nullptr;
+    response_data response = {};
+  };
+
+  static size_t WriteCallback(void* data, size_t size, size_t nmemb,
+                              void* clientp);
+
+  bool StartTransfer(Transfer& transfer);
+  void FinishTransfer(std::unique_ptr<Transfer> transfer, CURLcode result);
+  void WorkerThread();
+
+  CURLM* multi_ = nullptr;
+
+  std::mutex queue_mutex_;
+  std::deque<std::unique_ptr<Transfer>> queue_;
+  bool shutting_down_ = false;
+
+  // Owned by the worker thread.
+  std::unordered_map<CURL*, std::unique_ptr<Transfer>> active_transfers_;
+
+  std::unique_ptr<xe::threading::Thread> worker_thread_;
+};
+
+// Short-lived cache of responses to idempotent requests, keyed by the URL, to
+// avoid going to the server when titles poll the same data in a loop.
+class HttpResponseCache {
+ public:
+  // Returns a malloc-allocated copy of the cached response if it's present and
+  // not expired.
+  bool Lookup(const std::string& key, response_data& response_out);
+  void Insert(const std::string& key, const response_data& response,
+              std::chrono::milliseconds time_to_live);
+  // Removes the entries with keys starting with the prefix.
+  void InvalidatePrefix(std::string_view prefix);
+  void Clear();
+  // Including the expired entries that haven't been dropped yet.
+  size_t size();
+
+ private:
+  struct Entry {
+    std::vector<char> body;
+    uint64_t http_code;
+    std::chrono::steady_clock::time_point expiry;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
+
+#endif  // XENIA_KERNEL_UTIL_HTTP_CLIENT_H_
@@ -144,9 +144,8 @@ std::filesystem::path ContentManager::ResolvePackagePath(
   return get_package_path(data.title_id);
 }
 
-std::filesystem::path ContentManager::ResolvePackageHeaderPath(
-    const std::string_view file_name, uint64_t xuid, uint32_t title_id,
-    const XContentType content_type) const {
+std::filesystem::path ContentManager::ResolvePackageHeaderRoot(
+    uint64_t xuid, uint32_t title_id, const XContentType content_type) const {
   if (title_id == kCurrentlyRunningTitleId) {
     title_id = kernel_state_->title_id();
   }
@@ -158,13 +157,19 @@ std::filesystem::path ContentManager::ResolvePackageHeaderPath(
   auto xuid_str = fmt::format("{:016X}", xuid);
   auto title_id_str = fmt::format("{:08X}", title_id);
   auto content_type_str = fmt::format("{:08X}", uint32_t(content_type));
-  std::string final_name =
-      xe::string_util::trim(std::string(file_name)) + ".header";
 
   // Header root path:
   // content_root/xuid/title_id/Headers/content_type/
   return root_path_ / xuid_str / title_id_str / kGameContentHeaderDirName /
-         content_type_str / final_name;
+         content_type_str;
+}
+
+std::filesystem::path ContentManager::ResolvePackageHeaderPath(
+    const std::string_view file_name, uint64_t xuid, uint32_t title_id,
+    const XContentType content_type) const {
+  std::string final_name =
+      xe::string_util::trim(std::string(file_name)) + ".header";
+  return ResolvePackageHeaderRoot(xuid, title_id, content_type) / final_name;
 }
 
 std::unordered_set<uint32_t> ContentManager::FindPublisherTitleIds(
@@ -217,24 +222,18 @@ std::vector<XCONTENT_AGGREGATE_DATA> ContentManager::ListContent(
     // Search path:
     // content_root/xuid/title_id/type_name/*
     auto package_root = ResolvePackageRoot(xuid, title_id, content_type);
-    auto file_infos = xe::filesystem::ListFiles(package_root);
+    std::vector<CatalogEntry> entries =
+        GetCatalogEntries(package_root, xuid, title_id, content_type);
 
-    for (const auto& file_info : file_infos) {
-      if (file_info.type != xe::filesystem::FileInfo::Type::kDirectory) {
-        // Directories only.
-        continue;
-      }
-
-      XCONTENT_AGGREGATE_DATA content_data;
-      if (XSUCCEEDED(ReadContentHeaderFile(xe::path_to_utf8(file_info.name),
-                                           xuid, title_id, content_type,
-                                           content_data))) {
-        result.emplace_back(std::move(content_data));
+    for (const CatalogEntry& entry : entries) {
+      if (entry.has_header) {
+        result.push_back(entry.header);
       } else {
+        XCONTENT_AGGREGATE_DATA content_data;
         content_data.device_id = device_id;
         content_data.content_type = content_type;
-        content_data.set_display_name(xe::path_to_utf16(file_info.name));
-        content_data.set_file_name(xe::path_to_utf8(file_info.name));
+        content_data.set_display_name(xe::path_to_utf16(entry.name));
+        content_data.set_file_name(xe::path_to_utf8(entry.name));
         content_data.title_id = title_id;
         content_data.xuid = xuid;
         result.emplace_back(std::move(content_data));
@@ -244,6 +243,83 @@ std::vector<XCONTENT_AGGREGATE_DATA> ContentManager::ListContent(
   return result;
 }
 
+static std::filesystem::file_time_type GetDirectoryWriteTime(
+    const std::filesystem::path& path) {
+  std::error_code error;
+  std::filesystem::file_time_type time =
+      std::filesystem::last_write_time(path, error);
+  return error ? std::filesystem::file_time_type::min() : time;
+}
+
+std::vector<ContentManager::CatalogEntry> ContentManager::GetCatalogEntries(
+    const std::filesystem::path& package_root, const uint64_t xuid,
+    const uint32_t title_id, const XContentType content_type) const {
+  std::string key = xe::path_to_utf8(package_root);
+  std::filesystem::path header_root =
+      ResolvePackageHeaderRoot(xuid, title_id, content_type);
+  // Packages or headers added, removed or renamed externally change the
+  // modification times of the directories. Obtained before listing so changes
+  // made while listing are picked up next time.
+  std::filesystem::file_time_type package_root_time =
+      GetDirectoryWriteTime(package_root);
+  std::filesystem::file_time_type header_root_time =
+      GetDirectoryWriteTime(header_root);
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    generation = catalog_generation_;
+    auto it = catalog_.find(key);
+    if (it != catalog_.end() &&
+        it->second.package_root_time == package_root_time &&
+        it->second.header_root_time == header_root_time) {
+      return it->second.entries;
+    }
+  }
+
+  CatalogRoot catalog_root;
+  catalog_root.package_root_time = package_root_time;
+  catalog_root.header_root_time = header_root_time;
+  catalog_root.header_root = header_root;
+  for (const auto& file_info : xe::filesystem::ListFiles(package_root)) {
+    if (file_info.type != xe::filesystem::FileInfo::Type::kDirectory) {
+      // Directories only.
+      continue;
+    }
+    CatalogEntry& entry = catalog_root.entries.emplace_back();
+    entry.name = file_info.name;
+    entry.has_header = XSUCCEEDED(
+        ReadContentHeaderFile(xe::path_to_utf8(file_info.name), xuid, title_id,
+                              content_type, entry.header));
+  }
+
+  std::vector<CatalogEntry> entries = catalog_root.entries;
+  std::lock_guard<std::mutex> lock(catalog_mutex_);
+  if (catalog_generation_ == generation) {
+    catalog_[key] = std::move(catalog_root);
+  }
+  return entries;
+}
+
+void ContentManager::InvalidateCatalogRoot(
+    const std::filesystem::path& package_root) {
+  std::lock_guard<std::mutex> lock(catalog_mutex_);
+  ++catalog_generation_;
+  catalog_.erase(xe::path_to_utf8(package_root));
+}
+
+void ContentManager::InvalidateCatalogHeaders(
+    const std::filesystem::path& header_root) {
+  std::lock_guard<std::mutex> lock(catalog_mutex_);
+  ++catalog_generation_;
+  for (auto it = catalog_.begin(); it != catalog_.end();) {
+    if (it->second.header_root == header_root) {
+      it = catalog_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 std::vector<XCONTENT_AGGREGATE_DATA> ContentManager::ListContentODD(
     const uint32_t device_id, const uint64_t xuid, const uint32_t title_id,
     const XContentType content_type) const {
@@ -328,6 +404,10 @@ X_RESULT ContentManager::WriteContentHeaderFile(const uint64_t xuid,
     auto file = xe::filesystem::OpenFile(header_path, "wb");
     fwrite(&data, 1, sizeof(XCONTENT_AGGREGATE_DATA), file);
     fclose(file);
+    // Overwriting an existing header doesn't change the directory modification
+    // time. Only dropped once the header is complete, so a listing can't cache
+    // the empty file.
+    InvalidateCatalogHeaders(parent_path);
     return X_STATUS_SUCCESS;
   }
   return X_STATUS_NO_SUCH_FILE;
@@ -384,6 +464,9 @@ X_RESULT ContentManager::CreateContent(const std::string_view root_name,
   if (!std::filesystem::create_directories(package_path)) {
     return X_ERROR_ACCESS_DENIED;
   }
+  // The modification time may have a coarse granularity, don't rely on it for
+  // changes made by the title itself.
+  InvalidateCatalogRoot(package_path.parent_path());
 
   auto package = ResolvePackage(root_name, xuid, data);
   assert_not_null(package);
@@ -474,7 +557,9 @@ X_RESULT ContentManager::SetContentThumbnail(
     std::vector<uint8_t> buffer) {
   auto global_lock = global_critical_region_.Acquire();
   auto package_path = ResolvePackagePath(xuid, data);
-  std::filesystem::create_directories(package_path);
+  if (std::filesystem::create_directories(package_path)) {
+    InvalidateCatalogRoot(package_path.parent_path());
+  }
   if (std::filesystem::exists(package_path)) {
     auto thumb_path = package_path / kThumbnailFileName;
     auto file = xe::filesystem::OpenFile(thumb_path, "wb");
@@ -497,6 +582,7 @@ X_RESULT ContentManager::DeleteContent(const uint64_t xuid,
 
   auto package_path = ResolvePackagePath(xuid, data);
   if (std::filesystem::remove_all(package_path) > 0) {
+    InvalidateCatalogRoot(package_path.parent_path());
     return X_ERROR_SUCCESS;
   } else {
     return X_ERROR_FILE_NOT_FOUND;
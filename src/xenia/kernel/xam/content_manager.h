@@ -10,7 +10,9 @@
 #ifndef XENIA_KERNEL_XAM_CONTENT_MANAGER_H_
 #define XENIA_KERNEL_XAM_CONTENT_MANAGER_H_
 
+#include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -195,10 +197,33 @@ class ContentManager {
   std::filesystem::path ResolvePackagePath(const uint64_t xuid,
                                            const XCONTENT_AGGREGATE_DATA& data,
                                            const uint32_t disc_number = -1);
+  std::filesystem::path ResolvePackageHeaderRoot(
+      uint64_t xuid, uint32_t title_id, const XContentType content_type) const;
   std::filesystem::path ResolvePackageHeaderPath(
       const std::string_view file_name, uint64_t xuid, uint32_t title_id,
       const XContentType content_type) const;
 
+  // Package directory in a package root, with its header if there's one.
+  struct CatalogEntry {
+    std::filesystem::path name;
+    bool has_header;
+    XCONTENT_AGGREGATE_DATA header;
+  };
+  // Listing of a package root, reused while the modification times of the
+  // package root and the header directory stay the same.
+  struct CatalogRoot {
+    std::filesystem::file_time_type package_root_time;
+    std::filesystem::file_time_type header_root_time;
+    std::filesystem::path header_root;
+    std::vector<CatalogEntry> entries;
+  };
+
+  std::vector<CatalogEntry> GetCatalogEntries(
+      const std::filesystem::path& package_root, const uint64_t xuid,
+      const uint32_t title_id, const XContentType content_type) const;
+  void InvalidateCatalogRoot(const std::filesystem::path& package_root);
+  void InvalidateCatalogHeaders(const std::filesystem::path& header_root);
+
   std::unordered_set<uint32_t> FindPublisherTitleIds(
       const uint64_t xuid,
       uint32_t base_title_id = kCurrentlyRunningTitleId) const;
@@ -209,6 +234,14 @@ class ContentManager {
   // TODO(benvanik): remove use of global lock, it's bad here!
   xe::global_critical_region global_critical_region_;
   std::unordered_map<string_key, ContentPackage*> open_packages_;
+
+  // Content index by the package root path, so titles polling for content
+  // don't make the disk read every package header again.
+  mutable std::mutex catalog_mutex_;
+  mutable std::unordered_map<std::string, CatalogRoot> catalog_;
+  // Bumped on every invalidation, so a listing that raced with a write doesn't
+  // put what it read before the write back in the cache.
+  mutable uint64_t catalog_generation_ = 0;
 };
 
 }  // namespace xam
@@ -1226,9 +1226,16 @@ dword_result_t NetDll_XNetQosLookup_entry(
 
   const uint32_t probes = qos->count - countOffset;
 
+  // Request the data for all the probes at once.
+  std::vector<uint64_t> probe_session_ids(probes);
   for (uint32_t i = 0; i < probes; i++) {
-    uint64_t session_id = session_ids[i].as_uintBE64();
-    response_data chunk = XLiveAPI::QoSGet(session_id);
+    probe_session_ids[i] = session_ids[i].as_uintBE64();
+  }
+  const std::vector<response_data> chunks =
+      XLiveAPI::QoSGet(probe_session_ids);
+
+  for (uint32_t i = 0; i < probes; i++) {
+    const response_data& chunk = chunks[i];
 
     if (chunk.http_code == HTTP_STATUS_CODE::HTTP_OK ||
         chunk.http_code == HTTP_STATUS_CODE::HTTP_NO_CONTENT) {
@@ -141,7 +141,12 @@ dword_result_t NtReadFile_entry(dword_t file_handle, dword_t event_handle,
   }
 
   if (XSUCCEEDED(result)) {
-    if (true || file->is_synchronous()) {
+    // Overlapped reads go to the host I/O workers, but only with an explicit
+    // offset (the current position is meaningless for overlapped handles) and
+    // within the file, so end of file is still reported immediately.
+    if (file->is_synchronous() || !byte_offset_ptr ||
+        !kernel_state()->async_io_queue() ||
+        *byte_offset_ptr >= file->entry()->size()) {
       // Synchronous.
       uint32_t bytes_read = 0;
       result = file->Read(
@@ -172,24 +177,41 @@ dword_result_t NtReadFile_entry(dword_t file_handle, dword_t event_handle,
       // we have written the info out.
       signal_event = true;
     } else {
-      // TODO(benvanik): async.
-
       // X_STATUS_PENDING if not returning immediately.
       // XFile is waitable and signalled after each async req completes.
-      // reset the input event (->Reset())
-      /*xeNtReadFileState* call_state = new xeNtReadFileState();
-      XAsyncRequest* request = new XAsyncRequest(
-      state, file,
-      (XAsyncRequest::CompletionCallback)xeNtReadFileCompleted,
-      call_state);*/
-      // result = file->Read(buffer.guest_address(), buffer_length, byte_offset,
-      //                     request);
       if (io_status_block) {
         io_status_block->status = X_STATUS_PENDING;
         io_status_block->information = 0;
       }
+      if (ev) {
+        ev->Reset();
+      }
 
-      result = X_STATUS_PENDING;
+      uint32_t io_status_block_ptr = io_status_block.guest_address();
+      uint32_t apc_routine = static_cast<uint32_t>(apc_routine_ptr) & ~1u;
+      uint32_t apc_context_ptr = apc_context.guest_address();
+      auto thread = retain_object(XThread::GetCurrentThread());
+      result = file->ReadAsync(
+          buffer.guest_address(), buffer_length,
+          static_cast<uint64_t>(*byte_offset_ptr), apc_context_ptr,
+          [ev, thread, io_status_block_ptr, apc_routine, apc_context_ptr](
+              X_STATUS read_result, uint32_t bytes_read) {
+            if (io_status_block_ptr) {
+              auto status_block =
+                  kernel_memory()->TranslateVirtual<X_IO_STATUS_BLOCK*>(
+                      io_status_block_ptr);
+              status_block->status = read_result;
+              status_block->information = bytes_read;
+            }
+            if (apc_routine && apc_context_ptr &&
+                read_result == X_STATUS_SUCCESS) {
+              thread->EnqueueApc(apc_routine, apc_context_ptr,
+                                 io_status_block_ptr, 0);
+            }
+            if (ev) {
+              ev->Set(0, false);
+            }
+          });
     }
   }
 
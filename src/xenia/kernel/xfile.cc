@@ -88,6 +88,54 @@ X_STATUS XFile::QueryDirectory(X_FILE_DIRECTORY_INFORMATION* out_info,
   return X_STATUS_SUCCESS;
 }
 
+X_STATUS XFile::TranslateReadBuffer(uint32_t buffer_guest_address,
+                                    uint32_t buffer_length,
+                                    uint8_t** host_buffer_out,
+                                    xe::PhysicalHeap** physical_heap_out) {
+  assert_not_zero(buffer_length);
+  if (UINT32_MAX - buffer_guest_address < buffer_length) {
+    return X_STATUS_ACCESS_VIOLATION;
+  }
+  // Games often read directly to texture/vertex buffer memory - in this case,
+  // invalidation notifications must be sent. However, having any memory
+  // callbacks in the range will result in STATUS_ACCESS_VIOLATION at least on
+  // Windows, without anything being read or any callbacks being triggered. So
+  // for physical memory, host protection must be bypassed, and invalidation
+  // callbacks must be triggered manually (it's also wrong to trigger
+  // invalidation callbacks before reading in this case, because during the
+  // read, the guest may still access the data around the buffer that is
+  // located in the same host pages as the buffer's start and end, on the GPU -
+  // and that must not trigger a race condition).
+  uint32_t buffer_guest_high_address = buffer_guest_address + buffer_length - 1;
+  xe::BaseHeap* buffer_start_heap = memory()->LookupHeap(buffer_guest_address);
+  const xe::BaseHeap* buffer_end_heap =
+      memory()->LookupHeap(buffer_guest_high_address);
+  if (!buffer_start_heap || !buffer_end_heap ||
+      (buffer_start_heap->heap_type() == HeapType::kGuestPhysical) !=
+          (buffer_end_heap->heap_type() == HeapType::kGuestPhysical) ||
+      (buffer_start_heap->heap_type() == HeapType::kGuestPhysical &&
+       buffer_start_heap != buffer_end_heap)) {
+    return X_STATUS_ACCESS_VIOLATION;
+  }
+  xe::PhysicalHeap* buffer_physical_heap =
+      buffer_start_heap->heap_type() == HeapType::kGuestPhysical
+          ? static_cast<xe::PhysicalHeap*>(buffer_start_heap)
+          : nullptr;
+  if (buffer_physical_heap &&
+      buffer_physical_heap->QueryRangeAccess(buffer_guest_address,
+                                             buffer_guest_high_address) !=
+          memory::PageAccess::kReadWrite) {
+    return X_STATUS_ACCESS_VIOLATION;
+  }
+  *host_buffer_out = buffer_physical_heap
+                         ? memory()->TranslatePhysical(
+                               buffer_physical_heap->GetPhysicalAddress(
+                                   buffer_guest_address))
+                         : memory()->TranslateVirtual(buffer_guest_address);
+  *physical_heap_out = buffer_physical_heap;
+  return X_STATUS_SUCCESS;
+}
+
 X_STATUS XFile::Read(uint32_t buffer_guest_address, uint32_t buffer_length,
                      uint64_t byte_offset, uint32_t* out_bytes_read,
                      uint32_t apc_context, bool notify_completion) {
@@ -101,64 +149,26 @@ X_STATUS XFile::Read(uint32_t buffer_guest_address, uint32_t buffer_length,
   // Zero length means success for a valid file object according to Windows
   // tests.
   if (buffer_length) {
-    if (UINT32_MAX - buffer_guest_address < buffer_length) {
-      result = X_STATUS_ACCESS_VIOLATION;
-    } else {
-      // Games often read directly to texture/vertex buffer memory - in this
-      // case, invalidation notifications must be sent. However, having any
-      // memory callbacks in the range will result in STATUS_ACCESS_VIOLATION at
-      // least on Windows, without anything being read or any callbacks being
-      // triggered. So for physical memory, host protection must be bypassed,
-      // and invalidation callbacks must be triggered manually (it's also wrong
-      // to trigger invalidation callbacks before reading in this case, because
-      // during the read, the guest may still access the data around the buffer
-      // that is located in the same host pages as the buffer's start and end,
-      // on the GPU - and that must not trigger a race condition).
-      uint32_t buffer_guest_high_address =
-          buffer_guest_address + buffer_length - 1;
-      xe::BaseHeap* buffer_start_heap =
-          memory()->LookupHeap(buffer_guest_address);
-      const xe::BaseHeap* buffer_end_heap =
-          memory()->LookupHeap(buffer_guest_high_address);
-      if (!buffer_start_heap || !buffer_end_heap ||
-          (buffer_start_heap->heap_type() == HeapType::kGuestPhysical) !=
-              (buffer_end_heap->heap_type() == HeapType::kGuestPhysical) ||
-          (buffer_start_heap->heap_type() == HeapType::kGuestPhysical &&
-           buffer_start_heap != buffer_end_heap)) {
-        result = X_STATUS_ACCESS_VIOLATION;
-      } else {
-        xe::PhysicalHeap* buffer_physical_heap =
-            buffer_start_heap->heap_type() == HeapType::kGuestPhysical
-                ? static_cast<xe::PhysicalHeap*>(buffer_start_heap)
-                : nullptr;
-        if (buffer_physical_heap &&
-            buffer_physical_heap->QueryRangeAccess(buffer_guest_address,
-                                                   buffer_guest_high_address) !=
-                memory::PageAccess::kReadWrite) {
-          result = X_STATUS_ACCESS_VIOLATION;
-        } else {
-          result = file_->ReadSync(
-              std::span<uint8_t>(
-                  buffer_physical_heap
-                      ? memory()->TranslatePhysical(
-                            buffer_physical_heap->GetPhysicalAddress(
-                                buffer_guest_address))
-                      : memory()->TranslateVirtual(buffer_guest_address),
-                  buffer_length),
-              size_t(byte_offset), &bytes_read);
-          if (XSUCCEEDED(result)) {
-            if (buffer_physical_heap) {
-              buffer_physical_heap->TriggerCallbacks(
-                  xe::global_critical_region::AcquireDirect(),
-                  buffer_guest_address, buffer_length, true, true);
-            }
+    uint8_t* host_buffer;
+    xe::PhysicalHeap* buffer_physical_heap;
+    result = TranslateReadBuffer(buffer_guest_address, buffer_length,
+                                 &host_buffer, &buffer_physical_heap);
+    if (XSUCCEEDED(result)) {
+      result = file_->ReadSync(std::span<uint8_t>(host_buffer, buffer_length),
+                               size_t(byte_offset), &bytes_read);
+      if (XSUCCEEDED(result)) {
+        kernel_state()->file_system()->RecordFileRead(
+            file_->entry(), byte_offset, bytes_read);
+        if (buffer_physical_heap) {
+          buffer_physical_heap->TriggerCallbacks(
+              xe::global_critical_region::AcquireDirect(), buffer_guest_address,
+              buffer_length, true, true);
+        }
 
-            if (byte_offset) {
-              position_ = byte_offset;
-            }
-            position_ += bytes_read;
-          }
+        if (byte_offset) {
+          position_ = byte_offset;
         }
+        position_ += bytes_read;
       }
     }
   }
@@ -181,6 +191,78 @@ X_STATUS XFile::Read(uint32_t buffer_guest_address, uint32_t buffer_length,
   return result;
 }
 
+X_STATUS XFile::ReadAsync(
+    uint32_t buffer_guest_address, uint32_t buffer_length, uint64_t byte_offset,
+    uint32_t apc_context,
+    std::function<void(X_STATUS result, uint32_t bytes_read)>
+        completion_callback) {
+  util::AsyncIOQueue* async_io_queue = kernel_state()->async_io_queue();
+  assert_not_null(async_io_queue);
+
+  uint8_t* host_buffer = nullptr;
+  xe::PhysicalHeap* buffer_physical_heap = nullptr;
+  if (buffer_length) {
+    X_STATUS result = TranslateReadBuffer(buffer_guest_address, buffer_length,
+                                          &host_buffer, &buffer_physical_heap);
+    if (XFAILED(result)) {
+      return result;
+    }
+  }
+
+  kernel_state()->file_system()->RecordFileRead(file_->entry(), byte_offset,
+                                                buffer_length);
+
+  // Keep the file alive until the request has completed even if the guest
+  // closes the handle in the meantime.
+  object_ref<XFile> file = retain_object(this);
+  async_io_queue->Submit([file, host_buffer, buffer_physical_heap,
+                          buffer_guest_address, buffer_length, byte_offset,
+                          apc_context,
+                          completion_callback =
+                              std::move(completion_callback)]() mutable {
+    size_t bytes_read = 0;
+    X_STATUS result = X_STATUS_SUCCESS;
+    if (buffer_length) {
+      result = file->file_->ReadSync(
+          std::span<uint8_t>(host_buffer, buffer_length), size_t(byte_offset),
+          &bytes_read);
+    }
+    file->kernel_state()->EnqueueDispatch(
+        [file, buffer_physical_heap, buffer_guest_address, buffer_length,
+         byte_offset, apc_context, result, bytes_read,
+         completion_callback = std::move(completion_callback)]() {
+          if (XSUCCEEDED(result)) {
+            if (buffer_physical_heap) {
+              buffer_physical_heap->TriggerCallbacks(
+                  xe::global_critical_region::AcquireDirect(),
+                  buffer_guest_address, buffer_length, true, true);
+            }
+            // Like a synchronous read, for later reads from the current
+            // position.
+            file->position_ = byte_offset + bytes_read;
+          }
+
+          XIOCompletion::IONotification notify;
+          notify.apc_context = apc_context;
+          notify.num_bytes = uint32_t(bytes_read);
+          notify.status = result;
+          file->NotifyIOCompletionPorts(notify);
+
+          if (completion_callback) {
+            completion_callback(result, uint32_t(bytes_read));
+          }
+
+          // Only set, never reset on submission, as that could clear the
+          // completion of another read still in flight. The completion of
+          // this request is reported through its own event and status block
+          // by the callback.
+          file->async_event_->Set();
+        });
+  });
+
+  return X_STATUS_PENDING;
+}
+
 X_STATUS XFile::ReadScatter(uint32_t segments_guest_address, uint32_t length,
                             uint64_t byte_offset, uint32_t* out_bytes_read,
                             uint32_t apc_context) {
@@ -10,6 +10,7 @@
 #ifndef XENIA_KERNEL_XFILE_H_
 #define XENIA_KERNEL_XFILE_H_
 
+#include <functional>
 #include <string>
 
 #include "xenia/kernel/xiocompletion.h"
@@ -155,6 +156,16 @@ class XFile : public XObject {
                 uint64_t byte_offset, uint32_t* out_bytes_read,
                 uint32_t apc_context, bool notify_completion = true);
 
+  // Starts a read on the kernel async I/O queue and returns X_STATUS_PENDING,
+  // or fails immediately if the buffer is invalid. The completion ports and
+  // the file wait handle are notified, and completion_callback is called with
+  // the result and the number of bytes read, on the kernel dispatch thread.
+  X_STATUS ReadAsync(
+      uint32_t buffer_guest_address, uint32_t buffer_length,
+      uint64_t byte_offset, uint32_t apc_context,
+      std::function<void(X_STATUS result, uint32_t bytes_read)>
+          completion_callback);
+
   X_STATUS ReadScatter(uint32_t segments_guest_address, uint32_t length,
                        uint64_t byte_offset, uint32_t* out_bytes_read,
                        uint32_t apc_context);
@@ -176,6 +187,13 @@ class XFile : public XObject {
   bool is_synchronous() const { return is_synchronous_; }
 
  protected:
+  // Validates a guest read destination and returns where to write it on the
+  // host. Physical memory is written bypassing host protection, and the
+  // physical heap is returned for triggering invalidation callbacks afterwards.
+  X_STATUS TranslateReadBuffer(uint32_t buffer_guest_address,
+                               uint32_t buffer_length, uint8_t** host_buffer_out,
+                               xe::PhysicalHeap** physical_heap_out);
+
   void NotifyIOCompletionPorts(XIOCompletion::IONotification& notification);
 
   xe::threading::WaitHandle* GetWaitHandle() override {
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <iterator>
 #include <utility>
 
 #include "third_party/fmt/include/fmt/format.h"
@@ -687,28 +688,49 @@ void Memory::DumpMap() {
   XELOGE("");
 }
 
+BaseHeap* Memory::GetSaveStateHeap(uint32_t index) {
+  switch (index) {
+    case 0:
+      return &heaps_.v00000000;
+    case 1:
+      return &heaps_.v40000000;
+    case 2:
+      return &heaps_.v80000000;
+    case 3:
+      return &heaps_.v90000000;
+    case 4:
+      return &heaps_.physical;
+    default:
+      return nullptr;
+  }
+}
+
 bool Memory::Save(ByteStream* stream) {
   XELOGD("Serializing memory...");
-  heaps_.v00000000.Save(stream);
-  heaps_.v40000000.Save(stream);
-  heaps_.v80000000.Save(stream);
-  heaps_.v90000000.Save(stream);
-  heaps_.physical.Save(stream);
-
+  for (uint32_t i = 0; i < kSaveStateHeapCount; ++i) {
+    if (!GetSaveStateHeap(i)->Save(stream)) {
+      return false;
+    }
+  }
   return true;
 }
 
 bool Memory::Restore(ByteStream* stream) {
   XELOGD("Restoring memory...");
-  heaps_.v00000000.Restore(stream);
-  heaps_.v40000000.Restore(stream);
-  heaps_.v80000000.Restore(stream);
-  heaps_.v90000000.Restore(stream);
-  heaps_.physical.Restore(stream);
-
+  for (uint32_t i = 0; i < kSaveStateHeapCount; ++i) {
+    if (!GetSaveStateHeap(i)->Restore(stream)) {
+      return false;
+    }
+  }
   return true;
 }
 
+void Memory::RestoreProtection() {
+  for (uint32_t i = 0; i < kSaveStateHeapCount; ++i) {
+    GetSaveStateHeap(i)->RestoreProtection();
+  }
+}
+
 uint32_t FromPageAccess(xe::memory::PageAccess protect) {
   switch (protect) {
     case memory::PageAccess::kNoAccess:
@@ -749,6 +771,85 @@ void BaseHeap::Initialize(Memory* memory, uint8_t* membase, HeapType heap_type,
   host_address_offset_ = host_address_offset;
   page_table_.resize(heap_size / page_size);
   unreserved_page_count_ = uint32_t(page_table_.size());
+  RebuildFreeExtents();
+}
+
+void BaseHeap::RebuildFreeExtents() {
+  free_extents_.clear();
+  uint32_t page_count = uint32_t(page_table_.size());
+  uint32_t page_number = 0;
+  while (page_number < page_count) {
+    if (page_table_[page_number].state) {
+      ++page_number;
+      continue;
+    }
+    uint32_t run_end = page_number + 1;
+    while (run_end < page_count && !page_table_[run_end].state) {
+      ++run_end;
+    }
+    free_extents_.emplace_hint(free_extents_.end(), page_number,
+                               run_end - page_number);
+    page_number = run_end;
+  }
+}
+
+void BaseHeap::AddFreeExtent(uint32_t first_page_number, uint32_t page_count) {
+  if (!page_count) {
+    return;
+  }
+  uint32_t end_page_number = first_page_number + page_count;
+  auto next_it = free_extents_.lower_bound(first_page_number);
+  bool has_next = next_it != free_extents_.end() &&
+                  next_it->first == end_page_number;
+  if (next_it != free_extents_.begin()) {
+    auto previous_it = std::prev(next_it);
+    if (previous_it->first + previous_it->second == first_page_number) {
+      previous_it->second += page_count;
+      if (has_next) {
+        previous_it->second += next_it->second;
+        free_extents_.erase(next_it);
+      }
+      return;
+    }
+  }
+  if (has_next) {
+    page_count += next_it->second;
+    next_it = free_extents_.erase(next_it);
+  }
+  free_extents_.emplace_hint(next_it, first_page_number, page_count);
+}
+
+void BaseHeap::RemoveFreeExtents(uint32_t first_page_number,
+                                 uint32_t page_count) {
+  if (!page_count) {
+    return;
+  }
+  uint32_t end_page_number = first_page_number + page_count;
+  auto it = free_extents_.upper_bound(first_page_number);
+  if (it != free_extents_.begin()) {
+    // The extent starting before or at the range may overlap it.
+    auto previous_it = std::prev(it);
+    uint32_t previous_end = previous_it->first + previous_it->second;
+    if (previous_end > first_page_number) {
+      if (previous_end > end_page_number) {
+        free_extents_.emplace_hint(it, end_page_number,
+                                   previous_end - end_page_number);
+      }
+      previous_it->second = first_page_number - previous_it->first;
+      if (!previous_it->second) {
+        free_extents_.erase(previous_it);
+      }
+    }
+  }
+  while (it != free_extents_.end() && it->first < end_page_number) {
+    uint32_t extent_end = it->first + it->second;
+    it = free_extents_.erase(it);
+    if (extent_end > end_page_number) {
+      free_extents_.emplace_hint(it, end_page_number,
+                                 extent_end - end_page_number);
+      break;
+    }
+  }
 }
 
 void BaseHeap::Dispose() {
@@ -815,81 +916,79 @@ void BaseHeap::DumpMap() {
   }
 }
 
-bool BaseHeap::Save(ByteStream* stream) {
-  XELOGD("Heap {:08X}-{:08X}", heap_base_, heap_base_ + (heap_size_ - 1));
-
-  for (size_t i = 0; i < page_table_.size(); i++) {
-    auto& page = page_table_[i];
-    stream->Write(page.qword);
-    if (!page.state) {
-      // Unallocated.
+void BaseHeap::GetCommittedRanges(
+    std::vector<CommittedRange>& ranges_out) const {
+  uint32_t page_count = uint32_t(page_table_.size());
+  uint32_t i = 0;
+  while (i < page_count) {
+    const PageEntry& page = page_table_[i];
+    if (!(page.state & kMemoryAllocationCommit)) {
+      ++i;
       continue;
     }
-
-    // TODO(DrChat): write compressed with snappy.
-    if (page.state & kMemoryAllocationCommit) {
-      void* addr = TranslateRelative(i * page_size_);
-
-      memory::PageAccess old_access;
-      memory::Protect(addr, page_size_, memory::PageAccess::kReadWrite,
-                      &old_access);
-
-      stream->Write(addr, page_size_);
-
-      memory::Protect(addr, page_size_, old_access, nullptr);
+    uint32_t run_end = i + 1;
+    while (run_end < page_count &&
+           (page_table_[run_end].state & kMemoryAllocationCommit) &&
+           page_table_[run_end].current_protect == page.current_protect) {
+      ++run_end;
     }
+    ranges_out.push_back({i << page_size_shift_,
+                          (run_end - i) << page_size_shift_,
+                          page.current_protect});
+    i = run_end;
   }
+}
 
+bool BaseHeap::Save(ByteStream* stream) {
+  XELOGD("Heap {:08X}-{:08X}", heap_base_, heap_base_ + (heap_size_ - 1));
+
+  stream->Write(uint32_t(page_table_.size()));
+  stream->Write(page_table_.data(), sizeof(PageEntry) * page_table_.size());
   return true;
 }
 
 bool BaseHeap::Restore(ByteStream* stream) {
   XELOGD("Heap {:08X}-{:08X}", heap_base_, heap_base_ + (heap_size_ - 1));
 
-  for (size_t i = 0; i < page_table_.size(); i++) {
-    auto& page = page_table_[i];
-    page.qword = stream->Read<uint64_t>();
-    if (!page.state) {
-      // Unallocated.
-      continue;
-    }
-
-    memory::PageAccess page_access = memory::PageAccess::kNoAccess;
-    if ((page.current_protect & kMemoryProtectRead) &&
-        (page.current_protect & kMemoryProtectWrite)) {
-      page_access = memory::PageAccess::kReadWrite;
-    } else if (page.current_protect & kMemoryProtectRead) {
-      page_access = memory::PageAccess::kReadOnly;
-    }
-
-    // Commit the memory if it isn't already. We do not need to reserve any
-    // memory, as the mapping has already taken care of that.
-    if (page.state & kMemoryAllocationCommit) {
-      xe::memory::AllocFixed(TranslateRelative(i * page_size_), page_size_,
-                             memory::AllocationType::kCommit,
-                             memory::PageAccess::kReadWrite);
-    }
-
-    // Now read into memory. We'll set R/W protection first, then set the
-    // protection back to its previous state.
-    // TODO(DrChat): read compressed with snappy.
-    if (page.state & kMemoryAllocationCommit) {
-      void* addr = TranslateRelative(i * page_size_);
-      xe::memory::Protect(addr, page_size_, memory::PageAccess::kReadWrite,
-                          nullptr);
-
-      stream->Read(addr, page_size_);
+  if (stream->Read<uint32_t>() != page_table_.size()) {
+    return false;
+  }
+  stream->Read(page_table_.data(), sizeof(PageEntry) * page_table_.size());
+  unreserved_page_count_ = uint32_t(
+      std::count_if(page_table_.cbegin(), page_table_.cend(),
+                    [](const PageEntry& page) { return !page.state; }));
+  RebuildFreeExtents();
+
+  // Commit the memory if it isn't already, as read/write for restoring the
+  // contents. We do not need to reserve any memory, as the mapping has already
+  // taken care of that.
+  std::vector<CommittedRange> committed_ranges;
+  GetCommittedRanges(committed_ranges);
+  for (const CommittedRange& range : committed_ranges) {
+    xe::memory::AllocFixed(TranslateRelative(range.offset), range.length,
+                           memory::AllocationType::kCommit,
+                           memory::PageAccess::kReadWrite);
+  }
+  return true;
+}
 
-      xe::memory::Protect(addr, page_size_, page_access, nullptr);
+void BaseHeap::RestoreProtection() {
+  std::vector<CommittedRange> committed_ranges;
+  GetCommittedRanges(committed_ranges);
+  for (const CommittedRange& range : committed_ranges) {
+    memory::PageAccess page_access = ToPageAccess(range.protect);
+    if (page_access != memory::PageAccess::kReadWrite) {
+      xe::memory::Protect(TranslateRelative(range.offset), range.length,
+                          page_access, nullptr);
     }
   }
-
-  return true;
 }
 
 void BaseHeap::Reset() {
   // TODO(DrChat): protect pages.
   std::memset(page_table_.data(), 0, sizeof(PageEntry) * page_table_.size());
+  unreserved_page_count_ = uint32_t(page_table_.size());
+  RebuildFreeExtents();
   // TODO(Triang3l): Remove access callbacks from pages if this is a physical
   // memory heap.
 }
@@ -998,6 +1097,7 @@ bool BaseHeap::AllocFixed(uint32_t base_address, uint32_t size,
     }
     page_entry.state = kMemoryAllocationReserve | allocation_type;
   }
+  RemoveFreeExtents(start_page_number, page_count);
 
   return true;
 }
@@ -1010,6 +1110,70 @@ static inline T QuickMod(T value, uint32_t modv) {
   }
 }
 
+uint32_t BaseHeap::FindFreePages(uint32_t low_page_number,
+                                 uint32_t high_page_number,
+                                 uint32_t page_count, uint32_t page_alignment,
+                                 bool top_down) const {
+  // The base page must be free even for empty ranges.
+  uint32_t needed_page_count = std::max(page_count, uint32_t(1));
+  if (top_down) {
+    uint32_t page_count_aligned = xe::round_up(page_count, page_alignment);
+    if (high_page_number < page_count_aligned) {
+      return UINT32_MAX;
+    }
+    uint32_t max_base_page_number = high_page_number - page_count_aligned;
+    // Walk the extents starting at or below the highest possible base
+    // downwards.
+    auto it = free_extents_.upper_bound(max_base_page_number);
+    while (it != free_extents_.begin()) {
+      --it;
+      uint32_t extent_end = it->first + it->second;
+      if (extent_end < needed_page_count) {
+        break;
+      }
+      uint32_t base_page_number =
+          std::min(max_base_page_number, extent_end - needed_page_count);
+      base_page_number -= QuickMod(base_page_number, page_alignment);
+      if (base_page_number < low_page_number) {
+        // Lower extents can only give lower bases.
+        break;
+      }
+      if (base_page_number >= it->first) {
+        return base_page_number;
+      }
+    }
+  } else {
+    if (high_page_number < page_count) {
+      return UINT32_MAX;
+    }
+    uint32_t min_base_page_number =
+        xe::round_up(low_page_number, page_alignment);
+    uint32_t max_base_page_number = high_page_number - page_count;
+    // Start from the extent containing the lowest possible base, if there's
+    // one.
+    auto it = free_extents_.upper_bound(min_base_page_number);
+    if (it != free_extents_.begin()) {
+      auto previous_it = std::prev(it);
+      if (previous_it->first + previous_it->second > min_base_page_number) {
+        it = previous_it;
+      }
+    }
+    for (; it != free_extents_.end() && it->first <= max_base_page_number;
+         ++it) {
+      uint32_t base_page_number = xe::round_up(
+          std::max(it->first, min_base_page_number), page_alignment);
+      if (base_page_number > max_base_page_number) {
+        break;
+      }
+      if (uint64_t(base_page_number) + needed_page_count <=
+          uint64_t(it->first) + it->second) {
+        return base_page_number;
+      }
+    }
+  }
+  return UINT32_MAX;
+}
+
 bool BaseHeap::AllocRange(uint32_t low_address, uint32_t high_address,
                           uint32_t size, uint32_t alignment,
                           uint32_t allocation_type, uint32_t protect,
@@ -1035,89 +1199,17 @@ bool BaseHeap::AllocRange(uint32_t low_address, uint32_t high_address,
 
   auto global_lock = global_critical_region_.Acquire();
 
-  // Find a free page range.
-  // The base page must match the requested alignment, so we first scan for
-  // a free aligned page and only then check for continuous free pages.
-  // TODO(benvanik): optimized searching (free list buckets, bitmap, etc).
-  uint32_t start_page_number = UINT_MAX;
-  uint32_t end_page_number = UINT_MAX;
+  // Find a free page range with the base page matching the requested
+  // alignment.
   // chrispy:todo, page_scan_stride is probably always a power of two...
   uint32_t page_scan_stride = alignment >> page_size_shift_;
   high_page_number =
       high_page_number - QuickMod(high_page_number, page_scan_stride);
-  if (top_down) {
-    for (int64_t base_page_number =
-             high_page_number - xe::round_up(page_count, page_scan_stride);
-         base_page_number >= low_page_number;
-         base_page_number -= page_scan_stride) {
-      if (page_table_[base_page_number].state != 0) {
-        // Base page not free, skip to next usable page.
-        continue;
-      }
-      // Check requested range to ensure free.
-      start_page_number = uint32_t(base_page_number);
-      end_page_number = uint32_t(base_page_number) + page_count - 1;
-      assert_true(end_page_number < page_table_.size());
-      bool any_taken = false;
-      for (uint32_t page_number = uint32_t(base_page_number);
-           !any_taken && page_number <= end_page_number; ++page_number) {
-        bool is_free = page_table_[page_number].state == 0;
-        if (!is_free) {
-          // At least one page in the range is used, skip to next.
-          // We know we'll be starting at least before this page.
-          any_taken = true;
-          if (page_count > page_number) {
-            // Not enough space left to fit entire page range. Breaks outer
-            // loop.
-            base_page_number = -1;
-          } else {
-            base_page_number = page_number - page_count;
-            base_page_number -= QuickMod(base_page_number, page_scan_stride);
-            base_page_number += page_scan_stride;  // cancel out loop logic
-          }
-          break;
-        }
-      }
-      if (!any_taken) {
-        // Found our place.
-        break;
-      }
-      // Retry.
-      start_page_number = end_page_number = UINT_MAX;
-    }
-  } else {
-    for (uint32_t base_page_number = low_page_number;
-         base_page_number <= high_page_number - page_count;
-         base_page_number += page_scan_stride) {
-      if (page_table_[base_page_number].state != 0) {
-        // Base page not free, skip to next usable page.
-        continue;
-      }
-      // Check requested range to ensure free.
-      start_page_number = base_page_number;
-      end_page_number = base_page_number + page_count - 1;
-      bool any_taken = false;
-      for (uint32_t page_number = base_page_number;
-           !any_taken && page_number <= end_page_number; ++page_number) {
-        bool is_free = page_table_[page_number].state == 0;
-        if (!is_free) {
-          // At least one page in the range is used, skip to next.
-          // We know we'll be starting at least after this page.
-          any_taken = true;
-          base_page_number = xe::round_up(page_number + 1, page_scan_stride);
-          base_page_number -= page_scan_stride;  // cancel out loop logic
-          break;
-        }
-      }
-      if (!any_taken) {
-        // Found our place.
-        break;
-      }
-      // Retry.
-      start_page_number = end_page_number = UINT_MAX;
-    }
-  }
-  if (start_page_number == UINT_MAX || end_page_number == UINT_MAX) {
+  uint32_t start_page_number =
+      FindFreePages(low_page_number, high_page_number, page_count,
+                    page_scan_stride, top_down);
+  uint32_t end_page_number = start_page_number + page_count - 1;
+  if (start_page_number == UINT32_MAX) {
     // Out of memory.
     XELOGE("BaseHeap::Alloc failed to find contiguous range");
     // assert_always("Heap exhausted!");
@@ -1155,6 +1247,7 @@ bool BaseHeap::AllocRange(uint32_t low_address, uint32_t high_address,
     page_entry.state = kMemoryAllocationReserve | allocation_type;
     unreserved_page_count_--;
   }
+  RemoveFreeExtents(start_page_number, page_count);
 
   *out_address = heap_base_ + (start_page_number << page_size_shift_);
   return true;
@@ -1264,6 +1357,7 @@ bool BaseHeap::Release(uint32_t base_address, uint32_t* out_region_size) {
     page_entry.qword = 0;
     unreserved_page_count_++;
   }
+  AddFreeExtent(base_page_number, base_page_entry.region_page_count);
 
   return true;
 }
@@ -1401,16 +1495,14 @@ bool BaseHeap::QueryRegionInfo(uint32_t base_address,
       out_info->region_size += page_size_;
     }
   } else {
-    // Free region.
-    for (uint32_t page_number = start_page_number;
-         page_number < page_table_.size(); ++page_number) {
-      auto page_entry = page_table_[page_number];
-      if (page_entry.state) {
-        // First non-free page; done with region.
-        break;
-      }
-      out_info->region_size += page_size_;
-    }
+    // Free region, until the end of the free extent containing the page.
+    auto extent_it = free_extents_.upper_bound(start_page_number);
+    assert_true(extent_it != free_extents_.begin());
+    --extent_it;
+    assert_true(extent_it->first + extent_it->second > start_page_number);
+    out_info->region_size =
+        (extent_it->first + extent_it->second - start_page_number)
+        << page_size_shift_;
   }
   return true;
 }
@@ -11,6 +11,7 @@
 #define XENIA_MEMORY_H_
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -124,6 +125,9 @@ class BaseHeap {
     return total_page_count() - unreserved_page_count();
   }
 
+  // Number of separate runs of unreserved pages, for fragmentation diagnostics.
+  uint32_t free_extent_count() const { return uint32_t(free_extents_.size()); }
+
   // Type of specified heap
   HeapType heap_type() const { return heap_type_; }
 
@@ -198,8 +202,22 @@ class BaseHeap {
   xe::memory::PageAccess QueryRangeAccess(uint32_t low_address,
                                           uint32_t high_address);
 
+  // Run of committed pages with the same protection, relative to the heap.
+  struct CommittedRange {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t protect;
+  };
+  // Gathers the committed pages for bulk copying of the heap contents.
+  void GetCommittedRanges(std::vector<CommittedRange>& ranges_out) const;
+
+  // Only the page table is serialized - the contents of the committed pages
+  // are saved separately (see MemorySnapshot). Restore commits the pages as
+  // read/write, RestoreProtection must be called after their contents have
+  // been restored.
   bool Save(ByteStream* stream);
   bool Restore(ByteStream* stream);
+  void RestoreProtection();
 
   void Reset();
 
@@ -210,6 +228,24 @@ class BaseHeap {
                   uint32_t heap_base, uint32_t heap_size, uint32_t page_size,
                   uint32_t host_address_offset = 0);
 
+  // Rebuilds the free extents from the page table after it has been replaced.
+  void RebuildFreeExtents();
+  // Marks the pages, which must all be reserved, as unreserved, merging them
+  // with the neighboring free extents.
+  void AddFreeExtent(uint32_t first_page_number, uint32_t page_count);
+  // Removes the pages, some of which may be already reserved, from the free
+  // extents.
+  void RemoveFreeExtents(uint32_t first_page_number, uint32_t page_count);
+  // Returns the first page number of the lowest (or the highest if top_down is
+  // true) free range of page_count pages aligned to page_alignment, or
+  // UINT32_MAX if there's no space. Bottom-up, the range must end before
+  // high_page_number, top-down, it must start at or below high_page_number
+  // minus page_count aligned to page_alignment, matching the original page
+  // table scan.
+  uint32_t FindFreePages(uint32_t low_page_number, uint32_t high_page_number,
+                         uint32_t page_count, uint32_t page_alignment,
+                         bool top_down) const;
+
   Memory* memory_;
   uint8_t* membase_;
   HeapType heap_type_;
@@ -221,6 +257,10 @@ class BaseHeap {
   uint32_t unreserved_page_count_;
   xe::global_critical_region global_critical_region_;
   std::vector<PageEntry> page_table_;
+  // Runs of unreserved pages in the page table, as the first page number ->
+  // the page count, kept in sync with the page table so allocations don't need
+  // to scan it page by page.
+  std::map<uint32_t, uint32_t> free_extents_;
 };
 
 // Normal heap allowing allocations from guest virtual address ranges.
@@ -536,8 +576,14 @@ class Memory {
   // Dumps a map of all allocated memory to the log.
   void DumpMap();
 
+  // Heaps included in save states. Indices are stored in the save states.
+  static constexpr uint32_t kSaveStateHeapCount = 5;
+  BaseHeap* GetSaveStateHeap(uint32_t index);
+
+  // Page tables of the save state heaps (see BaseHeap::Save).
   bool Save(ByteStream* stream);
   bool Restore(ByteStream* stream);
+  void RestoreProtection();
 
   void SetMMIOExceptionRecordingCallback(cpu::MmioAccessRecordCallback callback,
                                          void* context);
@@ -0,0 +1,472 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/memory_snapshot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "third_party/zstd/lib/zstd.h"
+#include "xenia/base/cvar.h"
+#include "xenia/base/filesystem.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/memory.h"
+#include "xenia/base/threading.h"
+#include "xenia/base/xxhash.h"
+#include "xenia/memory.h"
+
+DEFINE_uint32(save_state_threads, 0,
+              "Number of threads to compress and decompress save states on, "
+              "or 0 to use all logical processors.",
+              "Memory");
+DEFINE_int32(save_state_compression_level, 1,
+             "zstd compression level of the memory in save states. Higher "
+             "levels produce smaller files, but make saving slower.",
+             "Memory");
+
+namespace xe {
+
+static uint32_t GetSaveStateThreadCount(size_t work_item_count) {
+  uint32_t thread_count = cvars::save_state_threads;
+  if (!thread_count) {
+    thread_count = xe::threading::logical_processor_count();
+  }
+  return uint32_t(std::max(
+      std::min(size_t(thread_count), work_item_count), size_t(1)));
+}
+
+// Runs the function on the calling thread and on thread_count - 1 additional
+// threads.
+static void RunOnThreads(uint32_t thread_count,
+                         const std::function<void()>& function) {
+  std::vector<std::unique_ptr<xe::threading::Thread>> threads;
+  for (uint32_t i = 1; i < thread_count; ++i) {
+    std::unique_ptr<xe::threading::Thread> thread =
+        xe::threading::Thread::Create({}, function);
+    assert_not_null(thread);
+    thread->set_name("Save State Worker");
+    threads.push_back(std::move(thread));
+  }
+  function();
+  for (const std::unique_ptr<xe::threading::Thread>& thread : threads) {
+    xe::threading::Wait(thread.get(), false);
+  }
+}
+
+bool MemorySnapshot::Write(Memory& memory, FILE* file,
+                           const MemorySnapshot* base) {
+  // Gather the chunks, aligned to kChunkSize within each heap.
+  std::vector<Chunk> chunks;
+  std::vector<const uint8_t*> chunk_host_addresses;
+  std::vector<std::pair<uint8_t*, uint32_t>> unreadable_ranges;
+  std::vector<BaseHeap::CommittedRange> committed_ranges;
+  for (uint32_t heap_index = 0; heap_index < Memory::kSaveStateHeapCount;
+       ++heap_index) {
+    BaseHeap* heap = memory.GetSaveStateHeap(heap_index);
+    committed_ranges.clear();
+    heap->GetCommittedRanges(committed_ranges);
+    for (const BaseHeap::CommittedRange& range : committed_ranges) {
+      if (!(range.protect & kMemoryProtectRead)) {
+        unreadable_ranges.emplace_back(heap->TranslateRelative(range.offset),
+                                       range.length);
+      }
+      uint32_t offset = range.offset;
+      uint32_t range_end = range.offset + range.length;
+      while (offset < range_end) {
+        uint32_t chunk_end =
+            std::min((offset & ~(kChunkSize - 1)) + kChunkSize, range_end);
+        Chunk& chunk = chunks.emplace_back();
+        chunk.heap_index = heap_index;
+        chunk.offset = offset;
+        chunk.length = chunk_end - offset;
+        chunk.block_index = kBlockInBase;
+        chunk.hash = 0;
+        chunk_host_addresses.push_back(heap->TranslateRelative(offset));
+        offset = chunk_end;
+      }
+    }
+  }
+
+  // Guard pages and no-access pages need to be readable to be copied - a whole
+  // range at once rather than every page.
+  for (const auto& range : unreadable_ranges) {
+    xe::memory::Protect(range.first, range.second,
+                        xe::memory::PageAccess::kReadOnly, nullptr);
+  }
+
+  {
+    std::atomic<size_t> next_chunk_index(0);
+    RunOnThreads(GetSaveStateThreadCount(chunks.size() / 256), [&]() {
+      while (true) {
+        size_t chunk_index = next_chunk_index.fetch_add(1);
+        if (chunk_index >= chunks.size()) {
+          break;
+        }
+        Chunk& chunk = chunks[chunk_index];
+        chunk.hash = XXH3_64bits(chunk_host_addresses[chunk_index],
+                                 chunk.length);
+      }
+    });
+  }
+
+  // Skip the chunks that are the same in the base, and assign the rest to
+  // blocks.
+  std::unordered_map<uint64_t, const Chunk*> base_chunks;
+  if (base) {
+    base_chunks.reserve(base->chunks_.size());
+    for (const Chunk& base_chunk : base->chunks_) {
+      base_chunks.emplace(GetChunkKey(base_chunk), &base_chunk);
+    }
+  }
+  // Indices of the chunks in each block.
+  std::vector<std::vector<size_t>> block_chunks;
+  std::vector<Block> blocks;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    Chunk& chunk = chunks[i];
+    auto base_chunk_it = base_chunks.find(GetChunkKey(chunk));
+    if (base_chunk_it != base_chunks.end() &&
+        base_chunk_it->second->length == chunk.length &&
+        base_chunk_it->second->hash == chunk.hash) {
+      continue;
+    }
+    if (blocks.empty() ||
+        blocks.back().uncompressed_size + chunk.length > kBlockSize) {
+      blocks.push_back({0, 0, 0});
+      block_chunks.emplace_back();
+    }
+    chunk.block_index = uint32_t(blocks.size() - 1);
+    blocks.back().uncompressed_size += chunk.length;
+    block_chunks.back().push_back(i);
+  }
+
+  Header header;
+  header.magic = kMagic;
+  header.chunk_size = kChunkSize;
+  header.chunk_count = uint32_t(chunks.size());
+  header.block_count = uint32_t(blocks.size());
+  int64_t blocks_table_offset = -1;
+  bool write_failed =
+      fwrite(&header, sizeof(header), 1, file) != 1 ||
+      (!chunks.empty() &&
+       fwrite(chunks.data(), sizeof(Chunk), chunks.size(), file) !=
+           chunks.size()) ||
+      (blocks_table_offset = xe::filesystem::Tell(file)) < 0 ||
+      // Placeholder until the compressed sizes are known.
+      (!blocks.empty() &&
+       fwrite(blocks.data(), sizeof(Block), blocks.size(), file) !=
+           blocks.size());
+
+  // Compress on the worker threads, write in order on this thread as the
+  // blocks become ready, with a limited number of blocks kept in memory.
+  uint32_t thread_count = GetSaveStateThreadCount(blocks.size());
+  size_t max_blocks_in_flight = size_t(thread_count) * 2;
+  std::vector<std::vector<uint8_t>> compressed_blocks(blocks.size());
+  std::vector<bool> blocks_ready(blocks.size(), false);
+  size_t next_block_index = 0;
+  size_t next_block_to_write = 0;
+  bool compression_failed = false;
+  std::mutex blocks_mutex;
+  std::condition_variable blocks_ready_cond;
+  std::condition_variable blocks_written_cond;
+  auto compression_thread_function = [&]() {
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    std::vector<uint8_t> uncompressed;
+    while (true) {
+      size_t block_index;
+      {
+        std::unique_lock<std::mutex> lock(blocks_mutex);
+        blocks_written_cond.wait(lock, [&]() {
+          return next_block_index >= blocks.size() || write_failed ||
+                 next_block_index <
+                     next_block_to_write + max_blocks_in_flight;
+        });
+        if (next_block_index >= blocks.size() || write_failed) {
+          break;
+        }
+        block_index = next_block_index++;
+      }
+      uncompressed.resize(blocks[block_index].uncompressed_size);
+      uint8_t* uncompressed_position = uncompressed.data();
+      for (size_t chunk_index : block_chunks[block_index]) {
+        std::memcpy(uncompressed_position, chunk_host_addresses[chunk_index],
+                    chunks[chunk_index].length);
+        uncompressed_position += chunks[chunk_index].length;
+      }
+      std::vector<uint8_t> compressed(ZSTD_compressBound(uncompressed.size()));
+      size_t compressed_size = ZSTD_compressCCtx(
+          cctx, compressed.data(), compressed.size(), uncompressed.data(),
+          uncompressed.size(), cvars::save_state_compression_level);
+      std::unique_lock<std::mutex> lock(blocks_mutex);
+      if (ZSTD_isError(compressed_size)) {
+        XELOGE("Failed to compress a save state memory block: {}",
+               ZSTD_getErrorName(compressed_size));
+        compression_failed = true;
+        compressed.clear();
+      } else {
+        compressed.resize(compressed_size);
+      }
+      compressed_blocks[block_index] = std::move(compressed);
+      blocks_ready[block_index] = true;
+      blocks_ready_cond.notify_all();
+    }
+    ZSTD_freeCCtx(cctx);
+  };
+  std::vector<std::unique_ptr<xe::threading::Thread>> threads;
+  if (!write_failed) {
+    for (uint32_t i = 0; i < thread_count && !blocks.empty(); ++i) {
+      std::unique_ptr<xe::threading::Thread> thread =
+          xe::threading::Thread::Create({}, compression_thread_function);
+      assert_not_null(thread);
+      thread->set_name("Save State Compression");
+      threads.push_back(std::move(thread));
+    }
+  }
+  while (!write_failed && next_block_to_write < blocks.size()) {
+    std::vector<uint8_t> compressed;
+    {
+      std::unique_lock<std::mutex> lock(blocks_mutex);
+      blocks_ready_cond.wait(
+          lock, [&]() { return bool(blocks_ready[next_block_to_write]); });
+      compressed = std::move(compressed_blocks[next_block_to_write]);
+    }
+    Block& block = blocks[next_block_to_write];
+    int64_t file_offset = xe::filesystem::Tell(file);
+    bool block_write_failed =
+        compression_failed || file_offset < 0 ||
+        fwrite(compressed.data(), 1, compressed.size(), file) !=
+            compressed.size();
+    block.file_offset = uint64_t(file_offset);
+    block.compressed_size = uint32_t(compressed.size());
+    std::unique_lock<std::mutex> lock(blocks_mutex);
+    write_failed = block_write_failed;
+    ++next_block_to_write;
+    blocks_written_cond.notify_all();
+  }
+  for (const std::unique_ptr<xe::threading::Thread>& thread : threads) {
+    xe::threading::Wait(thread.get(), false);
+  }
+
+  for (const auto& range : unreadable_ranges) {
+    xe::memory::Protect(range.first, range.second,
+                        xe::memory::PageAccess::kNoAccess, nullptr);
+  }
+
+  if (write_failed) {
+    XELOGE("Failed to write the memory to the save state");
+    return false;
+  }
+
+  // Fill the block table.
+  int64_t end_offset = xe::filesystem::Tell(file);
+  if (!blocks.empty() &&
+      (end_offset < 0 ||
+       !xe::filesystem::Seek(file, blocks_table_offset, SEEK_SET) ||
+       fwrite(blocks.data(), sizeof(Block), blocks.size(), file) !=
+           blocks.size() ||
+       !xe::filesystem::Seek(file, end_offset, SEEK_SET))) {
+    XELOGE("Failed to write the memory to the save state");
+    return false;
+  }
+
+  uint64_t uncompressed_total = 0, compressed_total = 0;
+  for (const Block& block : blocks) {
+    uncompressed_total += block.uncompressed_size;
+    compressed_total += block.compressed_size;
+  }
+  XELOGI(
+      "Saved {} of {} memory chunks ({} bytes compressed to {}) on {} "
+      "threads",
+      chunks.size() - size_t(std::count_if(
+                          chunks.cbegin(), chunks.cend(),
+                          [](const Chunk& chunk) {
+                            return chunk.block_index == kBlockInBase;
+                          })),
+      chunks.size(), uncompressed_total, compressed_total, thread_count);
+  return true;
+}
+
+bool MemorySnapshot::Load(const std::filesystem::path& path, uint64_t offset) {
+  path_ = path;
+  chunks_.clear();
+  blocks_.clear();
+  FILE* file = xe::filesystem::OpenFile(path, "rb");
+  if (!file) {
+    return false;
+  }
+  Header header;
+  bool result = xe::filesystem::Seek(file, int64_t(offset), SEEK_SET) &&
+                fread(&header, sizeof(header), 1, file) == 1 &&
+                header.magic == kMagic && header.chunk_size == kChunkSize;
+  if (result) {
+    chunks_.resize(header.chunk_count);
+    blocks_.resize(header.block_count);
+    result = fread(chunks_.data(), sizeof(Chunk), chunks_.size(), file) ==
+                 chunks_.size() &&
+             fread(blocks_.data(), sizeof(Block), blocks_.size(), file) ==
+                 blocks_.size();
+  }
+  fclose(file);
+  if (result) {
+    for (const Chunk& chunk : chunks_) {
+      if (chunk.heap_index >= Memory::kSaveStateHeapCount ||
+          (chunk.block_index != kBlockInBase &&
+           chunk.block_index >= blocks_.size())) {
+        result = false;
+        break;
+      }
+    }
+  }
+  if (!result) {
+    chunks_.clear();
+    blocks_.clear();
+  }
+  return result;
+}
+
+bool MemorySnapshot::is_incremental() const {
+  return std::any_of(chunks_.cbegin(), chunks_.cend(), [](const Chunk& chunk) {
+    return chunk.block_index == kBlockInBase;
+  });
+}
+
+bool MemorySnapshot::Restore(Memory& memory,
+                             const MemorySnapshot* base) const {
+  std::vector<bool> chunk_mask(chunks_.size());
+  std::vector<bool> base_chunk_mask;
+  std::unordered_map<uint64_t, size_t> base_chunks;
+  if (base) {
+    base_chunk_mask.resize(base->chunks_.size());
+    base_chunks.reserve(base->chunks_.size());
+    for (size_t i = 0; i < base->chunks_.size(); ++i) {
+      base_chunks.emplace(GetChunkKey(base->chunks_[i]), i);
+    }
+  }
+  for (size_t i = 0; i < chunks_.size(); ++i) {
+    const Chunk& chunk = chunks_[i];
+    if (chunk.block_index != kBlockInBase) {
+      chunk_mask[i] = true;
+      continue;
+    }
+    auto base_chunk_it = base_chunks.find(GetChunkKey(chunk));
+    if (base_chunk_it == base_chunks.end()) {
+      XELOGE("Memory chunk {:08X} of heap {} is not in the base save state",
+             chunk.offset, chunk.heap_index);
+      return false;
+    }
+    const Chunk& base_chunk = base->chunks_[base_chunk_it->second];
+    if (base_chunk.length != chunk.length || base_chunk.hash != chunk.hash ||
+        base_chunk.block_index == kBlockInBase) {
+      XELOGE("Memory chunk {:08X} of heap {} differs in the base save state",
+             chunk.offset, chunk.heap_index);
+      return false;
+    }
+    base_chunk_mask[base_chunk_it->second] = true;
+  }
+  if (base && !base->RestoreChunks(memory, base_chunk_mask)) {
+    return false;
+  }
+  return RestoreChunks(memory, chunk_mask);
+}
+
+bool MemorySnapshot::RestoreChunks(Memory& memory,
+                                   const std::vector<bool>& chunk_mask) const {
+  // The chunks of every block are consecutive.
+  std::vector<std::pair<size_t, size_t>> block_chunk_ranges(blocks_.size(),
+                                                            {SIZE_MAX, 0});
+  std::vector<bool> blocks_needed(blocks_.size(), false);
+  for (size_t i = 0; i < chunks_.size(); ++i) {
+    uint32_t block_index = chunks_[i].block_index;
+    if (block_index == kBlockInBase) {
+      continue;
+    }
+    auto& block_chunk_range = block_chunk_ranges[block_index];
+    block_chunk_range.first = std::min(block_chunk_range.first, i);
+    block_chunk_range.second = i + 1;
+    if (chunk_mask[i]) {
+      blocks_needed[block_index] = true;
+    }
+  }
+
+  std::atomic<size_t> next_block_index(0);
+  std::atomic<bool> failed(false);
+  RunOnThreads(GetSaveStateThreadCount(blocks_.size()), [&]() {
+    FILE* file = xe::filesystem::OpenFile(path_, "rb");
+    if (!file) {
+      failed = true;
+      return;
+    }
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    std::vector<uint8_t> compressed, uncompressed;
+    while (!failed) {
+      size_t block_index = next_block_index.fetch_add(1);
+      if (block_index >= blocks_.size()) {
+        break;
+      }
+      if (!blocks_needed[block_index]) {
+        continue;
+      }
+      const Block& block = blocks_[block_index];
+      compressed.resize(block.compressed_size);
+      uncompressed.resize(block.uncompressed_size);
+      if (!xe::filesystem::Seek(file, int64_t(block.file_offset), SEEK_SET) ||
+          fread(compressed.data(), 1, compressed.size(), file) !=
+              compressed.size()) {
+        XELOGE("Failed to read a save state memory block");
+        failed = true;
+        break;
+      }
+      size_t uncompressed_size =
+          ZSTD_decompressDCtx(dctx, uncompressed.data(), uncompressed.size(),
+                              compressed.data(), compressed.size());
+      if (ZSTD_isError(uncompressed_size) ||
+          uncompressed_size != uncompressed.size()) {
+        XELOGE("Failed to decompress a save state memory block");
+        failed = true;
+        break;
+      }
+      const uint8_t* chunk_data = uncompressed.data();
+      const uint8_t* chunk_data_end = chunk_data + uncompressed_size;
+      for (size_t i = block_chunk_ranges[block_index].first;
+           i < block_chunk_ranges[block_index].second; ++i) {
+        const Chunk& chunk = chunks_[i];
+        if (chunk.block_index != block_index) {
+          continue;
+        }
+        if (size_t(chunk_data_end - chunk_data) < chunk.length) {
+          failed = true;
+          break;
+        }
+        if (chunk_mask[i]) {
+          BaseHeap* heap = memory.GetSaveStateHeap(chunk.heap_index);
+          if (uint64_t(chunk.offset) + chunk.length > heap->heap_size()) {
+            failed = true;
+            break;
+          }
+          std::memcpy(heap->TranslateRelative(chunk.offset), chunk_data,
+                      chunk.length);
+        }
+        chunk_data += chunk.length;
+      }
+    }
+    ZSTD_freeDCtx(dctx);
+    fclose(file);
+  });
+  if (failed) {
+    XELOGE("Failed to restore the memory from {}", path_);
+  }
+  return !failed;
+}
+
+}  // namespace xe
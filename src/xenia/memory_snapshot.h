@@ -0,0 +1,102 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_MEMORY_SNAPSHOT_H_
+#define XENIA_MEMORY_SNAPSHOT_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+#include "xenia/base/assert.h"
+
+namespace xe {
+
+class Memory;
+
+// Contents of the committed pages of the save state heaps (the page tables are
+// saved by Memory::Save).
+//
+// The committed ranges are split into chunks that are hashed, so an incremental
+// snapshot only stores the chunks that differ from those in a full base
+// snapshot. The stored chunks are grouped into blocks compressed with zstd
+// independently of each other, so compression and decompression are done on
+// multiple threads.
+//
+// Layout: Header, Chunk[chunk_count], Block[block_count], then the compressed
+// blocks.
+class MemorySnapshot {
+ public:
+  static constexpr uint32_t kMagic = 0x4D454D58;  // 'XMEM'
+  static constexpr uint32_t kChunkSize = 64 * 1024;
+  // Uncompressed size of the chunks gathered in one block, approximately.
+  static constexpr uint32_t kBlockSize = 1024 * 1024;
+  static constexpr uint32_t kBlockInBase = UINT32_MAX;
+
+  struct Header {
+    uint32_t magic;
+    uint32_t chunk_size;
+    uint32_t chunk_count;
+    uint32_t block_count;
+  };
+  static_assert_size(Header, 16);
+
+  struct Chunk {
+    uint32_t heap_index;
+    // Relative to the heap.
+    uint32_t offset;
+    uint32_t length;
+    // Block containing the data, or kBlockInBase if it's stored in the base
+    // snapshot.
+    uint32_t block_index;
+    uint64_t hash;
+  };
+  static_assert_size(Chunk, 24);
+
+  struct Block {
+    // Absolute offset in the file.
+    uint64_t file_offset;
+    uint32_t compressed_size;
+    uint32_t uncompressed_size;
+  };
+  static_assert_size(Block, 16);
+
+  // Writes the contents of the memory at the current position of the file,
+  // with the chunks identical to those in the base skipped if it's not null.
+  // The memory must not be modified while this is happening.
+  static bool Write(Memory& memory, FILE* file, const MemorySnapshot* base);
+
+  // Reads the tables of the snapshot stored at the offset in the file.
+  bool Load(const std::filesystem::path& path, uint64_t offset);
+
+  const std::vector<Chunk>& chunks() const { return chunks_; }
+  bool is_incremental() const;
+
+  // Writes the contents to the memory with the page tables already restored.
+  // The base must be provided for incremental snapshots.
+  bool Restore(Memory& memory, const MemorySnapshot* base) const;
+
+ private:
+  static uint64_t GetChunkKey(const Chunk& chunk) {
+    return (uint64_t(chunk.heap_index) << 32) | chunk.offset;
+  }
+
+  // Decompresses the blocks containing the chunks marked in the mask and
+  // copies those chunks to the memory.
+  bool RestoreChunks(Memory& memory, const std::vector<bool>& chunk_mask) const;
+
+  std::filesystem::path path_;
+  std::vector<Chunk> chunks_;
+  std::vector<Block> blocks_;
+};
+
+}  // namespace xe
+
+#endif  // XENIA_MEMORY_SNAPSHOT_H_
@@ -9,8 +9,13 @@ project("xenia-core")
   links({
     "fmt",
     "xenia-base",
+    "zstd",
   })
   defines({
     "CURL_STATICLIB"
   })
   files({"*.h", "*.cc"})
+
+if enableTests then
+  include("testing")
+end
@@ -0,0 +1,198 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "xenia/base/math.h"
+#include "xenia/memory.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe::test {
+
+namespace {
+
+constexpr uint32_t kHeapBase = 0x40000000;
+
+// Page table scan equivalent to what BaseHeap::AllocRange did before the free
+// extents were introduced, for the whole heap.
+uint32_t FindFreePagesByScan(const std::vector<bool>& reserved,
+                             uint32_t page_count, uint32_t page_alignment,
+                             bool top_down) {
+  uint32_t high_page_number = uint32_t(reserved.size()) - 1;
+  high_page_number -= high_page_number % page_alignment;
+  auto is_range_free = [&](uint32_t base_page_number) {
+    for (uint32_t i = 0; i < page_count; ++i) {
+      if (reserved[base_page_number + i]) {
+        return false;
+      }
+    }
+    return true;
+  };
+  if (top_down) {
+    for (int64_t base_page_number =
+             int64_t(high_page_number) -
+             xe::round_up(page_count, page_alignment);
+         base_page_number >= 0; base_page_number -= page_alignment) {
+      if (is_range_free(uint32_t(base_page_number))) {
+        return uint32_t(base_page_number);
+      }
+    }
+  } else {
+    for (uint32_t base_page_number = 0;
+         base_page_number + page_count <= high_page_number;
+         base_page_number += page_alignment) {
+      if (is_range_free(base_page_number)) {
+        return base_page_number;
+      }
+    }
+  }
+  return UINT32_MAX;
+}
+
+struct Allocation {
+  uint32_t address;
+  uint32_t page_count;
+};
+
+// Fills the heap with allocations of mixed sizes and releases a part of them,
+// leaving holes like after a few level loads.
+void FragmentHeap(BaseHeap& heap, std::mt19937& random,
+                  std::vector<Allocation>& allocations) {
+  const uint32_t page_size = heap.page_size();
+  for (uint32_t i = 0; i < 4096; ++i) {
+    uint32_t page_count = 1 + random() % 8;
+    uint32_t address;
+    if (!heap.AllocRange(kHeapBase, kHeapBase + heap.heap_size() - 1,
+                         page_count * page_size, page_size,
+                         kMemoryAllocationReserve, kMemoryProtectRead, false,
+                         &address)) {
+      break;
+    }
+    allocations.push_back({address, page_count});
+  }
+  for (size_t i = 0; i < allocations.size();) {
+    if (random() % 3) {
+      ++i;
+      continue;
+    }
+    REQUIRE(heap.Release(allocations[i].address));
+    allocations[i] = allocations.back();
+    allocations.pop_back();
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Heap allocation matches the page table scan", "[memory]") {
+  auto memory = std::make_unique<Memory>();
+  REQUIRE(memory->Initialize());
+  BaseHeap& heap = *memory->LookupHeap(kHeapBase);
+  REQUIRE(heap.heap_base() == kHeapBase);
+  const uint32_t page_size = heap.page_size();
+
+  std::vector<bool> reserved(heap.total_page_count(), false);
+  std::vector<Allocation> allocations;
+  std::mt19937 random(0x360);
+  const uint32_t alignments[] = {1, 1, 1, 2, 16};
+  for (uint32_t i = 0; i < 2000; ++i) {
+    if (!allocations.empty() && random() % 5 < 2) {
+      size_t index = random() % allocations.size();
+      const Allocation& allocation = allocations[index];
+      REQUIRE(heap.Release(allocation.address));
+      uint32_t first_page_number =
+          (allocation.address - kHeapBase) / page_size;
+      for (uint32_t j = 0; j < allocation.page_count; ++j) {
+        reserved[first_page_number + j] = false;
+      }
+      allocations[index] = allocations.back();
+      allocations.pop_back();
+      continue;
+    }
+    uint32_t page_count = 1 + random() % 32;
+    uint32_t page_alignment = alignments[random() % xe::countof(alignments)];
+    bool top_down = (random() & 1) != 0;
+    uint32_t expected_page_number =
+        FindFreePagesByScan(reserved, page_count, page_alignment, top_down);
+    uint32_t address;
+    bool allocated = heap.AllocRange(
+        kHeapBase, kHeapBase + heap.heap_size() - 1, page_count * page_size,
+        page_alignment * page_size, kMemoryAllocationReserve,
+        kMemoryProtectRead, top_down, &address);
+    INFO("Allocation " << i << ": " << page_count << " pages aligned to "
+                       << page_alignment << (top_down ? ", top-down" : ""));
+    REQUIRE(allocated == (expected_page_number != UINT32_MAX));
+    if (!allocated) {
+      continue;
+    }
+    REQUIRE(address == kHeapBase + expected_page_number * page_size);
+    for (uint32_t j = 0; j < page_count; ++j) {
+      reserved[expected_page_number + j] = true;
+    }
+    allocations.push_back({address, page_count});
+  }
+
+  // Free regions reported by queries must match the model too.
+  uint32_t page_number = 0;
+  while (page_number < reserved.size()) {
+    HeapAllocationInfo info;
+    REQUIRE(heap.QueryRegionInfo(kHeapBase + page_number * page_size, &info));
+    uint32_t region_page_count = info.region_size / page_size;
+    REQUIRE(region_page_count);
+    for (uint32_t j = 0; j < region_page_count; ++j) {
+      REQUIRE(reserved[page_number + j] == (info.state != 0));
+    }
+    page_number += region_page_count;
+  }
+}
+
+TEST_CASE("Heap allocation churn", "[.benchmark][memory]") {
+  auto memory = std::make_unique<Memory>();
+  REQUIRE(memory->Initialize());
+  BaseHeap& heap = *memory->LookupHeap(kHeapBase);
+  const uint32_t page_size = heap.page_size();
+
+  std::mt19937 random(0x360);
+  std::vector<Allocation> allocations;
+  FragmentHeap(heap, random, allocations);
+
+  constexpr uint32_t kIterations = 100000;
+  uint32_t failed_count = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kIterations; ++i) {
+    if (!allocations.empty() && (random() & 1)) {
+      size_t index = random() % allocations.size();
+      heap.Release(allocations[index].address);
+      allocations[index] = allocations.back();
+      allocations.pop_back();
+      continue;
+    }
+    uint32_t page_count = 1 + random() % 16;
+    uint32_t address;
+    if (heap.AllocRange(kHeapBase, kHeapBase + heap.heap_size() - 1,
+                        page_count * page_size, page_size,
+                        kMemoryAllocationReserve, kMemoryProtectRead,
+                        (random() & 3) == 0, &address)) {
+      allocations.push_back({address, page_count});
+    } else {
+      ++failed_count;
+    }
+  }
+  std::chrono::duration<double> seconds =
+      std::chrono::steady_clock::now() - start;
+  WARN(kIterations / seconds.count()
+       << " operations/s, " << heap.free_extent_count() << " free extents, "
+       << failed_count << " failed allocations");
+}
+
+}  // namespace xe::test
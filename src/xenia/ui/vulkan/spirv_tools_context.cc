@@ -15,6 +15,7 @@
 
 #include "xenia/base/logging.h"
 #include "xenia/base/platform.h"
+#include "xenia/base/utf8.h"
 
 #if XE_PLATFORM_LINUX
 #include <dlfcn.h>
@@ -63,17 +64,32 @@ bool SpirvToolsContext::Initialize(unsigned int spirv_version) {
     Shutdown();
     return false;
   }
-  spv_target_env target_env;
+  if (!LoadLibraryFunction(fn_spvBinaryDestroy_, "spvBinaryDestroy") ||
+      !LoadLibraryFunction(fn_spvOptimizerDestroy_, "spvOptimizerDestroy") ||
+      !LoadLibraryFunction(fn_spvOptimizerRegisterPassesFromFlags_,
+                           "spvOptimizerRegisterPassesFromFlags") ||
+      !LoadLibraryFunction(fn_spvOptimizerRun_, "spvOptimizerRun") ||
+      !LoadLibraryFunction(fn_spvOptimizerOptionsCreate_,
+                           "spvOptimizerOptionsCreate") ||
+      !LoadLibraryFunction(fn_spvOptimizerOptionsDestroy_,
+                           "spvOptimizerOptionsDestroy") ||
+      !LoadLibraryFunction(fn_spvOptimizerCreate_, "spvOptimizerCreate")) {
+    // Checked last for IsOptimizerAvailable.
+    fn_spvOptimizerCreate_ = nullptr;
+    XELOGW(
+        "SPIRV-Tools: The library doesn't provide the optimizer interface, "
+        "shaders won't be optimized");
+  }
   if (spirv_version >= 0x10500) {
-    target_env = SPV_ENV_VULKAN_1_2;
+    target_env_ = SPV_ENV_VULKAN_1_2;
   } else if (spirv_version >= 0x10400) {
-    target_env = SPV_ENV_VULKAN_1_1_SPIRV_1_4;
+    target_env_ = SPV_ENV_VULKAN_1_1_SPIRV_1_4;
   } else if (spirv_version >= 0x10300) {
-    target_env = SPV_ENV_VULKAN_1_1;
+    target_env_ = SPV_ENV_VULKAN_1_1;
   } else {
-    target_env = SPV_ENV_VULKAN_1_0;
+    target_env_ = SPV_ENV_VULKAN_1_0;
   }
-  context_ = fn_spvContextCreate_(target_env);
+  context_ = fn_spvContextCreate_(target_env_);
   if (!context_) {
     XELOGE("SPIRV-Tools: Failed to create a Vulkan 1.0 context");
     Shutdown();
@@ -95,6 +111,7 @@ void SpirvToolsContext::Shutdown() {
 #endif
     library_ = nullptr;
   }
+  fn_spvOptimizerCreate_ = nullptr;
 }
 
 spv_result_t SpirvToolsContext::Validate(const uint32_t* words,
@@ -118,6 +135,65 @@ spv_result_t SpirvToolsContext::Validate(const uint32_t* words,
   return result;
 }
 
+spv_result_t SpirvToolsContext::Optimize(
+    const uint32_t* words, size_t num_words, const std::string_view passes,
+    std::vector<uint32_t>& optimized_out) const {
+  optimized_out.clear();
+  if (!context_ || !IsOptimizerAvailable()) {
+    return SPV_UNSUPPORTED;
+  }
+  std::vector<std::string> pass_strings;
+  for (std::string_view pass : xe::utf8::split(passes, " ", true)) {
+    pass_strings.emplace_back(pass);
+  }
+  std::vector<const char*> pass_flags;
+  pass_flags.reserve(pass_strings.size());
+  for (const std::string& pass : pass_strings) {
+    pass_flags.push_back(pass.c_str());
+  }
+  spv_optimizer_t* optimizer = fn_spvOptimizerCreate_(target_env_);
+  if (!optimizer) {
+    return SPV_ERROR_OUT_OF_MEMORY;
+  }
+  spv_result_t result = SPV_ERROR_INVALID_BINARY;
+  if (fn_spvOptimizerRegisterPassesFromFlags_(optimizer, pass_flags.data(),
+                                              pass_flags.size())) {
+    spv_optimizer_options options = fn_spvOptimizerOptionsCreate_();
+    spv_binary optimized = nullptr;
+    result = fn_spvOptimizerRun_(optimizer, words, num_words, &optimized,
+                                 options);
+    if (optimized) {
+      if (result == SPV_SUCCESS) {
+        optimized_out.assign(optimized->code,
+                             optimized->code + optimized->wordCount);
+      }
+      fn_spvBinaryDestroy_(optimized);
+    }
+    fn_spvOptimizerOptionsDestroy_(options);
+  } else {
+    XELOGE("SPIRV-Tools: Invalid optimizer passes: {}", passes);
+  }
+  fn_spvOptimizerDestroy_(optimizer);
+  return result;
+}
+
+size_t SpirvToolsContext::CountInstructions(const uint32_t* words,
+                                            size_t num_words) {
+  // Skip the 5-word header.
+  size_t word_index = 5;
+  size_t instruction_count = 0;
+  while (word_index < num_words) {
+    // The word count is in the upper 16 bits of the first word.
+    uint32_t instruction_word_count = words[word_index] >> 16;
+    if (!instruction_word_count) {
+      break;
+    }
+    word_index += instruction_word_count;
+    ++instruction_count;
+  }
+  return instruction_count;
+}
+
 }  // namespace vulkan
 }  // namespace ui
 }  // namespace xe
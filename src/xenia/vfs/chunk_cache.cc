@@ -0,0 +1,67 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/vfs/chunk_cache.h"
+
+#include <cstring>
+
+#include "xenia/base/assert.h"
+
+namespace xe {
+namespace vfs {
+
+ChunkCache::ChunkCache(size_t chunk_size, size_t max_chunks)
+    : chunk_size_(chunk_size), max_chunks_(max_chunks) {
+  assert_not_zero(chunk_size);
+  assert_not_zero(max_chunks);
+}
+
+bool ChunkCache::Read(uint64_t key, size_t chunk_offset,
+                      std::span<uint8_t> buffer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = map_.find(key);
+  if (it == map_.end() || chunk_offset + buffer.size() > it->second->size) {
+    ++statistics_.misses;
+    return false;
+  }
+  std::memcpy(buffer.data(), it->second->data.get() + chunk_offset,
+              buffer.size());
+  lru_.splice(lru_.begin(), lru_, it->second);
+  ++statistics_.hits;
+  return true;
+}
+
+bool ChunkCache::Contains(uint64_t key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return map_.count(key) != 0;
+}
+
+void ChunkCache::Insert(uint64_t key, std::unique_ptr<uint8_t[]> data,
+                        size_t size) {
+  assert_true(size <= chunk_size_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (map_.count(key)) {
+    return;
+  }
+  while (lru_.size() >= max_chunks_) {
+    map_.erase(lru_.back().key);
+    lru_.pop_back();
+    ++statistics_.evictions;
+  }
+  lru_.push_front({key, size, std::move(data)});
+  map_.emplace(key, lru_.begin());
+}
+
+ChunkCache::Statistics ChunkCache::statistics() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+}  // namespace vfs
+}  // namespace xe
@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_VFS_CHUNK_CACHE_H_
+#define XENIA_VFS_CHUNK_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+
+namespace xe {
+namespace vfs {
+
+// Thread-safe LRU cache of fixed-size chunks of device data, for devices where
+// obtaining the data is expensive (decompression, host reads bypassing the
+// memory mapping). The meaning of the keys is up to the device.
+class ChunkCache {
+ public:
+  struct Statistics {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+  };
+
+  ChunkCache(size_t chunk_size, size_t max_chunks);
+
+  size_t chunk_size() const { return chunk_size_; }
+  size_t max_chunks() const { return max_chunks_; }
+
+  // Copies from a cached chunk and marks it as recently used. Returns false if
+  // the chunk is not cached or is shorter than the requested range.
+  bool Read(uint64_t key, size_t chunk_offset, std::span<uint8_t> buffer);
+  bool Contains(uint64_t key);
+  // data must be chunk_size() long, with size valid bytes. Does nothing if the
+  // chunk has been inserted by another thread in the meantime.
+  void Insert(uint64_t key, std::unique_ptr<uint8_t[]> data, size_t size);
+
+  Statistics statistics();
+
+ private:
+  struct Chunk {
+    uint64_t key;
+    size_t size;
+    std::unique_ptr<uint8_t[]> data;
+  };
+
+  size_t chunk_size_;
+  size_t max_chunks_;
+
+  std::mutex mutex_;
+  // Most recently used first.
+  std::list<Chunk> lru_;
+  std::unordered_map<uint64_t, std::list<Chunk>::iterator> map_;
+  Statistics statistics_ = {};
+};
+
+}  // namespace vfs
+}  // namespace xe
+
+#endif  // XENIA_VFS_CHUNK_CACHE_H_
@@ -9,17 +9,36 @@
 
 #include "xenia/vfs/devices/disc_image_device.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "xenia/base/cvar.h"
 #include "xenia/base/literals.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/math.h"
+#include "xenia/base/profiling.h"
 #include "xenia/vfs/devices/disc_image_entry.h"
 
+DEFINE_bool(disc_image_streaming, false,
+            "Read disc images on demand through an explicit cache instead of "
+            "mapping the whole image into the address space. Reduces memory "
+            "and page fault pressure when running many instances with large "
+            "images.",
+            "Storage");
+DEFINE_uint32(disc_image_cache_size, 32,
+              "Size of the cache of disc image data when disc_image_streaming "
+              "is enabled, in MiB.",
+              "Storage");
+
 namespace xe {
 namespace vfs {
 
 using namespace xe::literals;
 
 constexpr size_t kXESectorSize = 2_KiB;
+// Bound on the size of a directory listing, real ones are a few sectors.
+constexpr size_t kMaxDirectorySize = 32_MiB;
+constexpr size_t kStreamingChunkSize = 64_KiB;
 
 DiscImageDevice::DiscImageDevice(const std::string_view mount_path,
                                  const std::filesystem::path& host_path)
@@ -28,17 +47,41 @@ DiscImageDevice::DiscImageDevice(const std::string_view mount_path,
 DiscImageDevice::~DiscImageDevice() = default;
 
 bool DiscImageDevice::Initialize() {
-  mmap_ = MappedMemory::Open(host_path_, MappedMemory::Mode::kRead);
-  if (!mmap_) {
-    XELOGE("Disc image could not be mapped");
-    return false;
+  if (cvars::disc_image_streaming) {
+    file_ = xe::filesystem::FileHandle::OpenExisting(
+        host_path_, xe::filesystem::FileAccess::kGenericRead);
+    if (!file_) {
+      XELOGE("Disc image could not be opened");
+      return false;
+    }
+    std::error_code error_code;
+    image_size_ = size_t(std::filesystem::file_size(host_path_, error_code));
+    if (error_code) {
+      XELOGE("Disc image size could not be queried");
+      return false;
+    }
+    // All reads are either of directories or guided by the file extents, so
+    // the OS reading ahead blindly would mostly load unrelated files.
+    file_->DisableReadAhead();
+    cache_ = std::make_unique<ChunkCache>(
+        kStreamingChunkSize,
+        std::max(size_t(cvars::disc_image_cache_size) * 1_MiB /
+                     kStreamingChunkSize,
+                 size_t(1)));
+    XELOGFS("DiscImageDevice::Initialize (streaming)");
   } else {
-    XELOGFS("DiscImageDevice::Initialize");
+    mmap_ = MappedMemory::Open(host_path_, MappedMemory::Mode::kRead);
+    if (!mmap_) {
+      XELOGE("Disc image could not be mapped");
+      return false;
+    } else {
+      XELOGFS("DiscImageDevice::Initialize");
+    }
+    image_size_ = mmap_->size();
   }
 
   ParseState state = {0};
-  state.ptr = mmap_->data();
-  state.size = mmap_->size();
+  state.size = image_size_;
   auto result = Verify(&state);
   if (result != Error::kSuccess) {
     XELOGE("Failed to verify disc image header: {}",
@@ -46,7 +89,12 @@ bool DiscImageDevice::Initialize() {
     return false;
   }
 
-  result = ReadAllEntries(&state, state.ptr + state.root_offset);
+  std::vector<uint8_t> root_buffer(state.root_size);
+  if (!ReadImage(state.root_offset, root_buffer)) {
+    XELOGE("Failed to read the GDFX root directory");
+    return false;
+  }
+  result = ReadAllEntries(&state, root_buffer.data());
   if (result != Error::kSuccess) {
     XELOGE("Failed to read all GDFX entries: {}", static_cast<int32_t>(result));
     return false;
@@ -68,6 +116,78 @@ Entry* DiscImageDevice::ResolvePath(const std::string_view path) {
   return root_entry_->ResolvePath(path);
 }
 
+bool DiscImageDevice::ReadImage(size_t offset, std::span<uint8_t> buffer) {
+  if (offset > image_size_ || image_size_ - offset < buffer.size()) {
+    return false;
+  }
+  if (mmap_) {
+    std::memcpy(buffer.data(), mmap_->data() + offset, buffer.size());
+    return true;
+  }
+
+  uint8_t* out = buffer.data();
+  size_t position = offset;
+  size_t end = offset + buffer.size();
+  while (position < end) {
+    uint64_t chunk_index = position / kStreamingChunkSize;
+    size_t chunk_start = size_t(chunk_index) * kStreamingChunkSize;
+    size_t chunk_offset = position - chunk_start;
+    size_t chunk_end = std::min(chunk_start + kStreamingChunkSize, image_size_);
+    size_t copy_length = std::min(chunk_end, end) - position;
+    if (!cache_->Read(chunk_index, chunk_offset, {out, copy_length})) {
+      if (!chunk_offset && position + copy_length == chunk_end) {
+        // Whole chunks are read directly, without pushing out data that small
+        // reads may need again.
+        if (!ReadImageUncached(position, {out, copy_length})) {
+          return false;
+        }
+      } else {
+        auto chunk_data = std::make_unique<uint8_t[]>(kStreamingChunkSize);
+        size_t chunk_size = chunk_end - chunk_start;
+        if (!ReadImageUncached(chunk_start, {chunk_data.get(), chunk_size})) {
+          return false;
+        }
+        std::memcpy(out, chunk_data.get() + chunk_offset, copy_length);
+        cache_->Insert(chunk_index, std::move(chunk_data), chunk_size);
+      }
+    }
+    out += copy_length;
+    position += copy_length;
+  }
+
+  auto statistics = cache_->statistics();
+  COUNT_profile_set("vfs/disc_image/cache_hits", statistics.hits);
+  COUNT_profile_set("vfs/disc_image/cache_misses", statistics.misses);
+  COUNT_profile_set("vfs/disc_image/host_read_mb",
+                    host_read_bytes_.load(std::memory_order_relaxed) / 1_MiB);
+  return true;
+}
+
+bool DiscImageDevice::ReadImageUncached(size_t offset,
+                                        std::span<uint8_t> buffer) {
+  size_t bytes_read = 0;
+  if (!file_->Read(offset, buffer.data(), buffer.size(), &bytes_read) ||
+      bytes_read != buffer.size()) {
+    XELOGE("Failed to read {} bytes at 0x{:X} from the disc image",
+           buffer.size(), offset);
+    return false;
+  }
+  host_read_bytes_.fetch_add(bytes_read, std::memory_order_relaxed);
+  return true;
+}
+
+void DiscImageDevice::PrefetchImage(size_t offset, size_t length) {
+  if (offset >= image_size_) {
+    return;
+  }
+  length = std::min(length, image_size_ - offset);
+  if (mmap_) {
+    mmap_->Prefetch(offset, length);
+  } else {
+    file_->Prefetch(offset, length);
+  }
+}
+
 DiscImageDevice::Error DiscImageDevice::Verify(ParseState* state) {
   // Find sector 32 of the game partition - try at a few points.
   static constexpr size_t likely_offsets[] = {
@@ -87,15 +207,16 @@ DiscImageDevice::Error DiscImageDevice::Verify(ParseState* state) {
   }
 
   // Read sector 32 to get FS state.
-  if (state->size < state->game_offset + (32 * kXESectorSize)) {
+  uint8_t fs_header[28];
+  if (!ReadImage(state->game_offset + (32 * kXESectorSize), fs_header)) {
     return Error::kErrorReadError;
   }
-  uint8_t* fs_ptr = state->ptr + state->game_offset + (32 * kXESectorSize);
-  state->root_sector = xe::load<uint32_t>(fs_ptr + 20);
-  state->root_size = xe::load<uint32_t>(fs_ptr + 24);
+  state->root_sector = xe::load<uint32_t>(fs_header + 20);
+  state->root_size = xe::load<uint32_t>(fs_header + 24);
   state->root_offset =
       state->game_offset + (state->root_sector * kXESectorSize);
-  if (state->root_size < 13 || state->root_size > 32_MiB) {
+  if (state->root_size < 13 || state->root_size > kMaxDirectorySize ||
+      state->root_offset + state->root_size > state->size) {
     return Error::kErrorDamagedFile;
   }
 
@@ -108,7 +229,11 @@ bool DiscImageDevice::VerifyMagic(ParseState* state, size_t offset) {
   }
 
   // Simple check to see if the given offset contains the magic value.
-  return std::memcmp(state->ptr + offset, "MICROSOFT*XBOX*MEDIA", 20) == 0;
+  uint8_t magic[20];
+  if (!ReadImage(offset, magic)) {
+    return false;
+  }
+  return std::memcmp(magic, "MICROSOFT*XBOX*MEDIA", 20) == 0;
 }
 
 DiscImageDevice::Error DiscImageDevice::ReadAllEntries(
@@ -117,7 +242,7 @@ DiscImageDevice::Error DiscImageDevice::ReadAllEntries(
   root_entry->attributes_ = kFileAttributeDirectory;
   root_entry_ = std::unique_ptr<Entry>(root_entry);
 
-  if (!ReadEntry(state, root_buffer, 0, root_entry)) {
+  if (!ReadEntry(state, root_buffer, state->root_size, 0, root_entry)) {
     return Error::kErrorOutOfMemory;
   }
 
@@ -125,9 +250,13 @@ DiscImageDevice::Error DiscImageDevice::ReadAllEntries(
 }
 
 bool DiscImageDevice::ReadEntry(ParseState* state, const uint8_t* buffer,
-                                uint16_t entry_ordinal,
+                                size_t buffer_size, uint16_t entry_ordinal,
                                 DiscImageEntry* parent) {
-  const uint8_t* p = buffer + (entry_ordinal * 4);
+  size_t entry_offset = size_t(entry_ordinal) * 4;
+  if (entry_offset + 14 > buffer_size) {
+    return false;
+  }
+  const uint8_t* p = buffer + entry_offset;
 
   uint16_t node_l = xe::load<uint16_t>(p + 0);
   uint16_t node_r = xe::load<uint16_t>(p + 2);
@@ -136,8 +265,11 @@ bool DiscImageDevice::ReadEntry(ParseState* state, const uint8_t* buffer,
   uint8_t attributes = xe::load<uint8_t>(p + 12);
   uint8_t name_length = xe::load<uint8_t>(p + 13);
   auto name_buffer = reinterpret_cast<const char*>(p + 14);
+  if (entry_offset + 14 + name_length > buffer_size) {
+    return false;
+  }
 
-  if (node_l && !ReadEntry(state, buffer, node_l, parent)) {
+  if (node_l && !ReadEntry(state, buffer, buffer_size, node_l, parent)) {
     return false;
   }
 
@@ -166,14 +298,21 @@ bool DiscImageDevice::ReadEntry(ParseState* state, const uint8_t* buffer,
     entry->data_size_ = 0;
     if (length) {
       // Not a leaf - read in children.
-      if (state->size < state->game_offset + (sector * kXESectorSize)) {
-        // Out of bounds read.
+      size_t folder_offset = state->game_offset + (sector * kXESectorSize);
+      if (length < 14 || length > kMaxDirectorySize ||
+          folder_offset > state->size ||
+          length > state->size - folder_offset) {
+        // Too small for an entry, or damaged so that the listing would be huge
+        // or out of bounds.
         return false;
       }
       // Read child list.
-      uint8_t* folder_ptr =
-          state->ptr + state->game_offset + (sector * kXESectorSize);
-      if (!ReadEntry(state, folder_ptr, 0, entry.get())) {
+      std::vector<uint8_t> folder_buffer(length);
+      if (!ReadImage(folder_offset, folder_buffer)) {
+        return false;
+      }
+      if (!ReadEntry(state, folder_buffer.data(), folder_buffer.size(), 0,
+                     entry.get())) {
         return false;
       }
     }
@@ -187,7 +326,7 @@ bool DiscImageDevice::ReadEntry(ParseState* state, const uint8_t* buffer,
   parent->children_.emplace_back(std::move(entry));
 
   // Read next file in the list.
-  if (node_r && !ReadEntry(state, buffer, node_r, parent)) {
+  if (node_r && !ReadEntry(state, buffer, buffer_size, node_r, parent)) {
     return false;
   }
 
@@ -10,10 +10,14 @@
 #ifndef XENIA_VFS_DEVICES_DISC_IMAGE_DEVICE_H_
 #define XENIA_VFS_DEVICES_DISC_IMAGE_DEVICE_H_
 
+#include <atomic>
 #include <memory>
+#include <span>
 #include <string>
 
+#include "xenia/base/filesystem.h"
 #include "xenia/base/mapped_memory.h"
+#include "xenia/vfs/chunk_cache.h"
 #include "xenia/vfs/device.h"
 
 namespace xe {
@@ -38,13 +42,25 @@ class DiscImageDevice : public Device {
   uint32_t component_name_max_length() const override { return 255; }
 
   uint32_t total_allocation_units() const override {
-    return uint32_t(mmap_->size() / sectors_per_allocation_unit() /
+    return uint32_t(image_size_ / sectors_per_allocation_unit() /
                     bytes_per_sector());
   }
   uint32_t available_allocation_units() const override { return 0; }
   uint32_t sectors_per_allocation_unit() const override { return 1; }
   uint32_t bytes_per_sector() const override { return 0x200; }
 
+  size_t image_size() const { return image_size_; }
+  // Null if the image is streamed rather than mapped.
+  MappedMemory* mmap() const { return mmap_.get(); }
+
+  // Reads from the image through the memory mapping or the chunk cache.
+  // Returns false if the range is outside the image or the host read fails.
+  bool ReadImage(size_t offset, std::span<uint8_t> buffer);
+  // Hints that the range of the image will be read soon. Ranges come from the
+  // GDFX directory, so only the data of the file being read is loaded rather
+  // than whatever follows it in the image.
+  void PrefetchImage(size_t offset, size_t length);
+
  private:
   enum class Error {
     kSuccess = 0,
@@ -57,10 +73,15 @@ class DiscImageDevice : public Device {
   std::string name_;
   std::filesystem::path host_path_;
   std::unique_ptr<Entry> root_entry_;
+  size_t image_size_ = 0;
+  // Either the image is mapped...
   std::unique_ptr<MappedMemory> mmap_;
+  // ...or it's read on demand and cached explicitly.
+  std::unique_ptr<xe::filesystem::FileHandle> file_;
+  std::unique_ptr<ChunkCache> cache_;
+  std::atomic<uint64_t> host_read_bytes_ = 0;
 
   typedef struct {
-    uint8_t* ptr;
     size_t size;         // Size (bytes) of total image.
     size_t game_offset;  // Offset (bytes) of game partition.
     size_t root_sector;  // Offset (sector) of root.
@@ -71,8 +92,9 @@ class DiscImageDevice : public Device {
   Error Verify(ParseState* state);
   bool VerifyMagic(ParseState* state, size_t offset);
   Error ReadAllEntries(ParseState* state, const uint8_t* root_buffer);
-  bool ReadEntry(ParseState* state, const uint8_t* buffer,
+  bool ReadEntry(ParseState* state, const uint8_t* buffer, size_t buffer_size,
                  uint16_t entry_ordinal, DiscImageEntry* parent);
+  bool ReadImageUncached(size_t offset, std::span<uint8_t> buffer);
 };
 
 }  // namespace vfs
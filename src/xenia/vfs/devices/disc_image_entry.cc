@@ -11,7 +11,9 @@
 
 #include <algorithm>
 
+#include "xenia/base/literals.h"
 #include "xenia/base/math.h"
+#include "xenia/vfs/devices/disc_image_device.h"
 #include "xenia/vfs/devices/disc_image_file.h"
 
 namespace xe {
@@ -35,13 +37,27 @@ std::unique_ptr<DiscImageEntry> DiscImageEntry::Create(
 }
 
 X_STATUS DiscImageEntry::Open(uint32_t desired_access, File** out_file) {
+  // Most files are read from the beginning soon after being opened.
+  if (data_size_) {
+    using namespace xe::literals;
+    static_cast<DiscImageDevice*>(device_)->PrefetchImage(
+        data_offset_, std::min(data_size_, size_t(256_KiB)));
+  }
   *out_file = new DiscImageFile(desired_access, this);
   return X_STATUS_SUCCESS;
 }
 
+void DiscImageEntry::Prefetch(size_t offset, size_t length) {
+  if (offset >= data_size_) {
+    return;
+  }
+  static_cast<DiscImageDevice*>(device_)->PrefetchImage(
+      data_offset_ + offset, std::min(length, data_size_ - offset));
+}
+
 std::unique_ptr<MappedMemory> DiscImageEntry::OpenMapped(
     MappedMemory::Mode mode, size_t offset, size_t length) {
-  if (mode != MappedMemory::Mode::kRead) {
+  if (mode != MappedMemory::Mode::kRead || !mmap_) {
     // Only allow reads.
     return nullptr;
   }
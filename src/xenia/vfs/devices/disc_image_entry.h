@@ -36,8 +36,10 @@ class DiscImageEntry : public Entry {
   size_t data_size() const { return data_size_; }
 
   X_STATUS Open(uint32_t desired_access, File** out_file) override;
+  void Prefetch(size_t offset, size_t length) override;
 
-  bool can_map() const override { return true; }
+  // Streamed images can't be mapped.
+  bool can_map() const override { return mmap_ != nullptr; }
   std::unique_ptr<MappedMemory> OpenMapped(MappedMemory::Mode mode,
                                            size_t offset,
                                            size_t length) override;
@@ -11,11 +11,19 @@
 
 #include <algorithm>
 
+#include "xenia/base/literals.h"
 #include "xenia/base/logging.h"
+#include "xenia/vfs/devices/disc_image_device.h"
 #include "xenia/vfs/devices/disc_image_entry.h"
+
 namespace xe {
 namespace vfs {
 
+using namespace xe::literals;
+
+// How far ahead of sequential reads to hint the OS to load, within the file.
+constexpr size_t kSequentialPrefetchSize = 1_MiB;
+
 DiscImageFile::DiscImageFile(uint32_t file_access, DiscImageEntry* entry)
     : File(file_access, entry), entry_(entry) {}
 
@@ -29,7 +37,8 @@ X_STATUS DiscImageFile::ReadSync(std::span<uint8_t> buffer, size_t byte_offset,
     return X_STATUS_END_OF_FILE;
   }
 
-  if (entry_->data_offset() >= entry_->mmap()->size()) {
+  auto device = static_cast<DiscImageDevice*>(entry_->device());
+  if (entry_->data_offset() >= device->image_size()) {
     xe::FatalError("This ISO image is corrupted and cannot be played.");
     return X_STATUS_END_OF_FILE;
   }
@@ -37,8 +46,21 @@ X_STATUS DiscImageFile::ReadSync(std::span<uint8_t> buffer, size_t byte_offset,
   size_t real_offset = entry_->data_offset() + byte_offset;
   size_t real_length =
       std::min(buffer.size(), entry_->data_size() - byte_offset);
-  std::memcpy(buffer.data(), entry_->mmap()->data() + real_offset, real_length);
+  if (!device->ReadImage(real_offset, buffer.first(real_length))) {
+    return X_STATUS_UNSUCCESSFUL;
+  }
   *out_bytes_read = real_length;
+
+  // Streaming the file - get the OS to load what follows, but not past the end
+  // of the file.
+  size_t read_end = byte_offset + real_length;
+  if (last_read_end_.exchange(read_end, std::memory_order_relaxed) ==
+          byte_offset &&
+      read_end < entry_->data_size()) {
+    device->PrefetchImage(
+        entry_->data_offset() + read_end,
+        std::min(kSequentialPrefetchSize, entry_->data_size() - read_end));
+  }
   return X_STATUS_SUCCESS;
 }
 
@@ -10,6 +10,8 @@
 #ifndef XENIA_VFS_DEVICES_DISC_IMAGE_FILE_H_
 #define XENIA_VFS_DEVICES_DISC_IMAGE_FILE_H_
 
+#include <atomic>
+
 #include "xenia/vfs/file.h"
 
 namespace xe {
@@ -34,6 +36,8 @@ class DiscImageFile : public File {
 
  private:
   DiscImageEntry* entry_;
+  // For detecting sequential access.
+  std::atomic<uint64_t> last_read_end_ = 0;
 };
 
 }  // namespace vfs
@@ -9,6 +9,10 @@
 
 #include "xenia/vfs/devices/disc_zarchive_device.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "xenia/base/cvar.h"
 #include "xenia/base/literals.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/math.h"
@@ -16,14 +20,34 @@
 
 #include "third_party/zarchive/include/zarchive/zarchivereader.h"
 
+DEFINE_uint32(zarchive_cache_size, 64,
+              "Size of the cache of decompressed data for zarchive disc "
+              "images, in MiB. 0 to decompress on every read.",
+              "Storage");
+DEFINE_uint32(zarchive_read_ahead, 8,
+              "Number of 64 KiB chunks of zarchive disc images to decompress "
+              "in the background ahead of files being read sequentially.",
+              "Storage");
+
 namespace xe {
 namespace vfs {
 
+using namespace xe::literals;
+
 DiscZarchiveDevice::DiscZarchiveDevice(const std::string_view mount_path,
                                        const std::filesystem::path& host_path)
     : Device(mount_path), name_("GDFX"), host_path_(host_path), reader_() {}
 
-DiscZarchiveDevice::~DiscZarchiveDevice() {};
+DiscZarchiveDevice::~DiscZarchiveDevice() {
+  if (read_ahead_thread_) {
+    {
+      std::lock_guard<std::mutex> lock(read_ahead_mutex_);
+      read_ahead_shutdown_ = true;
+    }
+    read_ahead_cond_.notify_all();
+    xe::threading::Wait(read_ahead_thread_.get(), false);
+  }
+}
 
 bool DiscZarchiveDevice::Initialize() {
   reader_ =
@@ -43,7 +67,143 @@ bool DiscZarchiveDevice::Initialize() {
   root_entry->absolute_path_ = root_path;
   root_entry_ = std::unique_ptr<Entry>(root_entry);
 
-  return ReadAllEntries("", root_entry, nullptr);
+  if (!ReadAllEntries("", root_entry, nullptr)) {
+    return false;
+  }
+
+  size_t cache_max_chunks =
+      size_t(cvars::zarchive_cache_size) * 1_MiB / kChunkSize;
+  if (cache_max_chunks) {
+    cache_ = std::make_unique<ChunkCache>(kChunkSize, cache_max_chunks);
+  }
+  if (cache_ && cvars::zarchive_read_ahead) {
+    read_ahead_thread_ = xe::threading::Thread::Create(
+        {}, [this]() { ReadAheadThread(); });
+    read_ahead_thread_->set_name("ZArchive Read Ahead");
+  }
+  return true;
+}
+
+uint64_t DiscZarchiveDevice::ReadFile(ZArchiveNodeHandle handle,
+                                      uint64_t file_size, uint64_t offset,
+                                      std::span<uint8_t> buffer) {
+  if (offset >= file_size) {
+    return 0;
+  }
+  uint64_t end = std::min(offset + buffer.size(), file_size);
+
+  if (!cache_) {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    return reader_->ReadFromFile(handle, offset, end - offset, buffer.data());
+  }
+
+  uint8_t* out = buffer.data();
+  uint64_t position = offset;
+  while (position < end) {
+    uint64_t chunk_index = position / kChunkSize;
+    uint64_t chunk_offset = position % kChunkSize;
+    uint64_t chunk_end = std::min((chunk_index + 1) * kChunkSize, file_size);
+    uint64_t copy_length = std::min(chunk_end, end) - position;
+    uint64_t key = ChunkKey(handle, chunk_index);
+    if (!cache_->Read(key, chunk_offset, {out, size_t(copy_length)})) {
+      if (!chunk_offset && position + copy_length == chunk_end) {
+        // Large reads covering whole chunks are decompressed directly into
+        // the destination without evicting data that may be reused.
+        if (DecompressChunk(handle, file_size, chunk_index, out) !=
+            copy_length) {
+          break;
+        }
+      } else {
+        auto chunk_data = std::make_unique<uint8_t[]>(kChunkSize);
+        uint32_t chunk_size =
+            DecompressChunk(handle, file_size, chunk_index, chunk_data.get());
+        if (chunk_size < chunk_offset + copy_length) {
+          break;
+        }
+        std::memcpy(out, chunk_data.get() + chunk_offset, copy_length);
+        cache_->Insert(key, std::move(chunk_data), chunk_size);
+      }
+    }
+    out += copy_length;
+    position += copy_length;
+  }
+  return position - offset;
+}
+
+void DiscZarchiveDevice::ReadAhead(ZArchiveNodeHandle handle,
+                                   uint64_t file_size, uint64_t offset) {
+  ReadAhead(handle, file_size, offset,
+            uint64_t(cvars::zarchive_read_ahead) * kChunkSize);
+}
+
+void DiscZarchiveDevice::ReadAhead(ZArchiveNodeHandle handle,
+                                   uint64_t file_size, uint64_t offset,
+                                   uint64_t length) {
+  if (!read_ahead_thread_ || offset >= file_size || !length) {
+    return;
+  }
+  uint64_t first_chunk = offset / kChunkSize;
+  uint64_t chunk_count =
+      std::min((offset + length - 1) / kChunkSize + 1 - first_chunk,
+               uint64_t(cache_->max_chunks()));
+  uint64_t end_chunk =
+      std::min(first_chunk + chunk_count,
+               (file_size + kChunkSize - 1) / kChunkSize);
+  bool queued = false;
+  {
+    std::lock_guard<std::mutex> lock(read_ahead_mutex_);
+    for (uint64_t i = first_chunk; i < end_chunk; ++i) {
+      uint64_t key = ChunkKey(handle, i);
+      if (read_ahead_pending_.count(key) || cache_->Contains(key)) {
+        continue;
+      }
+      read_ahead_pending_.insert(key);
+      read_ahead_queue_.push_back({handle, file_size, i});
+      queued = true;
+    }
+  }
+  if (queued) {
+    read_ahead_cond_.notify_one();
+  }
+}
+
+uint32_t DiscZarchiveDevice::DecompressChunk(ZArchiveNodeHandle handle,
+                                             uint64_t file_size,
+                                             uint64_t chunk_index,
+                                             uint8_t* buffer) {
+  uint64_t chunk_start = chunk_index * kChunkSize;
+  uint64_t length = std::min(kChunkSize, file_size - chunk_start);
+  std::lock_guard<std::mutex> lock(reader_mutex_);
+  return uint32_t(reader_->ReadFromFile(handle, chunk_start, length, buffer));
+}
+
+void DiscZarchiveDevice::ReadAheadThread() {
+  while (true) {
+    ReadAheadRequest request;
+    {
+      std::unique_lock<std::mutex> lock(read_ahead_mutex_);
+      read_ahead_cond_.wait(lock, [this]() {
+        return read_ahead_shutdown_ || !read_ahead_queue_.empty();
+      });
+      if (read_ahead_shutdown_) {
+        break;
+      }
+      request = read_ahead_queue_.front();
+      read_ahead_queue_.pop_front();
+    }
+    uint64_t key = ChunkKey(request.handle, request.chunk_index);
+    if (!cache_->Contains(key)) {
+      auto chunk_data = std::make_unique<uint8_t[]>(kChunkSize);
+      uint32_t chunk_size = DecompressChunk(request.handle, request.file_size,
+                                            request.chunk_index,
+                                            chunk_data.get());
+      if (chunk_size) {
+        cache_->Insert(key, std::move(chunk_data), chunk_size);
+      }
+    }
+    std::lock_guard<std::mutex> lock(read_ahead_mutex_);
+    read_ahead_pending_.erase(key);
+  }
 }
 
 void DiscZarchiveDevice::Dump(StringBuffer* string_buffer) {
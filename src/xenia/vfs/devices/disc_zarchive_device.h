@@ -10,10 +10,17 @@
 #ifndef XENIA_VFS_DEVICES_DISC_ZARCHIVE_DEVICE_H_
 #define XENIA_VFS_DEVICES_DISC_ZARCHIVE_DEVICE_H_
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <unordered_set>
 
 #include "xenia/base/mapped_memory.h"
+#include "xenia/base/threading.h"
+#include "xenia/vfs/chunk_cache.h"
 #include "xenia/vfs/device.h"
 
 #include "third_party/zarchive/include/zarchive/zarchivereader.h"
@@ -49,14 +56,57 @@ class DiscZarchiveDevice : public Device {
 
   ZArchiveReader* reader() const { return reader_.get(); }
 
+  // Reads file data through the cache of decompressed chunks shared by all
+  // files of the device. Returns the number of bytes read.
+  uint64_t ReadFile(ZArchiveNodeHandle handle, uint64_t file_size,
+                    uint64_t offset, std::span<uint8_t> buffer);
+  // Decompresses the chunks following the offset in the background, for files
+  // being read sequentially.
+  void ReadAhead(ZArchiveNodeHandle handle, uint64_t file_size,
+                 uint64_t offset);
+  // Decompresses the chunks of the range in the background, up to the cache
+  // capacity.
+  void ReadAhead(ZArchiveNodeHandle handle, uint64_t file_size,
+                 uint64_t offset, uint64_t length);
+
  private:
+  // Same as the zarchive compressed block size, so a chunk usually takes one
+  // or two block decompressions.
+  static constexpr uint64_t kChunkSize = 64 * 1024;
+
+  struct ReadAheadRequest {
+    ZArchiveNodeHandle handle;
+    uint64_t file_size;
+    uint64_t chunk_index;
+  };
+
+  static uint64_t ChunkKey(ZArchiveNodeHandle handle, uint64_t chunk_index) {
+    return (uint64_t(handle) << 32) | chunk_index;
+  }
+
   bool ReadAllEntries(const std::string& path, DiscZarchiveEntry* node,
                       DiscZarchiveEntry* parent);
 
+  uint32_t DecompressChunk(ZArchiveNodeHandle handle, uint64_t file_size,
+                           uint64_t chunk_index, uint8_t* buffer);
+  void ReadAheadThread();
+
   std::string name_;
   std::filesystem::path host_path_;
   std::unique_ptr<Entry> root_entry_;
   std::unique_ptr<ZArchiveReader> reader_;
+  // ZArchiveReader is not thread-safe.
+  std::mutex reader_mutex_;
+
+  // Null if caching is disabled.
+  std::unique_ptr<ChunkCache> cache_;
+
+  std::mutex read_ahead_mutex_;
+  std::condition_variable read_ahead_cond_;
+  std::deque<ReadAheadRequest> read_ahead_queue_;
+  std::unordered_set<uint64_t> read_ahead_pending_;
+  bool read_ahead_shutdown_ = false;
+  std::unique_ptr<xe::threading::Thread> read_ahead_thread_;
 };
 
 }  // namespace vfs
@@ -12,6 +12,7 @@
 #include <algorithm>
 
 #include "xenia/base/math.h"
+#include "xenia/vfs/devices/disc_zarchive_device.h"
 #include "xenia/vfs/devices/disc_zarchive_file.h"
 
 #include "third_party/zarchive/include/zarchive/zarchivereader.h"
@@ -40,6 +41,11 @@ X_STATUS DiscZarchiveEntry::Open(uint32_t desired_access, File** out_file) {
   return X_STATUS_SUCCESS;
 }
 
+void DiscZarchiveEntry::Prefetch(size_t offset, size_t length) {
+  static_cast<DiscZarchiveDevice*>(device_)->ReadAhead(handle_, data_size_,
+                                                       offset, length);
+}
+
 std::unique_ptr<MappedMemory> DiscZarchiveEntry::OpenMapped(
     MappedMemory::Mode mode, size_t offset, size_t length) {
   return nullptr;
@@ -35,6 +35,7 @@ class DiscZarchiveEntry : public Entry {
   size_t data_size() const { return data_size_; }
 
   X_STATUS Open(uint32_t desired_access, File** out_file) override;
+  void Prefetch(size_t offset, size_t length) override;
 
   bool can_map() const override { return false; }
   std::unique_ptr<MappedMemory> OpenMapped(MappedMemory::Mode mode,
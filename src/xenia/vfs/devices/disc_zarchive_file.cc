@@ -39,9 +39,17 @@ X_STATUS DiscZarchiveFile::ReadSync(std::span<uint8_t> buffer,
     return X_STATUS_UNSUCCESSFUL;
   }
 
-  const uint64_t bytes_read = zArchDev->reader()->ReadFromFile(
-      entry_->handle_, byte_offset, buffer.size(), buffer.data());
+  const uint64_t bytes_read =
+      zArchDev->ReadFile(entry_->handle_, entry_->size(), byte_offset, buffer);
   *out_bytes_read = bytes_read;
+
+  // Continuing from where the previous read ended - likely streaming the file,
+  // so get the following data ready before it's requested.
+  uint64_t read_end = byte_offset + bytes_read;
+  if (last_read_end_.exchange(read_end, std::memory_order_relaxed) ==
+      byte_offset) {
+    zArchDev->ReadAhead(entry_->handle_, entry_->size(), read_end);
+  }
   return X_STATUS_SUCCESS;
 }
 
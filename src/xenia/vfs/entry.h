@@ -132,6 +132,9 @@ class Entry {
     return nullptr;
   }
   virtual void update() { return; }
+  // Hints that the range of the file will be read soon, so the device can load
+  // it into its caches ahead of time. Doesn't block on the data.
+  virtual void Prefetch(size_t offset, size_t length) {}
 
  protected:
   Entry(Device* device, Entry* parent, const std::string_view path);
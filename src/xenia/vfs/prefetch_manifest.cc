@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/vfs/prefetch_manifest.h"
+
+#include <charconv>
+
+#include "third_party/fmt/include/fmt/format.h"
+#include "xenia/base/filesystem.h"
+
+namespace xe {
+namespace vfs {
+
+void PrefetchManifest::Clear() {
+  accesses_.clear();
+  last_access_.clear();
+}
+
+void PrefetchManifest::Record(const std::string_view path, uint64_t offset,
+                              uint64_t length, uint32_t time_ms) {
+  if (!length || path.empty()) {
+    return;
+  }
+  std::string path_string(path);
+  auto last_it = last_access_.find(path_string);
+  if (last_it != last_access_.end()) {
+    Access& last = accesses_[last_it->second];
+    uint64_t last_end = last.offset + last.length;
+    if (offset >= last.offset && offset + length <= last_end) {
+      // Already covered by the previous read.
+      return;
+    }
+    if (offset == last_end) {
+      last.length += length;
+      return;
+    }
+  }
+  if (accesses_.size() >= max_accesses_) {
+    return;
+  }
+  last_access_[path_string] = accesses_.size();
+  accesses_.push_back({time_ms, offset, length, std::move(path_string)});
+}
+
+std::string PrefetchManifest::Serialize() const {
+  std::string result;
+  for (const Access& access : accesses_) {
+    fmt::format_to(std::back_inserter(result), "{} {} {} {}\n", access.time_ms,
+                   access.offset, access.length, access.path);
+  }
+  return result;
+}
+
+template <typename T>
+static bool ParseField(std::string_view& line, T& value) {
+  auto [ptr, ec] =
+      std::from_chars(line.data(), line.data() + line.size(), value);
+  if (ec != std::errc() || ptr == line.data() + line.size() || *ptr != ' ') {
+    return false;
+  }
+  line.remove_prefix(ptr - line.data() + 1);
+  return true;
+}
+
+bool PrefetchManifest::Deserialize(const std::string_view data) {
+  Clear();
+  std::string_view remaining = data;
+  while (!remaining.empty()) {
+    size_t line_end = remaining.find('\n');
+    std::string_view line = remaining.substr(0, line_end);
+    remaining.remove_prefix(line_end == std::string_view::npos ? remaining.size()
+                                                               : line_end + 1);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    if (line.empty()) {
+      continue;
+    }
+    Access access;
+    if (!ParseField(line, access.time_ms) || !ParseField(line, access.offset) ||
+        !ParseField(line, access.length) || line.empty()) {
+      Clear();
+      return false;
+    }
+    access.path = line;
+    if (accesses_.size() < max_accesses_) {
+      accesses_.push_back(std::move(access));
+    }
+  }
+  return true;
+}
+
+bool PrefetchManifest::Load(const std::filesystem::path& path) {
+  FILE* file = xe::filesystem::OpenFile(path, "rb");
+  if (!file) {
+    return false;
+  }
+  std::string data;
+  char buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) != 0) {
+    data.append(buffer, read);
+  }
+  fclose(file);
+  return Deserialize(data);
+}
+
+bool PrefetchManifest::Save(const std::filesystem::path& path) const {
+  if (!xe::filesystem::CreateParentFolder(path)) {
+    return false;
+  }
+  FILE* file = xe::filesystem::OpenFile(path, "wb");
+  if (!file) {
+    return false;
+  }
+  std::string data = Serialize();
+  bool result = fwrite(data.data(), 1, data.size(), file) == data.size();
+  fclose(file);
+  return result;
+}
+
+}  // namespace vfs
+}  // namespace xe
@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_VFS_PREFETCH_MANIFEST_H_
+#define XENIA_VFS_PREFETCH_MANIFEST_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace xe {
+namespace vfs {
+
+// Ordered list of the file reads a title performed during a boot, stored per
+// title so that later boots can prefetch the same data before the guest asks
+// for it. Sequential reads of a file are merged into a single access to keep
+// the manifest small. Not thread-safe.
+class PrefetchManifest {
+ public:
+  struct Access {
+    // Milliseconds since recording started.
+    uint32_t time_ms;
+    uint64_t offset;
+    uint64_t length;
+    // Absolute guest path.
+    std::string path;
+  };
+
+  explicit PrefetchManifest(size_t max_accesses = 16384)
+      : max_accesses_(max_accesses) {}
+
+  const std::vector<Access>& accesses() const { return accesses_; }
+  bool empty() const { return accesses_.empty(); }
+
+  void Clear();
+  void Record(const std::string_view path, uint64_t offset, uint64_t length,
+              uint32_t time_ms);
+
+  // Text format, one access per line: "time_ms offset length path".
+  std::string Serialize() const;
+  bool Deserialize(const std::string_view data);
+
+  bool Load(const std::filesystem::path& path);
+  bool Save(const std::filesystem::path& path) const;
+
+ private:
+  size_t max_accesses_;
+  std::vector<Access> accesses_;
+  // Index of the latest access to each path, for merging sequential reads.
+  std::unordered_map<std::string, size_t> last_access_;
+};
+
+}  // namespace vfs
+}  // namespace xe
+
+#endif  // XENIA_VFS_PREFETCH_MANIFEST_H_
@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/vfs/chunk_cache.h"
+
+#include <cstring>
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe::vfs::test {
+
+static std::unique_ptr<uint8_t[]> MakeChunk(size_t size, uint8_t value) {
+  auto data = std::make_unique<uint8_t[]>(size);
+  std::memset(data.get(), value, size);
+  return data;
+}
+
+TEST_CASE("Chunk cache read", "[chunk_cache]") {
+  ChunkCache cache(16, 2);
+  uint8_t buffer[8] = {};
+
+  REQUIRE_FALSE(cache.Read(0, 0, buffer));
+  cache.Insert(0, MakeChunk(16, 0xAB), 12);
+  REQUIRE(cache.Contains(0));
+  REQUIRE(cache.Read(0, 4, buffer));
+  REQUIRE(buffer[0] == 0xAB);
+  REQUIRE(buffer[7] == 0xAB);
+
+  // Past the valid part of a short chunk.
+  REQUIRE_FALSE(cache.Read(0, 8, buffer));
+
+  auto statistics = cache.statistics();
+  REQUIRE(statistics.hits == 1);
+  REQUIRE(statistics.misses == 2);
+}
+
+TEST_CASE("Chunk cache LRU eviction", "[chunk_cache]") {
+  ChunkCache cache(16, 2);
+  uint8_t buffer[1];
+
+  cache.Insert(1, MakeChunk(16, 1), 16);
+  cache.Insert(2, MakeChunk(16, 2), 16);
+  // Make chunk 1 the most recently used, so chunk 2 is evicted first.
+  REQUIRE(cache.Read(1, 0, buffer));
+  cache.Insert(3, MakeChunk(16, 3), 16);
+
+  REQUIRE(cache.Contains(1));
+  REQUIRE_FALSE(cache.Contains(2));
+  REQUIRE(cache.Contains(3));
+  REQUIRE(cache.statistics().evictions == 1);
+
+  // Inserting an already cached chunk keeps the existing data.
+  cache.Insert(3, MakeChunk(16, 4), 16);
+  REQUIRE(cache.Read(3, 0, buffer));
+  REQUIRE(buffer[0] == 3);
+}
+
+}  // namespace xe::vfs::test
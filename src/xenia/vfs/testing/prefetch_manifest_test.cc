@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/vfs/prefetch_manifest.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe::vfs::test {
+
+TEST_CASE("Prefetch manifest merges sequential reads", "[prefetch_manifest]") {
+  PrefetchManifest manifest;
+  manifest.Record("game:\\a.bin", 0, 100, 0);
+  manifest.Record("game:\\b.bin", 0, 50, 1);
+  manifest.Record("game:\\a.bin", 100, 100, 2);
+  // Already covered.
+  manifest.Record("game:\\a.bin", 20, 30, 3);
+  // Not sequential.
+  manifest.Record("game:\\a.bin", 1000, 10, 4);
+
+  const auto& accesses = manifest.accesses();
+  REQUIRE(accesses.size() == 3);
+  REQUIRE(accesses[0].path == "game:\\a.bin");
+  REQUIRE(accesses[0].offset == 0);
+  REQUIRE(accesses[0].length == 200);
+  REQUIRE(accesses[1].path == "game:\\b.bin");
+  REQUIRE(accesses[2].offset == 1000);
+  REQUIRE(accesses[2].time_ms == 4);
+}
+
+TEST_CASE("Prefetch manifest round trip", "[prefetch_manifest]") {
+  PrefetchManifest manifest;
+  manifest.Record("\\Device\\Cdrom0\\media\\file with spaces.bin", 4096,
+                  0x10000, 25);
+  manifest.Record("\\Device\\Cdrom0\\default.xex", 0, 12, 30);
+
+  PrefetchManifest loaded;
+  REQUIRE(loaded.Deserialize(manifest.Serialize()));
+  REQUIRE(loaded.accesses().size() == 2);
+  REQUIRE(loaded.accesses()[0].path ==
+          "\\Device\\Cdrom0\\media\\file with spaces.bin");
+  REQUIRE(loaded.accesses()[0].offset == 4096);
+  REQUIRE(loaded.accesses()[0].length == 0x10000);
+  REQUIRE(loaded.accesses()[0].time_ms == 25);
+  REQUIRE(loaded.accesses()[1].time_ms == 30);
+
+  REQUIRE_FALSE(loaded.Deserialize("12 nope\n"));
+  REQUIRE(loaded.empty());
+}
+
+}  // namespace xe::vfs::test
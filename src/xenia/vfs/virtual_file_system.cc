@@ -12,11 +12,23 @@
 #include "xenia/vfs/devices/xcontent_container_device.h"
 
 #include "devices/host_path_entry.h"
+#include "xenia/base/cvar.h"
+#include "xenia/base/filesystem.h"
 #include "xenia/base/literals.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/string.h"
 #include "xenia/kernel/xfile.h"
 
+DEFINE_bool(prefetch_manifest, false,
+            "Record the file reads a title performs while booting and, on "
+            "later boots, prefetch the same data in the background ahead of "
+            "the title. Shortens load screens on slow storage.",
+            "Storage");
+DEFINE_uint32(prefetch_manifest_lead_ms, 2000,
+              "How far ahead of the recorded timeline the prefetch manifest is "
+              "replayed, in milliseconds.",
+              "Storage");
+
 namespace xe {
 namespace vfs {
 
@@ -25,12 +37,14 @@ using namespace xe::literals;
 VirtualFileSystem::VirtualFileSystem() {}
 
 VirtualFileSystem::~VirtualFileSystem() {
+  EndPrefetchManifest();
   // Delete all devices.
   // This will explode if anyone is still using data from them.
   Clear();
 }
 
 void VirtualFileSystem::Clear() {
+  StopPrefetchReplay();
   devices_.clear();
   symlinks_.clear();
 }
@@ -42,6 +56,8 @@ bool VirtualFileSystem::RegisterDevice(std::unique_ptr<Device> device) {
 }
 
 bool VirtualFileSystem::UnregisterDevice(const std::string_view path) {
+  // The replay may be holding entries of the device.
+  StopPrefetchReplay();
   auto global_lock = global_critical_region_.Acquire();
   for (auto it = devices_.begin(); it != devices_.end(); ++it) {
     if ((*it)->mount_path() == path) {
@@ -333,6 +349,107 @@ X_STATUS VirtualFileSystem::OpenFile(Entry* root_entry,
   return result;
 }
 
+void VirtualFileSystem::BeginPrefetchManifest(
+    const std::filesystem::path& manifest_path) {
+  EndPrefetchManifest();
+  if (!cvars::prefetch_manifest) {
+    return;
+  }
+
+  PrefetchManifest manifest;
+  if (manifest.Load(manifest_path) && !manifest.empty()) {
+    XELOGI("Replaying prefetch manifest with {} accesses from {}",
+           manifest.accesses().size(), xe::path_to_utf8(manifest_path));
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    prefetch_stop_ = false;
+    xe::threading::Thread::CreationParameters params;
+    params.stack_size = 256 * 1024;
+    prefetch_thread_ = xe::threading::Thread::Create(
+        params, [this, manifest = std::move(manifest)]() {
+          ReplayPrefetchManifest(manifest);
+        });
+    if (prefetch_thread_) {
+      prefetch_thread_->set_name("VFS Prefetch");
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  prefetch_manifest_path_ = manifest_path;
+  recorded_manifest_.Clear();
+  prefetch_record_start_ = std::chrono::steady_clock::now();
+  prefetch_recording_ = true;
+}
+
+void VirtualFileSystem::EndPrefetchManifest() {
+  StopPrefetchReplay();
+  if (!prefetch_recording_.exchange(false)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  if (!recorded_manifest_.empty() &&
+      !recorded_manifest_.Save(prefetch_manifest_path_)) {
+    XELOGW("Failed to save prefetch manifest to {}",
+           xe::path_to_utf8(prefetch_manifest_path_));
+  }
+  recorded_manifest_.Clear();
+}
+
+void VirtualFileSystem::RecordFileRead(const Entry* entry, uint64_t offset,
+                                       uint64_t length) {
+  if (!prefetch_recording_.load(std::memory_order_relaxed) || !entry ||
+      !entry->device()->is_read_only()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  if (!prefetch_recording_) {
+    return;
+  }
+  auto time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - prefetch_record_start_);
+  recorded_manifest_.Record(entry->absolute_path(), offset, length,
+                            uint32_t(time_ms.count()));
+}
+
+void VirtualFileSystem::ReplayPrefetchManifest(
+    const PrefetchManifest& manifest) {
+  auto start = std::chrono::steady_clock::now();
+  auto lead = std::chrono::milliseconds(cvars::prefetch_manifest_lead_ms);
+  for (const PrefetchManifest::Access& access : manifest.accesses()) {
+    {
+      // Stay close to the recorded timeline so the prefetched data isn't
+      // evicted from the caches before the guest gets to it.
+      std::unique_lock<std::mutex> lock(prefetch_mutex_);
+      if (prefetch_cond_.wait_until(
+              lock, start + std::chrono::milliseconds(access.time_ms) - lead,
+              [this]() { return prefetch_stop_; })) {
+        return;
+      }
+    }
+
+    Entry* entry = ResolvePath(access.path);
+    if (!entry || entry->attributes() & kFileAttributeDirectory) {
+      continue;
+    }
+    // Only ask the device to warm its caches - reading through a File would
+    // bypass them for large reads and block the guest's own reads.
+    entry->Prefetch(size_t(access.offset), size_t(access.length));
+  }
+}
+
+void VirtualFileSystem::StopPrefetchReplay() {
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    if (!prefetch_thread_) {
+      return;
+    }
+    prefetch_stop_ = true;
+  }
+  prefetch_cond_.notify_all();
+  xe::threading::Wait(prefetch_thread_.get(), false);
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  prefetch_thread_.reset();
+}
+
 X_STATUS VirtualFileSystem::ExtractContentFile(Entry* entry,
                                                std::filesystem::path base_path,
                                                uint64_t& progress,
@@ -10,15 +10,22 @@
 #ifndef XENIA_VFS_VIRTUAL_FILE_SYSTEM_H_
 #define XENIA_VFS_VIRTUAL_FILE_SYSTEM_H_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "xenia/base/mutex.h"
+#include "xenia/base/threading.h"
 #include "xenia/vfs/device.h"
 #include "xenia/vfs/entry.h"
 #include "xenia/vfs/file.h"
+#include "xenia/vfs/prefetch_manifest.h"
 
 namespace xe {
 namespace vfs {
@@ -49,6 +56,14 @@ class VirtualFileSystem {
                     bool is_non_directory, File** out_file,
                     FileAction* out_action);
 
+  // Starts recording reads of files on read-only devices and, if a manifest
+  // was recorded at manifest_path on an earlier boot, replays it in the
+  // background so the data is already cached when the guest asks for it.
+  void BeginPrefetchManifest(const std::filesystem::path& manifest_path);
+  // Stops the replay and saves the recorded manifest.
+  void EndPrefetchManifest();
+  void RecordFileRead(const Entry* entry, uint64_t offset, uint64_t length);
+
   static X_STATUS ExtractContentFile(Entry* entry,
                                      std::filesystem::path base_path,
                                      uint64_t& progress,
@@ -64,7 +79,18 @@ class VirtualFileSystem {
   std::vector<std::unique_ptr<Device>> devices_;
   std::unordered_map<std::string, std::string> symlinks_;
 
+  std::mutex prefetch_mutex_;
+  std::condition_variable prefetch_cond_;
+  bool prefetch_stop_ = false;
+  std::unique_ptr<xe::threading::Thread> prefetch_thread_;
+  std::atomic<bool> prefetch_recording_ = false;
+  std::chrono::steady_clock::time_point prefetch_record_start_;
+  std::filesystem::path prefetch_manifest_path_;
+  PrefetchManifest recorded_manifest_;
+
   bool ResolveSymbolicLink(const std::string_view path, std::string& result);
+  void ReplayPrefetchManifest(const PrefetchManifest& manifest);
+  void StopPrefetchReplay();
 };
 
 }  // namespace vfs
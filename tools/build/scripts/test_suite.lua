@@ -32,9 +32,9 @@ local function combined_test_suite(test_suite_name, project_root, base_path, con
       end
       filter({})
     end
-    defines({
+    defines(merge_arrays(config["defines"], {
       "XE_TEST_SUITE_NAME=\""..test_suite_name.."\"",
-    })
+    }))
     files({
       project_root.."/"..build_tools_src.."/test_suite_main.cc",
       project_root.."/src/xenia/base/console_app_main_"..platform_suffix..".cc",
@@ -71,6 +71,9 @@ local function split_test_suite(test_suite_name, project_root, base_path, config
         end
         filter({})
       end
+      if config["defines"] ~= nil then
+        defines(config["defines"])
+      end
       files({
         project_root.."/"..build_tools_src.."/test_suite_main.cc",
         file_path,